@@ -0,0 +1,392 @@
+/******************************************************************************
+* File Name:   binlog.c
+*
+* Description: Binary log channel: framed binary records sent over the debug
+*              UART, between the text lines of printf, or as a byte stream over
+*              CAN FD frames on a reserved identifier.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+#include "binlog.h"
+#include "canfd_frame.h"
+#include "canfd_txq.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* UART bytes collected before a HAL write */
+#define BINLOG_UART_CHUNK       (64u)
+
+/* A CAN FD frame of the log: sequence number, byte count, bytes. The count
+ * keeps the padding up to the next valid CAN FD length out of the stream. */
+#define BINLOG_CAN_HEADER       (2u)
+#define BINLOG_CAN_CHUNK        (CANFD_FRAME_MAX_LEN - BINLOG_CAN_HEADER)
+
+#define BINLOG_CRC_INIT         (0xFFFFu)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static binlog_stats_t binlog_stats;
+
+STATS_COUNTER(records, "binlog.records", &binlog_stats.records);
+STATS_COUNTER(bytes, "binlog.bytes", &binlog_stats.bytes);
+STATS_COUNTER(can_dropped, "binlog.can_dropped", &binlog_stats.can_dropped);
+
+/* Record in progress */
+static bool binlog_active;
+static binlog_channel_t binlog_channel;
+static uint32_t binlog_remaining;
+static uint16_t binlog_crc;
+
+/* Bytes not yet handed to the channel */
+static uint8_t binlog_chunk[BINLOG_UART_CHUNK];
+static uint32_t binlog_fill;
+static uint8_t binlog_can_seq;
+
+/* The Tx queue stayed full for BINLOG_CAN_WAIT_MS during this record */
+static bool binlog_can_stalled;
+
+/* CRC-16/CCITT, one nibble per step */
+static const uint16_t binlog_crc_table[16] =
+{
+    0x0000u, 0x1021u, 0x2042u, 0x3063u, 0x4084u, 0x50A5u, 0x60C6u, 0x70E7u,
+    0x8108u, 0x9129u, 0xA14Au, 0xB16Bu, 0xC18Cu, 0xD1ADu, 0xE1CEu, 0xF1EFu
+};
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void binlog_put(const uint8_t *data, uint32_t len);
+static void binlog_flush(void);
+static uint16_t binlog_crc_update(uint16_t crc, const uint8_t *data,
+                                  uint32_t len);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: binlog_begin
+********************************************************************************
+* Summary:
+* Starts a record of len payload bytes, written with binlog_write and closed
+* with binlog_end. One record at a time, thread context only. On the UART
+* channel the pending printf output is flushed first so that records never
+* split a text line.
+*
+* Parameters:
+*  channel    Output of the record
+*  type       BINLOG_TYPE_xxx
+*  len        Payload length in bytes
+*
+* Return:
+*  bool  false if a record is in progress or len is too large
+*
+*******************************************************************************/
+bool binlog_begin(binlog_channel_t channel, uint8_t type, uint32_t len)
+{
+    uint8_t header[BINLOG_HEADER_SIZE];
+
+    if (binlog_active || (len > BINLOG_MAX_PAYLOAD))
+    {
+        return false;
+    }
+
+    if (BINLOG_CHANNEL_UART == channel)
+    {
+        (void)fflush(stdout);
+    }
+
+    binlog_active = true;
+    binlog_channel = channel;
+    binlog_remaining = len;
+    binlog_fill = 0UL;
+    binlog_can_stalled = false;
+
+    header[0] = BINLOG_SYNC;
+    header[1] = type;
+    header[2] = (uint8_t)len;
+    header[3] = (uint8_t)(len >> 8);
+    binlog_crc = binlog_crc_update(BINLOG_CRC_INIT, &header[1],
+                                   BINLOG_HEADER_SIZE - 1UL);
+    binlog_put(header, BINLOG_HEADER_SIZE);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: binlog_write
+********************************************************************************
+* Summary:
+* Appends payload bytes to the current record. Bytes beyond the length given
+* to binlog_begin are discarded.
+*
+*******************************************************************************/
+void binlog_write(const void *data, uint32_t len)
+{
+    if (!binlog_active)
+    {
+        return;
+    }
+    if (len > binlog_remaining)
+    {
+        len = binlog_remaining;
+    }
+
+    binlog_crc = binlog_crc_update(binlog_crc, (const uint8_t *)data, len);
+    binlog_put((const uint8_t *)data, len);
+    binlog_remaining -= len;
+}
+
+/*******************************************************************************
+* Function Name: binlog_end
+********************************************************************************
+* Summary:
+* Closes the current record: pads a short payload with zeros so that the
+* framing stays intact, appends the CRC and sends the remaining bytes.
+*
+*******************************************************************************/
+void binlog_end(void)
+{
+    static const uint8_t zero[8] = { 0u };
+    uint8_t trailer[BINLOG_TRAILER_SIZE];
+
+    if (!binlog_active)
+    {
+        return;
+    }
+
+    while (0UL != binlog_remaining)
+    {
+        binlog_write(zero, (binlog_remaining < sizeof(zero)) ?
+                           binlog_remaining : sizeof(zero));
+    }
+
+    trailer[0] = (uint8_t)binlog_crc;
+    trailer[1] = (uint8_t)(binlog_crc >> 8);
+    binlog_put(trailer, BINLOG_TRAILER_SIZE);
+    binlog_flush();
+
+    binlog_stats.records++;
+    binlog_active = false;
+}
+
+/*******************************************************************************
+* Function Name: binlog_record
+********************************************************************************
+* Summary:
+* Sends a complete record from one buffer.
+*
+*******************************************************************************/
+bool binlog_record(binlog_channel_t channel, uint8_t type, const void *data,
+                   uint32_t len)
+{
+    if (!binlog_begin(channel, type, len))
+    {
+        return false;
+    }
+    binlog_write(data, len);
+    binlog_end();
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: binlog_seal
+********************************************************************************
+* Summary:
+* Frames a record built in place, for records that are stored rather than
+* sent: writes the header in front of and the CRC behind the len payload
+* bytes at record + BINLOG_HEADER_SIZE. The result is byte for byte the
+* record binlog_record would send.
+*
+* Parameters:
+*  record     Buffer of at least len + BINLOG_HEADER_SIZE + BINLOG_TRAILER_SIZE
+*  type       BINLOG_TYPE_xxx
+*  len        Payload length in bytes
+*
+* Return:
+*  uint32_t  Size of the record, 0 if len is too large
+*
+*******************************************************************************/
+uint32_t binlog_seal(uint8_t *record, uint8_t type, uint32_t len)
+{
+    uint16_t crc;
+
+    if (len > BINLOG_MAX_PAYLOAD)
+    {
+        return 0UL;
+    }
+
+    record[0] = BINLOG_SYNC;
+    record[1] = type;
+    record[2] = (uint8_t)len;
+    record[3] = (uint8_t)(len >> 8);
+    crc = binlog_crc_update(BINLOG_CRC_INIT, &record[1],
+                            (BINLOG_HEADER_SIZE - 1UL) + len);
+    record[BINLOG_HEADER_SIZE + len] = (uint8_t)crc;
+    record[BINLOG_HEADER_SIZE + len + 1UL] = (uint8_t)(crc >> 8);
+    return BINLOG_HEADER_SIZE + len + BINLOG_TRAILER_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: binlog_get_stats
+*******************************************************************************/
+const binlog_stats_t *binlog_get_stats(void)
+{
+    return &binlog_stats;
+}
+
+/*******************************************************************************
+* Function Name: binlog_put
+********************************************************************************
+* Summary:
+* Collects record bytes into the chunk of the channel: 64 bytes per UART
+* write, or the payload of one CAN FD frame.
+*
+*******************************************************************************/
+static void binlog_put(const uint8_t *data, uint32_t len)
+{
+    uint32_t chunk = (BINLOG_CHANNEL_CAN == binlog_channel) ?
+                     BINLOG_CAN_CHUNK : BINLOG_UART_CHUNK;
+
+    while (0UL != len)
+    {
+        uint32_t count = chunk - binlog_fill;
+
+        if (count > len)
+        {
+            count = len;
+        }
+        memcpy(&binlog_chunk[binlog_fill], data, count);
+        binlog_fill += count;
+        data += count;
+        len -= count;
+
+        if (binlog_fill == chunk)
+        {
+            binlog_flush();
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: binlog_flush
+********************************************************************************
+* Summary:
+* Hands the collected bytes to the channel. The UART write blocks until the
+* bytes are in the UART FIFO. A CAN FD frame waits up to BINLOG_CAN_WAIT_MS
+* for a free slot of the Tx queue, so a record longer than the queue is paced
+* by the bus. A frame that still does not fit is dropped, and so is the rest
+* of the record; the host sees the gap in the sequence numbers and the record
+* fails its CRC.
+*
+*******************************************************************************/
+static void binlog_flush(void)
+{
+    if (0UL == binlog_fill)
+    {
+        return;
+    }
+
+    if (BINLOG_CHANNEL_UART == binlog_channel)
+    {
+        size_t size = binlog_fill;
+
+        (void)cyhal_uart_write(&cy_retarget_io_uart_obj, binlog_chunk, &size);
+    }
+    else
+    {
+        canfd_frame_t *frame = NULL;
+
+        if (!binlog_can_stalled &&
+            canfd_txq_wait_space(1UL, BINLOG_CAN_WAIT_MS))
+        {
+            frame = canfd_txq_alloc();
+        }
+        binlog_can_stalled = (NULL == frame);
+
+        if (NULL == frame)
+        {
+            binlog_stats.can_dropped++;
+        }
+        else
+        {
+            uint8_t *bytes = canfd_frame_bytes(frame);
+            uint32_t len = canfd_dlc_to_len(canfd_len_to_dlc(
+                               BINLOG_CAN_HEADER + binlog_fill));
+
+            frame->id = BINLOG_CAN_ID;
+            frame->flags = CANFD_FRAME_FLAG_FDF | CANFD_FRAME_FLAG_BRS;
+            frame->len = (uint8_t)len;
+            bytes[0] = binlog_can_seq;
+            bytes[1] = (uint8_t)binlog_fill;
+            memcpy(&bytes[BINLOG_CAN_HEADER], binlog_chunk, binlog_fill);
+            memset(&bytes[BINLOG_CAN_HEADER + binlog_fill], 0,
+                   len - BINLOG_CAN_HEADER - binlog_fill);
+            canfd_txq_commit();
+            binlog_stats.can_frames++;
+        }
+        binlog_can_seq++;
+    }
+
+    binlog_stats.bytes += binlog_fill;
+    binlog_fill = 0UL;
+}
+
+/*******************************************************************************
+* Function Name: binlog_crc_update
+*******************************************************************************/
+static uint16_t binlog_crc_update(uint16_t crc, const uint8_t *data,
+                                  uint32_t len)
+{
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[idx] << 8);
+        crc = (uint16_t)((crc << 4) ^ binlog_crc_table[crc >> 12]);
+        crc = (uint16_t)((crc << 4) ^ binlog_crc_table[crc >> 12]);
+    }
+    return crc;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,115 @@
+/******************************************************************************
+* File Name:   binlog.h
+*
+* Description: Binary log channel: framed binary records sent over the debug
+*              UART, between the text lines of printf, or as a byte stream over
+*              CAN FD frames on a reserved identifier.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef BINLOG_H_
+#define BINLOG_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Identifier of the CAN FD frames carrying the binary log */
+#ifndef BINLOG_CAN_ID
+#define BINLOG_CAN_ID           (0x7F0u)
+#endif
+
+/* Longest wait for a free Tx queue slot per CAN FD frame of the log. After
+ * one timeout the rest of the record is dropped without waiting. */
+#ifndef BINLOG_CAN_WAIT_MS
+#define BINLOG_CAN_WAIT_MS      (50u)
+#endif
+
+/* Record layout: sync, type, payload length (16-bit LE), payload, CRC-16
+ * (CCITT, LE) over type, length and payload. The sync byte never occurs in
+ * the text output, so a host can split the UART stream into text and
+ * records. */
+#define BINLOG_SYNC             (0x1Eu)
+#define BINLOG_HEADER_SIZE      (4u)
+#define BINLOG_TRAILER_SIZE     (2u)
+#define BINLOG_MAX_PAYLOAD      (0xFFFFu)
+
+/* Record types */
+#define BINLOG_TYPE_STATS_SCHEMA    (0x01u)
+#define BINLOG_TYPE_STATS_VALUES    (0x02u)
+#define BINLOG_TYPE_TRACE           (0x03u)
+#define BINLOG_TYPE_FAULT           (0x04u)
+#define BINLOG_TYPE_CAPTURE         (0x05u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef enum
+{
+    BINLOG_CHANNEL_UART,    /* Debug UART used by retarget-io */
+    BINLOG_CHANNEL_CAN      /* Tx queue, frames with BINLOG_CAN_ID */
+} binlog_channel_t;
+
+typedef struct
+{
+    uint32_t records;       /* Records completed */
+    uint32_t bytes;         /* Bytes sent, framing included */
+    uint32_t can_frames;    /* CAN FD frames queued */
+    uint32_t can_dropped;   /* CAN FD frames lost to a Tx queue full for
+                             * BINLOG_CAN_WAIT_MS */
+} binlog_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool binlog_begin(binlog_channel_t channel, uint8_t type, uint32_t len);
+void binlog_write(const void *data, uint32_t len);
+void binlog_end(void);
+bool binlog_record(binlog_channel_t channel, uint8_t type, const void *data,
+                   uint32_t len);
+uint32_t binlog_seal(uint8_t *record, uint8_t type, uint32_t len);
+const binlog_stats_t *binlog_get_stats(void);
+
+#endif /* BINLOG_H_ */
+
+/* [] END OF FILE */
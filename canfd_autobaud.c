@@ -0,0 +1,488 @@
+/******************************************************************************
+* File Name:   canfd_autobaud.c
+*
+* Description: Bit rate detection: cycles through the bit timing profiles
+*              in bus monitoring mode and locks to the one that receives
+*              frames without errors.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "canfd_autobaud.h"
+#include "canfd_bitrate.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* PSR.LEC and DLEC: no error, no change since the last read */
+#define AUTOBAUD_LEC_NONE           (0UL)
+#define AUTOBAUD_LEC_NO_CHANGE      (7UL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef enum
+{
+    AUTOBAUD_SILENT,            /* Nothing heard, the window is inconclusive */
+    AUTOBAUD_LOCK,
+    AUTOBAUD_REJECT_NOMINAL,    /* Errors in the arbitration phase */
+    AUTOBAUD_REJECT_DATA,       /* Arbitration phase right, data phase wrong */
+} autobaud_verdict_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static cy_en_canfd_status_t canfd_autobaud_select(uint32_t profile,
+                                                  bool monitor);
+static autobaud_verdict_t canfd_autobaud_listen(uint32_t profile,
+                                                uint32_t start_ms);
+static void canfd_autobaud_reorder(uint32_t pos, bool same_first);
+static bool canfd_autobaud_same_nominal(uint32_t a, uint32_t b);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type *autobaud_base;
+static uint32_t autobaud_chan;
+
+/* Order of the profiles in the current run */
+static uint8_t autobaud_order[CANFD_AUTOBAUD_MAX_PROFILES];
+static uint32_t autobaud_count;
+
+static canfd_autobaud_stats_t autobaud_stats;
+
+static const uint8_t autobaud_likely[] = CANFD_AUTOBAUD_ORDER;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_run
+********************************************************************************
+* Summary:
+* Finds the bit rate of the bus without disturbing it. The channel listens in
+* bus monitoring mode, where it sends neither acknowledgements nor error
+* frames, with one profile of canfd_bitrate_profiles after the other: first
+* the hint, then CANFD_AUTOBAUD_ORDER. Every read of the PSR gives the result
+* of the last frame (LEC, DLEC) and resets it, so polling it counts the
+* frames received without error and the errors of each phase.
+*
+* A profile locks as soon as CANFD_AUTOBAUD_MIN_FRAMES frames with bit rate
+* switching arrive without error, or when its window ends with more frames
+* than errors and fewer than CANFD_AUTOBAUD_MAX_ERRORS errors. It is rejected
+* as soon as CANFD_AUTOBAUD_MAX_ERRORS errors outnumber the frames. Errors
+* only in the data phase mean the arbitration rate is right, so the profiles
+* with the same arbitration timing are tried next; errors in the arbitration
+* phase move them to the end. A silent bus keeps the current profile until
+* the timeout. Without a lock, the profile with the most frames over its
+* errors is taken after the timeout, as a best effort that is not reported
+* as locked.
+*
+* The monitored frames count only if another node acknowledges them. Call
+* after Cy_CANFD_Init, before the modules that read the PSR; blocks for up to
+* CANFD_AUTOBAUD_TIMEOUT_MS. The channel is left in normal operation with
+* the profile locked to, the best effort, or the hint if no profile received
+* more frames than errors.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  hint       Profile to try first, for example the last one locked to
+*
+* Return:
+*  cy_rslt_t  CY_RSLT_SUCCESS if locked, CANFD_AUTOBAUD_RSLT_BEST_EFFORT,
+*             CANFD_AUTOBAUD_RSLT_NO_TRAFFIC, CANFD_AUTOBAUD_RSLT_NO_MATCH,
+*             the result of sys_tick_init, or the cy_en_canfd_status_t of a
+*             failed configuration change
+*
+*******************************************************************************/
+cy_rslt_t canfd_autobaud_run(CANFD_Type *base, uint32_t chan, uint32_t hint)
+{
+    const canfd_autobaud_candidate_t *cand;
+    autobaud_verdict_t verdict = AUTOBAUD_SILENT;
+    cy_en_canfd_status_t status;
+    cy_rslt_t result = sys_tick_init();
+    uint32_t profiles = canfd_bitrate_profile_count;
+    uint32_t start_ms;
+    uint32_t pos = 0UL;
+    uint32_t idx;
+    uint32_t best;
+    int32_t best_score = 0;
+    int32_t score;
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    autobaud_base = base;
+    autobaud_chan = chan;
+    memset(&autobaud_stats, 0, sizeof(autobaud_stats));
+    if (profiles > CANFD_AUTOBAUD_MAX_PROFILES)
+    {
+        profiles = CANFD_AUTOBAUD_MAX_PROFILES;
+    }
+    if (hint >= profiles)
+    {
+        hint = CANFD_BITRATE_DEFAULT_PROFILE;
+    }
+
+    /* The hint, the likely profiles, then any others in table order */
+    autobaud_order[0] = (uint8_t)hint;
+    autobaud_count = 1UL;
+    for (idx = 0UL; idx < (sizeof(autobaud_likely) + profiles); idx++)
+    {
+        uint32_t profile = (idx < sizeof(autobaud_likely)) ?
+                           autobaud_likely[idx] :
+                           (idx - sizeof(autobaud_likely));
+        bool listed = (profile >= profiles);
+
+        for (uint32_t i = 0UL; i < autobaud_count; i++)
+        {
+            listed = listed || (autobaud_order[i] == profile);
+        }
+        if (!listed)
+        {
+            autobaud_order[autobaud_count++] = (uint8_t)profile;
+        }
+    }
+
+    start_ms = sys_tick_ms();
+    while (((sys_tick_ms() - start_ms) < CANFD_AUTOBAUD_TIMEOUT_MS) &&
+           (AUTOBAUD_LOCK != verdict))
+    {
+        if (AUTOBAUD_SILENT != verdict)
+        {
+            pos = (pos + 1UL) % autobaud_count;
+        }
+        status = canfd_autobaud_select(autobaud_order[pos], true);
+        if (CY_CANFD_SUCCESS != status)
+        {
+            result = (cy_rslt_t)status;
+            break;
+        }
+
+        verdict = canfd_autobaud_listen(autobaud_order[pos], start_ms);
+        if (AUTOBAUD_REJECT_DATA == verdict)
+        {
+            canfd_autobaud_reorder(pos, true);
+        }
+        else if (AUTOBAUD_REJECT_NOMINAL == verdict)
+        {
+            canfd_autobaud_reorder(pos, false);
+        }
+        else
+        {
+            /* Locked, or nothing heard yet */
+        }
+    }
+    autobaud_stats.time_ms = sys_tick_ms() - start_ms;
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        /* The configuration change failed; leave the channel as it is */
+        return result;
+    }
+
+    best = autobaud_order[pos];
+    if (AUTOBAUD_LOCK != verdict)
+    {
+        /* Best effort after the timeout: most frames over the errors */
+        result = CANFD_AUTOBAUD_RSLT_NO_TRAFFIC;
+        best = hint;
+        for (idx = 0UL; idx < profiles; idx++)
+        {
+            cand = &autobaud_stats.candidates[idx];
+            score = (int32_t)cand->frames -
+                    (int32_t)(cand->arb_errors + cand->data_errors);
+            if (0UL != (cand->frames + cand->arb_errors + cand->data_errors))
+            {
+                if (CANFD_AUTOBAUD_RSLT_NO_TRAFFIC == result)
+                {
+                    result = CANFD_AUTOBAUD_RSLT_NO_MATCH;
+                }
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best = idx;
+                    result = CANFD_AUTOBAUD_RSLT_BEST_EFFORT;
+                }
+            }
+        }
+    }
+
+    autobaud_stats.profile = best;
+    autobaud_stats.locked = (CY_RSLT_SUCCESS == result);
+    autobaud_stats.best_effort = (CANFD_AUTOBAUD_RSLT_BEST_EFFORT == result);
+    autobaud_stats.data_verified =
+        (autobaud_stats.locked || autobaud_stats.best_effort) &&
+        (0UL != autobaud_stats.candidates[best].brs_frames);
+    (void)canfd_autobaud_select(best, false);
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_print_stats
+*******************************************************************************/
+void canfd_autobaud_print_stats(void)
+{
+    const canfd_autobaud_candidate_t *cand;
+
+    printf("Autobaud: %s %s%s after %lu ms, %lu profile changes\r\n",
+           autobaud_stats.locked ? "locked to" :
+           (autobaud_stats.best_effort ? "not locked, best effort" :
+                                         "no match, using"),
+           canfd_bitrate_profiles[autobaud_stats.profile].name,
+           ((autobaud_stats.locked || autobaud_stats.best_effort) &&
+            !autobaud_stats.data_verified) ?
+           " (data phase not verified)" : "",
+           (unsigned long)autobaud_stats.time_ms,
+           (unsigned long)autobaud_stats.switches);
+
+    for (uint32_t idx = 0UL; idx < autobaud_count; idx++)
+    {
+        cand = &autobaud_stats.candidates[autobaud_order[idx]];
+        if (0UL != cand->windows)
+        {
+            printf("  %-8s %4lu ms: %lu frames (%lu BRS), %lu arbitration "
+                   "and %lu data phase errors\r\n",
+                   canfd_bitrate_profiles[autobaud_order[idx]].name,
+                   (unsigned long)cand->time_ms, (unsigned long)cand->frames,
+                   (unsigned long)cand->brs_frames,
+                   (unsigned long)cand->arb_errors,
+                   (unsigned long)cand->data_errors);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_get_stats
+*******************************************************************************/
+const canfd_autobaud_stats_t *canfd_autobaud_get_stats(void)
+{
+    return &autobaud_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_select
+********************************************************************************
+* Summary:
+* Writes the timing of a profile, in bus monitoring mode or for normal
+* operation, and restarts the channel. The restart waits for 11 recessive
+* bits before the channel takes part in the bus traffic again.
+*
+*******************************************************************************/
+static cy_en_canfd_status_t canfd_autobaud_select(uint32_t profile,
+                                                  bool monitor)
+{
+    const canfd_bitrate_profile_t *timing = &canfd_bitrate_profiles[profile];
+    cy_en_canfd_status_t status;
+    uint32_t cccr;
+
+    status = Cy_CANFD_ConfigChangesEnable(autobaud_base, autobaud_chan);
+    if (CY_CANFD_SUCCESS == status)
+    {
+        Cy_CANFD_SetBitrate(autobaud_base, autobaud_chan, &timing->nominal);
+        Cy_CANFD_SetFastBitrate(autobaud_base, autobaud_chan, &timing->data);
+        cccr = CANFD_CCCR(autobaud_base, autobaud_chan) &
+               ~CANFD_CH_M_TTCAN_CCCR_MON__Msk;
+        CANFD_CCCR(autobaud_base, autobaud_chan) =
+            monitor ? (cccr | CANFD_CH_M_TTCAN_CCCR_MON__Msk) : cccr;
+        status = Cy_CANFD_ConfigChangesDisable(autobaud_base, autobaud_chan);
+        autobaud_stats.switches++;
+    }
+
+    /* Drop the codes of the previous timing */
+    (void)CANFD_PSR(autobaud_base, autobaud_chan);
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_listen
+********************************************************************************
+* Summary:
+* Polls the PSR for one window, or until the verdict is clear.
+*
+* Parameters:
+*  profile    Profile selected
+*  start_ms   Start of the detection, for the timeout
+*
+*******************************************************************************/
+static autobaud_verdict_t canfd_autobaud_listen(uint32_t profile,
+                                                uint32_t start_ms)
+{
+    canfd_autobaud_candidate_t *cand = &autobaud_stats.candidates[profile];
+    uint32_t window_ms = sys_tick_ms();
+    uint32_t frames = 0UL;
+    uint32_t brs_frames = 0UL;
+    uint32_t arb_errors = 0UL;
+    uint32_t data_errors = 0UL;
+    autobaud_verdict_t verdict = AUTOBAUD_SILENT;
+    uint32_t psr;
+    uint32_t lec;
+
+    while (AUTOBAUD_SILENT == verdict)
+    {
+        psr = CANFD_PSR(autobaud_base, autobaud_chan);
+        lec = _FLD2VAL(CANFD_CH_M_TTCAN_PSR_LEC, psr);
+        if (AUTOBAUD_LEC_NONE == lec)
+        {
+            frames++;
+            if (0UL != (psr & CANFD_CH_M_TTCAN_PSR_RBRS_Msk))
+            {
+                brs_frames++;
+            }
+        }
+        else if (AUTOBAUD_LEC_NO_CHANGE != lec)
+        {
+            arb_errors++;
+        }
+        else
+        {
+            /* Nothing since the last read */
+        }
+
+        lec = _FLD2VAL(CANFD_CH_M_TTCAN_PSR_DLEC, psr);
+        if ((AUTOBAUD_LEC_NONE != lec) && (AUTOBAUD_LEC_NO_CHANGE != lec))
+        {
+            data_errors++;
+        }
+
+        if ((arb_errors >= CANFD_AUTOBAUD_MAX_ERRORS) && (arb_errors > frames))
+        {
+            verdict = AUTOBAUD_REJECT_NOMINAL;
+        }
+        else if ((data_errors >= CANFD_AUTOBAUD_MAX_ERRORS) &&
+                 (data_errors > brs_frames))
+        {
+            verdict = AUTOBAUD_REJECT_DATA;
+        }
+        else if ((brs_frames >= CANFD_AUTOBAUD_MIN_FRAMES) &&
+                 (0UL == (arb_errors + data_errors)))
+        {
+            verdict = AUTOBAUD_LOCK;
+        }
+        else if ((0UL == (frames + arb_errors + data_errors)) &&
+                 ((sys_tick_ms() - start_ms) >= CANFD_AUTOBAUD_TIMEOUT_MS))
+        {
+            /* Silent until the timeout */
+            break;
+        }
+        else if ((0UL != (frames + arb_errors + data_errors)) &&
+                 ((sys_tick_ms() - window_ms) >= CANFD_AUTOBAUD_WINDOW_MS))
+        {
+            /* Window over: frames with few errors lock, even without bit
+             * rate switching to confirm the data phase */
+            if ((frames > (arb_errors + data_errors)) &&
+                ((arb_errors + data_errors) < CANFD_AUTOBAUD_MAX_ERRORS))
+            {
+                verdict = AUTOBAUD_LOCK;
+            }
+            else
+            {
+                verdict = (arb_errors >= data_errors) ?
+                          AUTOBAUD_REJECT_NOMINAL : AUTOBAUD_REJECT_DATA;
+            }
+        }
+        else
+        {
+            /* The window starts with the first frame or error */
+            if (0UL == (frames + arb_errors + data_errors))
+            {
+                window_ms = sys_tick_ms();
+            }
+        }
+    }
+
+    cand->frames += frames;
+    cand->brs_frames += brs_frames;
+    cand->arb_errors += arb_errors;
+    cand->data_errors += data_errors;
+    cand->windows++;
+    cand->time_ms += sys_tick_ms() - window_ms;
+    return verdict;
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_reorder
+********************************************************************************
+* Summary:
+* Moves the untried profiles with the same arbitration timing as the one at
+* pos to the front of the rest of the order, or to its end.
+*
+*******************************************************************************/
+static void canfd_autobaud_reorder(uint32_t pos, bool same_first)
+{
+    uint8_t rest[CANFD_AUTOBAUD_MAX_PROFILES];
+    uint32_t count = 0UL;
+    uint32_t out = pos + 1UL;
+    uint32_t idx;
+
+    for (idx = pos + 1UL; idx < autobaud_count; idx++)
+    {
+        if (canfd_autobaud_same_nominal(autobaud_order[idx],
+                                        autobaud_order[pos]) == same_first)
+        {
+            autobaud_order[out++] = autobaud_order[idx];
+        }
+        else
+        {
+            rest[count++] = autobaud_order[idx];
+        }
+    }
+    for (idx = 0UL; idx < count; idx++)
+    {
+        autobaud_order[out++] = rest[idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_autobaud_same_nominal
+*******************************************************************************/
+static bool canfd_autobaud_same_nominal(uint32_t a, uint32_t b)
+{
+    return canfd_bitrate_bps(&canfd_bitrate_profiles[a].nominal) ==
+           canfd_bitrate_bps(&canfd_bitrate_profiles[b].nominal);
+}
+
+/* [] END OF FILE */
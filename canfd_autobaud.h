@@ -0,0 +1,134 @@
+/******************************************************************************
+* File Name:   canfd_autobaud.h
+*
+* Description: Bit rate detection: listens in bus monitoring mode with each
+*              bit timing profile and locks to the one that receives frames
+*              without errors.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_AUTOBAUD_H_
+#define CANFD_AUTOBAUD_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Profiles by likelihood, after the hint passed to canfd_autobaud_run: the
+ * timing of the templates, the same arbitration rate with a faster data
+ * phase, then the others */
+#ifndef CANFD_AUTOBAUD_ORDER
+#define CANFD_AUTOBAUD_ORDER            { 1u, 2u, 0u, 3u }
+#endif
+
+/* Profiles considered, from the start of canfd_bitrate_profiles */
+#ifndef CANFD_AUTOBAUD_MAX_PROFILES
+#define CANFD_AUTOBAUD_MAX_PROFILES     (8u)
+#endif
+
+/* Listening time per profile once the bus carries traffic */
+#ifndef CANFD_AUTOBAUD_WINDOW_MS
+#define CANFD_AUTOBAUD_WINDOW_MS        (100u)
+#endif
+
+/* Give up after this time, for example on a silent bus */
+#ifndef CANFD_AUTOBAUD_TIMEOUT_MS
+#define CANFD_AUTOBAUD_TIMEOUT_MS       (5000u)
+#endif
+
+/* Error-free frames with bit rate switching that lock a profile before the
+ * end of its window */
+#ifndef CANFD_AUTOBAUD_MIN_FRAMES
+#define CANFD_AUTOBAUD_MIN_FRAMES       (4u)
+#endif
+
+/* Errors that reject a profile before the end of its window */
+#ifndef CANFD_AUTOBAUD_MAX_ERRORS
+#define CANFD_AUTOBAUD_MAX_ERRORS       (3u)
+#endif
+
+/* No frames and no errors until the timeout */
+#define CANFD_AUTOBAUD_RSLT_NO_TRAFFIC  \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 14u)
+/* Traffic, but no profile received more frames than errors */
+#define CANFD_AUTOBAUD_RSLT_NO_MATCH    \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 15u)
+/* No profile locked; the one with the most frames over its errors is used */
+#define CANFD_AUTOBAUD_RSLT_BEST_EFFORT \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 19u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* What was heard with one profile, over all its windows */
+typedef struct
+{
+    uint32_t frames;            /* Frames without error (PSR.LEC = 0) */
+    uint32_t brs_frames;        /* Of them with bit rate switching */
+    uint32_t arb_errors;        /* Errors in the arbitration phase (LEC) */
+    uint32_t data_errors;       /* Errors in the data phase (DLEC) */
+    uint32_t windows;
+    uint32_t time_ms;
+} canfd_autobaud_candidate_t;
+
+typedef struct
+{
+    uint32_t profile;           /* Index in canfd_bitrate_profiles */
+    bool locked;
+    bool best_effort;           /* Not locked, taken after the timeout */
+    bool data_verified;         /* Data phase timing confirmed by BRS frames */
+    uint32_t time_ms;           /* Detection time */
+    uint32_t switches;          /* Profile changes */
+    canfd_autobaud_candidate_t candidates[CANFD_AUTOBAUD_MAX_PROFILES];
+} canfd_autobaud_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_autobaud_run(CANFD_Type *base, uint32_t chan, uint32_t hint);
+void canfd_autobaud_print_stats(void);
+const canfd_autobaud_stats_t *canfd_autobaud_get_stats(void);
+
+#endif /* CANFD_AUTOBAUD_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,187 @@
+/******************************************************************************
+* File Name:   canfd_bitrate.c
+*
+* Description: Bit timing profiles and a worst-case CAN FD frame duration model
+*              (arbitration phase at the nominal rate, data phase at the data
+*              rate, worst-case dynamic stuffing).
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_bitrate.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Register encoding of a bit timing given in time quanta */
+#define BITRATE(presc, seg1, seg2, sjw)                 \
+    {                                                   \
+        .prescaler     = (uint16_t)((presc) - 1u),      \
+        .timeSegment1  = (uint8_t)((seg1) - 1u),        \
+        .timeSegment2  = (uint8_t)((seg2) - 1u),        \
+        .syncJumpWidth = (uint8_t)((sjw) - 1u),         \
+    }
+
+/* Frame fields in bits, ISO 11898-1:2015 FD frame format */
+#define FD_ARB_BITS_STD         (17UL)  /* SOF, ID, RRS, IDE, FDF, res, BRS */
+#define FD_ARB_BITS_EXT         (36UL)  /* SOF, ID, SRR, IDE, ID ext, RRS, FDF, res, BRS */
+#define FD_CTRL_BITS            (5UL)   /* ESI, DLC */
+#define FD_STUFF_COUNT_BITS     (4UL)
+#define FD_CRC17_BITS           (17UL)
+#define FD_CRC21_BITS           (21UL)
+#define FD_TAIL_BITS            (13UL)  /* CRC delim, ACK, ACK delim, EOF, IFS */
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* The second entry is the timing configured in the templates */
+const canfd_bitrate_profile_t canfd_bitrate_profiles[] =
+{
+    { "250k/1M", BITRATE(12u, 5u, 2u, 2u), BITRATE(3u, 5u, 2u, 2u) },
+    { "500k/1M", BITRATE( 6u, 5u, 2u, 2u), BITRATE(3u, 5u, 2u, 2u) },
+    { "500k/2M", BITRATE( 6u, 5u, 2u, 2u), BITRATE(1u, 8u, 3u, 3u) },
+    { "1M/4M",   BITRATE( 3u, 5u, 2u, 2u), BITRATE(1u, 4u, 1u, 1u) },
+};
+
+const uint32_t canfd_bitrate_profile_count =
+    sizeof(canfd_bitrate_profiles) / sizeof(canfd_bitrate_profiles[0]);
+
+/* Timing the channel runs with, for the frame time based estimates */
+static const canfd_bitrate_profile_t *bitrate_active =
+    &canfd_bitrate_profiles[CANFD_BITRATE_DEFAULT_PROFILE];
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_bitrate_bps
+********************************************************************************
+* Summary:
+* Returns the bit rate of a register encoded timing at CANFD_BITRATE_CLOCK_HZ.
+*
+*******************************************************************************/
+uint32_t canfd_bitrate_bps(const cy_stc_canfd_bitrate_t *timing)
+{
+    uint32_t tq_per_bit = 3UL + (uint32_t)timing->timeSegment1 +
+                          (uint32_t)timing->timeSegment2;
+
+    return CANFD_BITRATE_CLOCK_HZ /
+           (((uint32_t)timing->prescaler + 1UL) * tq_per_bit);
+}
+
+/*******************************************************************************
+* Function Name: canfd_bitrate_sample_point_permille
+********************************************************************************
+* Summary:
+* Returns the sample point position in 1/1000 of the bit time.
+*
+*******************************************************************************/
+uint32_t canfd_bitrate_sample_point_permille(const cy_stc_canfd_bitrate_t *timing)
+{
+    uint32_t before = 2UL + (uint32_t)timing->timeSegment1;
+    uint32_t total  = before + 1UL + (uint32_t)timing->timeSegment2;
+
+    return (before * 1000UL) / total;
+}
+
+/*******************************************************************************
+* Function Name: canfd_bitrate_frame_time_ns
+********************************************************************************
+* Summary:
+* Worst-case duration of one data frame including the interframe space. The
+* dynamic stuff bits are counted as one per four bits in each phase; the CRC
+* field uses the fixed stuff bits of the FD format.
+*
+* Parameters:
+*  profile      Bit timing
+*  len          Payload length in bytes (rounded up to a DLC length)
+*  extended_id  true for a 29-bit identifier
+*  brs          true if the data phase uses the data bit rate
+*
+* Return:
+*  uint32_t     frame time in nanoseconds
+*
+*******************************************************************************/
+uint32_t canfd_bitrate_frame_time_ns(const canfd_bitrate_profile_t *profile,
+                                     uint32_t len, bool extended_id, bool brs)
+{
+    uint32_t arb_bits = extended_id ? FD_ARB_BITS_EXT : FD_ARB_BITS_STD;
+    uint32_t crc_bits = (len > 16UL) ? FD_CRC21_BITS : FD_CRC17_BITS;
+    uint32_t data_bits = FD_CTRL_BITS + (8UL * len);
+    uint32_t nominal_bps = canfd_bitrate_bps(&profile->nominal);
+    uint32_t data_bps = brs ? canfd_bitrate_bps(&profile->data) : nominal_bps;
+    uint64_t nominal_total;
+    uint64_t data_total;
+
+    arb_bits += (arb_bits - 1UL) / 4UL;
+    data_bits += (data_bits - 1UL) / 4UL;
+    /* Stuff count and CRC carry a fixed stuff bit every four bits */
+    data_bits += FD_STUFF_COUNT_BITS + crc_bits +
+                 ((FD_STUFF_COUNT_BITS + crc_bits + 3UL) / 4UL);
+
+    nominal_total = ((uint64_t)(arb_bits + FD_TAIL_BITS) * 1000000000ULL) /
+                    nominal_bps;
+    data_total = ((uint64_t)data_bits * 1000000000ULL) / data_bps;
+
+    return (uint32_t)(nominal_total + data_total);
+}
+
+/*******************************************************************************
+* Function Name: canfd_bitrate_set_active
+********************************************************************************
+* Summary:
+* Records the profile the channel runs with, when it is not the one of
+* design.modus. Modules that estimate frame times at start-up read it with
+* canfd_bitrate_get_active, so set it before initializing them.
+*
+*******************************************************************************/
+void canfd_bitrate_set_active(const canfd_bitrate_profile_t *profile)
+{
+    bitrate_active = profile;
+}
+
+/*******************************************************************************
+* Function Name: canfd_bitrate_get_active
+*******************************************************************************/
+const canfd_bitrate_profile_t *canfd_bitrate_get_active(void)
+{
+    return bitrate_active;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name:   canfd_bitrate.h
+*
+* Description: Bit timing profiles for the CAN FD channel and the frame
+*              duration model used to report bus capacity.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CANFD_BITRATE_H_
+#define CANFD_BITRATE_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* CAN FD peripheral clock. The templates divide the 72 MHz peripheral clock
+ * by 3 (CY_CANFD_CLK_DIV); change this when the divider is changed. */
+#ifndef CANFD_BITRATE_CLOCK_HZ
+#define CANFD_BITRATE_CLOCK_HZ          (24000000UL)
+#endif
+
+/* Profile matching the nominalPrescaler/dataPrescaler settings of design.modus */
+#define CANFD_BITRATE_DEFAULT_PROFILE   (1u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Arbitration and data phase timing. The cy_stc_canfd_bitrate_t members use
+ * the register encoding, i.e. each value is the number of time quanta minus
+ * one, the same as the code generated from design.modus. */
+typedef struct
+{
+    const char *name;
+    cy_stc_canfd_bitrate_t nominal;
+    cy_stc_canfd_bitrate_t data;
+} canfd_bitrate_profile_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+extern const canfd_bitrate_profile_t canfd_bitrate_profiles[];
+extern const uint32_t canfd_bitrate_profile_count;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t canfd_bitrate_bps(const cy_stc_canfd_bitrate_t *timing);
+uint32_t canfd_bitrate_sample_point_permille(const cy_stc_canfd_bitrate_t *timing);
+uint32_t canfd_bitrate_frame_time_ns(const canfd_bitrate_profile_t *profile,
+                                     uint32_t len, bool extended_id, bool brs);
+void canfd_bitrate_set_active(const canfd_bitrate_profile_t *profile);
+const canfd_bitrate_profile_t *canfd_bitrate_get_active(void);
+
+#endif /* CANFD_BITRATE_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,682 @@
+/******************************************************************************
+* File Name:   canfd_calib.c
+*
+* Description: Bit timing calibration: sweeps the sample point and the
+*              synchronization jump width of both phases and picks the
+*              setting with the widest error-free margin.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "canfd_calib.h"
+#include "canfd_errlog.h"
+#include "canfd_txq.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Highest data phase prescaler (DBTP.DBRP) */
+#define CALIB_DATA_MAX_PRESCALER    (32UL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Register limits of a phase, in time quanta */
+typedef struct
+{
+    uint16_t max_tq;
+    uint16_t min_seg1;
+    uint16_t max_seg1;
+    uint8_t min_seg2;
+    uint8_t max_seg2;
+    uint8_t max_sjw;
+} calib_limits_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t canfd_calib_prescaler(const canfd_bitrate_profile_t *profile);
+static uint32_t canfd_calib_point_ms(const canfd_bitrate_profile_t *profile,
+                                     bool brs);
+static void canfd_calib_rescale(cy_stc_canfd_bitrate_t *timing,
+                                uint32_t prescaler,
+                                const calib_limits_t *limits);
+static void canfd_calib_set(cy_stc_canfd_bitrate_t *timing, uint32_t tq,
+                            uint32_t seg2, uint32_t sjw);
+static bool canfd_calib_sweep_sp(uint8_t phase, uint16_t *margin);
+static void canfd_calib_sweep_sjw(uint8_t phase);
+static bool canfd_calib_measure(uint8_t phase);
+static cy_en_canfd_status_t canfd_calib_select(bool loopback);
+static uint32_t canfd_calib_pending(void);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static const calib_limits_t calib_limits[2] =
+{
+    { 385u, 2u, 256u, 2u, 128u, 128u },     /* NBTP */
+    { 49u,  1u, 32u,  1u, 16u,  16u },      /* DBTP */
+};
+
+static CANFD_Type *calib_base;
+static uint32_t calib_chan;
+static uint32_t calib_fifo_mask;
+
+/* Timing under test */
+static cy_stc_canfd_bitrate_t calib_timing[2];
+
+static canfd_frame_t calib_frame;
+
+static canfd_calib_stats_t calib_stats;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_calib_run
+********************************************************************************
+* Summary:
+* Finds the most robust bit timing for the cable and transceivers at the bit
+* rates of a profile. Both phases are moved to the smallest common prescaler
+* first, which gives the finest steps at the same bit rate. Then the sample
+* point of the arbitration phase is swept with frames without bit rate
+* switching, and the one of the data phase with frames that switch. At each
+* setting CANFD_CALIB_FRAMES test frames are sent through the Tx queue and
+* the protocol errors counted (ECR.CEL). The sample point chosen is the
+* middle of the widest range without errors or unsent frames; then the
+* largest error-free SJW up to phase segment 2 is taken.
+*
+* With loopback, the channel runs in external loopback mode: it receives its
+* own frames from the transceiver and needs no other node, which measures
+* the transceiver loop delay but not the cable. Otherwise another node must
+* acknowledge the frames, and bad settings put error frames on the bus.
+* Each setting restarts the channel, which drops the frames still pending in
+* the hardware Tx FIFO. Blocks for up to a few seconds.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  profile    Bit rates to calibrate
+*  loopback   true for external loopback mode
+*  result     Calibrated timing, the timing of profile if none was found
+*
+* Return:
+*  cy_rslt_t  CANFD_CALIB_RSLT_NO_CLEAN if a phase had no error-free sample
+*             point, or the cy_en_canfd_status_t of a failed configuration
+*             change
+*
+*******************************************************************************/
+cy_rslt_t canfd_calib_run(CANFD_Type *base, uint32_t chan,
+                          const canfd_bitrate_profile_t *profile,
+                          bool loopback, canfd_bitrate_profile_t *result)
+{
+    uint32_t txbc = CANFD_TXBC(base, chan);
+    uint32_t dedicated = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_NDTB, txbc);
+    uint32_t fifo = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TFQS, txbc);
+    uint32_t start_ms;
+    uint32_t prescaler;
+    cy_rslt_t status;
+
+    status = sys_tick_init();
+    if (CY_RSLT_SUCCESS != status)
+    {
+        return status;
+    }
+
+    calib_base = base;
+    calib_chan = chan;
+    calib_fifo_mask = ((1UL << fifo) - 1UL) << dedicated;
+    memset(&calib_stats, 0, sizeof(calib_stats));
+    calib_stats.loopback = loopback;
+    calib_stats.point_ms[CANFD_CALIB_NOMINAL] =
+        canfd_calib_point_ms(profile, false);
+    calib_stats.point_ms[CANFD_CALIB_DATA] = canfd_calib_point_ms(profile, true);
+    start_ms = sys_tick_ms();
+
+    /* 64 bytes in runs of 64 equal bits: only stuff bits resynchronize */
+    memset(&calib_frame, 0, sizeof(calib_frame));
+    calib_frame.id = CANFD_CALIB_CAN_ID;
+    calib_frame.len = CANFD_FRAME_MAX_LEN;
+    for (uint32_t idx = 0UL; idx < CANFD_FRAME_MAX_WORDS; idx++)
+    {
+        calib_frame.data[idx] = (0UL != (idx & 2UL)) ? 0xFFFFFFFFUL : 0UL;
+    }
+
+    calib_timing[CANFD_CALIB_NOMINAL] = profile->nominal;
+    calib_timing[CANFD_CALIB_DATA] = profile->data;
+    prescaler = canfd_calib_prescaler(profile);
+    if (0UL != prescaler)
+    {
+        canfd_calib_rescale(&calib_timing[CANFD_CALIB_NOMINAL], prescaler,
+                            &calib_limits[CANFD_CALIB_NOMINAL]);
+        canfd_calib_rescale(&calib_timing[CANFD_CALIB_DATA], prescaler,
+                            &calib_limits[CANFD_CALIB_DATA]);
+    }
+
+    calib_stats.found =
+        canfd_calib_sweep_sp(CANFD_CALIB_NOMINAL,
+                             &calib_stats.nominal_margin_permille) &&
+        canfd_calib_sweep_sp(CANFD_CALIB_DATA,
+                             &calib_stats.data_margin_permille);
+    if (calib_stats.found)
+    {
+        canfd_calib_sweep_sjw(CANFD_CALIB_NOMINAL);
+        canfd_calib_sweep_sjw(CANFD_CALIB_DATA);
+    }
+    else
+    {
+        calib_timing[CANFD_CALIB_NOMINAL] = profile->nominal;
+        calib_timing[CANFD_CALIB_DATA] = profile->data;
+    }
+
+    calib_stats.result.name = profile->name;
+    calib_stats.result.nominal = calib_timing[CANFD_CALIB_NOMINAL];
+    calib_stats.result.data = calib_timing[CANFD_CALIB_DATA];
+    *result = calib_stats.result;
+
+    status = (cy_rslt_t)canfd_calib_select(false);
+    calib_stats.time_ms = sys_tick_ms() - start_ms;
+    if ((CY_RSLT_SUCCESS == status) && !calib_stats.found)
+    {
+        status = CANFD_CALIB_RSLT_NO_CLEAN;
+    }
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_apply
+********************************************************************************
+* Summary:
+* Writes the timing of a profile, for example a stored calibration, into the
+* running channel. The restart drops the frames pending in the hardware.
+*
+*******************************************************************************/
+cy_en_canfd_status_t canfd_calib_apply(CANFD_Type *base, uint32_t chan,
+                                       const canfd_bitrate_profile_t *profile)
+{
+    calib_base = base;
+    calib_chan = chan;
+    calib_timing[CANFD_CALIB_NOMINAL] = profile->nominal;
+    calib_timing[CANFD_CALIB_DATA] = profile->data;
+    return canfd_calib_select(false);
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_rx_frame
+********************************************************************************
+* Summary:
+* Counts and consumes the test frames received back in loopback mode, or
+* from a node that calibrates against this one.
+*
+* Return:
+*  bool  true if the frame was a test frame
+*
+*******************************************************************************/
+bool canfd_calib_rx_frame(const canfd_frame_t *frame)
+{
+    if ((CANFD_CALIB_CAN_ID != frame->id) ||
+        (0u != (frame->flags & CANFD_FRAME_FLAG_XTD)))
+    {
+        return false;
+    }
+
+    calib_stats.echoed++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_print_stats
+*******************************************************************************/
+void canfd_calib_print_stats(void)
+{
+    const canfd_calib_point_t *point;
+    const cy_stc_canfd_bitrate_t *timing;
+
+    if (0UL == calib_stats.points)
+    {
+        printf("Calibration: not run\r\n");
+        return;
+    }
+
+    printf("Calibration (%s): %lu settings in %lu ms (up to %lu/%lu ms "
+           "each), %lu test frames received\r\n",
+           calib_stats.loopback ? "loopback" : "live",
+           (unsigned long)calib_stats.points,
+           (unsigned long)calib_stats.time_ms,
+           (unsigned long)calib_stats.point_ms[CANFD_CALIB_NOMINAL],
+           (unsigned long)calib_stats.point_ms[CANFD_CALIB_DATA],
+           (unsigned long)calib_stats.echoed);
+    printf("  phase    tq  SP  SJW  sent  failed  errors  TEC\r\n");
+    for (uint32_t idx = 0UL; idx < calib_stats.points; idx++)
+    {
+        point = &calib_stats.point[idx];
+        printf("  %-7s %3u %2u.%u%% %3u %5u %7u %7u %4u%s\r\n",
+               (CANFD_CALIB_DATA == point->phase) ? "data" : "nominal",
+               point->tq, point->sp_permille / 10u, point->sp_permille % 10u,
+               point->sjw, point->sent, point->failed, point->errors,
+               point->tec, point->clean ? "" : "  x");
+    }
+
+    for (uint32_t phase = CANFD_CALIB_NOMINAL; phase <= CANFD_CALIB_DATA;
+         phase++)
+    {
+        timing = (CANFD_CALIB_DATA == phase) ? &calib_stats.result.data :
+                                               &calib_stats.result.nominal;
+        printf("  %s: prescaler %u, %u+%u tq, SP %lu permille (+/- %u), "
+               "SJW %u\r\n", (CANFD_CALIB_DATA == phase) ? "Data" : "Nominal",
+               timing->prescaler + 1u, timing->timeSegment1 + 2u,
+               timing->timeSegment2 + 1u,
+               (unsigned long)canfd_bitrate_sample_point_permille(timing),
+               (CANFD_CALIB_DATA == phase) ?
+               calib_stats.data_margin_permille :
+               calib_stats.nominal_margin_permille,
+               timing->syncJumpWidth + 1u);
+    }
+    if (!calib_stats.found)
+    {
+        printf("  No error-free sample point, timing of %s kept\r\n",
+               calib_stats.result.name);
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_get_stats
+*******************************************************************************/
+const canfd_calib_stats_t *canfd_calib_get_stats(void)
+{
+    return &calib_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_prescaler
+********************************************************************************
+* Summary:
+* Smallest prescaler common to both phases at which the bit times of the
+* profile are whole numbers of time quanta within the register limits.
+*
+* Return:
+*  uint32_t  prescaler, 0 if there is none
+*
+*******************************************************************************/
+static uint32_t canfd_calib_prescaler(const canfd_bitrate_profile_t *profile)
+{
+    uint32_t nominal = ((uint32_t)profile->nominal.prescaler + 1UL) *
+                       (3UL + profile->nominal.timeSegment1 +
+                        profile->nominal.timeSegment2);
+    uint32_t data = ((uint32_t)profile->data.prescaler + 1UL) *
+                    (3UL + profile->data.timeSegment1 +
+                     profile->data.timeSegment2);
+
+    for (uint32_t prescaler = 1UL; prescaler <= CALIB_DATA_MAX_PRESCALER;
+         prescaler++)
+    {
+        if ((0UL == (nominal % prescaler)) && (0UL == (data % prescaler)) &&
+            ((nominal / prescaler) <=
+             calib_limits[CANFD_CALIB_NOMINAL].max_tq) &&
+            ((data / prescaler) <= calib_limits[CANFD_CALIB_DATA].max_tq))
+        {
+            return prescaler;
+        }
+    }
+    return 0UL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_point_ms
+********************************************************************************
+* Summary:
+* Time a setting has for its test frames: at 250 kbit/s without bit rate
+* switching, 32 frames of 64 bytes alone take about 90 ms.
+*
+*******************************************************************************/
+static uint32_t canfd_calib_point_ms(const canfd_bitrate_profile_t *profile,
+                                     bool brs)
+{
+    uint64_t frames_ns = (uint64_t)CANFD_CALIB_FRAMES *
+                         canfd_bitrate_frame_time_ns(profile,
+                                                     CANFD_FRAME_MAX_LEN,
+                                                     false, brs);
+
+    return (uint32_t)(((frames_ns * CANFD_CALIB_TIME_FACTOR) + 999999ULL) /
+                      1000000ULL) + CANFD_CALIB_SLACK_MS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_rescale
+********************************************************************************
+* Summary:
+* Converts a timing to another prescaler at the same bit rate, keeping phase
+* segment 2 and the SJW as close as the new time quantum allows.
+*
+*******************************************************************************/
+static void canfd_calib_rescale(cy_stc_canfd_bitrate_t *timing,
+                                uint32_t prescaler,
+                                const calib_limits_t *limits)
+{
+    uint32_t clocks = (uint32_t)timing->prescaler + 1UL;
+    uint32_t tq = ((3UL + timing->timeSegment1 + timing->timeSegment2) *
+                   clocks) / prescaler;
+    uint32_t seg2 = (((uint32_t)timing->timeSegment2 + 1UL) * clocks) /
+                    prescaler;
+    uint32_t sjw = (((uint32_t)timing->syncJumpWidth + 1UL) * clocks) /
+                   prescaler;
+
+    seg2 = (seg2 < limits->min_seg2) ? limits->min_seg2 : seg2;
+    seg2 = (seg2 > limits->max_seg2) ? limits->max_seg2 : seg2;
+    if ((tq - 1UL - seg2) > limits->max_seg1)
+    {
+        seg2 = tq - 1UL - limits->max_seg1;
+    }
+
+    timing->prescaler = (uint16_t)(prescaler - 1UL);
+    canfd_calib_set(timing, tq, seg2, sjw);
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_set
+********************************************************************************
+* Summary:
+* Encodes a bit of tq time quanta with seg2 after the sample point; the SJW
+* is limited to seg2.
+*
+*******************************************************************************/
+static void canfd_calib_set(cy_stc_canfd_bitrate_t *timing, uint32_t tq,
+                            uint32_t seg2, uint32_t sjw)
+{
+    sjw = (sjw > seg2) ? seg2 : sjw;
+    sjw = (0UL == sjw) ? 1UL : sjw;
+    timing->timeSegment1 = (uint8_t)(tq - 2UL - seg2);
+    timing->timeSegment2 = (uint8_t)(seg2 - 1UL);
+    timing->syncJumpWidth = (uint8_t)(sjw - 1UL);
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_sweep_sp
+********************************************************************************
+* Summary:
+* Measures the sample points of a phase from CANFD_CALIB_SP_MIN_PERMILLE to
+* CANFD_CALIB_SP_MAX_PERMILLE, in at most CANFD_CALIB_SP_STEPS steps, and
+* selects the middle of the widest run of error-free settings.
+*
+* Parameters:
+*  phase   CANFD_CALIB_NOMINAL or CANFD_CALIB_DATA
+*  margin  Half the width of the run, in permille of the bit time
+*
+* Return:
+*  bool  false if no setting was error-free; the timing is unchanged
+*
+*******************************************************************************/
+static bool canfd_calib_sweep_sp(uint8_t phase, uint16_t *margin)
+{
+    const calib_limits_t *limits = &calib_limits[phase];
+    cy_stc_canfd_bitrate_t *timing = &calib_timing[phase];
+    cy_stc_canfd_bitrate_t saved = *timing;
+    uint32_t tq = 3UL + timing->timeSegment1 + timing->timeSegment2;
+    uint32_t sjw = (uint32_t)timing->syncJumpWidth + 1UL;
+    uint32_t best_first = 0UL;
+    uint32_t best_len = 0UL;
+    uint32_t run = 0UL;
+    uint32_t hi;
+    uint32_t lo;
+    uint32_t step;
+    const canfd_calib_point_t *low;
+    const canfd_calib_point_t *mid;
+
+    /* Phase segment 2 from long to short: the sample point moves later */
+    hi = (tq * (1000UL - CANFD_CALIB_SP_MIN_PERMILLE)) / 1000UL;
+    hi = (hi > limits->max_seg2) ? limits->max_seg2 : hi;
+    hi = (hi > (tq - 1UL - limits->min_seg1)) ? (tq - 1UL - limits->min_seg1) :
+                                                hi;
+    lo = ((tq * (1000UL - CANFD_CALIB_SP_MAX_PERMILLE)) + 999UL) / 1000UL;
+    lo = (lo < limits->min_seg2) ? limits->min_seg2 : lo;
+    if ((tq - 1UL) > (lo + limits->max_seg1))
+    {
+        lo = tq - 1UL - limits->max_seg1;
+    }
+    if (lo > hi)
+    {
+        return false;
+    }
+    step = ((hi - lo) / CANFD_CALIB_SP_STEPS) + 1UL;
+
+    for (uint32_t seg2 = hi; (seg2 >= lo) && (seg2 <= hi); seg2 -= step)
+    {
+        canfd_calib_set(timing, tq, seg2, sjw);
+        if (canfd_calib_measure(phase))
+        {
+            run++;
+            if (run > best_len)
+            {
+                best_len = run;
+                best_first = calib_stats.points - run;
+            }
+        }
+        else
+        {
+            run = 0UL;
+        }
+    }
+
+    if (0UL == best_len)
+    {
+        *timing = saved;
+        return false;
+    }
+
+    low = &calib_stats.point[best_first];
+    mid = &calib_stats.point[best_first + ((best_len - 1UL) / 2UL)];
+    *margin = (uint16_t)((calib_stats.point[best_first + best_len - 1UL]
+                          .sp_permille - low->sp_permille) / 2u);
+    canfd_calib_set(timing, tq, mid->seg2, sjw);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_sweep_sjw
+********************************************************************************
+* Summary:
+* Measures the SJW of a phase from 1 to phase segment 2 and keeps the
+* largest error-free one, which follows the most oscillator tolerance.
+*
+*******************************************************************************/
+static void canfd_calib_sweep_sjw(uint8_t phase)
+{
+    cy_stc_canfd_bitrate_t *timing = &calib_timing[phase];
+    uint32_t tq = 3UL + timing->timeSegment1 + timing->timeSegment2;
+    uint32_t seg2 = (uint32_t)timing->timeSegment2 + 1UL;
+    uint32_t max_sjw = (seg2 > calib_limits[phase].max_sjw) ?
+                       calib_limits[phase].max_sjw : seg2;
+    uint32_t step = ((max_sjw - 1UL) / CANFD_CALIB_SJW_STEPS) + 1UL;
+    uint32_t best = (uint32_t)timing->syncJumpWidth + 1UL;
+
+    for (uint32_t sjw = max_sjw; sjw >= 1UL; sjw = (sjw > step) ?
+                                                   (sjw - step) : 0UL)
+    {
+        canfd_calib_set(timing, tq, seg2, sjw);
+        if (canfd_calib_measure(phase))
+        {
+            best = sjw;
+            break;
+        }
+    }
+    canfd_calib_set(timing, tq, seg2, best);
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_measure
+********************************************************************************
+* Summary:
+* Restarts the channel with the timing under test and sends the test frames,
+* with bit rate switching for the data phase.
+*
+* Return:
+*  bool  true if all frames were sent in the time of the phase without error
+*
+*******************************************************************************/
+static bool canfd_calib_measure(uint8_t phase)
+{
+    const cy_stc_canfd_bitrate_t *timing = &calib_timing[phase];
+    uint32_t point_ms = calib_stats.point_ms[phase];
+    canfd_calib_point_t *point;
+    uint32_t start_ms;
+    uint32_t sent = 0UL;
+    uint32_t errors = 0UL;
+    uint32_t ecr;
+    uint32_t done;
+
+    if (calib_stats.points >= CANFD_CALIB_MAX_POINTS)
+    {
+        return false;
+    }
+
+    point = &calib_stats.point[calib_stats.points++];
+    point->phase = phase;
+    point->tq = (uint16_t)(3u + timing->timeSegment1 + timing->timeSegment2);
+    point->seg2 = (uint8_t)(timing->timeSegment2 + 1u);
+    point->sjw = (uint8_t)(timing->syncJumpWidth + 1u);
+    point->sp_permille = (uint16_t)canfd_bitrate_sample_point_permille(timing);
+
+    if (CY_CANFD_SUCCESS != canfd_calib_select(calib_stats.loopback))
+    {
+        return false;
+    }
+
+    calib_frame.flags = CANFD_FRAME_FLAG_FDF;
+    if (CANFD_CALIB_DATA == phase)
+    {
+        calib_frame.flags |= CANFD_FRAME_FLAG_BRS;
+    }
+
+    /* A bus off of the previous setting recovers after the restart */
+    start_ms = sys_tick_ms();
+    while ((0UL != (canfd_errlog_read_psr(calib_base, calib_chan) &
+                    CANFD_CH_M_TTCAN_PSR_BO_Msk)) &&
+           ((sys_tick_ms() - start_ms) < point_ms))
+    {
+    }
+    (void)CANFD_ECR(calib_base, calib_chan);
+
+    do
+    {
+        if ((sent < CANFD_CALIB_FRAMES) && (0UL != canfd_txq_space()))
+        {
+            calib_frame.data[0] = (calib_frame.data[0] & 0xFFFF0000UL) | sent;
+            if (canfd_txq_push(&calib_frame))
+            {
+                sent++;
+            }
+        }
+        (void)canfd_txq_service();
+
+        ecr = CANFD_ECR(calib_base, calib_chan);
+        errors += _FLD2VAL(CANFD_CH_M_TTCAN_ECR_CEL, ecr);
+        if (_FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC, ecr) > point->tec)
+        {
+            point->tec = (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC, ecr);
+        }
+        done = (sent >= CANFD_CALIB_FRAMES) && (0UL == canfd_calib_pending());
+    } while ((!done) && (errors < CANFD_CALIB_MAX_ERRORS) &&
+             ((sys_tick_ms() - start_ms) < point_ms));
+
+    point->sent = (uint16_t)sent;
+    point->failed = (uint16_t)(CANFD_CALIB_FRAMES - sent +
+                               canfd_calib_pending());
+    point->errors = (uint16_t)errors;
+    point->clean = (0UL == errors) && (0u == point->failed);
+    return point->clean;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_select
+********************************************************************************
+* Summary:
+* Writes the timing under test and the test mode, and restarts the channel.
+* The configuration change resets the Tx requests pending in the hardware;
+* the Tx queue drops its frames too, so that none of them spills into the
+* next setting.
+*
+*******************************************************************************/
+static cy_en_canfd_status_t canfd_calib_select(bool loopback)
+{
+    cy_en_canfd_status_t status;
+
+    status = Cy_CANFD_ConfigChangesEnable(calib_base, calib_chan);
+    if (CY_CANFD_SUCCESS == status)
+    {
+        Cy_CANFD_SetBitrate(calib_base, calib_chan,
+                            &calib_timing[CANFD_CALIB_NOMINAL]);
+        Cy_CANFD_SetFastBitrate(calib_base, calib_chan,
+                                &calib_timing[CANFD_CALIB_DATA]);
+        status = Cy_CANFD_TestModeConfig(calib_base, calib_chan, loopback ?
+                                         CY_CANFD_TEST_MODE_EXTERNAL_LOOP_BACK :
+                                         CY_CANFD_TEST_MODE_DISABLE);
+    }
+    if (CY_CANFD_SUCCESS == status)
+    {
+        status = Cy_CANFD_ConfigChangesDisable(calib_base, calib_chan);
+    }
+    canfd_txq_flush();
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: canfd_calib_pending
+********************************************************************************
+* Summary:
+* Frames in the Tx queue and in the hardware Tx FIFO.
+*
+*******************************************************************************/
+static uint32_t canfd_calib_pending(void)
+{
+    uint32_t pending = CANFD_TXBRP(calib_base, calib_chan) & calib_fifo_mask;
+    uint32_t count = canfd_txq_depth();
+
+    while (0UL != pending)
+    {
+        pending &= pending - 1UL;
+        count++;
+    }
+    return count;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,155 @@
+/******************************************************************************
+* File Name:   canfd_calib.h
+*
+* Description: Bit timing calibration: sweeps the sample point and the
+*              synchronization jump width of both phases and picks the
+*              setting with the widest error-free margin.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_CALIB_H_
+#define CANFD_CALIB_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "canfd_bitrate.h"
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Identifier of the test frames */
+#ifndef CANFD_CALIB_CAN_ID
+#define CANFD_CALIB_CAN_ID              (0x7F8u)
+#endif
+
+/* Test frames per setting. They have CANFD_CALIB_TIME_FACTOR times their
+ * frame time at the bit rates of the profile to get through, plus
+ * CANFD_CALIB_SLACK_MS for the other traffic and the restart */
+#ifndef CANFD_CALIB_FRAMES
+#define CANFD_CALIB_FRAMES              (32u)
+#endif
+#ifndef CANFD_CALIB_TIME_FACTOR
+#define CANFD_CALIB_TIME_FACTOR         (2u)
+#endif
+#ifndef CANFD_CALIB_SLACK_MS
+#define CANFD_CALIB_SLACK_MS            (20u)
+#endif
+
+/* Errors that end the measurement of a setting early */
+#ifndef CANFD_CALIB_MAX_ERRORS
+#define CANFD_CALIB_MAX_ERRORS          (4u)
+#endif
+
+/* Sample points swept, in 1/1000 of the bit time, and the most settings
+ * measured per phase */
+#ifndef CANFD_CALIB_SP_MIN_PERMILLE
+#define CANFD_CALIB_SP_MIN_PERMILLE     (500u)
+#endif
+#ifndef CANFD_CALIB_SP_MAX_PERMILLE
+#define CANFD_CALIB_SP_MAX_PERMILLE     (950u)
+#endif
+#ifndef CANFD_CALIB_SP_STEPS
+#define CANFD_CALIB_SP_STEPS            (16u)
+#endif
+#ifndef CANFD_CALIB_SJW_STEPS
+#define CANFD_CALIB_SJW_STEPS           (8u)
+#endif
+
+#define CANFD_CALIB_MAX_POINTS          (2u * (CANFD_CALIB_SP_STEPS + 1u + \
+                                               CANFD_CALIB_SJW_STEPS + 1u))
+
+/* Phases */
+#define CANFD_CALIB_NOMINAL             (0u)
+#define CANFD_CALIB_DATA                (1u)
+
+/* No error-free sample point in one of the phases; the timing of the
+ * profile is kept */
+#define CANFD_CALIB_RSLT_NO_CLEAN           \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 18u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* One measured setting */
+typedef struct
+{
+    uint8_t phase;              /* CANFD_CALIB_NOMINAL or CANFD_CALIB_DATA */
+    uint8_t sjw;                /* Synchronization jump width in tq */
+    uint8_t seg2;               /* Time quanta after the sample point */
+    uint8_t tec;                /* Highest transmit error counter */
+    uint16_t tq;                /* Time quanta per bit */
+    uint16_t sp_permille;       /* Sample point */
+    uint16_t sent;              /* Test frames queued */
+    uint16_t failed;            /* Test frames not sent in time */
+    uint16_t errors;            /* Protocol errors (ECR.CEL) */
+    bool clean;                 /* All frames sent without error */
+} canfd_calib_point_t;
+
+typedef struct
+{
+    canfd_bitrate_profile_t result; /* Timing chosen */
+    bool loopback;
+    bool found;
+    uint16_t nominal_margin_permille;   /* Error-free sample point range on */
+    uint16_t data_margin_permille;      /* either side of the one chosen */
+    uint32_t time_ms;
+    uint32_t point_ms[2];       /* Time per setting, by phase */
+    volatile uint32_t echoed;   /* Test frames received back */
+    uint32_t points;
+    canfd_calib_point_t point[CANFD_CALIB_MAX_POINTS];
+} canfd_calib_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_calib_run(CANFD_Type *base, uint32_t chan,
+                          const canfd_bitrate_profile_t *profile,
+                          bool loopback, canfd_bitrate_profile_t *result);
+cy_en_canfd_status_t canfd_calib_apply(CANFD_Type *base, uint32_t chan,
+                                       const canfd_bitrate_profile_t *profile);
+bool canfd_calib_rx_frame(const canfd_frame_t *frame);
+void canfd_calib_print_stats(void);
+const canfd_calib_stats_t *canfd_calib_get_stats(void);
+
+#endif /* CANFD_CALIB_H_ */
+
+/* [] END OF FILE */
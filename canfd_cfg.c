@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   canfd_cfg.c
+*
+* Description: Run-time copy of the CAN FD channel configuration. CANFD_config
+*              generated from design.modus is constant and sized for classic
+*              8-byte frames; this module copies it into RAM, sets all Rx and
+*              Tx elements to 64 bytes and installs the Tx queue completion
+*              callback before Cy_CANFD_Init is called.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_cfg.h"
+#include "canfd_txq.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static cy_stc_canfd_config_t canfd_cfg;
+
+/* Bit timing used when a profile is selected at run time */
+static cy_stc_canfd_bitrate_t canfd_cfg_nominal;
+static cy_stc_canfd_bitrate_t canfd_cfg_data;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_cfg_init
+********************************************************************************
+* Summary:
+* Builds the run-time configuration from the generated CANFD_config and
+* returns it for Cy_CANFD_Init.
+*
+* Return:
+*  const cy_stc_canfd_config_t *  configuration to pass to Cy_CANFD_Init
+*
+*******************************************************************************/
+const cy_stc_canfd_config_t *canfd_cfg_init(void)
+{
+    canfd_cfg = CANFD_config;
+
+    /* Every element carries a full CAN FD payload */
+    canfd_cfg.rxBufferDataSize = CY_CANFD_BUFFER_DATA_SIZE_64;
+    canfd_cfg.rxFifo0DataSize  = CY_CANFD_BUFFER_DATA_SIZE_64;
+    canfd_cfg.rxFifo1DataSize  = CY_CANFD_BUFFER_DATA_SIZE_64;
+    canfd_cfg.txBufferDataSize = CY_CANFD_BUFFER_DATA_SIZE_64;
+
+    /* Transmission complete refills the hardware Tx FIFO from the Tx queue */
+    canfd_cfg.txCallback = canfd_txq_on_tx_complete;
+
+    return &canfd_cfg;
+}
+
+/*******************************************************************************
+* Function Name: canfd_cfg_get
+********************************************************************************
+* Summary:
+* Returns the run-time configuration for modules that re-initialize or
+* inspect the channel.
+*
+*******************************************************************************/
+cy_stc_canfd_config_t *canfd_cfg_get(void)
+{
+    return &canfd_cfg;
+}
+
+/*******************************************************************************
+* Function Name: canfd_cfg_set_bitrate
+********************************************************************************
+* Summary:
+* Selects the arbitration and data phase timing used by the next
+* Cy_CANFD_Init with this configuration, and makes it the active profile.
+*
+* Parameters:
+*  profile    Bit timing profile
+*
+*******************************************************************************/
+void canfd_cfg_set_bitrate(const canfd_bitrate_profile_t *profile)
+{
+    canfd_cfg_nominal = profile->nominal;
+    canfd_cfg_data = profile->data;
+    canfd_cfg.bitrate = &canfd_cfg_nominal;
+    canfd_cfg.fastBitrate = &canfd_cfg_data;
+    canfd_bitrate_set_active(profile);
+}
+
+/* [] END OF FILE */
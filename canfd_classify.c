@@ -0,0 +1,721 @@
+/******************************************************************************
+* File Name:   canfd_classify.c
+*
+* Description: Second classification stage behind the acceptance filters.
+*              Standard identifiers are looked up in a bitmap with a rank
+*              table, extended identifiers by a branchless binary search of a
+*              sorted array, and multiplexed messages in a table indexed by the
+*              multiplexer value.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_classify.h"
+#include "canfd_filter.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Route bytes: 0 is no route, 1..127 a handler index + 1, 0x80 | n the
+ * multiplexer table n */
+#define ROUTE_NONE              (0x00u)
+#define ROUTE_MUX               (0x80u)
+
+#define CLASSIFY_SID_Msk        (0x7FFUL)
+#define CLASSIFY_XID_Msk        (0x1FFFFFFFUL)
+#define CLASSIFY_SID_WORDS      (2048u / 32u)
+
+/* Padding of the extended table, larger than any 29-bit identifier */
+#define CLASSIFY_XID_EMPTY      (0xFFFFFFFFUL)
+
+/* Frames per identifier timed by canfd_classify_benchmark */
+#define CLASSIFY_BENCH_ROUNDS   (16u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint8_t byte;               /* Payload byte holding the multiplexer */
+    uint8_t shift;
+    uint8_t mask;               /* Below CANFD_CLASSIFY_MUX_VALUES */
+    uint8_t route[CANFD_CLASSIFY_MUX_VALUES];
+} classify_mux_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Standard identifiers: one bit per identifier, the number of bits set in
+ * the words before each word, and the routes in identifier order. The route
+ * array has one spare entry read on a miss when the table is full. */
+static uint32_t classify_sid_bitmap[CLASSIFY_SID_WORDS];
+static uint16_t classify_sid_rank[CLASSIFY_SID_WORDS];
+static uint8_t classify_sid_route[CANFD_CLASSIFY_SID_MAX + 1u];
+static uint16_t classify_sid_ids[CANFD_CLASSIFY_SID_MAX];
+
+/* Extended identifiers in ascending order, padded with CLASSIFY_XID_EMPTY */
+static uint32_t classify_xid_keys[CANFD_CLASSIFY_XID_MAX];
+static uint8_t classify_xid_route[CANFD_CLASSIFY_XID_MAX];
+
+static classify_mux_t classify_mux[CANFD_CLASSIFY_MUX_TABLES];
+static canfd_classify_handler_t classify_handlers[CANFD_CLASSIFY_HANDLERS];
+static uint32_t classify_handler_frames[CANFD_CLASSIFY_HANDLERS];
+static uint32_t classify_handler_count;
+
+static canfd_classify_stats_t classify_stats;
+static bool classify_ready;
+
+STATS_COUNTER(frames, "classify.frames", &classify_stats.frames);
+STATS_COUNTER(unmatched, "classify.unmatched", &classify_stats.unmatched);
+STATS_GAUGE(max_cycles, "classify.max_cycles", &classify_stats.max_cycles);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void classify_init(void);
+static uint32_t classify_popcount(uint32_t value);
+static uint32_t classify_route(const canfd_frame_t *frame);
+static uint8_t *classify_find(uint32_t id, bool extended, bool insert);
+static bool classify_has_room(bool extended);
+static uint8_t classify_handler_route(canfd_classify_handler_t handler);
+static uint32_t classify_id_at(const void *ids, bool extended, uint32_t idx);
+static bool classify_ranges(const void *ids, bool extended, uint32_t count,
+                            uint32_t max_ranges);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: classify_init
+********************************************************************************
+* Summary:
+* Pads the extended table, on the first change of the tables.
+*
+*******************************************************************************/
+static void classify_init(void)
+{
+    for (uint32_t idx = 0UL; idx < CANFD_CLASSIFY_XID_MAX; idx++)
+    {
+        classify_xid_keys[idx] = CLASSIFY_XID_EMPTY;
+    }
+    classify_ready = true;
+}
+
+/*******************************************************************************
+* Function Name: classify_popcount
+********************************************************************************
+* Summary:
+* Counts the bits set, in a fixed number of operations (the core has no
+* population count instruction).
+*
+*******************************************************************************/
+static inline uint32_t classify_popcount(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555UL);
+    value = (value & 0x33333333UL) + ((value >> 2) & 0x33333333UL);
+    value = (value + (value >> 4)) & 0x0F0F0F0FUL;
+    return (uint32_t)(value * 0x01010101UL) >> 24;
+}
+
+/*******************************************************************************
+* Function Name: classify_route
+********************************************************************************
+* Summary:
+* Returns the route of a frame, after the multiplexer if there is one. The
+* standard lookup is one bitmap word, a rank and a route read; the extended
+* lookup a binary search of log2(CANFD_CLASSIFY_XID_MAX) steps whose
+* comparisons compile to conditional selects, not branches; the
+* multiplexer one payload byte and a table read.
+*
+*******************************************************************************/
+static inline uint32_t classify_route(const canfd_frame_t *frame)
+{
+    uint32_t route;
+
+    if (0U == (frame->flags & CANFD_FRAME_FLAG_XTD))
+    {
+        uint32_t id = frame->id & CLASSIFY_SID_Msk;
+        uint32_t word = classify_sid_bitmap[id >> 5];
+        uint32_t bit = id & 31UL;
+        uint32_t hit = (word >> bit) & 1UL;
+        uint32_t rank = classify_sid_rank[id >> 5] +
+                        classify_popcount(word & ((1UL << bit) - 1UL));
+
+        route = classify_sid_route[rank] & (0UL - hit);
+    }
+    else
+    {
+        uint32_t id = frame->id & CLASSIFY_XID_Msk;
+        const uint32_t *keys = classify_xid_keys;
+
+        for (uint32_t half = CANFD_CLASSIFY_XID_MAX / 2UL; half > 0UL;
+             half >>= 1)
+        {
+            keys = (keys[half] <= id) ? &keys[half] : keys;
+        }
+        route = (*keys == id) ?
+                classify_xid_route[keys - classify_xid_keys] : ROUTE_NONE;
+    }
+
+    if (0UL != (route & ROUTE_MUX))
+    {
+        const classify_mux_t *mux = &classify_mux[route & ~ROUTE_MUX];
+
+        route = (frame->len > mux->byte) ?
+                mux->route[(((const uint8_t *)frame->data)[mux->byte] >>
+                            mux->shift) & mux->mask] : ROUTE_NONE;
+    }
+    return route;
+}
+
+/*******************************************************************************
+* Function Name: classify_find
+********************************************************************************
+* Summary:
+* Returns the route entry of an identifier, inserted with no route if
+* insert is true and the identifier is new.
+*
+* Return:
+*  uint8_t*  route entry, or NULL if absent or the table is full
+*
+*******************************************************************************/
+static uint8_t *classify_find(uint32_t id, bool extended, bool insert)
+{
+    const void *ids = extended ? (const void *)classify_xid_keys :
+                                 (const void *)classify_sid_ids;
+    uint32_t count = extended ? classify_stats.xid_count :
+                                classify_stats.sid_count;
+    uint32_t pos = 0UL;
+
+    while ((pos < count) && (classify_id_at(ids, extended, pos) < id))
+    {
+        pos++;
+    }
+
+    if (extended)
+    {
+        if ((pos < count) && (classify_xid_keys[pos] == id))
+        {
+            return &classify_xid_route[pos];
+        }
+        if (!insert || (count >= CANFD_CLASSIFY_XID_MAX))
+        {
+            return NULL;
+        }
+        for (uint32_t idx = count; idx > pos; idx--)
+        {
+            classify_xid_keys[idx] = classify_xid_keys[idx - 1UL];
+            classify_xid_route[idx] = classify_xid_route[idx - 1UL];
+        }
+        classify_xid_keys[pos] = id;
+        classify_xid_route[pos] = ROUTE_NONE;
+        classify_stats.xid_count++;
+        return &classify_xid_route[pos];
+    }
+
+    if ((pos < count) && (classify_sid_ids[pos] == id))
+    {
+        return &classify_sid_route[pos];
+    }
+    if (!insert || (count >= CANFD_CLASSIFY_SID_MAX))
+    {
+        return NULL;
+    }
+    for (uint32_t idx = count; idx > pos; idx--)
+    {
+        classify_sid_ids[idx] = classify_sid_ids[idx - 1UL];
+        classify_sid_route[idx] = classify_sid_route[idx - 1UL];
+    }
+    classify_sid_ids[pos] = (uint16_t)id;
+    classify_sid_route[pos] = ROUTE_NONE;
+    classify_stats.sid_count++;
+
+    /* The route positions follow the bitmap order */
+    classify_sid_bitmap[id >> 5] |= 1UL << (id & 31UL);
+    for (uint32_t word = (id >> 5) + 1UL; word < CLASSIFY_SID_WORDS; word++)
+    {
+        classify_sid_rank[word]++;
+    }
+    return &classify_sid_route[pos];
+}
+
+/*******************************************************************************
+* Function Name: classify_has_room
+********************************************************************************
+* Summary:
+* Tells whether classify_find can insert another identifier of this kind.
+*
+*******************************************************************************/
+static bool classify_has_room(bool extended)
+{
+    return extended ? (classify_stats.xid_count < CANFD_CLASSIFY_XID_MAX) :
+                      (classify_stats.sid_count < CANFD_CLASSIFY_SID_MAX);
+}
+
+/*******************************************************************************
+* Function Name: classify_handler_route
+********************************************************************************
+* Summary:
+* Returns the route of a handler, registering it on first use.
+*
+* Return:
+*  uint8_t  route, ROUTE_NONE if the handler table is full
+*
+*******************************************************************************/
+static uint8_t classify_handler_route(canfd_classify_handler_t handler)
+{
+    uint32_t idx;
+
+    for (idx = 0UL; idx < classify_handler_count; idx++)
+    {
+        if (classify_handlers[idx] == handler)
+        {
+            return (uint8_t)(idx + 1UL);
+        }
+    }
+    if (idx >= CANFD_CLASSIFY_HANDLERS)
+    {
+        return ROUTE_NONE;
+    }
+    classify_handlers[idx] = handler;
+    classify_handler_count++;
+    return (uint8_t)(idx + 1UL);
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_add
+********************************************************************************
+* Summary:
+* Routes the frames of an identifier to a handler, replacing an earlier
+* handler of the identifier. The tables are changed in place: call from
+* the context that handles the received frames, or before reception starts.
+* Every limit is checked before the first change, so a failed call leaves
+* the tables as they were.
+*
+* Parameters:
+*  id        11-bit or 29-bit identifier
+*  extended  true for a 29-bit identifier
+*  handler   Called for each frame of the identifier
+*
+* Return:
+*  bool  false if a table is full or the identifier is multiplexed
+*
+*******************************************************************************/
+bool canfd_classify_add(uint32_t id, bool extended,
+                        canfd_classify_handler_t handler)
+{
+    uint8_t route;
+    uint8_t *entry;
+
+    if (!classify_ready)
+    {
+        classify_init();
+    }
+
+    id &= extended ? CLASSIFY_XID_Msk : CLASSIFY_SID_Msk;
+    entry = classify_find(id, extended, false);
+    if (((NULL == entry) && !classify_has_room(extended)) ||
+        ((NULL != entry) && (0U != (*entry & ROUTE_MUX))))
+    {
+        return false;
+    }
+
+    route = classify_handler_route(handler);
+    if (ROUTE_NONE == route)
+    {
+        return false;
+    }
+    if (NULL == entry)
+    {
+        entry = classify_find(id, extended, true);
+    }
+    *entry = route;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_add_mux
+********************************************************************************
+* Summary:
+* Routes the frames of a multiplexed identifier with one multiplexer value
+* to a handler. The multiplexer is (data[byte] >> shift) & mask and must be
+* the same for all values of an identifier; frames shorter than byte + 1
+* have no route.
+*
+* Parameters:
+*  id        11-bit or 29-bit identifier
+*  extended  true for a 29-bit identifier
+*  byte      Payload byte holding the multiplexer
+*  shift     Position of the multiplexer in the byte
+*  mask      Multiplexer mask after the shift, below
+*            CANFD_CLASSIFY_MUX_VALUES
+*  value     Multiplexer value
+*  handler   Called for each frame with this value
+*
+* Return:
+*  bool  false if a table is full, the multiplexer differs from earlier
+*        values, or the identifier is not multiplexed; the tables are then
+*        unchanged
+*
+*******************************************************************************/
+bool canfd_classify_add_mux(uint32_t id, bool extended, uint8_t byte,
+                            uint8_t shift, uint8_t mask, uint8_t value,
+                            canfd_classify_handler_t handler)
+{
+    uint8_t route;
+    uint8_t *entry;
+    classify_mux_t *mux;
+
+    if ((mask >= CANFD_CLASSIFY_MUX_VALUES) || (value > mask) ||
+        (byte >= CANFD_FRAME_MAX_LEN) || (shift > 7U))
+    {
+        return false;
+    }
+    if (!classify_ready)
+    {
+        classify_init();
+    }
+
+    id &= extended ? CLASSIFY_XID_Msk : CLASSIFY_SID_Msk;
+    entry = classify_find(id, extended, false);
+    if (NULL == entry)
+    {
+        if (!classify_has_room(extended) ||
+            (classify_stats.mux_count >= CANFD_CLASSIFY_MUX_TABLES))
+        {
+            return false;
+        }
+        mux = NULL;
+    }
+    else if (0U != (*entry & ROUTE_MUX))
+    {
+        mux = &classify_mux[*entry & ~ROUTE_MUX];
+        if ((mux->byte != byte) || (mux->shift != shift) || (mux->mask != mask))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    route = classify_handler_route(handler);
+    if (ROUTE_NONE == route)
+    {
+        return false;
+    }
+
+    if (NULL == mux)
+    {
+        entry = classify_find(id, extended, true);
+        mux = &classify_mux[classify_stats.mux_count];
+        mux->byte = byte;
+        mux->shift = shift;
+        mux->mask = mask;
+        *entry = (uint8_t)(ROUTE_MUX | classify_stats.mux_count);
+        classify_stats.mux_count++;
+    }
+    mux->route[value] = route;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_lookup
+********************************************************************************
+* Summary:
+* Returns the handler of a frame.
+*
+* Return:
+*  canfd_classify_handler_t  handler, or NULL if the frame has no route
+*
+*******************************************************************************/
+canfd_classify_handler_t canfd_classify_lookup(const canfd_frame_t *frame)
+{
+    uint32_t route = classify_route(frame);
+
+    return (ROUTE_NONE == route) ? NULL : classify_handlers[route - 1UL];
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_dispatch
+********************************************************************************
+* Summary:
+* Classifies a frame on the Rx path and calls its handler. The lookup is
+* timed for the statistics; the handler is not.
+*
+* Parameters:
+*  frame   Received frame
+*
+* Return:
+*  bool  true if a handler took the frame
+*
+*******************************************************************************/
+bool canfd_classify_dispatch(const canfd_frame_t *frame)
+{
+    uint32_t start = cycle_count_now();
+    uint32_t route = classify_route(frame);
+    uint32_t cycles = cycle_count_now() - start;
+
+    classify_stats.frames++;
+    if (cycles > classify_stats.max_cycles)
+    {
+        classify_stats.max_cycles = cycles;
+    }
+    if (ROUTE_NONE == route)
+    {
+        classify_stats.unmatched++;
+        return false;
+    }
+    classify_handler_frames[route - 1UL]++;
+    classify_handlers[route - 1UL](frame);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: classify_id_at
+*******************************************************************************/
+static uint32_t classify_id_at(const void *ids, bool extended, uint32_t idx)
+{
+    return extended ? ((const uint32_t *)ids)[idx] :
+                      (uint32_t)((const uint16_t *)ids)[idx];
+}
+
+/*******************************************************************************
+* Function Name: classify_ranges
+********************************************************************************
+* Summary:
+* Adds range filters to the filter table being built that accept the sorted
+* identifiers with at most max_ranges elements, fewer if the table has less
+* room. The ranges are split at the largest gaps between identifiers: the
+* smallest gap size that leaves at most max_ranges ranges is found by a
+* binary search.
+*
+* Return:
+*  bool  false if a range did not fit into the table
+*
+*******************************************************************************/
+static bool classify_ranges(const void *ids, bool extended, uint32_t count,
+                            uint32_t max_ranges)
+{
+    uint32_t low = 0UL;
+    uint32_t high = extended ? CLASSIFY_XID_Msk : CLASSIFY_SID_Msk;
+    uint32_t space = canfd_filter_space(extended);
+    bool added = true;
+    canfd_filter_t filter;
+
+    if ((0UL == count) || (0UL == max_ranges))
+    {
+        return true;
+    }
+    if (max_ranges > space)
+    {
+        /* Without any room, the single range is rejected by canfd_filter_add
+         * and counted there */
+        max_ranges = (0UL != space) ? space : 1UL;
+    }
+
+    /* Smallest gap size at which splitting leaves max_ranges ranges */
+    while (low < high)
+    {
+        uint32_t mid = low + ((high - low) / 2UL);
+        uint32_t ranges = 1UL;
+
+        for (uint32_t idx = 1UL; idx < count; idx++)
+        {
+            if ((classify_id_at(ids, extended, idx) -
+                 classify_id_at(ids, extended, idx - 1UL) - 1UL) > mid)
+            {
+                ranges++;
+            }
+        }
+        if (ranges <= max_ranges)
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1UL;
+        }
+    }
+
+    filter.type = CANFD_FILTER_RANGE;
+    filter.action = CANFD_FILTER_TO_FIFO0;
+    filter.extended = extended;
+    filter.id1 = classify_id_at(ids, extended, 0UL);
+    for (uint32_t idx = 1UL; idx <= count; idx++)
+    {
+        uint32_t prev = classify_id_at(ids, extended, idx - 1UL);
+
+        if ((idx == count) ||
+            ((classify_id_at(ids, extended, idx) - prev - 1UL) > low))
+        {
+            filter.id2 = prev;
+            added = canfd_filter_add(&filter) && added;
+            if (idx < count)
+            {
+                filter.id1 = classify_id_at(ids, extended, idx);
+            }
+        }
+    }
+    return added;
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_add_filters
+********************************************************************************
+* Summary:
+* First stage: adds coarse range filters to Rx FIFO 0 for the classified
+* identifiers to the table started with canfd_filter_begin, at most
+* sid_ranges standard and xid_ranges extended elements. Identifiers in the
+* gaps of a range are accepted by the hardware and rejected by the
+* classifier.
+*
+* Parameters:
+*  sid_ranges  Standard filter elements to use
+*  xid_ranges  Extended filter elements to use
+*
+* Return:
+*  bool  false if a range did not fit, so some classified identifiers are
+*        not accepted by these filters
+*
+*******************************************************************************/
+bool canfd_classify_add_filters(uint32_t sid_ranges, uint32_t xid_ranges)
+{
+    bool sid_added = classify_ranges(classify_sid_ids, false,
+                                     classify_stats.sid_count, sid_ranges);
+    bool xid_added = classify_ranges(classify_xid_keys, true,
+                                     classify_stats.xid_count, xid_ranges);
+
+    return sid_added && xid_added;
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_benchmark
+********************************************************************************
+* Summary:
+* Prints the average and longest lookup over every classified identifier
+* and a miss of each kind, without calling the handlers.
+*
+*******************************************************************************/
+void canfd_classify_benchmark(void)
+{
+    canfd_frame_t frame = { 0 };
+    uint32_t total = 0UL;
+    uint32_t longest = 0UL;
+    uint32_t lookups = 0UL;
+    uint32_t count = classify_stats.sid_count + classify_stats.xid_count + 2UL;
+    volatile uint32_t sink = 0UL;
+
+    cycle_count_init();
+    frame.len = CANFD_FRAME_MAX_LEN;
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        if (idx < classify_stats.sid_count)
+        {
+            frame.id = classify_sid_ids[idx];
+            frame.flags = 0U;
+        }
+        else if (idx < (classify_stats.sid_count + classify_stats.xid_count))
+        {
+            frame.id = classify_xid_keys[idx - classify_stats.sid_count];
+            frame.flags = CANFD_FRAME_FLAG_XTD;
+        }
+        else
+        {
+            /* Misses: an unused standard and extended identifier */
+            frame.id = CLASSIFY_SID_Msk;
+            frame.flags = (idx == (count - 1UL)) ? CANFD_FRAME_FLAG_XTD : 0U;
+        }
+
+        for (uint32_t round = 0UL; round < CLASSIFY_BENCH_ROUNDS; round++)
+        {
+            uint32_t start = cycle_count_now();
+            uint32_t cycles;
+
+            sink += classify_route(&frame);
+            cycles = cycle_count_now() - start;
+            total += cycles;
+            lookups++;
+            if (cycles > longest)
+            {
+                longest = cycles;
+            }
+        }
+    }
+    (void)sink;
+
+    printf("Classifier: %lu standard, %lu extended, %lu multiplexed IDs, "
+           "%lu cycles per lookup, %lu max\r\n",
+           (unsigned long)classify_stats.sid_count,
+           (unsigned long)classify_stats.xid_count,
+           (unsigned long)classify_stats.mux_count,
+           (unsigned long)(total / lookups),
+           (unsigned long)longest);
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_print_stats
+*******************************************************************************/
+void canfd_classify_print_stats(void)
+{
+    printf("Classifier: %lu frames, %lu unmatched, %lu cycles max; frames "
+           "per handler:",
+           (unsigned long)classify_stats.frames,
+           (unsigned long)classify_stats.unmatched,
+           (unsigned long)classify_stats.max_cycles);
+    for (uint32_t idx = 0UL; idx < classify_handler_count; idx++)
+    {
+        printf(" %lu", (unsigned long)classify_handler_frames[idx]);
+    }
+    printf("\r\n");
+}
+
+/*******************************************************************************
+* Function Name: canfd_classify_get_stats
+*******************************************************************************/
+const canfd_classify_stats_t *canfd_classify_get_stats(void)
+{
+    return &classify_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,122 @@
+/******************************************************************************
+* File Name:   canfd_classify.h
+*
+* Description: Second classification stage behind the acceptance filters:
+*              routes received frames to handlers by identifier and multiplexer
+*              value in a bounded number of cycles.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_CLASSIFY_H_
+#define CANFD_CLASSIFY_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Classified standard and extended identifiers. The extended table is
+ * searched in log2(CANFD_CLASSIFY_XID_MAX) steps. */
+#ifndef CANFD_CLASSIFY_SID_MAX
+#define CANFD_CLASSIFY_SID_MAX      (256u)
+#endif
+
+#ifndef CANFD_CLASSIFY_XID_MAX
+#define CANFD_CLASSIFY_XID_MAX      (128u)
+#endif
+
+/* Distinct handlers, multiplexed identifiers and values per multiplexer */
+#ifndef CANFD_CLASSIFY_HANDLERS
+#define CANFD_CLASSIFY_HANDLERS     (16u)
+#endif
+
+#ifndef CANFD_CLASSIFY_MUX_TABLES
+#define CANFD_CLASSIFY_MUX_TABLES   (8u)
+#endif
+
+#ifndef CANFD_CLASSIFY_MUX_VALUES
+#define CANFD_CLASSIFY_MUX_VALUES   (32u)
+#endif
+
+#if ((CANFD_CLASSIFY_XID_MAX & (CANFD_CLASSIFY_XID_MAX - 1u)) != 0u)
+#error "CANFD_CLASSIFY_XID_MAX must be a power of two"
+#endif
+
+#if (CANFD_CLASSIFY_SID_MAX > 2048u) || (CANFD_CLASSIFY_HANDLERS > 127u) || \
+    (CANFD_CLASSIFY_MUX_TABLES > 128u) || (CANFD_CLASSIFY_MUX_VALUES > 256u)
+#error "Classifier tables exceed the route encoding"
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef void (*canfd_classify_handler_t)(const canfd_frame_t *frame);
+
+typedef struct
+{
+    uint32_t frames;            /* Frames classified */
+    uint32_t unmatched;         /* Frames without a route */
+    uint32_t max_cycles;        /* Longest lookup */
+    uint32_t sid_count;         /* Standard identifiers in the table */
+    uint32_t xid_count;         /* Extended identifiers in the table */
+    uint32_t mux_count;         /* Multiplexed identifiers */
+} canfd_classify_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool canfd_classify_add(uint32_t id, bool extended,
+                        canfd_classify_handler_t handler);
+bool canfd_classify_add_mux(uint32_t id, bool extended, uint8_t byte,
+                            uint8_t shift, uint8_t mask, uint8_t value,
+                            canfd_classify_handler_t handler);
+canfd_classify_handler_t canfd_classify_lookup(const canfd_frame_t *frame);
+bool canfd_classify_dispatch(const canfd_frame_t *frame);
+bool canfd_classify_add_filters(uint32_t sid_ranges, uint32_t xid_ranges);
+void canfd_classify_benchmark(void);
+void canfd_classify_print_stats(void);
+const canfd_classify_stats_t *canfd_classify_get_stats(void);
+
+#endif /* CANFD_CLASSIFY_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,368 @@
+/******************************************************************************
+* File Name:   canfd_coalesce.c
+*
+* Description: Adaptive Rx interrupt coalescing. At low Rx rates every new
+*              frame in Rx FIFO 0 raises the CAN FD interrupt (lowest latency).
+*              Above CANFD_COALESCE_ENTER_FPS the new-frame interrupt is
+*              masked; the FIFO is then drained when it reaches the watermark
+*              or when the TCPWM drain timer expires, whichever comes first, so
+*              several frames share one interrupt entry and no frame waits
+*              longer than CANFD_COALESCE_TIMEOUT_US. Below
+*              CANFD_COALESCE_LEAVE_FPS the per-frame interrupt is restored.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_coalesce.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define COALESCE_TIMER_HZ       (1000000UL)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type *coalesce_base;
+static uint32_t coalesce_chan;
+static cyhal_timer_t coalesce_timer;
+
+static canfd_coalesce_mode_t coalesce_mode;
+static canfd_coalesce_stats_t coalesce_stats;
+
+/* Rate measurement */
+static uint32_t coalesce_window_cycles;
+static uint32_t coalesce_window_start;
+static uint32_t coalesce_window_frames;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void coalesce_timer_event(void *callback_arg, cyhal_timer_event_t event);
+static uint32_t coalesce_drain(bool from_timer);
+static void coalesce_set_mode(canfd_coalesce_mode_t mode);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_coalesce_init
+********************************************************************************
+* Summary:
+* Sets the Rx FIFO 0 watermark, enables its interrupt and prepares the drain
+* timer. Starts in per-frame mode. Must be called right after Cy_CANFD_Init;
+* afterwards isr_canfd has to call canfd_coalesce_isr.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  context    Channel context
+*
+* Return:
+*  cy_rslt_t  HAL result of the timer setup, CANFD_COALESCE_RSLT_CONFIG if the
+*             watermark could not be written
+*
+*******************************************************************************/
+cy_rslt_t canfd_coalesce_init(CANFD_Type *base, uint32_t chan,
+                              cy_stc_canfd_context_t *context)
+{
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0UL,
+        .period = CANFD_COALESCE_TIMEOUT_US - 1UL,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = true,
+        .value = 0UL,
+    };
+    cy_en_canfd_status_t status;
+    cy_rslt_t result;
+
+    coalesce_base = base;
+    coalesce_chan = chan;
+    canfd_rxq_init(base, chan, context);
+
+    /* RXF0C is writable only while configuration changes are enabled */
+    status = Cy_CANFD_ConfigChangesEnable(base, chan);
+    if (CY_CANFD_SUCCESS == status)
+    {
+        CANFD_RXF0C(base, chan) = (CANFD_RXF0C(base, chan) &
+                                   ~CANFD_CH_M_TTCAN_RXF0C_F0WM_Msk) |
+                                  _VAL2FLD(CANFD_CH_M_TTCAN_RXF0C_F0WM,
+                                           CANFD_COALESCE_WATERMARK);
+        status = Cy_CANFD_ConfigChangesDisable(base, chan);
+    }
+    if (CY_CANFD_SUCCESS != status)
+    {
+        return CANFD_COALESCE_RSLT_CONFIG;
+    }
+
+    result = cyhal_timer_init(&coalesce_timer, NC, NULL);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_configure(&coalesce_timer, &timer_cfg);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_set_frequency(&coalesce_timer, COALESCE_TIMER_HZ);
+    }
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    cyhal_timer_register_callback(&coalesce_timer, coalesce_timer_event, NULL);
+    cyhal_timer_enable_event(&coalesce_timer, CYHAL_TIMER_IRQ_TERMINAL_COUNT,
+                             CANFD_COALESCE_TIMER_PRIORITY, true);
+
+    coalesce_window_cycles = (SystemCoreClock / 1000UL) * CANFD_COALESCE_WINDOW_MS;
+    coalesce_window_start = cycle_count_now();
+    coalesce_mode = CANFD_COALESCE_PER_FRAME;
+
+    /* The watermark interrupt stays enabled in both modes */
+    Cy_CANFD_SetInterruptMask(base, chan,
+                              Cy_CANFD_GetInterruptMask(base, chan) |
+                              CANFD_CH_M_TTCAN_IR_RF0N_Msk |
+                              CANFD_CH_M_TTCAN_IR_RF0W_Msk);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_coalesce_isr
+********************************************************************************
+* Summary:
+* Rx part of the CAN FD interrupt. Drains Rx FIFO 0 if one of its flags is
+* set; the flags are cleared so that Cy_CANFD_IrqHandler, called afterwards
+* for the remaining sources, does not read the FIFO again.
+*
+* Return:
+*  uint32_t  number of frames drained
+*
+*******************************************************************************/
+uint32_t canfd_coalesce_isr(void)
+{
+    if (0UL == (Cy_CANFD_GetInterruptStatus(coalesce_base, coalesce_chan) &
+                CANFD_RXQ_IRQ_MASK))
+    {
+        return 0UL;
+    }
+
+    return coalesce_drain(false);
+}
+
+/*******************************************************************************
+* Function Name: coalesce_timer_event
+********************************************************************************
+* Summary:
+* Drain timer interrupt, running only while coalescing.
+*
+*******************************************************************************/
+static void coalesce_timer_event(void *callback_arg, cyhal_timer_event_t event)
+{
+    (void)callback_arg;
+    (void)event;
+
+    (void)coalesce_drain(true);
+}
+
+/*******************************************************************************
+* Function Name: coalesce_drain
+********************************************************************************
+* Summary:
+* Drains the FIFO, accounts the cycles to the current mode and changes the
+* mode at the end of each measurement window. Returns the frames drained.
+*
+*******************************************************************************/
+static uint32_t coalesce_drain(bool from_timer)
+{
+    canfd_coalesce_mode_stats_t *stats = &coalesce_stats.mode[coalesce_mode];
+    uint32_t start = cycle_count_now();
+    uint32_t frames = canfd_rxq_drain();
+    uint32_t elapsed;
+
+    stats->cycles += cycle_count_now() - start;
+    stats->frames += frames;
+    if (from_timer)
+    {
+        stats->timer_drains++;
+    }
+    else
+    {
+        stats->interrupts++;
+    }
+
+    coalesce_window_frames += frames;
+    elapsed = start - coalesce_window_start;
+    if (elapsed < coalesce_window_cycles)
+    {
+        return frames;
+    }
+
+    coalesce_stats.rate_fps = (uint32_t)(((uint64_t)coalesce_window_frames *
+                                          SystemCoreClock) / elapsed);
+    coalesce_window_frames = 0UL;
+    coalesce_window_start = start;
+
+    if ((CANFD_COALESCE_PER_FRAME == coalesce_mode) &&
+        (coalesce_stats.rate_fps >= CANFD_COALESCE_ENTER_FPS))
+    {
+        coalesce_set_mode(CANFD_COALESCE_BATCHED);
+    }
+    else if ((CANFD_COALESCE_BATCHED == coalesce_mode) &&
+             (coalesce_stats.rate_fps < CANFD_COALESCE_LEAVE_FPS))
+    {
+        coalesce_set_mode(CANFD_COALESCE_PER_FRAME);
+    }
+    else
+    {
+        /* Keep the current mode */
+    }
+
+    return frames;
+}
+
+/*******************************************************************************
+* Function Name: coalesce_set_mode
+********************************************************************************
+* Summary:
+* Masks or unmasks the new-frame interrupt and stops or starts the drain
+* timer. Called from the drains only.
+*
+*******************************************************************************/
+static void coalesce_set_mode(canfd_coalesce_mode_t mode)
+{
+    uint32_t mask = Cy_CANFD_GetInterruptMask(coalesce_base, coalesce_chan);
+
+    if (CANFD_COALESCE_BATCHED == mode)
+    {
+        Cy_CANFD_SetInterruptMask(coalesce_base, coalesce_chan,
+                                  mask & ~CANFD_CH_M_TTCAN_IR_RF0N_Msk);
+        (void)cyhal_timer_reset(&coalesce_timer);
+        (void)cyhal_timer_start(&coalesce_timer);
+    }
+    else
+    {
+        (void)cyhal_timer_stop(&coalesce_timer);
+        Cy_CANFD_SetInterruptMask(coalesce_base, coalesce_chan,
+                                  mask | CANFD_CH_M_TTCAN_IR_RF0N_Msk);
+    }
+
+    coalesce_mode = mode;
+    coalesce_stats.switches++;
+}
+
+/*******************************************************************************
+* Function Name: canfd_coalesce_get_mode
+********************************************************************************
+* Summary:
+* Returns the current interrupt mode.
+*
+*******************************************************************************/
+canfd_coalesce_mode_t canfd_coalesce_get_mode(void)
+{
+    return coalesce_mode;
+}
+
+/*******************************************************************************
+* Function Name: canfd_coalesce_get_stats
+********************************************************************************
+* Summary:
+* Returns the coalescing counters.
+*
+*******************************************************************************/
+const canfd_coalesce_stats_t *canfd_coalesce_get_stats(void)
+{
+    return &coalesce_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_coalesce_print_stats
+********************************************************************************
+* Summary:
+* Prints the thresholds and, for each mode, the interrupt cost per frame and
+* the latency bound. The per-frame latency is the time to the handler in the
+* main loop; batching adds at most the timer period.
+*
+*******************************************************************************/
+void canfd_coalesce_print_stats(void)
+{
+    static const char *const mode_names[2] = { "per-frame", "batched" };
+    const canfd_rxq_stats_t *rxq = canfd_rxq_get_stats();
+
+    printf("Rx coalescing: batched from %u frames/s, per-frame below %u "
+           "frames/s, watermark %u, timeout %u us\r\n",
+           (unsigned int)CANFD_COALESCE_ENTER_FPS,
+           (unsigned int)CANFD_COALESCE_LEAVE_FPS,
+           (unsigned int)CANFD_COALESCE_WATERMARK,
+           (unsigned int)CANFD_COALESCE_TIMEOUT_US);
+    printf("  now %s at %lu frames/s, %lu mode changes\r\n",
+           mode_names[coalesce_mode], (unsigned long)coalesce_stats.rate_fps,
+           (unsigned long)coalesce_stats.switches);
+
+    for (uint32_t mode = 0UL; mode < 2UL; mode++)
+    {
+        const canfd_coalesce_mode_stats_t *stats = &coalesce_stats.mode[mode];
+        uint32_t entries = stats->interrupts + stats->timer_drains;
+
+        printf("  %-9s %8lu frames %8lu interrupts %6lu timer",
+               mode_names[mode], (unsigned long)stats->frames,
+               (unsigned long)stats->interrupts,
+               (unsigned long)stats->timer_drains);
+        if (0UL != stats->frames)
+        {
+            printf("  %lu.%02lu frames/entry %lu cycles/frame",
+                   (unsigned long)(stats->frames / entries),
+                   (unsigned long)(((stats->frames % entries) * 100UL) / entries),
+                   (unsigned long)(stats->cycles / stats->frames));
+        }
+        printf("\r\n");
+    }
+
+    printf("  wait in FIFO <= %u us when batched, queue to handler max %lu us, "
+           "%lu dropped, %lu FIFO overflows\r\n\r\n",
+           (unsigned int)CANFD_COALESCE_TIMEOUT_US,
+           (unsigned long)cycle_count_to_us(rxq->latency_max),
+           (unsigned long)rxq->dropped, (unsigned long)rxq->fifo_lost);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,124 @@
+/******************************************************************************
+* File Name:   canfd_coalesce.h
+*
+* Description: Adaptive Rx interrupt coalescing on top of the Rx queue.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_COALESCE_H_
+#define CANFD_COALESCE_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cyhal.h"
+#include "canfd_rxq.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Rx rate that switches from per-frame interrupts to coalescing, and the lower
+ * rate that switches back (hysteresis) */
+#ifndef CANFD_COALESCE_ENTER_FPS
+#define CANFD_COALESCE_ENTER_FPS        (2000u)
+#endif
+#ifndef CANFD_COALESCE_LEAVE_FPS
+#define CANFD_COALESCE_LEAVE_FPS        (500u)
+#endif
+
+/* Rx FIFO 0 fill level that raises the interrupt while coalescing */
+#ifndef CANFD_COALESCE_WATERMARK
+#define CANFD_COALESCE_WATERMARK        (6u)
+#endif
+
+/* Period of the drain timer while coalescing; bounds the extra latency */
+#ifndef CANFD_COALESCE_TIMEOUT_US
+#define CANFD_COALESCE_TIMEOUT_US       (500u)
+#endif
+
+/* Length of the rate measurement window */
+#ifndef CANFD_COALESCE_WINDOW_MS
+#define CANFD_COALESCE_WINDOW_MS        (10u)
+#endif
+
+/* Priority of the drain timer; equal to the CAN FD interrupt so that the two
+ * drains never preempt each other */
+#ifndef CANFD_COALESCE_TIMER_PRIORITY
+#define CANFD_COALESCE_TIMER_PRIORITY   (1u)
+#endif
+
+/* Returned by canfd_coalesce_init if the watermark cannot be configured */
+#define CANFD_COALESCE_RSLT_CONFIG      \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 3u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef enum
+{
+    CANFD_COALESCE_PER_FRAME = 0,   /* Interrupt for every new frame */
+    CANFD_COALESCE_BATCHED   = 1,   /* Watermark interrupt and drain timer */
+} canfd_coalesce_mode_t;
+
+typedef struct
+{
+    uint32_t frames;        /* Frames drained in this mode */
+    uint32_t interrupts;    /* Drains from the CAN FD interrupt */
+    uint32_t timer_drains;  /* Drains from the timeout timer */
+    uint32_t cycles;        /* Cycles spent in the drains */
+} canfd_coalesce_mode_stats_t;
+
+typedef struct
+{
+    canfd_coalesce_mode_stats_t mode[2];
+    uint32_t switches;      /* Mode changes */
+    uint32_t rate_fps;      /* Last measured Rx rate */
+} canfd_coalesce_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_coalesce_init(CANFD_Type *base, uint32_t chan,
+                              cy_stc_canfd_context_t *context);
+uint32_t canfd_coalesce_isr(void);
+canfd_coalesce_mode_t canfd_coalesce_get_mode(void);
+const canfd_coalesce_stats_t *canfd_coalesce_get_stats(void);
+void canfd_coalesce_print_stats(void);
+
+#endif /* CANFD_COALESCE_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,382 @@
+/******************************************************************************
+* File Name:   canfd_dispatch.c
+*
+* Description: Receive dispatch table: handlers registered per identifier or
+*              identifier range, run in the receive context (fast) or from the
+*              main loop (deferred), with per-handler cycle budgets.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_dispatch.h"
+#include "canfd_ring.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define DISPATCH_SID_COUNT      (2048u)
+#define DISPATCH_SID_Msk        (0x7FFUL)
+#define DISPATCH_XID_Msk        (0x1FFFFFFFUL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t first;
+    uint32_t last;
+    uint8_t index;              /* Handler entry + 1 */
+} dispatch_range_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Handler entry + 1 of every standard identifier, 0 for the default */
+static uint8_t dispatch_sid[DISPATCH_SID_COUNT];
+
+static dispatch_range_t dispatch_xid[CANFD_DISPATCH_XID_RANGES];
+static uint32_t dispatch_xid_count;
+
+static canfd_dispatch_handler_t *dispatch_handlers[CANFD_DISPATCH_MAX_HANDLERS];
+static uint32_t dispatch_count;
+static uint8_t dispatch_default;
+
+/* Frames for the deferred handlers; the reserved byte of each frame holds
+ * the handler entry + 1 */
+static canfd_frame_t dispatch_slots[CANFD_DISPATCH_DEFERRED_DEPTH];
+static canfd_ring_t dispatch_ring =
+{
+    .slots = dispatch_slots,
+    .size_mask = CANFD_DISPATCH_DEFERRED_DEPTH - 1u,
+};
+
+static canfd_dispatch_stats_t dispatch_stats;
+
+STATS_COUNTER(deferred, "dispatch.deferred", &dispatch_stats.deferred);
+STATS_COUNTER(dropped, "dispatch.dropped", &dispatch_stats.dropped);
+STATS_COUNTER(unhandled, "dispatch.unhandled", &dispatch_stats.unhandled);
+STATS_GAUGE(max_depth, "dispatch.max_depth", &dispatch_stats.max_depth);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool dispatch_register(canfd_dispatch_handler_t *handler);
+static void dispatch_call(canfd_dispatch_handler_t *handler,
+                          const canfd_frame_t *frame);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: dispatch_register
+********************************************************************************
+* Summary:
+* Gives a handler its table entry on first use.
+*
+* Return:
+*  bool  false if CANFD_DISPATCH_MAX_HANDLERS handlers are registered
+*
+*******************************************************************************/
+static bool dispatch_register(canfd_dispatch_handler_t *handler)
+{
+    if (0U != handler->index)
+    {
+        return true;
+    }
+    if (dispatch_count >= CANFD_DISPATCH_MAX_HANDLERS)
+    {
+        return false;
+    }
+
+    cycle_count_init();
+    handler->budget_cycles = (uint32_t)(((uint64_t)handler->budget_us *
+                                         SystemCoreClock) / 1000000ULL);
+    dispatch_handlers[dispatch_count] = handler;
+    dispatch_count++;
+    handler->index = (uint8_t)dispatch_count;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_add
+********************************************************************************
+* Summary:
+* Routes an identifier range to a handler defined with
+* CANFD_DISPATCH_HANDLER. A standard range overwrites the earlier routes of
+* its identifiers; extended ranges are searched in the order they were
+* added. Call before the reception starts.
+*
+* Parameters:
+*  handler   Handler defined with CANFD_DISPATCH_HANDLER
+*  first     First identifier of the range
+*  last      Last identifier of the range
+*  extended  true for 29-bit identifiers
+*
+* Return:
+*  bool  false if the handler or range table is full, or the range is empty
+*
+*******************************************************************************/
+bool canfd_dispatch_add(canfd_dispatch_handler_t *handler, uint32_t first,
+                        uint32_t last, bool extended)
+{
+    if ((first > last) ||
+        (last > (extended ? DISPATCH_XID_Msk : DISPATCH_SID_Msk)) ||
+        (extended && (dispatch_xid_count >= CANFD_DISPATCH_XID_RANGES)) ||
+        !dispatch_register(handler))
+    {
+        return false;
+    }
+
+    if (extended)
+    {
+        dispatch_xid[dispatch_xid_count].first = first;
+        dispatch_xid[dispatch_xid_count].last = last;
+        dispatch_xid[dispatch_xid_count].index = handler->index;
+        dispatch_xid_count++;
+    }
+    else
+    {
+        for (uint32_t id = first; id <= last; id++)
+        {
+            dispatch_sid[id] = handler->index;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_set_default
+********************************************************************************
+* Summary:
+* Sets the handler of the frames without a route; without one they are
+* counted as unhandled.
+*
+* Return:
+*  bool  false if the handler table is full
+*
+*******************************************************************************/
+bool canfd_dispatch_set_default(canfd_dispatch_handler_t *handler)
+{
+    if (!dispatch_register(handler))
+    {
+        return false;
+    }
+    dispatch_default = handler->index;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: dispatch_call
+********************************************************************************
+* Summary:
+* Runs a handler and checks its time against the budget. The time includes
+* the interrupts taken meanwhile.
+*
+*******************************************************************************/
+static void dispatch_call(canfd_dispatch_handler_t *handler,
+                          const canfd_frame_t *frame)
+{
+    uint32_t start = cycle_count_now();
+    uint32_t cycles;
+
+    handler->fn(frame);
+    cycles = cycle_count_now() - start;
+
+    handler->calls++;
+    handler->total_cycles += cycles;
+    if (cycles > handler->max_cycles)
+    {
+        handler->max_cycles = cycles;
+    }
+    if ((0UL != handler->budget_cycles) && (cycles > handler->budget_cycles))
+    {
+        handler->overruns++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_rx
+********************************************************************************
+* Summary:
+* Dispatches a received frame in the receive context: standard identifiers
+* through a table indexed by the identifier, extended ones through the
+* range list. A fast handler is called at once; for a deferred handler the
+* frame is copied to the deferred queue. The receive context is the only
+* producer of the queue.
+*
+* Parameters:
+*  frame   Received frame
+*
+* Return:
+*  bool  false if the frame had no handler or the deferred queue was full
+*
+*******************************************************************************/
+bool canfd_dispatch_rx(const canfd_frame_t *frame)
+{
+    uint32_t index = dispatch_default;
+    canfd_dispatch_handler_t *handler;
+    canfd_frame_t *slot;
+    uint32_t depth;
+
+    dispatch_stats.frames++;
+    if (0U == (frame->flags & CANFD_FRAME_FLAG_XTD))
+    {
+        uint32_t route = dispatch_sid[frame->id & DISPATCH_SID_Msk];
+
+        index = (0UL != route) ? route : index;
+    }
+    else
+    {
+        for (uint32_t idx = 0UL; idx < dispatch_xid_count; idx++)
+        {
+            if ((frame->id >= dispatch_xid[idx].first) &&
+                (frame->id <= dispatch_xid[idx].last))
+            {
+                index = dispatch_xid[idx].index;
+                break;
+            }
+        }
+    }
+
+    if (0UL == index)
+    {
+        dispatch_stats.unhandled++;
+        return false;
+    }
+
+    handler = dispatch_handlers[index - 1UL];
+    if (CANFD_DISPATCH_FAST == handler->mode)
+    {
+        dispatch_call(handler, frame);
+        return true;
+    }
+
+    slot = canfd_ring_alloc(&dispatch_ring);
+    if (NULL == slot)
+    {
+        dispatch_stats.dropped++;
+        return false;
+    }
+    *slot = *frame;
+    slot->reserved = (uint8_t)index;
+    canfd_ring_commit(&dispatch_ring);
+
+    dispatch_stats.deferred++;
+    depth = canfd_ring_count(&dispatch_ring);
+    if (depth > dispatch_stats.max_depth)
+    {
+        dispatch_stats.max_depth = depth;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_process
+********************************************************************************
+* Summary:
+* Runs the deferred handlers of the queued frames, in the order received.
+* Call from the main loop.
+*
+* Parameters:
+*  max_frames  Most frames to handle, 0 for all queued
+*
+* Return:
+*  uint32_t  frames handled
+*
+*******************************************************************************/
+uint32_t canfd_dispatch_process(uint32_t max_frames)
+{
+    const canfd_frame_t *frame;
+    uint32_t handled = 0UL;
+
+    while (((0UL == max_frames) || (handled < max_frames)) &&
+           (NULL != (frame = canfd_ring_peek(&dispatch_ring))))
+    {
+        dispatch_call(dispatch_handlers[frame->reserved - 1U], frame);
+        canfd_ring_release(&dispatch_ring);
+        handled++;
+    }
+    return handled;
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_print_stats
+********************************************************************************
+* Summary:
+* Prints the mode, budget, calls, overruns, average and worst case of every
+* handler, then the deferred queue counters.
+*
+*******************************************************************************/
+void canfd_dispatch_print_stats(void)
+{
+    printf("Handler          mode      budget us     calls  overruns  "
+           "avg cycles   max us\r\n");
+    for (uint32_t idx = 0UL; idx < dispatch_count; idx++)
+    {
+        const canfd_dispatch_handler_t *handler = dispatch_handlers[idx];
+
+        printf("%-16s %-9s %9lu %9lu %9lu %11lu %8lu\r\n", handler->name,
+               (CANFD_DISPATCH_FAST == handler->mode) ? "fast" : "deferred",
+               (unsigned long)handler->budget_us,
+               (unsigned long)handler->calls,
+               (unsigned long)handler->overruns,
+               (unsigned long)((0UL != handler->calls) ?
+                               (handler->total_cycles / handler->calls) : 0UL),
+               (unsigned long)cycle_count_to_us(handler->max_cycles));
+    }
+    printf("Dispatch: %lu frames, %lu deferred (%lu max queued), %lu dropped, "
+           "%lu unhandled\r\n",
+           (unsigned long)dispatch_stats.frames,
+           (unsigned long)dispatch_stats.deferred,
+           (unsigned long)dispatch_stats.max_depth,
+           (unsigned long)dispatch_stats.dropped,
+           (unsigned long)dispatch_stats.unhandled);
+}
+
+/*******************************************************************************
+* Function Name: canfd_dispatch_get_stats
+*******************************************************************************/
+const canfd_dispatch_stats_t *canfd_dispatch_get_stats(void)
+{
+    return &dispatch_stats;
+}
+
+/* [] END OF FILE */
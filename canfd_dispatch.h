@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name:   canfd_dispatch.h
+*
+* Description: Receive dispatch table: handlers registered per identifier or
+*              identifier range, run in the receive context (fast) or from the
+*              main loop (deferred), with per-handler cycle budgets.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_DISPATCH_H_
+#define CANFD_DISPATCH_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "canfd_frame.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Handlers that can be registered */
+#ifndef CANFD_DISPATCH_MAX_HANDLERS
+#define CANFD_DISPATCH_MAX_HANDLERS     (16u)
+#endif
+
+/* Extended identifier ranges, searched in order */
+#ifndef CANFD_DISPATCH_XID_RANGES
+#define CANFD_DISPATCH_XID_RANGES       (8u)
+#endif
+
+/* Frames waiting for deferred handlers (power of two) */
+#ifndef CANFD_DISPATCH_DEFERRED_DEPTH
+#define CANFD_DISPATCH_DEFERRED_DEPTH   (32u)
+#endif
+
+#if (CANFD_DISPATCH_MAX_HANDLERS > 255u)
+#error "CANFD_DISPATCH_MAX_HANDLERS is limited to 255"
+#endif
+
+/* Handler modes */
+#define CANFD_DISPATCH_FAST             (0u)    /* In the receive context */
+#define CANFD_DISPATCH_DEFERRED         (1u)    /* From the main loop */
+
+/* Defines a handler and registers its counters: <name>.calls, .overruns and
+ * .max_cycles. handler_name must be a string literal. */
+#define CANFD_DISPATCH_HANDLER(var, handler_name, handler_fn, handler_mode,   \
+                               budget)                                        \
+    static canfd_dispatch_handler_t var = { .name = (handler_name),          \
+                                            .fn = (handler_fn),              \
+                                            .mode = (handler_mode),          \
+                                            .budget_us = (budget) };         \
+    STATS_COUNTER(var##_calls, handler_name ".calls", &var.calls);           \
+    STATS_COUNTER(var##_overruns, handler_name ".overruns", &var.overruns);  \
+    STATS_GAUGE(var##_max, handler_name ".max_cycles", &var.max_cycles)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef void (*canfd_dispatch_fn_t)(const canfd_frame_t *frame);
+
+typedef struct
+{
+    const char *name;
+    canfd_dispatch_fn_t fn;
+    uint8_t mode;               /* CANFD_DISPATCH_FAST or _DEFERRED */
+    uint8_t index;              /* Entry + 1, set by canfd_dispatch_add */
+    uint32_t budget_us;
+    uint32_t budget_cycles;     /* Set by canfd_dispatch_add */
+    uint32_t calls;
+    uint32_t overruns;          /* Calls longer than the budget */
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+} canfd_dispatch_handler_t;
+
+typedef struct
+{
+    uint32_t frames;            /* Frames dispatched */
+    uint32_t deferred;          /* Frames queued for deferred handlers */
+    uint32_t dropped;           /* Deferred frames lost to a full queue */
+    uint32_t unhandled;         /* Frames without a handler */
+    uint32_t max_depth;         /* Highest deferred queue fill level */
+} canfd_dispatch_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool canfd_dispatch_add(canfd_dispatch_handler_t *handler, uint32_t first,
+                        uint32_t last, bool extended);
+bool canfd_dispatch_set_default(canfd_dispatch_handler_t *handler);
+bool canfd_dispatch_rx(const canfd_frame_t *frame);
+uint32_t canfd_dispatch_process(uint32_t max_frames);
+void canfd_dispatch_print_stats(void);
+const canfd_dispatch_stats_t *canfd_dispatch_get_stats(void);
+
+#endif /* CANFD_DISPATCH_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,680 @@
+/******************************************************************************
+* File Name:   canfd_errlog.c
+*
+* Description: Timestamped log of CAN bus errors, error state changes and
+*              protocol exceptions, with per-minute error rates next to the
+*              frame throughput.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_errlog.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define ERRLOG_MINUTE_MS            (60000UL)
+
+/* Error state bits of the PSR, as the code of a state event */
+#define ERRLOG_STATE_Msk            (CANFD_CH_M_TTCAN_PSR_EP_Msk | \
+                                     CANFD_CH_M_TTCAN_PSR_EW_Msk | \
+                                     CANFD_CH_M_TTCAN_PSR_BO_Msk)
+#define ERRLOG_STATE_Pos            (CANFD_CH_M_TTCAN_PSR_EP_Pos)
+#define ERRLOG_STATE_EP             (0x01u)
+#define ERRLOG_STATE_EW             (0x02u)
+#define ERRLOG_STATE_BO             (0x04u)
+
+/* PSR.LEC and DLEC: no error, no change since the last read */
+#define ERRLOG_LEC_NONE             (0UL)
+#define ERRLOG_LEC_NO_CHANGE        (7UL)
+
+/* PSR.ACT: node is transmitter */
+#define ERRLOG_ACT_TX               (3UL)
+
+/* PSR fields reset by every read, kept by canfd_errlog_read_psr */
+#define ERRLOG_PSR_KEEP_Msk         (CANFD_CH_M_TTCAN_PSR_LEC_Msk | \
+                                     CANFD_CH_M_TTCAN_PSR_DLEC_Msk | \
+                                     CANFD_CH_M_TTCAN_PSR_PXE_Msk)
+
+#if (0u != (CANFD_ERRLOG_EVENTS & (CANFD_ERRLOG_EVENTS - 1u)))
+#error "CANFD_ERRLOG_EVENTS must be a power of two"
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void canfd_errlog_record(uint8_t type, uint8_t code, uint32_t ecr);
+static void canfd_errlog_protocol(uint32_t lec, uint32_t psr, uint32_t ecr,
+                                  bool data_phase);
+static void canfd_errlog_state(uint32_t psr, uint32_t ecr);
+static uint32_t canfd_errlog_keep_code(uint32_t psr, uint32_t kept,
+                                       uint32_t mask, uint32_t pos);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type *errlog_base;
+static uint32_t errlog_chan;
+static bool errlog_enabled;
+
+/* Last error state (ERRLOG_STATE_xxx) */
+static uint8_t errlog_state;
+
+/* Error codes and exception flag read from the PSR, not yet logged */
+static uint32_t errlog_psr_kept;
+
+static canfd_errlog_event_t errlog_events[CANFD_ERRLOG_EVENTS];
+
+/* Counts and error counter maxima at the start of the current minute */
+static uint32_t errlog_base_count[CANFD_ERRLOG_COUNTERS];
+static uint32_t errlog_base_frames;
+static uint32_t errlog_minute;
+static uint8_t errlog_tec_max;
+static uint8_t errlog_rec_max;
+
+static canfd_errlog_minute_t errlog_history[CANFD_ERRLOG_MINUTES];
+
+static canfd_errlog_stats_t errlog_stats;
+
+static const char *const errlog_lec_names[] =
+{
+    "none", "stuff", "form", "ACK", "bit1", "bit0", "CRC", "-"
+};
+
+STATS_COUNTER(stuff, "errlog.stuff", &errlog_stats.count[CANFD_ERRLOG_STUFF]);
+STATS_COUNTER(form, "errlog.form", &errlog_stats.count[CANFD_ERRLOG_FORM]);
+STATS_COUNTER(ack, "errlog.ack", &errlog_stats.count[CANFD_ERRLOG_ACK]);
+STATS_COUNTER(bit1, "errlog.bit1", &errlog_stats.count[CANFD_ERRLOG_BIT1]);
+STATS_COUNTER(bit0, "errlog.bit0", &errlog_stats.count[CANFD_ERRLOG_BIT0]);
+STATS_COUNTER(crc, "errlog.crc", &errlog_stats.count[CANFD_ERRLOG_CRC]);
+STATS_COUNTER(data_phase, "errlog.data_phase",
+              &errlog_stats.count[CANFD_ERRLOG_DATA_PHASE]);
+STATS_COUNTER(transmit, "errlog.transmit",
+              &errlog_stats.count[CANFD_ERRLOG_TRANSMIT]);
+STATS_COUNTER(warning, "errlog.warning",
+              &errlog_stats.count[CANFD_ERRLOG_WARNING]);
+STATS_COUNTER(passive, "errlog.passive",
+              &errlog_stats.count[CANFD_ERRLOG_PASSIVE]);
+STATS_COUNTER(bus_off, "errlog.bus_off",
+              &errlog_stats.count[CANFD_ERRLOG_BUS_OFF]);
+STATS_COUNTER(exception, "errlog.exception",
+              &errlog_stats.count[CANFD_ERRLOG_EXCEPTION]);
+STATS_COUNTER(overflows, "errlog.overflows", &errlog_stats.overflows);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_errlog_init
+********************************************************************************
+* Summary:
+* Enables the protocol error, error state and error logging overflow
+* interrupts and takes the current error state. Afterwards the CAN FD
+* interrupt (or the polling loop) has to call canfd_errlog_isr before the
+* PDL handler.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*
+* Return:
+*  cy_rslt_t  result of sys_tick_init, for the timestamps
+*
+*******************************************************************************/
+cy_rslt_t canfd_errlog_init(CANFD_Type *base, uint32_t chan)
+{
+    cy_rslt_t result = sys_tick_init();
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    errlog_base = base;
+    errlog_chan = chan;
+    cycle_count_init();
+    errlog_state = (uint8_t)((canfd_errlog_read_psr(base, chan) &
+                              ERRLOG_STATE_Msk) >> ERRLOG_STATE_Pos);
+    errlog_minute = sys_tick_ms() / ERRLOG_MINUTE_MS;
+
+    CANFD_IR(base, chan) = CANFD_ERRLOG_IRQ_MASK;
+    Cy_CANFD_SetInterruptMask(base, chan,
+                              Cy_CANFD_GetInterruptMask(base, chan) |
+                              CANFD_ERRLOG_IRQ_MASK);
+    errlog_enabled = true;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_isr
+********************************************************************************
+* Summary:
+* Handles the error flags from the CAN FD interrupt and clears them, so the
+* PDL handler does not see them. Reading the PSR gives the last error code of
+* the arbitration and the data phase and whether the node was transmitting;
+* the read also resets these codes and the protocol exception flag. The codes
+* kept by canfd_errlog_read_psr since the last call are taken with it, so
+* every error is logged once, also when another module read the PSR first.
+* On an error state change, the new error state is logged; the timestamp of
+* each event is the tick and the cycle count, which relate it to the trace.
+*
+* Return:
+*  uint32_t  number of events logged
+*
+*******************************************************************************/
+uint32_t canfd_errlog_isr(void)
+{
+    uint32_t flags;
+    uint32_t psr;
+    uint32_t ecr;
+    uint32_t events;
+    uint32_t lec;
+    uint32_t intr;
+
+    if (!errlog_enabled)
+    {
+        return 0UL;
+    }
+
+    flags = CANFD_IR(errlog_base, errlog_chan) & CANFD_ERRLOG_IRQ_MASK;
+    if (0UL == flags)
+    {
+        return 0UL;
+    }
+    CANFD_IR(errlog_base, errlog_chan) = flags;
+
+    events = errlog_stats.events;
+    intr = Cy_SysLib_EnterCriticalSection();
+    psr = canfd_errlog_read_psr(errlog_base, errlog_chan);
+    errlog_psr_kept = 0UL;
+    Cy_SysLib_ExitCriticalSection(intr);
+    ecr = CANFD_ECR(errlog_base, errlog_chan);
+
+    lec = _FLD2VAL(CANFD_CH_M_TTCAN_PSR_LEC, psr);
+    if ((ERRLOG_LEC_NONE != lec) && (ERRLOG_LEC_NO_CHANGE != lec))
+    {
+        canfd_errlog_protocol(lec, psr, ecr, false);
+    }
+
+    lec = _FLD2VAL(CANFD_CH_M_TTCAN_PSR_DLEC, psr);
+    if ((ERRLOG_LEC_NONE != lec) && (ERRLOG_LEC_NO_CHANGE != lec))
+    {
+        canfd_errlog_protocol(lec, psr, ecr, true);
+    }
+
+    if (0UL != (psr & CANFD_CH_M_TTCAN_PSR_PXE_Msk))
+    {
+        errlog_stats.count[CANFD_ERRLOG_EXCEPTION]++;
+        canfd_errlog_record(CANFD_ERRLOG_EV_EXCEPTION,
+                            (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_PSR_ACT, psr),
+                            ecr);
+    }
+
+    canfd_errlog_state(psr, ecr);
+
+    if (0UL != (flags & CANFD_CH_M_TTCAN_IR_ELO_Msk))
+    {
+        errlog_stats.overflows++;
+        canfd_errlog_record(CANFD_ERRLOG_EV_OVERFLOW, 0u, ecr);
+    }
+
+    return errlog_stats.events - events;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_read_psr
+********************************************************************************
+* Summary:
+* Reads the protocol status register for the other modules. The read resets
+* the error codes (LEC, DLEC) and the protocol exception flag (PXE); they are
+* kept here until canfd_errlog_isr logs them, and a kept code is returned in
+* place of a reset one. Can be called before canfd_errlog_init and from any
+* context.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*
+* Return:
+*  uint32_t  PSR value, with the codes not yet logged
+*
+*******************************************************************************/
+uint32_t canfd_errlog_read_psr(CANFD_Type *base, uint32_t chan)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+    uint32_t psr = CANFD_PSR(base, chan);
+
+    psr = canfd_errlog_keep_code(psr, errlog_psr_kept,
+                                 CANFD_CH_M_TTCAN_PSR_LEC_Msk,
+                                 CANFD_CH_M_TTCAN_PSR_LEC_Pos);
+    psr = canfd_errlog_keep_code(psr, errlog_psr_kept,
+                                 CANFD_CH_M_TTCAN_PSR_DLEC_Msk,
+                                 CANFD_CH_M_TTCAN_PSR_DLEC_Pos);
+    psr |= errlog_psr_kept & CANFD_CH_M_TTCAN_PSR_PXE_Msk;
+    errlog_psr_kept = psr & ERRLOG_PSR_KEEP_Msk;
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    return psr;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_process
+********************************************************************************
+* Summary:
+* Closes the minute from the main loop: stores the errors counted since the
+* last minute, the frames passed in the same time and the error counter
+* maxima in the history. Also samples the error counters between errors.
+*
+* Parameters:
+*  frames  Frames received and sent since start-up, for the throughput
+*
+*******************************************************************************/
+void canfd_errlog_process(uint32_t frames)
+{
+    uint32_t minute = sys_tick_ms() / ERRLOG_MINUTE_MS;
+    uint32_t count[CANFD_ERRLOG_COUNTERS];
+    canfd_errlog_minute_t *entry;
+    uint32_t intr;
+    uint32_t delta;
+    uint32_t ecr;
+    uint32_t idx;
+
+    if ((!errlog_enabled) || (minute == errlog_minute))
+    {
+        return;
+    }
+
+    intr = Cy_SysLib_EnterCriticalSection();
+    ecr = CANFD_ECR(errlog_base, errlog_chan);
+    if (_FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC, ecr) > errlog_tec_max)
+    {
+        errlog_tec_max = (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC, ecr);
+    }
+    if (_FLD2VAL(CANFD_CH_M_TTCAN_ECR_REC, ecr) > errlog_rec_max)
+    {
+        errlog_rec_max = (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_ECR_REC, ecr);
+    }
+
+    entry = &errlog_history[errlog_stats.minutes % CANFD_ERRLOG_MINUTES];
+    entry->tec_max = errlog_tec_max;
+    entry->rec_max = errlog_rec_max;
+    errlog_tec_max = 0u;
+    errlog_rec_max = 0u;
+    for (idx = 0UL; idx < CANFD_ERRLOG_COUNTERS; idx++)
+    {
+        count[idx] = errlog_stats.count[idx];
+    }
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    entry->minute = errlog_minute;
+    entry->frames = frames - errlog_base_frames;
+    for (idx = 0UL; idx < CANFD_ERRLOG_COUNTERS; idx++)
+    {
+        delta = count[idx] - errlog_base_count[idx];
+        entry->count[idx] = (delta > UINT16_MAX) ? UINT16_MAX :
+                                                   (uint16_t)delta;
+        errlog_base_count[idx] = count[idx];
+    }
+
+    errlog_base_frames = frames;
+    errlog_minute = minute;
+    errlog_stats.minutes++;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_copy_events
+********************************************************************************
+* Summary:
+* Copies the last logged events, oldest first.
+*
+* Parameters:
+*  dst         Destination
+*  max_events  Size of dst in events
+*
+* Return:
+*  uint32_t  number of events copied
+*
+*******************************************************************************/
+uint32_t canfd_errlog_copy_events(canfd_errlog_event_t *dst,
+                                  uint32_t max_events)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+    uint32_t count = errlog_stats.events;
+    uint32_t first;
+
+    if (count > CANFD_ERRLOG_EVENTS)
+    {
+        count = CANFD_ERRLOG_EVENTS;
+    }
+    if (count > max_events)
+    {
+        count = max_events;
+    }
+
+    first = errlog_stats.events - count;
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        dst[idx] = errlog_events[(first + idx) & (CANFD_ERRLOG_EVENTS - 1u)];
+    }
+    Cy_SysLib_ExitCriticalSection(intr);
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_get_minute
+********************************************************************************
+* Summary:
+* Returns a closed minute of the history.
+*
+* Parameters:
+*  age  0 for the last closed minute, 1 for the one before, ...
+*
+* Return:
+*  const canfd_errlog_minute_t *  NULL if the minute is not in the history
+*
+*******************************************************************************/
+const canfd_errlog_minute_t *canfd_errlog_get_minute(uint32_t age)
+{
+    if ((age >= errlog_stats.minutes) || (age >= CANFD_ERRLOG_MINUTES))
+    {
+        return NULL;
+    }
+
+    return &errlog_history[(errlog_stats.minutes - 1UL - age) %
+                           CANFD_ERRLOG_MINUTES];
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_print_events
+*******************************************************************************/
+void canfd_errlog_print_events(void)
+{
+    canfd_errlog_event_t event;
+    uint32_t count;
+    uint32_t first;
+    uint32_t intr;
+
+    count = (errlog_stats.events > CANFD_ERRLOG_EVENTS) ?
+            CANFD_ERRLOG_EVENTS : errlog_stats.events;
+    first = errlog_stats.events - count;
+    printf("Bus error log: %lu events, last %lu:\r\n",
+           (unsigned long)errlog_stats.events, (unsigned long)count);
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        intr = Cy_SysLib_EnterCriticalSection();
+        event = errlog_events[(first + idx) & (CANFD_ERRLOG_EVENTS - 1u)];
+        Cy_SysLib_ExitCriticalSection(intr);
+
+        printf("  %10lu ms %10lu cyc  ", (unsigned long)event.time_ms,
+               (unsigned long)event.cycles);
+        switch (event.type)
+        {
+            case CANFD_ERRLOG_EV_PROTOCOL:
+                printf("%-5s error %s, %s",
+                       errlog_lec_names[event.code & CANFD_ERRLOG_CODE_LEC_Msk],
+                       (0u != (event.code & CANFD_ERRLOG_CODE_DATA)) ?
+                       "data phase" : "arbitration",
+                       (0u != (event.code & CANFD_ERRLOG_CODE_TX)) ?
+                       "transmitting" : "receiving");
+                break;
+
+            case CANFD_ERRLOG_EV_STATE:
+                printf("state %s",
+                       (0u != (event.code & ERRLOG_STATE_BO)) ? "bus off" :
+                       (0u != (event.code & ERRLOG_STATE_EP)) ? "error passive" :
+                       (0u != (event.code & ERRLOG_STATE_EW)) ? "error warning" :
+                       "error active");
+                break;
+
+            case CANFD_ERRLOG_EV_EXCEPTION:
+                printf("protocol exception");
+                break;
+
+            default:
+                printf("error logging overflow");
+                break;
+        }
+        printf(", TEC %u REC %u%s\r\n", event.tec, event.rec & 0x7Fu,
+               (0u != (event.rec & 0x80u)) ? " RP" : "");
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_print_stats
+********************************************************************************
+* Summary:
+* Prints the totals and, for the minutes in the history, the protocol errors
+* next to the frames of the same minute, so error bursts can be matched with
+* the load and the throughput.
+*
+*******************************************************************************/
+void canfd_errlog_print_stats(void)
+{
+    const canfd_errlog_minute_t *entry;
+    const uint32_t *count = errlog_stats.count;
+    uint32_t errors;
+    uint32_t age;
+
+    printf("Bus errors: %lu stuff, %lu form, %lu ACK, %lu bit1, %lu bit0, "
+           "%lu CRC (%lu data phase, %lu transmitting), %lu warning, "
+           "%lu passive, %lu bus off, %lu exceptions, %lu log overflows\r\n",
+           (unsigned long)count[CANFD_ERRLOG_STUFF],
+           (unsigned long)count[CANFD_ERRLOG_FORM],
+           (unsigned long)count[CANFD_ERRLOG_ACK],
+           (unsigned long)count[CANFD_ERRLOG_BIT1],
+           (unsigned long)count[CANFD_ERRLOG_BIT0],
+           (unsigned long)count[CANFD_ERRLOG_CRC],
+           (unsigned long)count[CANFD_ERRLOG_DATA_PHASE],
+           (unsigned long)count[CANFD_ERRLOG_TRANSMIT],
+           (unsigned long)count[CANFD_ERRLOG_WARNING],
+           (unsigned long)count[CANFD_ERRLOG_PASSIVE],
+           (unsigned long)count[CANFD_ERRLOG_BUS_OFF],
+           (unsigned long)count[CANFD_ERRLOG_EXCEPTION],
+           (unsigned long)errlog_stats.overflows);
+
+    if (0UL == errlog_stats.minutes)
+    {
+        return;
+    }
+
+    printf("  minute  frames  errors  ppm frames  data  tx  state  TEC  REC\r\n");
+    age = (errlog_stats.minutes < CANFD_ERRLOG_MINUTES) ?
+          errlog_stats.minutes : CANFD_ERRLOG_MINUTES;
+    while (0UL != age)
+    {
+        age--;
+        entry = canfd_errlog_get_minute(age);
+        errors = 0UL;
+        for (uint32_t idx = CANFD_ERRLOG_STUFF; idx <= CANFD_ERRLOG_CRC; idx++)
+        {
+            errors += entry->count[idx];
+        }
+
+        printf("  %6lu %7lu %7lu %11lu %5u %3u %6u %4u %4u\r\n",
+               (unsigned long)entry->minute, (unsigned long)entry->frames,
+               (unsigned long)errors,
+               (unsigned long)((0UL != entry->frames) ?
+                               (((uint64_t)errors * 1000000UL) /
+                                entry->frames) : 0UL),
+               entry->count[CANFD_ERRLOG_DATA_PHASE],
+               entry->count[CANFD_ERRLOG_TRANSMIT],
+               (unsigned int)(entry->count[CANFD_ERRLOG_WARNING] +
+                              entry->count[CANFD_ERRLOG_PASSIVE] +
+                              entry->count[CANFD_ERRLOG_BUS_OFF]),
+               entry->tec_max, entry->rec_max);
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_get_stats
+*******************************************************************************/
+const canfd_errlog_stats_t *canfd_errlog_get_stats(void)
+{
+    return &errlog_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_record
+********************************************************************************
+* Summary:
+* Writes an event into the ring, overwriting the oldest, and into the trace.
+*
+*******************************************************************************/
+static void canfd_errlog_record(uint8_t type, uint8_t code, uint32_t ecr)
+{
+    canfd_errlog_event_t *event =
+        &errlog_events[errlog_stats.events & (CANFD_ERRLOG_EVENTS - 1u)];
+    uint8_t tec = (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC, ecr);
+    uint8_t rec = (uint8_t)_FLD2VAL(CANFD_CH_M_TTCAN_ECR_REC, ecr);
+
+    event->time_ms = sys_tick_ms();
+    event->cycles = cycle_count_now();
+    event->type = type;
+    event->code = code;
+    event->tec = tec;
+    event->rec = rec;
+    if (0UL != (ecr & CANFD_CH_M_TTCAN_ECR_RP_Msk))
+    {
+        event->rec |= 0x80u;
+    }
+    errlog_stats.events++;
+
+    if (tec > errlog_tec_max)
+    {
+        errlog_tec_max = tec;
+    }
+    if (rec > errlog_rec_max)
+    {
+        errlog_rec_max = rec;
+    }
+
+    TRACE(TRACE_CAN_ERROR, type, (uint32_t)code | ((uint32_t)tec << 8));
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_protocol
+********************************************************************************
+* Summary:
+* Counts and logs a protocol error of the arbitration or the data phase.
+*
+*******************************************************************************/
+static void canfd_errlog_protocol(uint32_t lec, uint32_t psr, uint32_t ecr,
+                                  bool data_phase)
+{
+    uint8_t code = (uint8_t)lec;
+
+    errlog_stats.count[CANFD_ERRLOG_STUFF + lec - 1UL]++;
+    if (data_phase)
+    {
+        errlog_stats.count[CANFD_ERRLOG_DATA_PHASE]++;
+        code |= CANFD_ERRLOG_CODE_DATA;
+    }
+    if (ERRLOG_ACT_TX == _FLD2VAL(CANFD_CH_M_TTCAN_PSR_ACT, psr))
+    {
+        errlog_stats.count[CANFD_ERRLOG_TRANSMIT]++;
+        code |= CANFD_ERRLOG_CODE_TX;
+    }
+    canfd_errlog_record(CANFD_ERRLOG_EV_PROTOCOL, code, ecr);
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_state
+********************************************************************************
+* Summary:
+* Logs a change of the error state and counts the states entered.
+*
+*******************************************************************************/
+static void canfd_errlog_state(uint32_t psr, uint32_t ecr)
+{
+    uint8_t state = (uint8_t)((psr & ERRLOG_STATE_Msk) >> ERRLOG_STATE_Pos);
+    uint8_t entered = state & (uint8_t)~errlog_state;
+
+    if (state == errlog_state)
+    {
+        return;
+    }
+
+    if (0u != (entered & ERRLOG_STATE_EW))
+    {
+        errlog_stats.count[CANFD_ERRLOG_WARNING]++;
+    }
+    if (0u != (entered & ERRLOG_STATE_EP))
+    {
+        errlog_stats.count[CANFD_ERRLOG_PASSIVE]++;
+    }
+    if (0u != (entered & ERRLOG_STATE_BO))
+    {
+        errlog_stats.count[CANFD_ERRLOG_BUS_OFF]++;
+    }
+    errlog_state = state;
+    canfd_errlog_record(CANFD_ERRLOG_EV_STATE, state, ecr);
+}
+
+/*******************************************************************************
+* Function Name: canfd_errlog_keep_code
+********************************************************************************
+* Summary:
+* Puts a kept error code into a PSR value whose code of the same field shows
+* no new error. A new error code replaces the kept one.
+*
+*******************************************************************************/
+static uint32_t canfd_errlog_keep_code(uint32_t psr, uint32_t kept,
+                                       uint32_t mask, uint32_t pos)
+{
+    uint32_t lec = (psr & mask) >> pos;
+
+    if ((ERRLOG_LEC_NONE == lec) || (ERRLOG_LEC_NO_CHANGE == lec))
+    {
+        lec = (kept & mask) >> pos;
+        if ((ERRLOG_LEC_NONE != lec) && (ERRLOG_LEC_NO_CHANGE != lec))
+        {
+            psr = (psr & ~mask) | (kept & mask);
+        }
+    }
+    return psr;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,152 @@
+/******************************************************************************
+* File Name:   canfd_errlog.h
+*
+* Description: Timestamped log and per-minute rates of CAN bus errors.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_ERRLOG_H_
+#define CANFD_ERRLOG_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Events held in RAM (power of two); older ones are overwritten */
+#ifndef CANFD_ERRLOG_EVENTS
+#define CANFD_ERRLOG_EVENTS         (64u)
+#endif
+
+/* Minutes of error rates kept */
+#ifndef CANFD_ERRLOG_MINUTES
+#define CANFD_ERRLOG_MINUTES        (16u)
+#endif
+
+/* Protocol errors in the arbitration and data phase, error warning, error
+ * passive and bus off changes, and error logging overflow */
+#define CANFD_ERRLOG_IRQ_MASK       (CANFD_CH_M_TTCAN_IR_PEA_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_PED_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_EW_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_EP_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_BO_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_ELO_Msk)
+
+/* Trace event of a bus error: event type, code */
+#define TRACE_CAN_ERROR             (12u)
+
+/* Event types */
+#define CANFD_ERRLOG_EV_PROTOCOL    (1u)    /* Code: LEC, see below */
+#define CANFD_ERRLOG_EV_STATE       (2u)    /* Code: PSR.EP, EW, BO in bits 0..2 */
+#define CANFD_ERRLOG_EV_EXCEPTION   (3u)    /* Protocol exception (PSR.PXE) */
+#define CANFD_ERRLOG_EV_OVERFLOW    (4u)    /* Error logging counter wrapped */
+
+/* Code of a protocol error: LEC or DLEC in bits 0..2 (1 stuff, 2 form,
+ * 3 ACK, 4 bit1, 5 bit0, 6 CRC), data phase, node transmitting */
+#define CANFD_ERRLOG_CODE_LEC_Msk   (0x07u)
+#define CANFD_ERRLOG_CODE_DATA      (0x08u)
+#define CANFD_ERRLOG_CODE_TX        (0x10u)
+
+/* Counters, as totals and per minute. The first six are the protocol errors
+ * by LEC - 1; DATA_PHASE and TRANSMIT count those of them in the data phase
+ * and while transmitting. */
+#define CANFD_ERRLOG_STUFF          (0u)
+#define CANFD_ERRLOG_FORM           (1u)
+#define CANFD_ERRLOG_ACK            (2u)
+#define CANFD_ERRLOG_BIT1           (3u)
+#define CANFD_ERRLOG_BIT0           (4u)
+#define CANFD_ERRLOG_CRC            (5u)
+#define CANFD_ERRLOG_DATA_PHASE     (6u)
+#define CANFD_ERRLOG_TRANSMIT       (7u)
+#define CANFD_ERRLOG_WARNING        (8u)    /* Error warning entered */
+#define CANFD_ERRLOG_PASSIVE        (9u)    /* Error passive entered */
+#define CANFD_ERRLOG_BUS_OFF        (10u)   /* Bus off entered */
+#define CANFD_ERRLOG_EXCEPTION      (11u)
+#define CANFD_ERRLOG_COUNTERS       (12u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t time_ms;           /* System tick */
+    uint32_t cycles;            /* DWT cycle count, as in the trace */
+    uint8_t type;               /* CANFD_ERRLOG_EV_xxx */
+    uint8_t code;
+    uint8_t tec;                /* Transmit error counter */
+    uint8_t rec;                /* Receive error counter, bit 7 ECR.RP */
+} canfd_errlog_event_t;
+
+typedef struct
+{
+    uint32_t minute;            /* Minutes since start-up */
+    uint32_t frames;            /* Frames received and sent */
+    uint16_t count[CANFD_ERRLOG_COUNTERS];
+    uint8_t tec_max;
+    uint8_t rec_max;
+} canfd_errlog_minute_t;
+
+typedef struct
+{
+    uint32_t count[CANFD_ERRLOG_COUNTERS];
+    uint32_t events;            /* Events recorded, including overwritten */
+    uint32_t overflows;         /* ECR.CEL wrapped (ELO) */
+    uint32_t minutes;           /* Minutes closed */
+} canfd_errlog_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_errlog_init(CANFD_Type *base, uint32_t chan);
+uint32_t canfd_errlog_isr(void);
+uint32_t canfd_errlog_read_psr(CANFD_Type *base, uint32_t chan);
+void canfd_errlog_process(uint32_t frames);
+uint32_t canfd_errlog_copy_events(canfd_errlog_event_t *dst,
+                                  uint32_t max_events);
+const canfd_errlog_minute_t *canfd_errlog_get_minute(uint32_t age);
+void canfd_errlog_print_events(void);
+void canfd_errlog_print_stats(void);
+const canfd_errlog_stats_t *canfd_errlog_get_stats(void);
+
+#endif /* CANFD_ERRLOG_H_ */
+
+/* [] END OF FILE */
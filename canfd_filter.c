@@ -0,0 +1,450 @@
+/******************************************************************************
+* File Name:   canfd_filter.c
+*
+* Description: Acceptance filter tables that change at run time: two filter
+*              regions in the message RAM, one active, one rewritten in the
+*              background, switched by enabling and disabling elements without
+*              stopping the controller.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_filter.h"
+#include "canfd_frame.h"
+#include "canfd_mram.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Element fields; an element with SFEC/EFEC 0 is disabled */
+#define FILTER_SFT_Pos          (30u)
+#define FILTER_SFEC_Pos         (27u)
+#define FILTER_SFEC_Msk         (0x38000000UL)
+#define FILTER_SFID1_Pos        (16u)
+#define FILTER_SID_Msk          (0x7FFUL)
+#define FILTER_EFEC_Pos         (29u)
+#define FILTER_EFT_Pos          (30u)
+#define FILTER_XID_Msk          (0x1FFFFFFFUL)
+
+/* Message RAM words of one region */
+#define FILTER_REGION_WORDS     (CANFD_FILTER_SID_SLOTS + \
+                                 (2u * CANFD_FILTER_XID_SLOTS))
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Regions 0 and 1 are adjacent, so that the standard and the extended
+ * filter list each cover both */
+static volatile uint32_t *filter_sid[2];
+static volatile uint32_t *filter_xid[2];
+static uint32_t filter_active;
+
+/* Enabled words of the table written to the inactive region: the standard
+ * elements and word F0 of the extended elements */
+static uint32_t filter_sid_staged[CANFD_FILTER_SID_SLOTS];
+static uint32_t filter_xid_staged[CANFD_FILTER_XID_SLOTS];
+static uint32_t filter_sid_count;
+static uint32_t filter_xid_count;
+
+/* Elements configured by Cy_CANFD_Init, for canfd_filter_add_initial */
+static uint32_t filter_initial_sid[CANFD_FILTER_SID_SLOTS];
+static uint32_t filter_initial_xid[2u * CANFD_FILTER_XID_SLOTS];
+static uint32_t filter_initial_sid_count;
+static uint32_t filter_initial_xid_count;
+
+static canfd_filter_stats_t filter_stats;
+
+STATS_COUNTER(switches, "filter.switches", &filter_stats.switches);
+STATS_COUNTER(rejected, "filter.rejected", &filter_stats.rejected);
+STATS_GAUGE(window, "filter.max_window_cycles",
+            &filter_stats.max_window_cycles);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_filter_init
+********************************************************************************
+* Summary:
+* Moves the filter lists to the end of the channel's message RAM, behind the
+* Tx FIFO of canfd_txq_init, and makes the lists twice as long: region 0
+* holds the elements configured by Cy_CANFD_Init, region 1 is disabled. This
+* is the only configuration change window; call it at start-up after
+* canfd_txq_init and before canfd_mram_init.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  config     Configuration passed to Cy_CANFD_Init
+*  context    Channel context
+*
+* Return:
+*  cy_rslt_t  CANFD_FILTER_RSLT_NO_RAM if the regions do not fit behind the
+*             Tx buffers, CANFD_FILTER_RSLT_SLOTS if Cy_CANFD_Init configured
+*             more elements than a region holds, or the PDL status
+*
+*******************************************************************************/
+cy_rslt_t canfd_filter_init(CANFD_Type *base, uint32_t chan,
+                            const cy_stc_canfd_config_t *config,
+                            cy_stc_canfd_context_t *context)
+{
+    uint32_t sidfc = CANFD_SIDFC(base, chan);
+    uint32_t xidfc = CANFD_XIDFC(base, chan);
+    uint32_t txbc = CANFD_TXBC(base, chan);
+    uint32_t ram_start = _FLD2VAL(CANFD_CH_M_TTCAN_SIDFC_FLSSA, sidfc);
+    uint32_t tx_start = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TBSA, txbc);
+    uint32_t tx_elems = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_NDTB, txbc) +
+                        _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TFQS, txbc);
+    /* TBDS encodes the element data size like the DLC codes 8..15 */
+    uint32_t elem_words = CANFD_ELEM_HEADER_WORDS +
+                          (canfd_dlc_to_len(8UL +
+                                            _FLD2VAL(CANFD_CH_M_TTCAN_TXESC_TBDS,
+                                                     CANFD_TXESC(base, chan))) /
+                           4UL);
+    uint32_t used_end = tx_start - ram_start + (tx_elems * elem_words);
+    uint32_t place = (config->messageRAMsize / 4UL) -
+                     (2UL * FILTER_REGION_WORDS);
+    volatile uint32_t *ram;
+    volatile uint32_t *old_sid;
+    volatile uint32_t *old_xid;
+    cy_en_canfd_status_t status;
+
+    filter_initial_sid_count = _FLD2VAL(CANFD_CH_M_TTCAN_SIDFC_LSS, sidfc);
+    filter_initial_xid_count = _FLD2VAL(CANFD_CH_M_TTCAN_XIDFC_LSE, xidfc);
+    if ((filter_initial_sid_count > CANFD_FILTER_SID_SLOTS) ||
+        (filter_initial_xid_count > CANFD_FILTER_XID_SLOTS))
+    {
+        return CANFD_FILTER_RSLT_SLOTS;
+    }
+    if (((config->messageRAMsize / 4UL) < (2UL * FILTER_REGION_WORDS)) ||
+        (place < used_end))
+    {
+        return CANFD_FILTER_RSLT_NO_RAM;
+    }
+
+    /* Word address 0 of the message RAM, found from Tx buffer 0 */
+    ram = (volatile uint32_t *)Cy_CANFD_CalcTxBufAdrs(base, chan, 0UL,
+                                                      context) - tx_start;
+    old_sid = ram + ram_start;
+    old_xid = ram + _FLD2VAL(CANFD_CH_M_TTCAN_XIDFC_FLESA, xidfc);
+    place += ram_start;
+
+    filter_sid[0] = ram + place;
+    filter_sid[1] = filter_sid[0] + CANFD_FILTER_SID_SLOTS;
+    filter_xid[0] = filter_sid[1] + CANFD_FILTER_SID_SLOTS;
+    filter_xid[1] = filter_xid[0] + (2UL * CANFD_FILTER_XID_SLOTS);
+
+    for (uint32_t idx = 0UL; idx < filter_initial_sid_count; idx++)
+    {
+        filter_initial_sid[idx] = old_sid[idx];
+    }
+    for (uint32_t idx = 0UL; idx < (2UL * filter_initial_xid_count); idx++)
+    {
+        filter_initial_xid[idx] = old_xid[idx];
+    }
+
+    for (uint32_t idx = 0UL; idx < (2UL * FILTER_REGION_WORDS); idx++)
+    {
+        filter_sid[0][idx] = 0UL;
+    }
+    for (uint32_t idx = 0UL; idx < filter_initial_sid_count; idx++)
+    {
+        filter_sid[0][idx] = filter_initial_sid[idx];
+    }
+    for (uint32_t idx = 0UL; idx < (2UL * filter_initial_xid_count); idx++)
+    {
+        filter_xid[0][idx] = filter_initial_xid[idx];
+    }
+    filter_active = 0UL;
+    filter_stats.sid_active = filter_initial_sid_count;
+    filter_stats.xid_active = filter_initial_xid_count;
+
+    status = Cy_CANFD_ConfigChangesEnable(base, chan);
+    if (CY_CANFD_SUCCESS == status)
+    {
+        CANFD_SIDFC(base, chan) =
+            _VAL2FLD(CANFD_CH_M_TTCAN_SIDFC_FLSSA, place) |
+            _VAL2FLD(CANFD_CH_M_TTCAN_SIDFC_LSS,
+                     2UL * CANFD_FILTER_SID_SLOTS);
+        CANFD_XIDFC(base, chan) =
+            _VAL2FLD(CANFD_CH_M_TTCAN_XIDFC_FLESA,
+                     place + (2UL * CANFD_FILTER_SID_SLOTS)) |
+            _VAL2FLD(CANFD_CH_M_TTCAN_XIDFC_LSE,
+                     2UL * CANFD_FILTER_XID_SLOTS);
+        status = Cy_CANFD_ConfigChangesDisable(base, chan);
+    }
+
+    cycle_count_init();
+    canfd_filter_begin();
+    return (CY_CANFD_SUCCESS == status) ? CY_RSLT_SUCCESS : (cy_rslt_t)status;
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_begin
+********************************************************************************
+* Summary:
+* Starts a new table in the inactive region; its elements stay disabled
+* until canfd_filter_commit. Thread context only.
+*
+*******************************************************************************/
+void canfd_filter_begin(void)
+{
+    uint32_t region = filter_active ^ 1UL;
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+
+    for (uint32_t idx = 0UL; idx < CANFD_FILTER_SID_SLOTS; idx++)
+    {
+        filter_sid[region][idx] = 0UL;
+    }
+    for (uint32_t idx = 0UL; idx < (2UL * CANFD_FILTER_XID_SLOTS); idx++)
+    {
+        filter_xid[region][idx] = 0UL;
+    }
+    canfd_mram_update_filters();
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    filter_sid_count = 0UL;
+    filter_xid_count = 0UL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_add
+********************************************************************************
+* Summary:
+* Appends a filter to the table started by canfd_filter_begin. The element
+* is written to the message RAM at once, disabled. As in the hardware, the
+* first matching element of a list decides.
+*
+* Return:
+*  bool  false if the region has no free element of this kind; the filter
+*        is counted as rejected
+*
+*******************************************************************************/
+bool canfd_filter_add(const canfd_filter_t *filter)
+{
+    uint32_t region = filter_active ^ 1UL;
+    volatile uint32_t *elem;
+    uint32_t intr;
+
+    if (filter->extended)
+    {
+        if (filter_xid_count >= CANFD_FILTER_XID_SLOTS)
+        {
+            filter_stats.rejected++;
+            return false;
+        }
+        filter_xid_staged[filter_xid_count] =
+            ((uint32_t)filter->action << FILTER_EFEC_Pos) |
+            (filter->id1 & FILTER_XID_Msk);
+
+        elem = &filter_xid[region][2UL * filter_xid_count];
+        intr = Cy_SysLib_EnterCriticalSection();
+        elem[0] = filter->id1 & FILTER_XID_Msk;
+        elem[1] = ((uint32_t)filter->type << FILTER_EFT_Pos) |
+                  (filter->id2 & FILTER_XID_Msk);
+        canfd_mram_update_filters();
+        Cy_SysLib_ExitCriticalSection(intr);
+        filter_xid_count++;
+    }
+    else
+    {
+        if (filter_sid_count >= CANFD_FILTER_SID_SLOTS)
+        {
+            filter_stats.rejected++;
+            return false;
+        }
+        filter_sid_staged[filter_sid_count] =
+            ((uint32_t)filter->type << FILTER_SFT_Pos) |
+            ((uint32_t)filter->action << FILTER_SFEC_Pos) |
+            ((filter->id1 & FILTER_SID_Msk) << FILTER_SFID1_Pos) |
+            (filter->id2 & FILTER_SID_Msk);
+
+        intr = Cy_SysLib_EnterCriticalSection();
+        filter_sid[region][filter_sid_count] =
+            filter_sid_staged[filter_sid_count] & ~FILTER_SFEC_Msk;
+        canfd_mram_update_filters();
+        Cy_SysLib_ExitCriticalSection(intr);
+        filter_sid_count++;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_add_initial
+********************************************************************************
+* Summary:
+* Appends the elements configured by Cy_CANFD_Init to the new table.
+*
+* Return:
+*  bool  false if an element did not fit; the others are added
+*
+*******************************************************************************/
+bool canfd_filter_add_initial(void)
+{
+    canfd_filter_t filter;
+    uint32_t word;
+    bool added = true;
+
+    for (uint32_t idx = 0UL; idx < filter_initial_sid_count; idx++)
+    {
+        word = filter_initial_sid[idx];
+        filter.extended = false;
+        filter.type = (uint8_t)(word >> FILTER_SFT_Pos);
+        filter.action = (uint8_t)((word & FILTER_SFEC_Msk) >> FILTER_SFEC_Pos);
+        filter.id1 = (word >> FILTER_SFID1_Pos) & FILTER_SID_Msk;
+        filter.id2 = word & FILTER_SID_Msk;
+        added = canfd_filter_add(&filter) && added;
+    }
+    for (uint32_t idx = 0UL; idx < filter_initial_xid_count; idx++)
+    {
+        word = filter_initial_xid[2UL * idx];
+        filter.extended = true;
+        filter.action = (uint8_t)(word >> FILTER_EFEC_Pos);
+        filter.id1 = word & FILTER_XID_Msk;
+        word = filter_initial_xid[(2UL * idx) + 1UL];
+        filter.type = (uint8_t)(word >> FILTER_EFT_Pos);
+        filter.id2 = word & FILTER_XID_Msk;
+        added = canfd_filter_add(&filter) && added;
+    }
+    return added;
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_space
+********************************************************************************
+* Summary:
+* Returns the free elements of one kind in the table being built.
+*
+*******************************************************************************/
+uint32_t canfd_filter_space(bool extended)
+{
+    return extended ? (CANFD_FILTER_XID_SLOTS - filter_xid_count) :
+                      (CANFD_FILTER_SID_SLOTS - filter_sid_count);
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_commit
+********************************************************************************
+* Summary:
+* Makes the new table active without a configuration change window: its
+* elements are enabled first, then the elements of the old table are
+* disabled. Each step is a single word write that the filter logic sees
+* between two frames, so every frame is filtered by the old table, the new
+* one, or both in list order, and none is lost: there is no blackout. The
+* window during which both tables are partly enabled is measured. The
+* interrupts are locked during the switch to keep the window short.
+*
+*******************************************************************************/
+void canfd_filter_commit(void)
+{
+    uint32_t old = filter_active;
+    uint32_t region = old ^ 1UL;
+    uint32_t intr;
+    uint32_t start;
+    uint32_t cycles;
+
+    intr = Cy_SysLib_EnterCriticalSection();
+    start = cycle_count_now();
+
+    for (uint32_t idx = 0UL; idx < filter_sid_count; idx++)
+    {
+        filter_sid[region][idx] = filter_sid_staged[idx];
+    }
+    for (uint32_t idx = 0UL; idx < filter_xid_count; idx++)
+    {
+        filter_xid[region][2UL * idx] = filter_xid_staged[idx];
+    }
+
+    for (uint32_t idx = 0UL; idx < filter_stats.sid_active; idx++)
+    {
+        filter_sid[old][idx] = 0UL;
+    }
+    for (uint32_t idx = 0UL; idx < filter_stats.xid_active; idx++)
+    {
+        filter_xid[old][2UL * idx] = 0UL;
+    }
+
+    cycles = cycle_count_now() - start;
+    canfd_mram_update_filters();
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    filter_active = region;
+    filter_stats.sid_active = filter_sid_count;
+    filter_stats.xid_active = filter_xid_count;
+    filter_stats.switches++;
+    filter_stats.window_cycles = cycles;
+    if (cycles > filter_stats.max_window_cycles)
+    {
+        filter_stats.max_window_cycles = cycles;
+    }
+
+    /* The old region takes the next table */
+    filter_sid_count = 0UL;
+    filter_xid_count = 0UL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_print_stats
+*******************************************************************************/
+void canfd_filter_print_stats(void)
+{
+    printf("Filters: region %lu active, %lu standard and %lu extended "
+           "elements, %lu switches, last window %lu cycles, max %lu, "
+           "%lu rejected\r\n",
+           (unsigned long)filter_active,
+           (unsigned long)filter_stats.sid_active,
+           (unsigned long)filter_stats.xid_active,
+           (unsigned long)filter_stats.switches,
+           (unsigned long)filter_stats.window_cycles,
+           (unsigned long)filter_stats.max_window_cycles,
+           (unsigned long)filter_stats.rejected);
+}
+
+/*******************************************************************************
+* Function Name: canfd_filter_get_stats
+*******************************************************************************/
+const canfd_filter_stats_t *canfd_filter_get_stats(void)
+{
+    return &filter_stats;
+}
+
+/* [] END OF FILE */
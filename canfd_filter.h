@@ -0,0 +1,127 @@
+/******************************************************************************
+* File Name:   canfd_filter.h
+*
+* Description: Acceptance filter tables that change at run time: two filter
+*              regions in the message RAM, one active, one rewritten in the
+*              background, switched by enabling and disabling elements without
+*              stopping the controller.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+
+#ifndef CANFD_FILTER_H_
+#define CANFD_FILTER_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Standard and extended filter elements per region */
+#ifndef CANFD_FILTER_SID_SLOTS
+#define CANFD_FILTER_SID_SLOTS      (16u)
+#endif
+
+#ifndef CANFD_FILTER_XID_SLOTS
+#define CANFD_FILTER_XID_SLOTS      (8u)
+#endif
+
+/* Both regions form one list: SIDFC.LSS is 8 bits, XIDFC.LSE 7 bits */
+#if ((2u * CANFD_FILTER_SID_SLOTS) > 128u) || \
+    ((2u * CANFD_FILTER_XID_SLOTS) > 64u)
+#error "CANFD_FILTER_SID_SLOTS is limited to 64, CANFD_FILTER_XID_SLOTS to 32"
+#endif
+
+/* Filter types (SFT, EFT) */
+#define CANFD_FILTER_RANGE          (0u)    /* id1 to id2 */
+#define CANFD_FILTER_DUAL           (1u)    /* id1 or id2 */
+#define CANFD_FILTER_CLASSIC        (2u)    /* id1 with the mask id2 */
+
+/* Filter actions (SFEC, EFEC) */
+#define CANFD_FILTER_TO_FIFO0       (1u)
+#define CANFD_FILTER_TO_FIFO1       (2u)
+#define CANFD_FILTER_REJECT         (3u)
+
+#define CANFD_FILTER_RSLT_NO_RAM            \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 9u))
+#define CANFD_FILTER_RSLT_SLOTS             \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 10u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t id1;
+    uint32_t id2;               /* Second ID, end of the range, or mask */
+    uint8_t type;               /* CANFD_FILTER_RANGE, _DUAL or _CLASSIC */
+    uint8_t action;             /* CANFD_FILTER_TO_FIFO0, _TO_FIFO1, _REJECT */
+    bool extended;              /* 29-bit identifiers */
+} canfd_filter_t;
+
+typedef struct
+{
+    uint32_t switches;          /* Tables made active */
+    uint32_t sid_active;        /* Elements of the active table */
+    uint32_t xid_active;
+    uint32_t window_cycles;     /* Last switch: first enable to last disable */
+    uint32_t max_window_cycles;
+    uint32_t rejected;          /* Elements that did not fit into a table */
+} canfd_filter_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_filter_init(CANFD_Type *base, uint32_t chan,
+                            const cy_stc_canfd_config_t *config,
+                            cy_stc_canfd_context_t *context);
+void canfd_filter_begin(void);
+bool canfd_filter_add(const canfd_filter_t *filter);
+bool canfd_filter_add_initial(void);
+uint32_t canfd_filter_space(bool extended);
+void canfd_filter_commit(void);
+void canfd_filter_print_stats(void);
+const canfd_filter_stats_t *canfd_filter_get_stats(void);
+
+#endif /* CANFD_FILTER_H_ */
+
+/* [] END OF FILE */
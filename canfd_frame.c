@@ -0,0 +1,321 @@
+/******************************************************************************
+* File Name:   canfd_frame.c
+*
+* Description: Conversion between canfd_frame_t and the M_TTCAN message RAM
+*              element layout (T0/T1 and R0/R1 header words followed by the
+*              payload words), and between DLC codes and payload lengths.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint8_t canfd_frame_len(uint32_t dlc, uint8_t flags);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Payload length for each DLC code */
+static const uint8_t canfd_dlc_len_table[16] =
+{
+    0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 12u, 16u, 20u, 24u, 32u, 48u, 64u
+};
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_dlc_to_len
+********************************************************************************
+* Summary:
+* Converts a DLC code into the payload length in bytes.
+*
+*******************************************************************************/
+uint32_t canfd_dlc_to_len(uint32_t dlc)
+{
+    return canfd_dlc_len_table[dlc & 0x0FUL];
+}
+
+/*******************************************************************************
+* Function Name: canfd_len_to_dlc
+********************************************************************************
+* Summary:
+* Converts a payload length into the smallest DLC code that can carry it.
+*
+*******************************************************************************/
+uint32_t canfd_len_to_dlc(uint32_t len)
+{
+    uint32_t dlc = 0UL;
+
+    while ((dlc < 15UL) && (canfd_dlc_len_table[dlc] < len))
+    {
+        dlc++;
+    }
+    return dlc;
+}
+
+/*******************************************************************************
+* Function Name: canfd_frame_to_element
+********************************************************************************
+* Summary:
+* Writes a frame into a Tx buffer element in message RAM. The payload is
+* rounded up to the DLC length; the padding bytes are sent as they are in
+* frame->data.
+*
+* Parameters:
+*  frame      Frame to send
+*  element    First word of the Tx buffer element
+*
+*******************************************************************************/
+void canfd_frame_to_element(const canfd_frame_t *frame,
+                            volatile uint32_t *element)
+{
+    uint32_t t0;
+    uint32_t t1;
+    uint32_t dlc = canfd_len_to_dlc(frame->len);
+    uint32_t words = (canfd_dlc_to_len(dlc) + 3UL) / 4UL;
+
+    if (0U != (frame->flags & CANFD_FRAME_FLAG_XTD))
+    {
+        t0 = CANFD_ELEM_XTD_Msk | (frame->id & CANFD_ELEM_XID_Msk);
+    }
+    else
+    {
+        t0 = (frame->id << CANFD_ELEM_SID_Pos) & CANFD_ELEM_SID_Msk;
+    }
+    if (0U != (frame->flags & CANFD_FRAME_FLAG_RTR))
+    {
+        t0 |= CANFD_ELEM_RTR_Msk;
+    }
+
+    t1 = (dlc << CANFD_ELEM_DLC_Pos) & CANFD_ELEM_DLC_Msk;
+    if (0U != (frame->flags & CANFD_FRAME_FLAG_FDF))
+    {
+        t1 |= CANFD_ELEM_FDF_Msk;
+    }
+    if (0U != (frame->flags & CANFD_FRAME_FLAG_BRS))
+    {
+        t1 |= CANFD_ELEM_BRS_Msk;
+    }
+
+    element[0] = t0;
+    element[1] = t1;
+    for (uint32_t idx = 0UL; idx < words; idx++)
+    {
+        element[CANFD_ELEM_HEADER_WORDS + idx] = frame->data[idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_frame_from_element
+********************************************************************************
+* Summary:
+* Reads an Rx buffer or Rx FIFO element from message RAM. Only the payload
+* words covered by the DLC are read, at most 8 bytes of a classic frame.
+*
+* Parameters:
+*  element    First word of the Rx element
+*  frame      Destination
+*
+*******************************************************************************/
+void canfd_frame_from_element(const volatile uint32_t *element,
+                              canfd_frame_t *frame)
+{
+    uint32_t r0 = element[0];
+    uint32_t r1 = element[1];
+    uint32_t words;
+    uint8_t flags = 0U;
+
+    if (0UL != (r0 & CANFD_ELEM_XTD_Msk))
+    {
+        frame->id = r0 & CANFD_ELEM_XID_Msk;
+        flags |= CANFD_FRAME_FLAG_XTD;
+    }
+    else
+    {
+        frame->id = (r0 & CANFD_ELEM_SID_Msk) >> CANFD_ELEM_SID_Pos;
+    }
+    if (0UL != (r0 & CANFD_ELEM_RTR_Msk))
+    {
+        flags |= CANFD_FRAME_FLAG_RTR;
+    }
+    if (0UL != (r0 & CANFD_ELEM_ESI_Msk))
+    {
+        flags |= CANFD_FRAME_FLAG_ESI;
+    }
+    if (0UL != (r1 & CANFD_ELEM_FDF_Msk))
+    {
+        flags |= CANFD_FRAME_FLAG_FDF;
+    }
+    if (0UL != (r1 & CANFD_ELEM_BRS_Msk))
+    {
+        flags |= CANFD_FRAME_FLAG_BRS;
+    }
+
+    frame->flags = flags;
+    frame->filter_index = (uint8_t)((r1 & CANFD_ELEM_FIDX_Msk) >>
+                                    CANFD_ELEM_FIDX_Pos);
+    frame->len = canfd_frame_len((r1 & CANFD_ELEM_DLC_Msk) >>
+                                 CANFD_ELEM_DLC_Pos, flags);
+
+    words = ((uint32_t)frame->len + 3UL) / 4UL;
+    for (uint32_t idx = 0UL; idx < words; idx++)
+    {
+        frame->data[idx] = element[CANFD_ELEM_HEADER_WORDS + idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_frame_from_rx_buffer
+********************************************************************************
+* Summary:
+* Copies a frame delivered by the PDL Rx callback into a canfd_frame_t. A
+* classic frame carries at most 8 bytes, whatever its DLC.
+*
+* Parameters:
+*  rx_buf     Message buffer passed to canfd_rx_callback
+*  frame      Destination
+*
+*******************************************************************************/
+void canfd_frame_from_rx_buffer(const cy_stc_canfd_rx_buffer_t *rx_buf,
+                                canfd_frame_t *frame)
+{
+    uint32_t words;
+    uint8_t flags = 0U;
+
+    frame->id = rx_buf->r0_f->id;
+    if (CY_CANFD_XTD_EXTENDED_ID == rx_buf->r0_f->xtd)
+    {
+        flags |= CANFD_FRAME_FLAG_XTD;
+    }
+    if (CY_CANFD_RTR_REMOTE_FRAME == rx_buf->r0_f->rtr)
+    {
+        flags |= CANFD_FRAME_FLAG_RTR;
+    }
+    if (CY_CANFD_FDF_CAN_FD_FRAME == rx_buf->r1_f->fdf)
+    {
+        flags |= CANFD_FRAME_FLAG_FDF;
+    }
+    if (rx_buf->r1_f->brs)
+    {
+        flags |= CANFD_FRAME_FLAG_BRS;
+    }
+
+    frame->flags = flags;
+    frame->filter_index = (uint8_t)rx_buf->r1_f->fidx;
+    frame->len = canfd_frame_len(rx_buf->r1_f->dlc, flags);
+
+    words = ((uint32_t)frame->len + 3UL) / 4UL;
+    for (uint32_t idx = 0UL; idx < words; idx++)
+    {
+        frame->data[idx] = rx_buf->data_area_f[idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_frame_from_tx_buffer
+********************************************************************************
+* Summary:
+* Copies a Tx buffer of the device configurator into a canfd_frame_t, to send
+* it through the Tx queue.
+*
+* Parameters:
+*  tx_buf     Tx buffer configuration
+*  frame      Destination
+*
+*******************************************************************************/
+void canfd_frame_from_tx_buffer(const cy_stc_canfd_tx_buffer_t *tx_buf,
+                                canfd_frame_t *frame)
+{
+    uint32_t words;
+    uint8_t flags = 0U;
+
+    frame->id = tx_buf->t0_f->id;
+    if (CY_CANFD_XTD_EXTENDED_ID == tx_buf->t0_f->xtd)
+    {
+        flags |= CANFD_FRAME_FLAG_XTD;
+    }
+    if (CY_CANFD_RTR_REMOTE_FRAME == tx_buf->t0_f->rtr)
+    {
+        flags |= CANFD_FRAME_FLAG_RTR;
+    }
+    if (CY_CANFD_FDF_CAN_FD_FRAME == tx_buf->t1_f->fdf)
+    {
+        flags |= CANFD_FRAME_FLAG_FDF;
+    }
+    if (tx_buf->t1_f->brs)
+    {
+        flags |= CANFD_FRAME_FLAG_BRS;
+    }
+
+    frame->flags = flags;
+    frame->filter_index = 0U;
+    frame->len = canfd_frame_len(tx_buf->t1_f->dlc, flags);
+
+    words = ((uint32_t)frame->len + 3UL) / 4UL;
+    for (uint32_t idx = 0UL; idx < words; idx++)
+    {
+        frame->data[idx] = tx_buf->data_area_f[idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_frame_len
+********************************************************************************
+* Summary:
+* Payload length of a frame with this DLC: the DLC table for CAN FD frames,
+* at most CANFD_FRAME_CLASSIC_MAX_LEN bytes for classic frames.
+*
+*******************************************************************************/
+static uint8_t canfd_frame_len(uint32_t dlc, uint8_t flags)
+{
+    uint32_t len = canfd_dlc_to_len(dlc);
+
+    if ((0U == (flags & CANFD_FRAME_FLAG_FDF)) &&
+        (len > CANFD_FRAME_CLASSIC_MAX_LEN))
+    {
+        len = CANFD_FRAME_CLASSIC_MAX_LEN;
+    }
+    return (uint8_t)len;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,138 @@
+/******************************************************************************
+* File Name:   canfd_frame.h
+*
+* Description: Application representation of a CAN FD frame and the helpers
+*              that convert it to and from the M_TTCAN message RAM element
+*              layout.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CANFD_FRAME_H_
+#define CANFD_FRAME_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Largest CAN FD payload in bytes and in 32-bit words */
+#define CANFD_FRAME_MAX_LEN         (64u)
+#define CANFD_FRAME_MAX_WORDS       (CANFD_FRAME_MAX_LEN / 4u)
+
+/* Largest classic CAN payload; DLC 9 to 15 also mean 8 bytes there */
+#define CANFD_FRAME_CLASSIC_MAX_LEN (8u)
+
+/* canfd_frame_t flags */
+#define CANFD_FRAME_FLAG_XTD        (0x01u)     /* 29-bit identifier */
+#define CANFD_FRAME_FLAG_FDF        (0x02u)     /* CAN FD format */
+#define CANFD_FRAME_FLAG_BRS        (0x04u)     /* Bit rate switching */
+#define CANFD_FRAME_FLAG_RTR        (0x08u)     /* Remote frame */
+#define CANFD_FRAME_FLAG_ESI        (0x10u)     /* Transmitter error passive */
+
+/* Header words of a Tx/Rx buffer element in message RAM (T0/T1, R0/R1) */
+#define CANFD_ELEM_ESI_Msk          (0x80000000UL)
+#define CANFD_ELEM_XTD_Msk          (0x40000000UL)
+#define CANFD_ELEM_RTR_Msk          (0x20000000UL)
+#define CANFD_ELEM_XID_Msk          (0x1FFFFFFFUL)
+#define CANFD_ELEM_SID_Pos          (18u)
+#define CANFD_ELEM_SID_Msk          (0x1FFC0000UL)
+#define CANFD_ELEM_ANMF_Msk         (0x80000000UL)
+#define CANFD_ELEM_FIDX_Pos         (24u)
+#define CANFD_ELEM_FIDX_Msk         (0x7F000000UL)
+#define CANFD_ELEM_EFC_Msk          (0x00800000UL)
+#define CANFD_ELEM_FDF_Msk          (0x00200000UL)
+#define CANFD_ELEM_BRS_Msk          (0x00100000UL)
+#define CANFD_ELEM_DLC_Pos          (16u)
+#define CANFD_ELEM_DLC_Msk          (0x000F0000UL)
+#define CANFD_ELEM_RXTS_Msk         (0x0000FFFFUL)
+
+/* Words used by the element header */
+#define CANFD_ELEM_HEADER_WORDS     (2u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* One frame as the application sees it. The payload is word aligned so that it
+ * can be copied to and from message RAM with 32-bit accesses. */
+typedef struct
+{
+    uint32_t id;            /* 11-bit or 29-bit identifier */
+    uint32_t timestamp;     /* Cycle count when received or queued */
+    uint8_t  len;           /* Payload length in bytes (0..64) */
+    uint8_t  flags;         /* CANFD_FRAME_FLAG_xxx */
+    uint8_t  filter_index;  /* Matching filter (Rx only) */
+    uint8_t  reserved;
+    uint32_t data[CANFD_FRAME_MAX_WORDS];
+} canfd_frame_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t canfd_dlc_to_len(uint32_t dlc);
+uint32_t canfd_len_to_dlc(uint32_t len);
+void canfd_frame_to_element(const canfd_frame_t *frame,
+                            volatile uint32_t *element);
+void canfd_frame_from_element(const volatile uint32_t *element,
+                              canfd_frame_t *frame);
+void canfd_frame_from_rx_buffer(const cy_stc_canfd_rx_buffer_t *rx_buf,
+                                canfd_frame_t *frame);
+void canfd_frame_from_tx_buffer(const cy_stc_canfd_tx_buffer_t *tx_buf,
+                                canfd_frame_t *frame);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_frame_bytes
+********************************************************************************
+* Summary:
+* Returns a byte view of the frame payload.
+*
+*******************************************************************************/
+__STATIC_INLINE uint8_t *canfd_frame_bytes(canfd_frame_t *frame)
+{
+    return (uint8_t *)frame->data;
+}
+
+#endif /* CANFD_FRAME_H_ */
+
+/* [] END OF FILE */
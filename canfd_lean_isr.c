@@ -0,0 +1,131 @@
+/******************************************************************************
+* File Name:   canfd_lean_isr.c
+*
+* Description: Specialized CAN FD interrupt handler. Cy_CANFD_IrqHandler tests
+*              every interrupt source, reads each Rx element through the
+*              cy_stc_canfd_rx_buffer_t structures and calls the Rx callback
+*              per frame. This handler reads and clears the enabled flags once,
+*              copies Rx FIFO 0 into the Rx queue with direct message RAM word
+*              reads, and refills the Tx FIFO inline on transmission complete.
+*              Any other source falls back to the PDL handler.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_lean_isr.h"
+#include "canfd_txq.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type *lean_base;
+static uint32_t lean_chan;
+static cy_stc_canfd_context_t *lean_context;
+
+/* Enabled interrupt sources, read once at init instead of in every interrupt */
+static uint32_t lean_enabled;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_lean_isr_init
+********************************************************************************
+* Summary:
+* Prepares the Rx queue and enables the sources handled by canfd_lean_isr.
+* Must be called after Cy_CANFD_Init and canfd_txq_init; afterwards the CAN FD
+* interrupt has to call canfd_lean_isr instead of Cy_CANFD_IrqHandler.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  context    Channel context
+*
+*******************************************************************************/
+void canfd_lean_isr_init(CANFD_Type *base, uint32_t chan,
+                         cy_stc_canfd_context_t *context)
+{
+    lean_base = base;
+    lean_chan = chan;
+    lean_context = context;
+    canfd_rxq_init(base, chan, context);
+
+    lean_enabled = Cy_CANFD_GetInterruptMask(base, chan) | CANFD_LEAN_ISR_MASK;
+    Cy_CANFD_SetInterruptMask(base, chan, lean_enabled);
+}
+
+/*******************************************************************************
+* Function Name: canfd_lean_isr
+********************************************************************************
+* Summary:
+* CAN FD interrupt handler. The flags are cleared before the FIFO is read so
+* that a frame arriving meanwhile raises the interrupt again.
+*
+* Return:
+*  uint32_t  number of frames moved into the Rx queue
+*
+*******************************************************************************/
+uint32_t canfd_lean_isr(void)
+{
+    uint32_t pending = CANFD_IR(lean_base, lean_chan) & lean_enabled;
+    uint32_t frames = 0UL;
+
+    /* Write one to clear */
+    CANFD_IR(lean_base, lean_chan) = pending & CANFD_LEAN_ISR_MASK;
+
+    if (0UL != (pending & CANFD_RXQ_IRQ_MASK))
+    {
+        frames = canfd_rxq_read_fifo(pending & CANFD_RXQ_IRQ_MASK);
+    }
+
+    if (0UL != (pending & CANFD_CH_M_TTCAN_IR_TC_Msk))
+    {
+        canfd_txq_on_tx_complete();
+    }
+
+    if (0UL != (pending & ~CANFD_LEAN_ISR_MASK))
+    {
+        Cy_CANFD_IrqHandler(lean_base, lean_chan, lean_context);
+    }
+
+    return frames;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,67 @@
+/******************************************************************************
+* File Name:   canfd_lean_isr.h
+*
+* Description: Specialized CAN FD interrupt handler for the configured feature
+*              set.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_LEAN_ISR_H_
+#define CANFD_LEAN_ISR_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+#include "canfd_rxq.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Interrupt sources handled without the PDL: Rx FIFO 0 and Tx complete */
+#define CANFD_LEAN_ISR_MASK     (CANFD_RXQ_IRQ_MASK | CANFD_CH_M_TTCAN_IR_TC_Msk)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void canfd_lean_isr_init(CANFD_Type *base, uint32_t chan,
+                         cy_stc_canfd_context_t *context);
+uint32_t canfd_lean_isr(void);
+
+#endif /* CANFD_LEAN_ISR_H_ */
+
+/* [] END OF FILE */
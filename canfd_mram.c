@@ -0,0 +1,482 @@
+/******************************************************************************
+* File Name:   canfd_mram.c
+*
+* Description: Message RAM error handling: bit error and access failure
+*              interrupts, recovery from shadow copies without re-initializing
+*              the channel, and background scrubbing of the filter list.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_mram.h"
+#include "canfd_errlog.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static volatile uint32_t *canfd_mram_word(uint32_t idx);
+static void canfd_mram_handle(uint32_t flags);
+static void canfd_mram_recover(void);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+bool canfd_mram_checking;
+
+static CANFD_Type *mram_base;
+static uint32_t mram_chan;
+static cy_stc_canfd_context_t *mram_context;
+
+/* Filter lists in the message RAM and their shadow: the standard filter
+ * words first, then the extended filter words */
+static volatile uint32_t *mram_sid;
+static volatile uint32_t *mram_xid;
+static uint32_t mram_sid_words;
+static uint32_t mram_words;
+static uint32_t mram_shadow[CANFD_MRAM_SHADOW_WORDS];
+
+/* Dedicated Tx buffers restored from the application copy */
+static const cy_stc_canfd_tx_buffer_t *mram_tx_buffers[CANFD_MRAM_TX_BUFFERS];
+static uint8_t mram_tx_index[CANFD_MRAM_TX_BUFFERS];
+static uint32_t mram_tx_count;
+static uint32_t mram_tx_mask;
+
+/* Tx buffer bits of the Tx FIFO elements */
+static uint32_t mram_fifo_mask;
+
+static uint32_t mram_scrub_pos;
+static volatile bool mram_scrub_all;
+
+static canfd_mram_stats_t mram_stats;
+
+STATS_COUNTER(corrected, "mram.corrected", &mram_stats.corrected);
+STATS_COUNTER(uncorrected, "mram.uncorrected", &mram_stats.uncorrected);
+STATS_COUNTER(access_failures, "mram.access_failures",
+              &mram_stats.access_failures);
+STATS_COUNTER(recoveries, "mram.recoveries", &mram_stats.recoveries);
+STATS_COUNTER(rx_dropped, "mram.rx_dropped", &mram_stats.rx_dropped);
+STATS_COUNTER(scrub_repairs, "mram.scrub_repairs", &mram_stats.scrub_repairs);
+STATS_GAUGE(max_recovery, "mram.max_recovery_cycles",
+            &mram_stats.max_recovery_cycles);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_mram_init
+********************************************************************************
+* Summary:
+* Takes the shadow copy of the filter lists and enables the message RAM error
+* interrupts. Call after Cy_CANFD_Init and canfd_txq_init; afterwards the
+* CAN FD interrupt has to call canfd_mram_isr before the other handlers.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  context    Channel context
+*
+* Return:
+*  cy_rslt_t  CANFD_MRAM_RSLT_SHADOW if the filter lists do not fit into
+*             CANFD_MRAM_SHADOW_WORDS
+*
+*******************************************************************************/
+cy_rslt_t canfd_mram_init(CANFD_Type *base, uint32_t chan,
+                          cy_stc_canfd_context_t *context)
+{
+    uint32_t sidfc = CANFD_SIDFC(base, chan);
+    uint32_t xidfc = CANFD_XIDFC(base, chan);
+    uint32_t txbc = CANFD_TXBC(base, chan);
+    uint32_t sid_words = _FLD2VAL(CANFD_CH_M_TTCAN_SIDFC_LSS, sidfc);
+    uint32_t xid_words = 2UL * _FLD2VAL(CANFD_CH_M_TTCAN_XIDFC_LSE, xidfc);
+    uint32_t dedicated = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_NDTB, txbc);
+    uint32_t fifo = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TFQS, txbc);
+    volatile uint32_t *ram;
+
+    if ((sid_words + xid_words) > CANFD_MRAM_SHADOW_WORDS)
+    {
+        return CANFD_MRAM_RSLT_SHADOW;
+    }
+
+    mram_base = base;
+    mram_chan = chan;
+    mram_context = context;
+    cycle_count_init();
+
+    /* Word address 0 of the message RAM, found from Tx buffer 0 */
+    ram = (volatile uint32_t *)Cy_CANFD_CalcTxBufAdrs(base, chan, 0UL,
+                                                      context) -
+          _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TBSA, txbc);
+    mram_sid = ram + _FLD2VAL(CANFD_CH_M_TTCAN_SIDFC_FLSSA, sidfc);
+    mram_xid = ram + _FLD2VAL(CANFD_CH_M_TTCAN_XIDFC_FLESA, xidfc);
+    mram_sid_words = sid_words;
+    mram_words = sid_words + xid_words;
+    canfd_mram_update_filters();
+
+    mram_fifo_mask = ((1UL << fifo) - 1UL) << dedicated;
+
+    CANFD_IR(base, chan) = CANFD_MRAM_IRQ_MASK;
+    Cy_CANFD_SetInterruptMask(base, chan,
+                              Cy_CANFD_GetInterruptMask(base, chan) |
+                              CANFD_MRAM_IRQ_MASK);
+    canfd_mram_checking = true;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_attach_tx_buffer
+********************************************************************************
+* Summary:
+* Registers the application copy of a dedicated Tx buffer, for example the
+* one passed to Cy_CANFD_UpdateAndTransmitMsgBuffer. After an uncorrected
+* error the element is rewritten from it and a pending request is repeated.
+*
+* Return:
+*  bool  false if CANFD_MRAM_TX_BUFFERS buffers are registered already
+*
+*******************************************************************************/
+bool canfd_mram_attach_tx_buffer(uint8_t index,
+                                 const cy_stc_canfd_tx_buffer_t *buffer)
+{
+    if (mram_tx_count >= CANFD_MRAM_TX_BUFFERS)
+    {
+        return false;
+    }
+
+    mram_tx_buffers[mram_tx_count] = buffer;
+    mram_tx_index[mram_tx_count] = index;
+    mram_tx_mask |= 1UL << index;
+    mram_tx_count++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_update_filters
+********************************************************************************
+* Summary:
+* Copies the filter lists from the message RAM into the shadow. Call after
+* changing filter elements, before the next canfd_mram_process.
+*
+*******************************************************************************/
+void canfd_mram_update_filters(void)
+{
+    for (uint32_t idx = 0UL; idx < mram_words; idx++)
+    {
+        mram_shadow[idx] = *canfd_mram_word(idx);
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_isr
+********************************************************************************
+* Summary:
+* Handles the message RAM error flags from the CAN FD interrupt and clears
+* them, so the PDL handler does not see them. A corrected error starts a
+* complete scrub pass in the main loop. An uncorrected error rewrites the
+* filter lists from the shadow; if the controller stopped on it (CCCR.INIT),
+* pending Tx FIFO requests are cancelled because their elements have no copy,
+* the registered Tx buffers are rewritten, and the channel is restarted. An
+* access failure of the Tx handler ends the restricted operation mode.
+*
+* Return:
+*  uint32_t  message RAM flags handled
+*
+*******************************************************************************/
+uint32_t canfd_mram_isr(void)
+{
+    uint32_t flags;
+
+    if (!canfd_mram_checking)
+    {
+        return 0UL;
+    }
+
+    flags = CANFD_IR(mram_base, mram_chan) & CANFD_MRAM_IRQ_MASK;
+    if (0UL != flags)
+    {
+        CANFD_IR(mram_base, mram_chan) = flags;
+        canfd_mram_handle(flags);
+    }
+    return flags;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_drop_rx
+********************************************************************************
+* Summary:
+* Slow path of canfd_mram_rx_error: counts the dropped element and handles
+* the uncorrected error.
+*
+* Return:
+*  bool  true
+*
+*******************************************************************************/
+bool canfd_mram_drop_rx(void)
+{
+    CANFD_IR(mram_base, mram_chan) = CANFD_CH_M_TTCAN_IR_BEU_Msk;
+    mram_stats.rx_dropped++;
+    canfd_mram_handle(CANFD_CH_M_TTCAN_IR_BEU_Msk);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_process
+********************************************************************************
+* Summary:
+* Compares the next CANFD_MRAM_SCRUB_WORDS filter words with the shadow and
+* rewrites the ones that differ, from the main loop. This also finds changes
+* on message RAM without ECC. After a corrected error, a complete pass runs
+* at once.
+*
+*******************************************************************************/
+void canfd_mram_process(void)
+{
+    uint32_t count = CANFD_MRAM_SCRUB_WORDS;
+    volatile uint32_t *word;
+
+    if ((!canfd_mram_checking) || (0UL == mram_words))
+    {
+        return;
+    }
+
+    if (mram_scrub_all)
+    {
+        mram_scrub_all = false;
+        count = mram_words;
+    }
+
+    while (0UL != count)
+    {
+        word = canfd_mram_word(mram_scrub_pos);
+        if (*word != mram_shadow[mram_scrub_pos])
+        {
+            *word = mram_shadow[mram_scrub_pos];
+            mram_stats.scrub_repairs++;
+        }
+
+        mram_scrub_pos++;
+        if (mram_scrub_pos >= mram_words)
+        {
+            mram_scrub_pos = 0UL;
+            mram_stats.scrub_passes++;
+        }
+        count--;
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_inject
+********************************************************************************
+* Summary:
+* Test aid: flips the lowest bit of a filter word in the message RAM, not in
+* the shadow, as a bit error would. The scrub repairs it.
+*
+* Parameters:
+*  word   Index in the filter lists, standard filters first
+*
+* Return:
+*  bool  false if the lists have fewer words
+*
+*******************************************************************************/
+bool canfd_mram_inject(uint32_t word)
+{
+    if (word >= mram_words)
+    {
+        return false;
+    }
+
+    *canfd_mram_word(word) ^= 1UL;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_print_stats
+*******************************************************************************/
+void canfd_mram_print_stats(void)
+{
+    printf("Message RAM: %lu corrected, %lu uncorrected, %lu access failures, "
+           "%lu recoveries (%lu us max), %lu Rx dropped, %lu Tx cancelled, "
+           "%lu scrub repairs in %lu passes over %lu words\r\n",
+           (unsigned long)mram_stats.corrected,
+           (unsigned long)mram_stats.uncorrected,
+           (unsigned long)mram_stats.access_failures,
+           (unsigned long)mram_stats.recoveries,
+           (unsigned long)cycle_count_to_us(mram_stats.max_recovery_cycles),
+           (unsigned long)mram_stats.rx_dropped,
+           (unsigned long)mram_stats.tx_cancelled,
+           (unsigned long)mram_stats.scrub_repairs,
+           (unsigned long)mram_stats.scrub_passes,
+           (unsigned long)mram_words);
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_get_stats
+*******************************************************************************/
+const canfd_mram_stats_t *canfd_mram_get_stats(void)
+{
+    return &mram_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_word
+********************************************************************************
+* Summary:
+* Address of a filter word in the message RAM, standard filters first.
+*
+*******************************************************************************/
+static volatile uint32_t *canfd_mram_word(uint32_t idx)
+{
+    return (idx < mram_sid_words) ? &mram_sid[idx] :
+                                    &mram_xid[idx - mram_sid_words];
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_handle
+********************************************************************************
+* Summary:
+* Counts the error flags and runs the recovery they need.
+*
+*******************************************************************************/
+static void canfd_mram_handle(uint32_t flags)
+{
+    uint32_t cccr;
+
+    if (0UL != (flags & CANFD_CH_M_TTCAN_IR_BEC_Msk))
+    {
+        mram_stats.corrected++;
+        mram_scrub_all = true;
+    }
+
+    if (0UL != (flags & CANFD_CH_M_TTCAN_IR_MRAF_Msk))
+    {
+        mram_stats.access_failures++;
+
+        /* A Tx handler access failure switches to restricted operation */
+        cccr = CANFD_CCCR(mram_base, mram_chan);
+        if (0UL != (cccr & CANFD_CH_M_TTCAN_CCCR_ASM_Msk))
+        {
+            CANFD_CCCR(mram_base, mram_chan) =
+                cccr & ~CANFD_CH_M_TTCAN_CCCR_ASM_Msk;
+            mram_stats.restarts++;
+        }
+    }
+
+    if (0UL != (flags & CANFD_CH_M_TTCAN_IR_BEU_Msk))
+    {
+        mram_stats.uncorrected++;
+        canfd_mram_recover();
+    }
+
+    TRACE(TRACE_MRAM_ERROR, (flags >> CANFD_CH_M_TTCAN_IR_MRAF_Pos) & 0xFFUL,
+          mram_stats.recoveries);
+}
+
+/*******************************************************************************
+* Function Name: canfd_mram_recover
+********************************************************************************
+* Summary:
+* Recovery from an uncorrected error at an unknown address. The filter words
+* are rewritten without reading them, since a read of the damaged word would
+* flag it again; a write stores a new check code. Rx elements are rewritten
+* by the next received frames. The Tx elements are only touched while the
+* controller is stopped, so that no element is changed during its
+* transmission.
+*
+*******************************************************************************/
+static void canfd_mram_recover(void)
+{
+    uint32_t start = cycle_count_now();
+    uint32_t pending;
+    uint32_t cancel;
+    uint32_t cycles;
+
+    for (uint32_t idx = 0UL; idx < mram_words; idx++)
+    {
+        *canfd_mram_word(idx) = mram_shadow[idx];
+    }
+
+    if ((0UL != (CANFD_CCCR(mram_base, mram_chan) &
+                 CANFD_CH_M_TTCAN_CCCR_INIT_Msk)) &&
+        (0UL == (canfd_errlog_read_psr(mram_base, mram_chan) &
+                 CANFD_CH_M_TTCAN_PSR_BO_Msk)))
+    {
+        pending = CANFD_TXBRP(mram_base, mram_chan);
+        cancel = pending & (mram_fifo_mask | mram_tx_mask);
+        if (0UL != cancel)
+        {
+            CANFD_TXBCR(mram_base, mram_chan) = cancel;
+        }
+        cancel &= mram_fifo_mask;
+        while (0UL != cancel)
+        {
+            cancel &= cancel - 1UL;
+            mram_stats.tx_cancelled++;
+        }
+
+        for (uint32_t idx = 0UL; idx < mram_tx_count; idx++)
+        {
+            (void)Cy_CANFD_TxBufferConfig(mram_base, mram_chan,
+                                          mram_tx_buffers[idx],
+                                          mram_tx_index[idx], mram_context);
+        }
+
+        /* Back on the bus after 11 recessive bits */
+        if (CY_CANFD_SUCCESS == Cy_CANFD_ConfigChangesDisable(mram_base,
+                                                               mram_chan))
+        {
+            mram_stats.restarts++;
+            if (0UL != (pending & mram_tx_mask))
+            {
+                CANFD_TXBAR(mram_base, mram_chan) = pending & mram_tx_mask;
+            }
+        }
+    }
+
+    mram_stats.recoveries++;
+    cycles = cycle_count_now() - start;
+    if (cycles > mram_stats.max_recovery_cycles)
+    {
+        mram_stats.max_recovery_cycles = cycles;
+    }
+}
+
+/* [] END OF FILE */
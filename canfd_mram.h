@@ -0,0 +1,145 @@
+/******************************************************************************
+* File Name:   canfd_mram.h
+*
+* Description: Message RAM error handling: bit error and access failure
+*              interrupts, recovery from shadow copies without re-initializing
+*              the channel, and background scrubbing of the filter list.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+
+#ifndef CANFD_MRAM_H_
+#define CANFD_MRAM_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Filter list words (standard filters take one, extended filters two) kept
+ * in the shadow copy */
+#ifndef CANFD_MRAM_SHADOW_WORDS
+#define CANFD_MRAM_SHADOW_WORDS     (256u)
+#endif
+
+/* Dedicated Tx buffers that can be restored from the application copy */
+#ifndef CANFD_MRAM_TX_BUFFERS
+#define CANFD_MRAM_TX_BUFFERS       (2u)
+#endif
+
+/* Filter words compared with the shadow per canfd_mram_process call */
+#ifndef CANFD_MRAM_SCRUB_WORDS
+#define CANFD_MRAM_SCRUB_WORDS      (16u)
+#endif
+
+/* Message RAM bit error (corrected, uncorrected) and access failure */
+#define CANFD_MRAM_IRQ_MASK         (CANFD_CH_M_TTCAN_IR_BEC_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_BEU_Msk | \
+                                     CANFD_CH_M_TTCAN_IR_MRAF_Msk)
+
+/* Trace event of a message RAM error: IR bits 17..24, recoveries */
+#define TRACE_MRAM_ERROR            (11u)
+
+#define CANFD_MRAM_RSLT_SHADOW              \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 8u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t corrected;         /* BEC: bit errors corrected by the ECC */
+    uint32_t uncorrected;       /* BEU: bit errors the ECC could not correct */
+    uint32_t access_failures;   /* MRAF: message RAM not accessed in time */
+    uint32_t recoveries;        /* Filters and Tx buffers rewritten */
+    uint32_t restarts;          /* Channel left INIT or restricted mode */
+    uint32_t rx_dropped;        /* Rx elements read with an uncorrected error */
+    uint32_t tx_cancelled;      /* Tx FIFO requests cancelled on recovery */
+    uint32_t scrub_repairs;     /* Filter words found changed by the scrub */
+    uint32_t scrub_passes;      /* Complete passes over the filter list */
+    uint32_t max_recovery_cycles;
+} canfd_mram_stats_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Set by canfd_mram_init */
+extern bool canfd_mram_checking;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t canfd_mram_init(CANFD_Type *base, uint32_t chan,
+                          cy_stc_canfd_context_t *context);
+bool canfd_mram_attach_tx_buffer(uint8_t index,
+                                 const cy_stc_canfd_tx_buffer_t *buffer);
+void canfd_mram_update_filters(void);
+uint32_t canfd_mram_isr(void);
+bool canfd_mram_drop_rx(void);
+void canfd_mram_process(void);
+bool canfd_mram_inject(uint32_t word);
+void canfd_mram_print_stats(void);
+const canfd_mram_stats_t *canfd_mram_get_stats(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_mram_rx_error
+********************************************************************************
+* Summary:
+* Called by an Rx FIFO reader after copying an element: true if the copy
+* raised an uncorrected bit error, so that the frame is dropped. The error
+* is then handled as by canfd_mram_isr.
+*
+*******************************************************************************/
+__STATIC_INLINE bool canfd_mram_rx_error(CANFD_Type *base, uint32_t chan)
+{
+    return canfd_mram_checking &&
+           (0UL != (CANFD_IR(base, chan) & CANFD_CH_M_TTCAN_IR_BEU_Msk)) &&
+           canfd_mram_drop_rx();
+}
+
+#endif /* CANFD_MRAM_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,424 @@
+/******************************************************************************
+* File Name:   canfd_pack.c
+*
+* Description: Packing of small messages into shared CAN FD frames. Messages of
+*              1 to 16 bytes for the same destination are appended to one
+*              frame, each behind a 2-byte sub-header, and the frame is sent
+*              with the smallest DLC that carries them. How long a message may
+*              wait for others depends on the bus load: on a quiet bus the
+*              frame leaves on the next service call, on a busy bus the
+*              messages wait up to their latency budget, trading latency for
+*              bus time only when bus time is scarce. canfd_pack_unpack
+*              delivers the messages of a received frame one by one.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "canfd_pack.h"
+#include "canfd_bitrate.h"
+#include "canfd_txq.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define PACK_SIGNAL_Msk         (0x0FFFUL)
+#define PACK_LEN_Pos            (12UL)
+#define PACK_HEADER_PAD         (0xFFFFUL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    canfd_frame_t frame;        /* Identifier, flags and packed payload */
+    uint32_t used;              /* Payload bytes used */
+    uint32_t count;             /* Messages in the frame */
+    uint32_t first_ms;          /* Arrival of the first message */
+    uint32_t due_ms;            /* End of the shortest wait in the frame */
+    uint32_t single_ns;         /* Bus time of the messages as own frames */
+    const uint32_t *frame_ns;   /* Frame time per DLC, set when opened */
+} pack_dest_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static pack_dest_t pack_dests[CANFD_PACK_DESTS];
+static canfd_pack_stats_t pack_stats;
+
+/* Frame time per DLC code, standard and extended identifier, at the active
+ * bit rate profile */
+static uint32_t pack_frame_ns[2][16];
+
+STATS_COUNTER(messages, "pack.messages", &pack_stats.messages);
+STATS_COUNTER(rejected, "pack.rejected", &pack_stats.rejected);
+STATS_COUNTER(frames, "pack.frames", &pack_stats.frames);
+STATS_COUNTER(packed_us, "pack.packed_us", &pack_stats.packed_us);
+STATS_COUNTER(single_us, "pack.single_us", &pack_stats.single_us);
+STATS_GAUGE(max_wait, "pack.max_wait_ms", &pack_stats.max_wait_ms);
+STATS_COUNTER(rx_messages, "pack.rx_messages", &pack_stats.rx_messages);
+STATS_COUNTER(rx_malformed, "pack.rx_malformed", &pack_stats.rx_malformed);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t pack_hold_ms(uint32_t budget_ms);
+static bool pack_flush(pack_dest_t *dest, uint32_t now_ms);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_pack_init
+********************************************************************************
+* Summary:
+* Closes all destinations and computes the frame times used for the bus time
+* counters.
+*
+*******************************************************************************/
+void canfd_pack_init(void)
+{
+    const canfd_bitrate_profile_t *profile = canfd_bitrate_get_active();
+
+    memset(pack_dests, 0, sizeof(pack_dests));
+    for (uint32_t dlc = 0UL; dlc < 16UL; dlc++)
+    {
+        pack_frame_ns[0][dlc] = canfd_bitrate_frame_time_ns(
+                                    profile, canfd_dlc_to_len(dlc), false, true);
+        pack_frame_ns[1][dlc] = canfd_bitrate_frame_time_ns(
+                                    profile, canfd_dlc_to_len(dlc), true, true);
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_open
+********************************************************************************
+* Summary:
+* Assigns the identifier of the packed frames of a destination. The frames
+* are sent in FD format with bit rate switching.
+*
+* Parameters:
+*  dest       Destination, below CANFD_PACK_DESTS
+*  id         Identifier of the packed frames
+*  extended   true for a 29-bit identifier
+*
+* Return:
+*  bool  false if dest is out of range or has messages waiting
+*
+*******************************************************************************/
+bool canfd_pack_open(uint32_t dest, uint32_t id, bool extended)
+{
+    pack_dest_t *entry;
+
+    if ((dest >= CANFD_PACK_DESTS) || (0UL != pack_dests[dest].count))
+    {
+        return false;
+    }
+
+    entry = &pack_dests[dest];
+    entry->frame.id = id;
+    entry->frame.flags = CANFD_FRAME_FLAG_FDF | CANFD_FRAME_FLAG_BRS |
+                         (extended ? CANFD_FRAME_FLAG_XTD : 0U);
+    entry->frame_ns = pack_frame_ns[extended ? 1 : 0];
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_send
+********************************************************************************
+* Summary:
+* Appends a message to the frame of a destination. A frame that has no room
+* for the message is sent first. The message waits for others at most
+* budget_ms, less the quieter the bus was at the last canfd_pack_service
+* call; the frame leaves on the first service call after the shortest wait
+* of its messages. Thread context only.
+*
+* Parameters:
+*  dest       Destination opened with canfd_pack_open
+*  signal     Message identifier, up to CANFD_PACK_MAX_SIGNAL
+*  data       Message bytes
+*  len        1 to CANFD_PACK_MAX_MSG_LEN
+*  budget_ms  Longest wait before the frame is sent
+*
+* Return:
+*  cy_rslt_t  CANFD_PACK_RSLT_BAD_PARAM if dest is not open or len or signal
+*             is out of range, CANFD_PACK_RSLT_FULL if the frame had no room
+*             and the Tx queue did not take it
+*
+*******************************************************************************/
+cy_rslt_t canfd_pack_send(uint32_t dest, uint32_t signal, const void *data,
+                          uint32_t len, uint32_t budget_ms)
+{
+    pack_dest_t *entry;
+    uint8_t *bytes;
+    uint32_t now;
+    uint32_t due;
+    uint32_t header;
+
+    if ((dest >= CANFD_PACK_DESTS) || (NULL == pack_dests[dest].frame_ns) ||
+        (0UL == len) || (len > CANFD_PACK_MAX_MSG_LEN) ||
+        (signal > CANFD_PACK_MAX_SIGNAL))
+    {
+        return CANFD_PACK_RSLT_BAD_PARAM;
+    }
+
+    entry = &pack_dests[dest];
+    bytes = (uint8_t *)entry->frame.data;
+    now = sys_tick_ms();
+
+    if ((entry->used + CANFD_PACK_HEADER_LEN + len) > CANFD_FRAME_MAX_LEN)
+    {
+        if (!pack_flush(entry, now))
+        {
+            pack_stats.rejected++;
+            return CANFD_PACK_RSLT_FULL;
+        }
+        pack_stats.flush_full++;
+    }
+
+    header = signal | ((len - 1UL) << PACK_LEN_Pos);
+    bytes[entry->used] = (uint8_t)header;
+    bytes[entry->used + 1UL] = (uint8_t)(header >> 8);
+    memcpy(&bytes[entry->used + CANFD_PACK_HEADER_LEN], data, len);
+    entry->used += CANFD_PACK_HEADER_LEN + len;
+
+    due = now + pack_hold_ms(budget_ms);
+    if ((0UL == entry->count) || ((int32_t)(due - entry->due_ms) < 0))
+    {
+        entry->due_ms = due;
+    }
+    if (0UL == entry->count)
+    {
+        entry->first_ms = now;
+    }
+    entry->count++;
+    entry->single_ns += entry->frame_ns[canfd_len_to_dlc(len)];
+    pack_stats.messages++;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_service
+********************************************************************************
+* Summary:
+* Records the bus load for the waits of the next messages and sends the
+* frames whose wait has ended, or that the Tx queue refused before. Call it
+* from the main loop, after the producers. Thread context only.
+*
+* Parameters:
+*  load_permille  Current bus load, for example from led_activity.c
+*
+* Return:
+*  uint32_t  number of frames queued
+*
+*******************************************************************************/
+uint32_t canfd_pack_service(uint32_t load_permille)
+{
+    uint32_t now = sys_tick_ms();
+    uint32_t sent = 0UL;
+
+    pack_stats.load_permille = load_permille;
+    for (uint32_t idx = 0UL; idx < CANFD_PACK_DESTS; idx++)
+    {
+        pack_dest_t *entry = &pack_dests[idx];
+
+        if ((0UL != entry->count) &&
+            ((int32_t)(now - entry->due_ms) >= 0) &&
+            pack_flush(entry, now))
+        {
+            pack_stats.flush_due++;
+            sent++;
+        }
+    }
+    return sent;
+}
+
+/*******************************************************************************
+* Function Name: pack_hold_ms
+********************************************************************************
+* Summary:
+* Returns how long a message with the given budget may wait for others: none
+* up to CANFD_PACK_LOAD_LOW_PERMILLE, the full budget from
+* CANFD_PACK_LOAD_HIGH_PERMILLE, linear in between.
+*
+*******************************************************************************/
+static uint32_t pack_hold_ms(uint32_t budget_ms)
+{
+    uint32_t load = pack_stats.load_permille;
+
+    if (load <= CANFD_PACK_LOAD_LOW_PERMILLE)
+    {
+        return 0UL;
+    }
+    if (load >= CANFD_PACK_LOAD_HIGH_PERMILLE)
+    {
+        return budget_ms;
+    }
+    return (budget_ms * (load - CANFD_PACK_LOAD_LOW_PERMILLE)) /
+           (CANFD_PACK_LOAD_HIGH_PERMILLE - CANFD_PACK_LOAD_LOW_PERMILLE);
+}
+
+/*******************************************************************************
+* Function Name: pack_flush
+********************************************************************************
+* Summary:
+* Pads the frame of a destination up to its DLC length and copies it into
+* the Tx queue.
+*
+* Return:
+*  bool  false if the Tx queue is full; the frame is kept
+*
+*******************************************************************************/
+static bool pack_flush(pack_dest_t *dest, uint32_t now_ms)
+{
+    uint8_t *bytes = (uint8_t *)dest->frame.data;
+    uint32_t dlc = canfd_len_to_dlc(dest->used);
+    uint32_t len = canfd_dlc_to_len(dlc);
+    uint32_t wait = now_ms - dest->first_ms;
+
+    memset(&bytes[dest->used], CANFD_PACK_PAD, len - dest->used);
+    dest->frame.len = (uint8_t)len;
+    if (!canfd_txq_push(&dest->frame))
+    {
+        return false;
+    }
+
+    pack_stats.frames++;
+    pack_stats.packed_us += dest->frame_ns[dlc] / 1000UL;
+    pack_stats.single_us += dest->single_ns / 1000UL;
+    if (wait > pack_stats.max_wait_ms)
+    {
+        pack_stats.max_wait_ms = wait;
+    }
+
+    dest->used = 0UL;
+    dest->count = 0UL;
+    dest->single_ns = 0UL;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_unpack
+********************************************************************************
+* Summary:
+* Passes the messages of a packed frame to handler in their order in the
+* payload, up to the padding. A sub-header whose message runs beyond the
+* payload ends the frame and is counted as malformed. Any context.
+*
+* Parameters:
+*  frame      Received packed frame
+*  handler    Called once per message; the data is valid during the call
+*
+* Return:
+*  uint32_t  number of messages delivered
+*
+*******************************************************************************/
+uint32_t canfd_pack_unpack(const canfd_frame_t *frame,
+                           canfd_pack_handler_t handler)
+{
+    const uint8_t *bytes = (const uint8_t *)frame->data;
+    uint32_t pos = 0UL;
+    uint32_t count = 0UL;
+    uint32_t header;
+    uint32_t len;
+
+    while ((pos + CANFD_PACK_HEADER_LEN) <= frame->len)
+    {
+        header = (uint32_t)bytes[pos] | ((uint32_t)bytes[pos + 1UL] << 8);
+        if (PACK_HEADER_PAD == header)
+        {
+            break;
+        }
+        len = (header >> PACK_LEN_Pos) + 1UL;
+        pos += CANFD_PACK_HEADER_LEN;
+        if ((pos + len) > frame->len)
+        {
+            pack_stats.rx_malformed++;
+            break;
+        }
+        handler(header & PACK_SIGNAL_Msk, &bytes[pos], len, frame);
+        pos += len;
+        count++;
+    }
+
+    pack_stats.rx_frames++;
+    pack_stats.rx_messages += count;
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_print_stats
+*******************************************************************************/
+void canfd_pack_print_stats(void)
+{
+    uint32_t saved = (pack_stats.single_us > pack_stats.packed_us) ?
+                     (pack_stats.single_us - pack_stats.packed_us) : 0UL;
+
+    printf("Packing: %lu messages in %lu frames (%lu when full, %lu due), "
+           "%lu rejected, %lu ms max wait, load %lu permille\r\n",
+           (unsigned long)pack_stats.messages,
+           (unsigned long)pack_stats.frames,
+           (unsigned long)pack_stats.flush_full,
+           (unsigned long)pack_stats.flush_due,
+           (unsigned long)pack_stats.rejected,
+           (unsigned long)pack_stats.max_wait_ms,
+           (unsigned long)pack_stats.load_permille);
+    printf("Packing: bus time %lu us instead of %lu us (%lu %% saved); "
+           "received %lu frames, %lu messages, %lu malformed\r\n",
+           (unsigned long)pack_stats.packed_us,
+           (unsigned long)pack_stats.single_us,
+           (unsigned long)((0UL != pack_stats.single_us) ?
+                           ((100ULL * saved) / pack_stats.single_us) : 0UL),
+           (unsigned long)pack_stats.rx_frames,
+           (unsigned long)pack_stats.rx_messages,
+           (unsigned long)pack_stats.rx_malformed);
+}
+
+/*******************************************************************************
+* Function Name: canfd_pack_get_stats
+*******************************************************************************/
+const canfd_pack_stats_t *canfd_pack_get_stats(void)
+{
+    return &pack_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name:   canfd_pack.h
+*
+* Description: Packing of small messages into shared CAN FD frames.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_PACK_H_
+#define CANFD_PACK_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Destinations, each with its own identifier and frame under construction */
+#ifndef CANFD_PACK_DESTS
+#define CANFD_PACK_DESTS                (4u)
+#endif
+
+/* Bus load up to which messages are sent on the next service call, and from
+ * which they wait for their full latency budget; in between the wait grows
+ * linearly with the load */
+#ifndef CANFD_PACK_LOAD_LOW_PERMILLE
+#define CANFD_PACK_LOAD_LOW_PERMILLE    (300u)
+#endif
+
+#ifndef CANFD_PACK_LOAD_HIGH_PERMILLE
+#define CANFD_PACK_LOAD_HIGH_PERMILLE   (700u)
+#endif
+
+/* Message layout in the payload: a 16-bit little-endian sub-header with the
+ * signal in bits 0..11 and the length minus one in bits 12..15, followed by
+ * the message bytes. 0xFFFF pads the payload up to the DLC length. */
+#define CANFD_PACK_HEADER_LEN           (2u)
+#define CANFD_PACK_MAX_MSG_LEN          (16u)
+#define CANFD_PACK_MAX_SIGNAL           (0xFFEu)
+#define CANFD_PACK_PAD                  (0xFFu)
+
+#define CANFD_PACK_RSLT_FULL                \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 13u))
+#define CANFD_PACK_RSLT_BAD_PARAM           \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 20u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Called once per message of a received packed frame */
+typedef void (*canfd_pack_handler_t)(uint32_t signal, const uint8_t *data,
+                                     uint32_t len, const canfd_frame_t *frame);
+
+typedef struct
+{
+    uint32_t messages;          /* Messages accepted for packing */
+    uint32_t rejected;          /* Messages refused: frame still not queued */
+    uint32_t frames;            /* Packed frames handed to the Tx queue */
+    uint32_t flush_due;         /* Frames sent when a wait ended */
+    uint32_t flush_full;        /* Frames sent because a message did not fit */
+    uint32_t max_wait_ms;       /* Longest wait of a message in a frame */
+    uint32_t packed_us;         /* Bus time of the packed frames */
+    uint32_t single_us;         /* Bus time of one frame per message */
+    uint32_t load_permille;     /* Bus load of the last service call */
+    uint32_t rx_frames;         /* Packed frames received */
+    uint32_t rx_messages;       /* Messages delivered to the handler */
+    uint32_t rx_malformed;      /* Frames with a message beyond the payload */
+} canfd_pack_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void canfd_pack_init(void);
+bool canfd_pack_open(uint32_t dest, uint32_t id, bool extended);
+cy_rslt_t canfd_pack_send(uint32_t dest, uint32_t signal, const void *data,
+                          uint32_t len, uint32_t budget_ms);
+uint32_t canfd_pack_service(uint32_t load_permille);
+uint32_t canfd_pack_unpack(const canfd_frame_t *frame,
+                           canfd_pack_handler_t handler);
+void canfd_pack_print_stats(void);
+const canfd_pack_stats_t *canfd_pack_get_stats(void);
+
+#endif /* CANFD_PACK_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name:   canfd_perf.c
+*
+* Description: Report of the Rx path cycle accounting.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_perf.h"
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_perf_print
+********************************************************************************
+* Summary:
+* Prints the cycles per frame of a path and the frame rate at which it would
+* use the whole CPU.
+*
+* Parameters:
+*  name           Label of the path
+*  perf           Counters of the path
+*  entry_cycles   Cost per call not included in the measurement, for example
+*                 CANFD_PERF_IRQ_ENTRY_CYCLES for an interrupt handler
+*
+*******************************************************************************/
+void canfd_perf_print(const char *name, const canfd_perf_t *perf,
+                      uint32_t entry_cycles)
+{
+    uint64_t total;
+    uint32_t per_frame;
+
+    if (0UL == perf->frames)
+    {
+        printf("  %-10s no frames\r\n", name);
+        return;
+    }
+
+    total = perf->cycles + ((uint64_t)perf->calls * entry_cycles);
+    per_frame = (uint32_t)(total / perf->frames);
+
+    printf("  %-10s %8lu frames in %8lu calls, %5lu cycles/frame, "
+           "max %5lu cycles/call, CPU limit %7lu frames/s\r\n",
+           name, (unsigned long)perf->frames, (unsigned long)perf->calls,
+           (unsigned long)per_frame,
+           (unsigned long)(perf->max_cycles + entry_cycles),
+           (unsigned long)(SystemCoreClock / ((0UL != per_frame) ? per_frame : 1UL)));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name:   canfd_perf.h
+*
+* Description: Cycle accounting for the Rx paths (interrupt handlers and
+*              polling loop).
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_PERF_H_
+#define CANFD_PERF_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Exception entry and return on Cortex-M4 with lazy FPU stacking, not seen by
+ * a cycle count taken inside the handler */
+#ifndef CANFD_PERF_IRQ_ENTRY_CYCLES
+#define CANFD_PERF_IRQ_ENTRY_CYCLES     (24u)
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t calls;         /* Handler calls or polls that found work */
+    uint32_t frames;        /* Frames handled by these calls */
+    uint32_t max_cycles;    /* Longest call */
+    uint64_t cycles;        /* Total cycles of these calls */
+} canfd_perf_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void canfd_perf_print(const char *name, const canfd_perf_t *perf,
+                      uint32_t entry_cycles);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_perf_add
+********************************************************************************
+* Summary:
+* Accounts one call of a measured path.
+*
+* Parameters:
+*  perf       Counters of the path
+*  cycles     Duration of the call
+*  frames     Frames handled by the call
+*
+*******************************************************************************/
+__STATIC_INLINE void canfd_perf_add(canfd_perf_t *perf, uint32_t cycles,
+                                    uint32_t frames)
+{
+    perf->calls++;
+    perf->frames += frames;
+    perf->cycles += cycles;
+    if (cycles > perf->max_cycles)
+    {
+        perf->max_cycles = cycles;
+    }
+}
+
+#endif /* CANFD_PERF_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,203 @@
+/******************************************************************************
+* File Name:   canfd_poll.c
+*
+* Description: Polling-mode CAN FD driver. The CAN FD interrupt stays disabled
+*              and canfd_poll does the work of Cy_CANFD_IrqHandler: it empties
+*              Rx FIFO 0 through the Rx queue and hands the frames to the
+*              handler as one batch, handles transmission complete inline by
+*              refilling the Tx FIFO, and passes only the remaining rare
+*              interrupt sources (errors, Rx FIFO 1, dedicated Rx buffers) to
+*              the PDL handler.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_poll.h"
+#include "canfd_txq.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type *poll_base;
+static uint32_t poll_chan;
+static cy_stc_canfd_context_t *poll_context;
+
+static canfd_poll_stats_t poll_stats;
+static uint32_t poll_last_cycles;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_poll_init
+********************************************************************************
+* Summary:
+* Switches the channel to polling: disables the CAN FD interrupt in the NVIC
+* and prepares the Rx queue. Call after Cy_CANFD_Init; from then on
+* canfd_poll must be called continuously.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  context    Channel context
+*  irqn       CAN FD interrupt of the channel
+*
+*******************************************************************************/
+void canfd_poll_init(CANFD_Type *base, uint32_t chan,
+                     cy_stc_canfd_context_t *context, IRQn_Type irqn)
+{
+    NVIC_DisableIRQ(irqn);
+
+    poll_base = base;
+    poll_chan = chan;
+    poll_context = context;
+    canfd_rxq_init(base, chan, context);
+
+    /* The enabled sources select what canfd_poll looks at */
+    Cy_CANFD_SetInterruptMask(base, chan, Cy_CANFD_GetInterruptMask(base, chan) |
+                                          CANFD_RXQ_IRQ_MASK |
+                                          CANFD_CH_M_TTCAN_IR_TC_Msk);
+
+    poll_stats.min_interval = UINT32_MAX;
+    poll_last_cycles = cycle_count_now();
+}
+
+/*******************************************************************************
+* Function Name: canfd_poll
+********************************************************************************
+* Summary:
+* One iteration of the polling loop. Thread context only. The frames still
+* queued are handled in every poll, also without new flags, so that
+* CANFD_POLL_BATCH only spreads them over several polls.
+*
+* Parameters:
+*  handler    Called for each received frame
+*
+* Return:
+*  uint32_t  number of frames handled
+*
+*******************************************************************************/
+uint32_t canfd_poll(canfd_rxq_handler_t handler)
+{
+    uint32_t start = cycle_count_now();
+    uint32_t interval = start - poll_last_cycles;
+    uint32_t pending;
+    uint32_t drained;
+
+    poll_last_cycles = start;
+    poll_stats.polls++;
+    if (interval > poll_stats.max_interval)
+    {
+        poll_stats.max_interval = interval;
+    }
+    if (interval < poll_stats.min_interval)
+    {
+        poll_stats.min_interval = interval;
+    }
+
+    pending = Cy_CANFD_GetInterruptStatus(poll_base, poll_chan) &
+              Cy_CANFD_GetInterruptMask(poll_base, poll_chan);
+
+    if (0UL != (pending & CANFD_CH_M_TTCAN_IR_TC_Msk))
+    {
+        Cy_CANFD_ClearInterrupt(poll_base, poll_chan, CANFD_CH_M_TTCAN_IR_TC_Msk);
+        canfd_txq_on_tx_complete();
+        poll_stats.tx_completions++;
+    }
+
+    if (0UL != (pending & CANFD_RXQ_IRQ_MASK))
+    {
+        /* Only the FIFO drain is measured, like the interrupt without its
+         * application handler */
+        start = cycle_count_now();
+        drained = canfd_rxq_drain();
+        canfd_perf_add(&poll_stats.rx, cycle_count_now() - start, drained);
+    }
+
+    if (0UL != (pending & ~(CANFD_RXQ_IRQ_MASK | CANFD_CH_M_TTCAN_IR_TC_Msk)))
+    {
+        Cy_CANFD_IrqHandler(poll_base, poll_chan, poll_context);
+        poll_stats.other_events++;
+    }
+
+    return canfd_rxq_process(handler, CANFD_POLL_BATCH);
+}
+
+/*******************************************************************************
+* Function Name: canfd_poll_get_stats
+********************************************************************************
+* Summary:
+* Returns the polling counters.
+*
+*******************************************************************************/
+const canfd_poll_stats_t *canfd_poll_get_stats(void)
+{
+    return &poll_stats;
+}
+
+/*******************************************************************************
+* Function Name: canfd_poll_print_stats
+********************************************************************************
+* Summary:
+* Prints the cost per frame, the highest frame rate the loop can sustain and
+* the detection latency: a frame that completes right before a poll is seen
+* after the shortest poll interval (best case), at worst after the longest.
+*
+*******************************************************************************/
+void canfd_poll_print_stats(void)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000UL;
+
+    printf("Polling: %lu polls, %lu Tx complete, %lu other events\r\n",
+           (unsigned long)poll_stats.polls,
+           (unsigned long)poll_stats.tx_completions,
+           (unsigned long)poll_stats.other_events);
+    canfd_perf_print("poll", &poll_stats.rx, 0UL);
+    if (0UL != poll_stats.polls)
+    {
+        printf("  poll interval %lu ns best case, %lu us worst case\r\n\r\n",
+               (unsigned long)((poll_stats.min_interval * 1000UL) / cycles_per_us),
+               (unsigned long)cycle_count_to_us(poll_stats.max_interval));
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/******************************************************************************
+* File Name:   canfd_poll.h
+*
+* Description: Polling-mode CAN FD driver for a dedicated core or a tight real-
+*              time loop.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_POLL_H_
+#define CANFD_POLL_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+#include "canfd_rxq.h"
+#include "canfd_perf.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frames handed to the handler per poll, 0 for all that are queued */
+#ifndef CANFD_POLL_BATCH
+#define CANFD_POLL_BATCH        (0u)
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t polls;             /* canfd_poll calls */
+    uint32_t tx_completions;    /* Transmission complete events handled */
+    uint32_t other_events;      /* Polls that passed flags to the PDL handler */
+    uint32_t max_interval;      /* Longest time between two polls in cycles */
+    uint32_t min_interval;      /* Shortest time between two polls in cycles */
+    canfd_perf_t rx;            /* Rx FIFO drains, without the handler */
+} canfd_poll_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void canfd_poll_init(CANFD_Type *base, uint32_t chan,
+                     cy_stc_canfd_context_t *context, IRQn_Type irqn);
+uint32_t canfd_poll(canfd_rxq_handler_t handler);
+const canfd_poll_stats_t *canfd_poll_get_stats(void);
+void canfd_poll_print_stats(void);
+
+#endif /* CANFD_POLL_H_ */
+
+/* [] END OF FILE */
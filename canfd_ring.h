@@ -0,0 +1,210 @@
+/******************************************************************************
+* File Name:   canfd_ring.h
+*
+* Description: Single-producer single-consumer ring of CAN FD frames shared
+*              between interrupt and thread context. The indices are free
+*              running; the slot count must be a power of two.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CANFD_RING_H_
+#define CANFD_RING_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    canfd_frame_t *slots;       /* Storage, size_mask + 1 entries */
+    uint32_t size_mask;
+    volatile uint32_t head;     /* Written only by the producer */
+    volatile uint32_t tail;     /* Written only by the consumer */
+} canfd_ring_t;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_ring_init
+********************************************************************************
+* Summary:
+* Initializes an empty ring over caller provided storage.
+*
+* Parameters:
+*  ring       Ring to initialize
+*  slots      Frame storage
+*  size       Number of slots, a power of two
+*
+*******************************************************************************/
+__STATIC_INLINE void canfd_ring_init(canfd_ring_t *ring, canfd_frame_t *slots,
+                                     uint32_t size)
+{
+    CY_ASSERT((0UL != size) && (0UL == (size & (size - 1UL))));
+
+    ring->slots = slots;
+    ring->size_mask = size - 1UL;
+    ring->head = 0UL;
+    ring->tail = 0UL;
+}
+
+/* Number of frames waiting in the ring */
+__STATIC_INLINE uint32_t canfd_ring_count(const canfd_ring_t *ring)
+{
+    return ring->head - ring->tail;
+}
+
+/* Number of free slots */
+__STATIC_INLINE uint32_t canfd_ring_space(const canfd_ring_t *ring)
+{
+    return (ring->size_mask + 1UL) - canfd_ring_count(ring);
+}
+
+/*******************************************************************************
+* Function Name: canfd_ring_alloc / canfd_ring_commit
+********************************************************************************
+* Summary:
+* Zero-copy producer interface. canfd_ring_alloc returns the next free slot
+* (NULL when full); the producer fills it and publishes it with
+* canfd_ring_commit.
+*
+*******************************************************************************/
+__STATIC_INLINE canfd_frame_t *canfd_ring_alloc(canfd_ring_t *ring)
+{
+    if (0UL == canfd_ring_space(ring))
+    {
+        return NULL;
+    }
+    return &ring->slots[ring->head & ring->size_mask];
+}
+
+__STATIC_INLINE void canfd_ring_commit(canfd_ring_t *ring)
+{
+    /* Slot contents must be visible before the new head */
+    __DMB();
+    ring->head = ring->head + 1UL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_ring_peek / canfd_ring_release
+********************************************************************************
+* Summary:
+* Zero-copy consumer interface. canfd_ring_peek returns the oldest frame (NULL
+* when empty) without removing it; canfd_ring_release frees it.
+*
+*******************************************************************************/
+__STATIC_INLINE canfd_frame_t *canfd_ring_peek(canfd_ring_t *ring)
+{
+    if (0UL == canfd_ring_count(ring))
+    {
+        return NULL;
+    }
+    __DMB();
+    return &ring->slots[ring->tail & ring->size_mask];
+}
+
+__STATIC_INLINE void canfd_ring_release(canfd_ring_t *ring)
+{
+    __DMB();
+    ring->tail = ring->tail + 1UL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_ring_commit_n / canfd_ring_release_n
+********************************************************************************
+* Summary:
+* Batch variants of canfd_ring_commit and canfd_ring_release: publish or free
+* count slots with one index update. The producer fills the slots from
+* head onwards, the consumer reads them from tail onwards, both modulo the
+* ring size and bounded by canfd_ring_space or canfd_ring_count.
+*
+*******************************************************************************/
+__STATIC_INLINE void canfd_ring_commit_n(canfd_ring_t *ring, uint32_t count)
+{
+    __DMB();
+    ring->head = ring->head + count;
+}
+
+__STATIC_INLINE void canfd_ring_release_n(canfd_ring_t *ring, uint32_t count)
+{
+    __DMB();
+    ring->tail = ring->tail + count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_ring_push / canfd_ring_pop
+********************************************************************************
+* Summary:
+* Copying variants of the producer and consumer interfaces. Both return false
+* when the ring is full or empty respectively.
+*
+*******************************************************************************/
+__STATIC_INLINE bool canfd_ring_push(canfd_ring_t *ring,
+                                     const canfd_frame_t *frame)
+{
+    canfd_frame_t *slot = canfd_ring_alloc(ring);
+
+    if (NULL == slot)
+    {
+        return false;
+    }
+    *slot = *frame;
+    canfd_ring_commit(ring);
+    return true;
+}
+
+__STATIC_INLINE bool canfd_ring_pop(canfd_ring_t *ring, canfd_frame_t *frame)
+{
+    canfd_frame_t *slot = canfd_ring_peek(ring);
+
+    if (NULL == slot)
+    {
+        return false;
+    }
+    *frame = *slot;
+    canfd_ring_release(ring);
+    return true;
+}
+
+#endif /* CANFD_RING_H_ */
+
+/* [] END OF FILE */
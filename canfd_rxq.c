@@ -0,0 +1,377 @@
+/******************************************************************************
+* File Name:   canfd_rxq.c
+*
+* Description: Software Rx queue. canfd_rxq_drain empties Rx FIFO 0 into a RAM
+*              ring with one acknowledge write per batch; canfd_rxq_process
+*              hands the queued frames to the application in thread context,
+*              or canfd_rxq_recv_batch copies them out in one call.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_rxq.h"
+#include "canfd_ring.h"
+#include "canfd_mram.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static canfd_frame_t rxq_slots[CANFD_RXQ_DEPTH];
+static canfd_ring_t rxq_ring;
+static canfd_rxq_stats_t rxq_stats;
+
+/* Signalled when frames were queued, for a task that handles them */
+static task_event_t *rxq_event;
+
+static CANFD_Type *rxq_base;
+static uint32_t rxq_chan;
+
+/* Rx FIFO 0 in message RAM: first element, element size and count */
+static const volatile uint32_t *rxq_fifo_elems;
+static uint32_t rxq_elem_words;
+static uint32_t rxq_fifo_size;
+
+/* Cycles from drain to handler, per frame */
+static stats_hist_t rxq_latency;
+
+STATS_COUNTER(frames, "rxq.frames", &rxq_stats.frames);
+STATS_COUNTER(dropped, "rxq.dropped", &rxq_stats.dropped);
+STATS_COUNTER(fifo_lost, "rxq.fifo_lost", &rxq_stats.fifo_lost);
+STATS_COUNTER(drains, "rxq.drains", &rxq_stats.drains);
+STATS_COUNTER(handled, "rxq.handled", &rxq_stats.handled);
+STATS_GAUGE(max_batch, "rxq.max_batch", &rxq_stats.max_batch);
+STATS_GAUGE(max_depth, "rxq.max_depth", &rxq_stats.max_depth);
+STATS_GAUGE_FN(depth, "rxq.depth", canfd_rxq_depth);
+STATS_HISTOGRAM(latency, "rxq.latency_cycles", &rxq_latency);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_rxq_init
+********************************************************************************
+* Summary:
+* Prepares the queue for the channel. Must be called after Cy_CANFD_Init. The
+* caller decides from where canfd_rxq_drain is called.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  context    Channel context
+*
+*******************************************************************************/
+void canfd_rxq_init(CANFD_Type *base, uint32_t chan,
+                    cy_stc_canfd_context_t *context)
+{
+    /* F0DS encodes the element data size like the DLC codes 8..15 */
+    uint32_t data_bytes = canfd_dlc_to_len(8UL +
+                                           _FLD2VAL(CANFD_CH_M_TTCAN_RXESC_F0DS,
+                                                    CANFD_RXESC(base, chan)));
+
+    rxq_base = base;
+    rxq_chan = chan;
+    rxq_fifo_elems = (const volatile uint32_t *)
+                     Cy_CANFD_CalcRxFifoAdrs(base, chan, CY_CANFD_RX_FIFO0,
+                                             0UL, context);
+    rxq_elem_words = CANFD_ELEM_HEADER_WORDS + (data_bytes / 4UL);
+    rxq_fifo_size = _FLD2VAL(CANFD_CH_M_TTCAN_RXF0C_F0S,
+                             CANFD_RXF0C(base, chan));
+    canfd_ring_init(&rxq_ring, rxq_slots, CANFD_RXQ_DEPTH);
+    cycle_count_init();
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_drain
+********************************************************************************
+* Summary:
+* Acknowledges the Rx FIFO 0 interrupt flags and moves every frame in the FIFO
+* into the queue. Must not be re-entered: call it from one interrupt priority
+* or from the main loop with the CAN FD interrupt disabled.
+*
+* Return:
+*  uint32_t  number of frames read from the FIFO
+*
+*******************************************************************************/
+uint32_t canfd_rxq_drain(void)
+{
+    uint32_t flags;
+
+    if (NULL == rxq_base)
+    {
+        return 0UL;
+    }
+
+    /* Clear first so that a frame arriving during the drain sets them again */
+    flags = Cy_CANFD_GetInterruptStatus(rxq_base, rxq_chan) & CANFD_RXQ_IRQ_MASK;
+    if (0UL != flags)
+    {
+        Cy_CANFD_ClearInterrupt(rxq_base, rxq_chan, flags);
+    }
+
+    return canfd_rxq_read_fifo(flags);
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_read_fifo
+********************************************************************************
+* Summary:
+* Moves every frame in Rx FIFO 0 into the queue with direct message RAM reads.
+* The FIFO is released with a single write of the last get index. Frames that
+* do not fit into the queue are discarded and counted, and so are elements
+* read with an uncorrected message RAM error (canfd_mram.c). For handlers
+* that read and clear the interrupt flags themselves; same context rules as
+* canfd_rxq_drain.
+*
+* Parameters:
+*  flags      Rx FIFO 0 interrupt flags cleared by the caller
+*
+* Return:
+*  uint32_t  number of frames read from the FIFO
+*
+*******************************************************************************/
+uint32_t canfd_rxq_read_fifo(uint32_t flags)
+{
+    uint32_t rxf0s;
+    uint32_t fill;
+    uint32_t get;
+    uint32_t now;
+    uint32_t depth;
+    uint32_t queued = 0UL;
+    canfd_frame_t *slot;
+
+    if (0UL != (flags & CANFD_CH_M_TTCAN_IR_RF0L_Msk))
+    {
+        rxq_stats.fifo_lost++;
+    }
+
+    rxf0s = CANFD_RXF0S(rxq_base, rxq_chan);
+    fill = _FLD2VAL(CANFD_CH_M_TTCAN_RXF0S_F0FL, rxf0s);
+    get = _FLD2VAL(CANFD_CH_M_TTCAN_RXF0S_F0GI, rxf0s);
+
+    if (0UL == fill)
+    {
+        return 0UL;
+    }
+
+    now = cycle_count_now();
+    for (uint32_t idx = 0UL; idx < fill; idx++)
+    {
+        slot = canfd_ring_alloc(&rxq_ring);
+        if (NULL != slot)
+        {
+            canfd_frame_from_element(&rxq_fifo_elems[get * rxq_elem_words],
+                                     slot);
+            /* An element read with an uncorrected bit error is dropped */
+            if (!canfd_mram_rx_error(rxq_base, rxq_chan))
+            {
+                slot->timestamp = now;
+                canfd_ring_commit(&rxq_ring);
+                queued++;
+            }
+        }
+        else
+        {
+            rxq_stats.dropped++;
+        }
+
+        get = ((get + 1UL) < rxq_fifo_size) ? (get + 1UL) : 0UL;
+    }
+
+    /* Acknowledging the last element frees all elements read before it */
+    CANFD_RXF0A(rxq_base, rxq_chan) = (0UL != get) ? (get - 1UL) :
+                                                     (rxq_fifo_size - 1UL);
+
+    rxq_stats.frames += queued;
+    rxq_stats.drains++;
+    if (fill > rxq_stats.max_batch)
+    {
+        rxq_stats.max_batch = fill;
+    }
+    depth = canfd_ring_count(&rxq_ring);
+    if (depth > rxq_stats.max_depth)
+    {
+        rxq_stats.max_depth = depth;
+    }
+    TRACE(TRACE_RXQ_DRAIN, fill, depth);
+
+    if (NULL != rxq_event)
+    {
+        task_event_signal(rxq_event);
+    }
+    return fill;
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_process
+********************************************************************************
+* Summary:
+* Passes queued frames to handler in arrival order. Thread context only.
+*
+* Parameters:
+*  handler      Called once per frame; the frame is valid during the call
+*  max_frames   Upper bound of frames handled by this call, 0 for no bound
+*
+* Return:
+*  uint32_t  number of frames handled
+*
+*******************************************************************************/
+uint32_t canfd_rxq_process(canfd_rxq_handler_t handler, uint32_t max_frames)
+{
+    uint32_t count = 0UL;
+    uint32_t latency;
+    canfd_frame_t *frame;
+
+    while (((0UL == max_frames) || (count < max_frames)) &&
+           (NULL != (frame = canfd_ring_peek(&rxq_ring))))
+    {
+        latency = cycle_count_now() - frame->timestamp;
+        if (latency > rxq_stats.latency_max)
+        {
+            rxq_stats.latency_max = latency;
+        }
+        stats_hist_add(&rxq_latency, latency);
+
+        handler(frame);
+        canfd_ring_release(&rxq_ring);
+        count++;
+    }
+
+    rxq_stats.handled += count;
+    if (0UL != count)
+    {
+        TRACE(TRACE_RXQ_PROCESS, 0u, count);
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_recv_batch
+********************************************************************************
+* Summary:
+* Copies up to max_frames queued frames into frames, in arrival order, and
+* frees them with one ring update, for consumers that handle frames in
+* blocks instead of one handler call per frame. Thread context only.
+*
+* Parameters:
+*  frames       Destination, room for max_frames frames
+*  max_frames   Upper bound of frames copied
+*
+* Return:
+*  uint32_t  number of frames copied, 0 if the queue is empty
+*
+*******************************************************************************/
+uint32_t canfd_rxq_recv_batch(canfd_frame_t *frames, uint32_t max_frames)
+{
+    uint32_t tail = rxq_ring.tail;
+    uint32_t count = canfd_ring_count(&rxq_ring);
+    uint32_t now;
+    uint32_t latency;
+
+    if (count > max_frames)
+    {
+        count = max_frames;
+    }
+    if (0UL == count)
+    {
+        return 0UL;
+    }
+
+    /* Slot contents are read after the head that published them */
+    __DMB();
+    now = cycle_count_now();
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        frames[idx] = rxq_slots[(tail + idx) & rxq_ring.size_mask];
+
+        latency = now - frames[idx].timestamp;
+        if (latency > rxq_stats.latency_max)
+        {
+            rxq_stats.latency_max = latency;
+        }
+        stats_hist_add(&rxq_latency, latency);
+    }
+    canfd_ring_release_n(&rxq_ring, count);
+
+    rxq_stats.handled += count;
+    TRACE(TRACE_RXQ_PROCESS, 0u, count);
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_depth
+********************************************************************************
+* Summary:
+* Returns the number of frames waiting in the queue.
+*
+*******************************************************************************/
+uint32_t canfd_rxq_depth(void)
+{
+    return canfd_ring_count(&rxq_ring);
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_set_event
+********************************************************************************
+* Summary:
+* Sets the event signalled whenever frames were queued, so that a task awaits
+* the frames instead of polling canfd_rxq_process. NULL for none.
+*
+*******************************************************************************/
+void canfd_rxq_set_event(task_event_t *event)
+{
+    rxq_event = event;
+}
+
+/*******************************************************************************
+* Function Name: canfd_rxq_get_stats
+********************************************************************************
+* Summary:
+* Returns the Rx queue counters.
+*
+*******************************************************************************/
+const canfd_rxq_stats_t *canfd_rxq_get_stats(void)
+{
+    return &rxq_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,101 @@
+/******************************************************************************
+* File Name:   canfd_rxq.h
+*
+* Description: Software Rx queue. Frames are moved from Rx FIFO 0 of the
+*              message RAM into a RAM ring in interrupt context and handled
+*              later from the main loop.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CANFD_RXQ_H_
+#define CANFD_RXQ_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+#include "canfd_frame.h"
+#include "task.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frames held in RAM until the main loop handles them (power of two) */
+#ifndef CANFD_RXQ_DEPTH
+#define CANFD_RXQ_DEPTH         (64u)
+#endif
+
+/* Rx FIFO 0 interrupt flags acknowledged by canfd_rxq_drain */
+#define CANFD_RXQ_IRQ_MASK      (CANFD_CH_M_TTCAN_IR_RF0N_Msk | \
+                                 CANFD_CH_M_TTCAN_IR_RF0W_Msk | \
+                                 CANFD_CH_M_TTCAN_IR_RF0F_Msk | \
+                                 CANFD_CH_M_TTCAN_IR_RF0L_Msk)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef void (*canfd_rxq_handler_t)(const canfd_frame_t *frame);
+
+typedef struct
+{
+    uint32_t frames;        /* Frames moved into the queue; without the
+                             * dropped ones and message RAM errors */
+    uint32_t dropped;       /* Frames discarded because the queue was full */
+    uint32_t fifo_lost;     /* Rx FIFO 0 overflows reported by the hardware */
+    uint32_t drains;        /* canfd_rxq_drain calls that found frames */
+    uint32_t max_batch;     /* Most FIFO elements read by one drain */
+    uint32_t handled;       /* Frames passed to the handler or copied out */
+    uint32_t latency_max;   /* Cycles from drain to handler */
+    uint32_t max_depth;     /* Highest queue fill level seen */
+} canfd_rxq_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void canfd_rxq_init(CANFD_Type *base, uint32_t chan,
+                    cy_stc_canfd_context_t *context);
+uint32_t canfd_rxq_drain(void);
+uint32_t canfd_rxq_read_fifo(uint32_t flags);
+uint32_t canfd_rxq_process(canfd_rxq_handler_t handler, uint32_t max_frames);
+uint32_t canfd_rxq_recv_batch(canfd_frame_t *frames, uint32_t max_frames);
+uint32_t canfd_rxq_depth(void);
+void canfd_rxq_set_event(task_event_t *event);
+const canfd_rxq_stats_t *canfd_rxq_get_stats(void);
+
+#endif /* CANFD_RXQ_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,782 @@
+/******************************************************************************
+* File Name:   canfd_txq.c
+*
+* Description: Software Tx queue in front of the M_TTCAN Tx FIFO.
+*              canfd_txq_init converts the message RAM area behind the
+*              dedicated Tx buffers into a hardware Tx FIFO so that queued
+*              frames leave the node in order regardless of their buffer index.
+*              Producers add frames from thread context; canfd_txq_service
+*              moves as many frames as there are free FIFO elements into
+*              message RAM and requests them with a single TXBAR write. It runs
+*              from the main loop and from the transmission complete callback.
+*              canfd_txq_send_batch queues an array of frames with one ring
+*              update and services the FIFO in the same call.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "canfd_txq.h"
+#include "canfd_ring.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CANFD_TXQ_MAX_TX_BUFFERS    (32UL)
+
+/* Frames sent per batch size by canfd_txq_benchmark, and the longest wait
+ * for queue space before it gives up (no other node acknowledging) */
+#define CANFD_TXQ_BENCH_FRAMES      (256UL)
+#define CANFD_TXQ_BENCH_TIMEOUT_MS  (100UL)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static canfd_frame_t txq_slots[CANFD_TXQ_DEPTH];
+static canfd_ring_t txq_ring;
+static canfd_txq_stats_t txq_stats;
+
+static CANFD_Type *txq_base;
+static uint32_t txq_chan;
+static cy_stc_canfd_context_t *txq_context;
+
+/* Buffer index of the first Tx FIFO element */
+static uint32_t txq_fifo_first;
+
+/* Completion callbacks of the queued frames, by ring slot, and of the frames
+ * in the hardware FIFO, by FIFO element; txq_cb_pending has the buffer bits
+ * of the elements whose callback is still due */
+static canfd_txq_callback_t txq_slot_cb[CANFD_TXQ_DEPTH];
+static void *txq_slot_arg[CANFD_TXQ_DEPTH];
+static canfd_txq_callback_t txq_elem_cb[CANFD_TXQ_FIFO_SIZE];
+static void *txq_elem_arg[CANFD_TXQ_FIFO_SIZE];
+static uint32_t txq_cb_pending;
+
+/* Signalled when transmissions complete */
+static task_event_t *txq_event;
+
+STATS_COUNTER(queued, "txq.queued", &txq_stats.queued);
+STATS_COUNTER(rejected, "txq.rejected", &txq_stats.rejected);
+STATS_COUNTER(submitted, "txq.submitted", &txq_stats.submitted);
+STATS_COUNTER(completed, "txq.completed", &txq_stats.completed);
+STATS_COUNTER(timeouts, "txq.timeouts", &txq_stats.timeouts);
+STATS_COUNTER(callbacks, "txq.callbacks", &txq_stats.callbacks);
+STATS_COUNTER(flushed, "txq.flushed", &txq_stats.flushed);
+STATS_GAUGE(max_depth, "txq.max_depth", &txq_stats.max_depth);
+STATS_GAUGE_FN(depth, "txq.depth", canfd_txq_depth);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void txq_publish(canfd_txq_callback_t callback, void *arg);
+static uint32_t txq_collect(canfd_txq_callback_t *callback, void **arg,
+                            uint32_t *sent, bool all);
+static void txq_call_back(const canfd_txq_callback_t *callback,
+                          void *const *arg, uint32_t done, uint32_t sent);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: canfd_txq_init
+********************************************************************************
+* Summary:
+* Adds a Tx FIFO of CANFD_TXQ_FIFO_SIZE elements behind the dedicated Tx
+* buffers configured by Cy_CANFD_Init and enables the transmission complete
+* interrupt for the FIFO elements. Must be called right after Cy_CANFD_Init.
+*
+* Parameters:
+*  base       CAN FD block
+*  chan       Channel number
+*  config     Configuration passed to Cy_CANFD_Init
+*  context    Channel context
+*
+* Return:
+*  cy_en_canfd_status_t  CY_CANFD_BAD_PARAM if the FIFO does not fit into the
+*                        Tx buffer range or the message RAM
+*
+*******************************************************************************/
+cy_en_canfd_status_t canfd_txq_init(CANFD_Type *base, uint32_t chan,
+                                    const cy_stc_canfd_config_t *config,
+                                    cy_stc_canfd_context_t *context)
+{
+    uint32_t txbc = CANFD_TXBC(base, chan);
+    uint32_t dedicated = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_NDTB, txbc);
+    uint32_t tx_start = _FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TBSA, txbc);
+    uint32_t ram_start = _FLD2VAL(CANFD_CH_M_TTCAN_SIDFC_FLSSA,
+                                  CANFD_SIDFC(base, chan));
+    /* TBDS encodes the element data size like the DLC codes 8..15 */
+    uint32_t data_bytes = canfd_dlc_to_len(8UL +
+                                           _FLD2VAL(CANFD_CH_M_TTCAN_TXESC_TBDS,
+                                                    CANFD_TXESC(base, chan)));
+    uint32_t elem_words = CANFD_ELEM_HEADER_WORDS + (data_bytes / 4UL);
+    uint32_t ram_end = tx_start - ram_start +
+                       ((dedicated + CANFD_TXQ_FIFO_SIZE) * elem_words);
+    cy_en_canfd_status_t status;
+
+    if (((dedicated + CANFD_TXQ_FIFO_SIZE) > CANFD_TXQ_MAX_TX_BUFFERS) ||
+        ((ram_end * 4UL) > config->messageRAMsize))
+    {
+        return CY_CANFD_BAD_PARAM;
+    }
+
+    txq_base = base;
+    txq_chan = chan;
+    txq_context = context;
+    txq_fifo_first = dedicated;
+    canfd_ring_init(&txq_ring, txq_slots, CANFD_TXQ_DEPTH);
+    cycle_count_init();
+
+    /* TFQM = 0 selects FIFO operation for the TFQS elements */
+    status = Cy_CANFD_ConfigChangesEnable(base, chan);
+    if (CY_CANFD_SUCCESS == status)
+    {
+        CANFD_TXBC(base, chan) = (txbc & ~(CANFD_CH_M_TTCAN_TXBC_TFQS_Msk |
+                                           CANFD_CH_M_TTCAN_TXBC_TFQM_Msk)) |
+                                 _VAL2FLD(CANFD_CH_M_TTCAN_TXBC_TFQS,
+                                          CANFD_TXQ_FIFO_SIZE);
+        status = Cy_CANFD_ConfigChangesDisable(base, chan);
+    }
+
+    if (CY_CANFD_SUCCESS == status)
+    {
+        CANFD_TXBTIE(base, chan) |= ((1UL << CANFD_TXQ_FIFO_SIZE) - 1UL) <<
+                                    dedicated;
+        Cy_CANFD_SetInterruptMask(base, chan,
+                                  Cy_CANFD_GetInterruptMask(base, chan) |
+                                  CANFD_CH_M_TTCAN_IR_TC_Msk);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_push
+********************************************************************************
+* Summary:
+* Copies a frame into the queue. Thread context only.
+*
+* Return:
+*  bool   false if the queue is full
+*
+*******************************************************************************/
+bool canfd_txq_push(const canfd_frame_t *frame)
+{
+    canfd_frame_t *slot = canfd_txq_alloc();
+
+    if (NULL == slot)
+    {
+        return false;
+    }
+    *slot = *frame;
+    canfd_txq_commit();
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_try_send
+********************************************************************************
+* Summary:
+* Copies a frame into the queue without waiting. Thread context only.
+*
+* Return:
+*  cy_rslt_t  CANFD_TXQ_RSLT_FULL if the queue is full
+*
+*******************************************************************************/
+cy_rslt_t canfd_txq_try_send(const canfd_frame_t *frame)
+{
+    return canfd_txq_push(frame) ? CY_RSLT_SUCCESS : CANFD_TXQ_RSLT_FULL;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_send
+********************************************************************************
+* Summary:
+* Copies a frame into the queue, waiting up to timeout_ms for a free slot
+* (see canfd_txq_wait_space). Thread context only.
+*
+* Return:
+*  cy_rslt_t  CANFD_TXQ_RSLT_TIMEOUT if the queue stayed full
+*
+*******************************************************************************/
+cy_rslt_t canfd_txq_send(const canfd_frame_t *frame, uint32_t timeout_ms)
+{
+    if (!canfd_txq_wait_space(1UL, timeout_ms))
+    {
+        return CANFD_TXQ_RSLT_TIMEOUT;
+    }
+    return canfd_txq_try_send(frame);
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_send_async
+********************************************************************************
+* Summary:
+* Copies a frame into the queue without waiting; callback is called once the
+* frame has been sent, or with sent false if its request was cancelled.
+* Thread context only.
+*
+* Parameters:
+*  frame     Frame to send
+*  callback  Completion callback, or NULL
+*  arg       Passed to the callback
+*
+* Return:
+*  cy_rslt_t  CANFD_TXQ_RSLT_FULL if the queue is full; the callback is not
+*             called then
+*
+*******************************************************************************/
+cy_rslt_t canfd_txq_send_async(const canfd_frame_t *frame,
+                               canfd_txq_callback_t callback, void *arg)
+{
+    canfd_frame_t *slot = canfd_txq_alloc();
+
+    if (NULL == slot)
+    {
+        return CANFD_TXQ_RSLT_FULL;
+    }
+    *slot = *frame;
+    txq_publish(callback, arg);
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_send_batch
+********************************************************************************
+* Summary:
+* Copies up to count frames into the queue, publishes them with one ring
+* update and moves as many as there are free hardware FIFO elements into
+* message RAM with a single TXBAR write (canfd_txq_service). The per-call
+* cost of push and service is paid once for the batch. Thread context only.
+*
+* Parameters:
+*  frames    Frames to send, in order
+*  count     Number of frames
+*
+* Return:
+*  uint32_t  number of frames accepted, from the start of the array; the
+*            rest did not fit into the queue and are counted as rejected
+*
+*******************************************************************************/
+uint32_t canfd_txq_send_batch(const canfd_frame_t *frames, uint32_t count)
+{
+    uint32_t head = txq_ring.head;
+    uint32_t accepted = canfd_ring_space(&txq_ring);
+    uint32_t now = cycle_count_now();
+    uint32_t depth;
+
+    if (accepted > count)
+    {
+        accepted = count;
+    }
+    for (uint32_t idx = 0UL; idx < accepted; idx++)
+    {
+        uint32_t slot = (head + idx) & txq_ring.size_mask;
+
+        txq_slots[slot] = frames[idx];
+        txq_slots[slot].timestamp = now;
+        txq_slot_cb[slot] = NULL;
+    }
+    canfd_ring_commit_n(&txq_ring, accepted);
+
+    txq_stats.queued += accepted;
+    txq_stats.rejected += count - accepted;
+    depth = canfd_ring_count(&txq_ring);
+    if (depth > txq_stats.max_depth)
+    {
+        txq_stats.max_depth = depth;
+    }
+    if (0UL != accepted)
+    {
+        TRACE(TRACE_TXQ_PUSH, depth, frames[0].id);
+        (void)canfd_txq_service();
+    }
+    return accepted;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_wait_space
+********************************************************************************
+* Summary:
+* Waits until count slots of the queue are free, for producers of bursts.
+* Between the transmission complete interrupts, which free hardware FIFO
+* elements and refill them from the queue, the core sleeps; the 1 ms system
+* tick bounds each sleep. Thread context with interrupts enabled only.
+*
+* Parameters:
+*  count       Free slots needed, up to CANFD_TXQ_DEPTH
+*  timeout_ms  Longest wait, 0 to only check
+*
+* Return:
+*  bool  false if the slots did not become free in time
+*
+*******************************************************************************/
+bool canfd_txq_wait_space(uint32_t count, uint32_t timeout_ms)
+{
+    uint32_t start = sys_tick_ms();
+
+    while (canfd_ring_space(&txq_ring) < count)
+    {
+        /* Also moves frames on when the interrupt is not used (polling) */
+        (void)canfd_txq_service();
+        if (canfd_ring_space(&txq_ring) >= count)
+        {
+            break;
+        }
+        if ((sys_tick_ms() - start) >= timeout_ms)
+        {
+            txq_stats.timeouts++;
+            return false;
+        }
+        __WFI();
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_alloc / canfd_txq_commit
+********************************************************************************
+* Summary:
+* Zero-copy variant of canfd_txq_push: the producer fills the returned slot
+* in place and publishes it with canfd_txq_commit. canfd_txq_alloc returns
+* NULL and counts a rejected frame when the queue is full.
+*
+*******************************************************************************/
+canfd_frame_t *canfd_txq_alloc(void)
+{
+    canfd_frame_t *slot = canfd_ring_alloc(&txq_ring);
+
+    if (NULL == slot)
+    {
+        txq_stats.rejected++;
+    }
+    return slot;
+}
+
+void canfd_txq_commit(void)
+{
+    txq_publish(NULL, NULL);
+}
+
+/*******************************************************************************
+* Function Name: txq_publish
+********************************************************************************
+* Summary:
+* Publishes the slot returned by canfd_txq_alloc with its completion
+* callback.
+*
+*******************************************************************************/
+static void txq_publish(canfd_txq_callback_t callback, void *arg)
+{
+    uint32_t idx = txq_ring.head & txq_ring.size_mask;
+    canfd_frame_t *slot = &txq_ring.slots[idx];
+    uint32_t depth;
+
+    slot->timestamp = cycle_count_now();
+    txq_slot_cb[idx] = callback;
+    txq_slot_arg[idx] = arg;
+    canfd_ring_commit(&txq_ring);
+
+    txq_stats.queued++;
+    depth = canfd_ring_count(&txq_ring);
+    TRACE(TRACE_TXQ_PUSH, depth, slot->id);
+    if (depth > txq_stats.max_depth)
+    {
+        txq_stats.max_depth = depth;
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_service
+********************************************************************************
+* Summary:
+* Moves queued frames into the free hardware Tx FIFO elements and requests
+* their transmission with one TXBAR write. The completions are collected in
+* the same critical section, and an element whose callback is still due is
+* not refilled: its TXBAR write would reset the TXBTO bit of the callback.
+* Safe to call from thread and interrupt context.
+*
+* Return:
+*  uint32_t  number of frames handed to the hardware
+*
+*******************************************************************************/
+uint32_t canfd_txq_service(void)
+{
+    canfd_txq_callback_t callback[CANFD_TXQ_FIFO_SIZE];
+    void *arg[CANFD_TXQ_FIFO_SIZE];
+    uint32_t saved_intr;
+    uint32_t txfqs;
+    uint32_t free_elems;
+    uint32_t put;
+    uint32_t request = 0UL;
+    uint32_t with_cb = 0UL;
+    uint32_t count = 0UL;
+    uint32_t done = 0UL;
+    uint32_t sent = 0UL;
+    canfd_frame_t *frame;
+
+    if (NULL == txq_base)
+    {
+        return 0UL;
+    }
+
+    saved_intr = Cy_SysLib_EnterCriticalSection();
+
+    if (0UL != txq_cb_pending)
+    {
+        done = txq_collect(callback, arg, &sent, false);
+    }
+
+    /* Read after the completions: an element freed in between still has its
+     * callback bit set and ends the refill */
+    txfqs = CANFD_TXFQS(txq_base, txq_chan);
+    free_elems = _FLD2VAL(CANFD_CH_M_TTCAN_TXFQS_TFFL, txfqs);
+    put = _FLD2VAL(CANFD_CH_M_TTCAN_TXFQS_TFQPI, txfqs);
+
+    while ((count < free_elems) && (0UL == (txq_cb_pending & (1UL << put))) &&
+           (NULL != (frame = canfd_ring_peek(&txq_ring))))
+    {
+        uint32_t slot = txq_ring.tail & txq_ring.size_mask;
+
+        canfd_frame_to_element(frame, (volatile uint32_t *)
+                               Cy_CANFD_CalcTxBufAdrs(txq_base, txq_chan, put,
+                                                      txq_context));
+        if (NULL != txq_slot_cb[slot])
+        {
+            txq_elem_cb[put - txq_fifo_first] = txq_slot_cb[slot];
+            txq_elem_arg[put - txq_fifo_first] = txq_slot_arg[slot];
+            with_cb |= 1UL << put;
+        }
+        canfd_ring_release(&txq_ring);
+        request |= 1UL << put;
+        count++;
+
+        put++;
+        if (put >= (txq_fifo_first + CANFD_TXQ_FIFO_SIZE))
+        {
+            put = txq_fifo_first;
+        }
+    }
+
+    if (0UL != request)
+    {
+        CANFD_TXBAR(txq_base, txq_chan) = request;
+        /* The request has reset the TXBTO and TXBCF bits of the elements */
+        txq_cb_pending |= with_cb;
+        txq_stats.submitted += count;
+        TRACE(TRACE_TXQ_SUBMIT, count, canfd_ring_count(&txq_ring));
+    }
+
+    Cy_SysLib_ExitCriticalSection(saved_intr);
+
+    if (0UL != done)
+    {
+        txq_call_back(callback, arg, done, sent);
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_flush
+********************************************************************************
+* Summary:
+* Drops the queued frames and forgets the hardware FIFO requests, after a
+* configuration change that reset them (CCCR.INIT). The callbacks of the
+* frames that were not sent are called with sent false. Thread context only.
+*
+*******************************************************************************/
+void canfd_txq_flush(void)
+{
+    canfd_txq_callback_t callback[CANFD_TXQ_FIFO_SIZE];
+    void *arg[CANFD_TXQ_FIFO_SIZE];
+    canfd_txq_callback_t slot_cb;
+    void *slot_arg;
+    uint32_t saved_intr;
+    uint32_t done;
+    uint32_t sent;
+
+    if (NULL == txq_base)
+    {
+        return;
+    }
+
+    saved_intr = Cy_SysLib_EnterCriticalSection();
+    done = txq_collect(callback, arg, &sent, true);
+    Cy_SysLib_ExitCriticalSection(saved_intr);
+    if (0UL != done)
+    {
+        txq_call_back(callback, arg, done, sent);
+    }
+
+    /* One frame per critical section: the callbacks run outside of it */
+    for (;;)
+    {
+        saved_intr = Cy_SysLib_EnterCriticalSection();
+        if (NULL == canfd_ring_peek(&txq_ring))
+        {
+            Cy_SysLib_ExitCriticalSection(saved_intr);
+            break;
+        }
+        slot_cb = txq_slot_cb[txq_ring.tail & txq_ring.size_mask];
+        slot_arg = txq_slot_arg[txq_ring.tail & txq_ring.size_mask];
+        canfd_ring_release(&txq_ring);
+        txq_stats.flushed++;
+        Cy_SysLib_ExitCriticalSection(saved_intr);
+
+        if (NULL != slot_cb)
+        {
+            slot_cb(slot_arg, false);
+            txq_stats.callbacks++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_depth
+********************************************************************************
+* Summary:
+* Returns the number of frames waiting in the software queue.
+*
+*******************************************************************************/
+uint32_t canfd_txq_depth(void)
+{
+    return canfd_ring_count(&txq_ring);
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_space
+********************************************************************************
+* Summary:
+* Returns the number of free slots in the software queue, for producers that
+* adapt their rate.
+*
+*******************************************************************************/
+uint32_t canfd_txq_space(void)
+{
+    return canfd_ring_space(&txq_ring);
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_set_event
+********************************************************************************
+* Summary:
+* Sets a task event signalled when transmissions complete, so that a task
+* can wait for queue space with TASK_AWAIT_FOR. NULL removes it.
+*
+*******************************************************************************/
+void canfd_txq_set_event(task_event_t *event)
+{
+    txq_event = event;
+}
+
+/*******************************************************************************
+* Function Name: txq_collect
+********************************************************************************
+* Summary:
+* Takes the completion callbacks of the FIFO elements that were sent
+* (TXBTO) or whose request was cancelled (TXBCF) and clears their pending
+* bits. Called in the critical section of canfd_txq_service, before the
+* elements can be refilled.
+*
+* Parameters:
+*  callback   Callbacks, by FIFO element
+*  arg        Their arguments
+*  sent       Buffer bits of the elements that were sent
+*  all        true to also take the requests that did not complete
+*
+* Return:
+*  uint32_t  buffer bits of the elements taken
+*
+*******************************************************************************/
+static uint32_t txq_collect(canfd_txq_callback_t *callback, void **arg,
+                            uint32_t *sent, bool all)
+{
+    uint32_t done;
+    uint32_t elem;
+
+    *sent = txq_cb_pending & CANFD_TXBTO(txq_base, txq_chan);
+    done = all ? txq_cb_pending :
+                 (*sent | (txq_cb_pending & CANFD_TXBCF(txq_base, txq_chan)));
+    txq_cb_pending &= ~done;
+    for (uint32_t bits = done; 0UL != bits; bits &= bits - 1UL)
+    {
+        elem = (31UL - (uint32_t)__CLZ(bits & (0UL - bits))) - txq_fifo_first;
+        callback[elem] = txq_elem_cb[elem];
+        arg[elem] = txq_elem_arg[elem];
+    }
+    return done;
+}
+
+/*******************************************************************************
+* Function Name: txq_call_back
+********************************************************************************
+* Summary:
+* Calls the callbacks taken by txq_collect, outside the critical section.
+*
+*******************************************************************************/
+static void txq_call_back(const canfd_txq_callback_t *callback,
+                          void *const *arg, uint32_t done, uint32_t sent)
+{
+    uint32_t elem;
+
+    for (uint32_t bits = done; 0UL != bits; bits &= bits - 1UL)
+    {
+        uint32_t bit = bits & (0UL - bits);
+
+        elem = (31UL - (uint32_t)__CLZ(bit)) - txq_fifo_first;
+        callback[elem](arg[elem], 0UL != (sent & bit));
+        txq_stats.callbacks++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_on_tx_complete
+********************************************************************************
+* Summary:
+* Transmission complete callback installed by canfd_cfg_init. Called by
+* Cy_CANFD_IrqHandler from the CAN FD interrupt; calls the completion
+* callbacks, refills the hardware FIFO and wakes a waiting task.
+*
+*******************************************************************************/
+void canfd_txq_on_tx_complete(void)
+{
+    TRACE(TRACE_TX_DONE, 0u, 0u);
+    txq_stats.completed++;
+    (void)canfd_txq_service();
+    if (NULL != txq_event)
+    {
+        task_event_signal(txq_event);
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_benchmark
+********************************************************************************
+* Summary:
+* Sends CANFD_TXQ_BENCH_FRAMES copies of frame for each batch size from 1 to
+* CANFD_TXQ_DEPTH with canfd_txq_send_batch, the first two payload bytes
+* holding a sequence number, and prints per batch size the cycles spent in
+* canfd_txq_send_batch per frame, the frame rate these cycles would allow,
+* and the frame rate reached on the bus until the queue was empty. Blocks
+* until the frames have left the queue; stops if no space becomes free for
+* CANFD_TXQ_BENCH_TIMEOUT_MS. Thread context only.
+*
+* Parameters:
+*  frame     Template of the frames sent
+*
+*******************************************************************************/
+void canfd_txq_benchmark(const canfd_frame_t *frame)
+{
+    static canfd_frame_t batch[CANFD_TXQ_DEPTH];
+    uint32_t seq = 0UL;
+
+    cycle_count_init();
+    for (uint32_t idx = 0UL; idx < CANFD_TXQ_DEPTH; idx++)
+    {
+        batch[idx] = *frame;
+    }
+
+    printf("Tx batch benchmark: %lu frames of %u bytes per batch size\r\n",
+           (unsigned long)CANFD_TXQ_BENCH_FRAMES, (unsigned int)frame->len);
+    printf("  batch  cycles/frame  API frames/s  bus frames/s\r\n");
+
+    for (uint32_t size = 1UL; size <= CANFD_TXQ_DEPTH; size <<= 1)
+    {
+        uint32_t sent = 0UL;
+        uint32_t api_cycles = 0UL;
+        uint32_t start = cycle_count_now();
+        uint32_t elapsed;
+        bool space = true;
+
+        while (space && (sent < CANFD_TXQ_BENCH_FRAMES))
+        {
+            uint32_t count = CANFD_TXQ_BENCH_FRAMES - sent;
+            uint32_t begin;
+
+            count = (count < size) ? count : size;
+            space = canfd_txq_wait_space(count, CANFD_TXQ_BENCH_TIMEOUT_MS);
+            if (space)
+            {
+                for (uint32_t idx = 0UL; idx < count; idx++)
+                {
+                    batch[idx].data[0] = (batch[idx].data[0] & 0xFFFF0000UL) |
+                                         (seq & 0xFFFFUL);
+                    seq++;
+                }
+                begin = cycle_count_now();
+                sent += canfd_txq_send_batch(batch, count);
+                api_cycles += cycle_count_now() - begin;
+            }
+        }
+        space = space && canfd_txq_wait_space(CANFD_TXQ_DEPTH,
+                                              CANFD_TXQ_BENCH_TIMEOUT_MS);
+        elapsed = cycle_count_now() - start;
+
+        if (!space)
+        {
+            printf("  %5lu  no queue space for %lu ms, stopped\r\n",
+                   (unsigned long)size,
+                   (unsigned long)CANFD_TXQ_BENCH_TIMEOUT_MS);
+            break;
+        }
+        printf("  %5lu  %12lu  %12lu  %12lu\r\n", (unsigned long)size,
+               (unsigned long)(api_cycles / sent),
+               (unsigned long)(((uint64_t)SystemCoreClock * sent) /
+                               ((0UL != api_cycles) ? api_cycles : 1UL)),
+               (unsigned long)(((uint64_t)SystemCoreClock * sent) / elapsed));
+    }
+}
+
+/*******************************************************************************
+* Function Name: canfd_txq_get_stats
+********************************************************************************
+* Summary:
+* Returns the Tx queue counters.
+*
+*******************************************************************************/
+const canfd_txq_stats_t *canfd_txq_get_stats(void)
+{
+    return &txq_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,115 @@
+/******************************************************************************
+* File Name:   canfd_txq.h
+*
+* Description: Software Tx queue in front of the M_TTCAN Tx FIFO.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CANFD_TXQ_H_
+#define CANFD_TXQ_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+#include "canfd_frame.h"
+#include "task.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frames held in RAM while the hardware FIFO is full (power of two) */
+#ifndef CANFD_TXQ_DEPTH
+#define CANFD_TXQ_DEPTH         (32u)
+#endif
+
+/* Message RAM Tx FIFO elements placed behind the dedicated Tx buffers */
+#ifndef CANFD_TXQ_FIFO_SIZE
+#define CANFD_TXQ_FIFO_SIZE     (8u)
+#endif
+
+#define CANFD_TXQ_RSLT_FULL                 \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 11u))
+#define CANFD_TXQ_RSLT_TIMEOUT              \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 12u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Completion of a frame sent with canfd_txq_send_async: sent is false if
+ * the request was cancelled. Called from the CAN FD interrupt or from
+ * canfd_txq_service. */
+typedef void (*canfd_txq_callback_t)(void *arg, bool sent);
+
+typedef struct
+{
+    uint32_t queued;        /* Frames accepted into the queue */
+    uint32_t rejected;      /* Frames refused because the queue was full */
+    uint32_t submitted;     /* Frames written to the hardware Tx FIFO */
+    uint32_t completed;     /* Transmission complete interrupts */
+    uint32_t timeouts;      /* Blocking sends that found no space in time */
+    uint32_t callbacks;     /* Completion callbacks called */
+    uint32_t flushed;       /* Queued frames dropped by canfd_txq_flush */
+    uint32_t max_depth;     /* Highest queue fill level seen */
+} canfd_txq_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_en_canfd_status_t canfd_txq_init(CANFD_Type *base, uint32_t chan,
+                                    const cy_stc_canfd_config_t *config,
+                                    cy_stc_canfd_context_t *context);
+bool canfd_txq_push(const canfd_frame_t *frame);
+cy_rslt_t canfd_txq_try_send(const canfd_frame_t *frame);
+cy_rslt_t canfd_txq_send(const canfd_frame_t *frame, uint32_t timeout_ms);
+cy_rslt_t canfd_txq_send_async(const canfd_frame_t *frame,
+                               canfd_txq_callback_t callback, void *arg);
+uint32_t canfd_txq_send_batch(const canfd_frame_t *frames, uint32_t count);
+bool canfd_txq_wait_space(uint32_t count, uint32_t timeout_ms);
+canfd_frame_t *canfd_txq_alloc(void);
+void canfd_txq_commit(void);
+uint32_t canfd_txq_service(void);
+void canfd_txq_flush(void);
+uint32_t canfd_txq_depth(void);
+uint32_t canfd_txq_space(void);
+void canfd_txq_set_event(task_event_t *event);
+void canfd_txq_on_tx_complete(void);
+void canfd_txq_benchmark(const canfd_frame_t *frame);
+const canfd_txq_stats_t *canfd_txq_get_stats(void);
+
+#endif /* CANFD_TXQ_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,203 @@
+/******************************************************************************
+* File Name:   config_store.c
+*
+* Description: Settings kept in the internal flash over resets: the bit rate
+*              profile found by autobaud and the calibrated bit timing.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "config_store.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#if defined(CYHAL_DRIVER_AVAILABLE_FLASH) && (CYHAL_DRIVER_AVAILABLE_FLASH)
+#define CONFIG_STORE_HAVE_FLASH
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t config_store_checksum(const config_store_t *record);
+static void config_store_defaults(void);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+#if defined(CONFIG_STORE_HAVE_FLASH)
+/* One row of the emulated EEPROM region (the auxiliary flash of PSoC 6),
+ * which the linker scripts keep free for data. Programming the application
+ * clears it. */
+CY_SECTION(".cy_em_eeprom") CY_ALIGN(CONFIG_STORE_ROW_SIZE)
+static const uint8_t store_row[CONFIG_STORE_ROW_SIZE] = { 0u };
+
+/* Row image written by config_store_save */
+static uint32_t store_buffer[CONFIG_STORE_ROW_SIZE / 4u];
+#endif
+
+static config_store_t store_record;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: config_store_init
+********************************************************************************
+* Summary:
+* Reads the record from the flash into RAM. A missing or damaged record, or
+* one of another version, is replaced by the defaults.
+*
+* Return:
+*  cy_rslt_t  CONFIG_STORE_RSLT_EMPTY if the defaults are used,
+*             CONFIG_STORE_RSLT_NO_FLASH on devices without internal flash
+*
+*******************************************************************************/
+cy_rslt_t config_store_init(void)
+{
+#if defined(CONFIG_STORE_HAVE_FLASH)
+    /* Word reads through a volatile pointer: the compiler must not use the
+     * initial value of the const row */
+    const volatile uint32_t *src = (const volatile uint32_t *)store_row;
+    uint32_t *dst = (uint32_t *)&store_record;
+
+    for (uint32_t idx = 0UL; idx < (sizeof(store_record) / 4UL); idx++)
+    {
+        dst[idx] = src[idx];
+    }
+
+    if ((CONFIG_STORE_MAGIC == store_record.magic) &&
+        (CONFIG_STORE_VERSION == store_record.version) &&
+        (config_store_checksum(&store_record) == store_record.checksum))
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    config_store_defaults();
+    return CONFIG_STORE_RSLT_EMPTY;
+#else
+    config_store_defaults();
+    return CONFIG_STORE_RSLT_NO_FLASH;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: config_store_get
+********************************************************************************
+* Summary:
+* Returns the RAM copy of the record. Changes are kept over a reset after
+* config_store_save.
+*
+*******************************************************************************/
+config_store_t *config_store_get(void)
+{
+    return &store_record;
+}
+
+/*******************************************************************************
+* Function Name: config_store_save
+********************************************************************************
+* Summary:
+* Writes the RAM copy into the flash row. Blocks for the erase and program
+* time of one row (a few ms); call from the main loop, not from an
+* interrupt.
+*
+* Return:
+*  cy_rslt_t  result of the HAL flash driver, CONFIG_STORE_RSLT_NO_FLASH on
+*             devices without internal flash
+*
+*******************************************************************************/
+cy_rslt_t config_store_save(void)
+{
+#if defined(CONFIG_STORE_HAVE_FLASH)
+    cyhal_flash_t flash;
+    cy_rslt_t result;
+
+    store_record.saves++;
+    store_record.checksum = config_store_checksum(&store_record);
+
+    memset(store_buffer, 0, sizeof(store_buffer));
+    memcpy(store_buffer, &store_record, sizeof(store_record));
+
+    result = cyhal_flash_init(&flash);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        /* Erases the row and programs it */
+        result = cyhal_flash_write(&flash, (uint32_t)(uintptr_t)store_row,
+                                   store_buffer);
+        cyhal_flash_free(&flash);
+    }
+    return result;
+#else
+    return CONFIG_STORE_RSLT_NO_FLASH;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: config_store_checksum
+*******************************************************************************/
+static uint32_t config_store_checksum(const config_store_t *record)
+{
+    const uint32_t *words = (const uint32_t *)record;
+    uint32_t sum = 0UL;
+
+    for (uint32_t idx = 0UL;
+         idx < (offsetof(config_store_t, checksum) / 4UL); idx++)
+    {
+        sum = ((sum << 1) | (sum >> 31)) + words[idx];
+    }
+    return ~sum;
+}
+
+/*******************************************************************************
+* Function Name: config_store_defaults
+*******************************************************************************/
+static void config_store_defaults(void)
+{
+    memset(&store_record, 0, sizeof(store_record));
+    store_record.magic = CONFIG_STORE_MAGIC;
+    store_record.version = CONFIG_STORE_VERSION;
+    store_record.bitrate_profile = CONFIG_STORE_NONE;
+    store_record.timing_profile = CONFIG_STORE_NONE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name:   config_store.h
+*
+* Description: Settings kept in the internal flash over resets: the bit rate
+*              profile found by autobaud and the calibrated bit timing.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef CONFIG_STORE_H_
+#define CONFIG_STORE_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "cyhal.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Flash row that holds the record (CY_FLASH_SIZEOF_ROW of PSoC 6) */
+#ifndef CONFIG_STORE_ROW_SIZE
+#define CONFIG_STORE_ROW_SIZE       (512u)
+#endif
+
+#define CONFIG_STORE_MAGIC          (0x47464E43UL)  /* "CNFG" */
+#define CONFIG_STORE_VERSION        (1UL)
+
+/* Profile field not set */
+#define CONFIG_STORE_NONE           (0xFFu)
+
+/* The device has no internal flash for data; the record stays in RAM */
+#define CONFIG_STORE_RSLT_NO_FLASH          \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 16u))
+/* No valid record in the flash, the defaults are used */
+#define CONFIG_STORE_RSLT_EMPTY             \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 17u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Settings kept over resets and power cycles */
+typedef struct
+{
+    uint32_t magic;                     /* CONFIG_STORE_MAGIC */
+    uint32_t version;                   /* CONFIG_STORE_VERSION */
+    uint32_t saves;                     /* Times written */
+    uint8_t bitrate_profile;            /* Last profile found by autobaud */
+    uint8_t timing_profile;             /* Profile the timing below is for */
+    uint16_t sp_margin_permille;        /* Error-free sample point range of
+                                         * the data phase, on either side */
+    cy_stc_canfd_bitrate_t nominal;     /* Calibrated arbitration phase */
+    cy_stc_canfd_bitrate_t data;        /* Calibrated data phase */
+    uint32_t checksum;
+} config_store_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t config_store_init(void);
+config_store_t *config_store_get(void);
+cy_rslt_t config_store_save(void);
+
+#endif /* CONFIG_STORE_H_ */
+
+/* [] END OF FILE */
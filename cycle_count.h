@@ -0,0 +1,101 @@
+/******************************************************************************
+* File Name:   cycle_count.h
+*
+* Description: Inline helpers around the DWT cycle counter, used to timestamp
+*              events and to benchmark hot paths.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CYCLE_COUNT_H_
+#define CYCLE_COUNT_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: cycle_count_init
+********************************************************************************
+* Summary:
+* Enables the trace block and starts the free running DWT cycle counter.
+* Calling it more than once is harmless; the counter is not reset if it is
+* already running so that timestamps taken earlier stay comparable.
+*
+*******************************************************************************/
+__STATIC_INLINE void cycle_count_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    if (0UL == (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        DWT->CYCCNT = 0UL;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/*******************************************************************************
+* Function Name: cycle_count_now
+********************************************************************************
+* Summary:
+* Returns the current CPU cycle count. The counter wraps; compute intervals
+* with unsigned subtraction.
+*
+*******************************************************************************/
+__STATIC_INLINE uint32_t cycle_count_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/*******************************************************************************
+* Function Name: cycle_count_to_us
+********************************************************************************
+* Summary:
+* Converts a cycle interval into microseconds at the current core clock.
+*
+*******************************************************************************/
+__STATIC_INLINE uint32_t cycle_count_to_us(uint32_t cycles)
+{
+    return (uint32_t)(((uint64_t)cycles * 1000000ULL) / SystemCoreClock);
+}
+
+#endif /* CYCLE_COUNT_H_ */
+
+/* [] END OF FILE */
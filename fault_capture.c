@@ -0,0 +1,508 @@
+/******************************************************************************
+* File Name:   fault_capture.c
+*
+* Description: Fault capture: on a hard fault or an unrecoverable error,
+*              registers, stack, recent trace events and CAN FD state are
+*              stored in no-init RAM and the device is reset; the record is
+*              reported once the channel is back on the bus.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "fault_capture.h"
+#include "binlog.h"
+#include "canfd_errlog.h"
+#include "canfd_txq.h"
+#include "canfd_rxq.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define FAULT_RECORD_MAGIC      (0xFA017C0DUL)
+#define FAULT_BOOT_MAGIC        (0xB0075AFEUL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Fault counters kept over resets; valid while check matches */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t restarts;      /* Fault resets since the bus was last active */
+    uint32_t total;         /* Faults since power-on */
+    uint32_t check;
+} fault_boot_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Not cleared by the start-up code, so they survive the reset */
+CY_NOINIT static fault_record_t fault_record;
+CY_NOINIT static fault_boot_t fault_boot;
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+/* Top of the stack, from the GCC linker script */
+extern uint32_t __StackTop;
+#endif
+
+static fault_capture_stats_t fault_stats;
+
+/* Channel whose state is captured, once it is initialized */
+static CANFD_Type *fault_base;
+static uint32_t fault_chan;
+
+/* A record of the previous run waits for the bus */
+static bool fault_pending;
+static uint32_t fault_boot_cycles;
+static uint32_t fault_reset_reason;
+
+STATS_GAUGE(total, "fault.total", &fault_stats.total);
+STATS_GAUGE(recovery, "fault.recovery_us", &fault_stats.recovery_us);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void fault_capture_begin(uint32_t reason, uint32_t status, uint32_t sp);
+static __NO_RETURN void fault_capture_finish(uint32_t start);
+static uint32_t fault_record_checksum(void);
+static uint32_t fault_boot_check(void);
+static void fault_report(void);
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+static void fault_capture_hard_fault_entry(void);
+/* Called from fault_capture_hard_fault_entry only */
+__NO_RETURN void fault_capture_hard_fault(const uint32_t *frame,
+                                          uint32_t exc_return);
+#endif
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: fault_capture_init
+********************************************************************************
+* Summary:
+* Call right after cybsp_init. Validates the no-init RAM (garbage after a
+* power-on), starts the recovery time measurement and installs the hard
+* fault handler.
+*
+* Return:
+*  bool  true if the previous run ended with a fault; the caller can skip
+*        start-up work that is not needed to get back on the bus
+*
+*******************************************************************************/
+bool fault_capture_init(void)
+{
+    cycle_count_init();
+    fault_boot_cycles = cycle_count_now();
+
+    fault_reset_reason = Cy_SysLib_GetResetReason();
+    Cy_SysLib_ClearResetReason();
+
+    if ((FAULT_BOOT_MAGIC != fault_boot.magic) ||
+        (fault_boot_check() != fault_boot.check))
+    {
+        fault_boot.magic = FAULT_BOOT_MAGIC;
+        fault_boot.restarts = 0UL;
+        fault_boot.total = 0UL;
+        fault_boot.check = fault_boot_check();
+    }
+    fault_stats.total = fault_boot.total;
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+    /* The vector table is in RAM; the shim replaces the PDL handler */
+    (void)Cy_SysInt_SetVector(HardFault_IRQn, fault_capture_hard_fault_entry);
+#endif
+
+    fault_pending = (FAULT_RECORD_MAGIC == fault_record.magic) &&
+                    (fault_record_checksum() == fault_record.checksum);
+    if (fault_pending)
+    {
+        fault_stats.capture_us = fault_record.capture_us;
+    }
+    return fault_pending;
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_attach
+********************************************************************************
+* Summary:
+* Call once the channel is initialized: its state is captured from now on,
+* and fault_capture_process waits for it to be active on the bus.
+*
+*******************************************************************************/
+void fault_capture_attach(CANFD_Type *base, uint32_t chan)
+{
+    fault_chan = chan;
+    __DMB();
+    fault_base = base;
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_process
+********************************************************************************
+* Summary:
+* Main loop part: when the channel has left initialization and finished
+* synchronizing to the bus, records the recovery time, resets the restart
+* guard and reports the fault record of the previous run, if any, over the
+* UART and the CAN FD binary log.
+*
+*******************************************************************************/
+void fault_capture_process(void)
+{
+    uint32_t psr;
+
+    if (fault_stats.bus_active || (NULL == fault_base))
+    {
+        return;
+    }
+
+    psr = canfd_errlog_read_psr(fault_base, fault_chan);
+    if ((0UL != (CANFD_CCCR(fault_base, fault_chan) &
+                 CANFD_CH_M_TTCAN_CCCR_INIT_Msk)) ||
+        (0UL == _FLD2VAL(CANFD_CH_M_TTCAN_PSR_ACT, psr)))
+    {
+        return;
+    }
+
+    fault_stats.recovery_us = cycle_count_to_us(cycle_count_now() -
+                                                 fault_boot_cycles);
+    fault_stats.bus_active = true;
+
+    fault_boot.restarts = 0UL;
+    fault_boot.check = fault_boot_check();
+
+    if (fault_pending)
+    {
+        fault_report();
+        fault_record.magic = 0UL;
+        fault_pending = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_error
+********************************************************************************
+* Summary:
+* Records an unrecoverable error and resets the device. Replaces the halt in
+* handle_error.
+*
+* Parameters:
+*  status     Result code of the failed call
+*  caller     Address of the failed call, FAULT_CAPTURE_CALLER()
+*
+*******************************************************************************/
+void fault_capture_error(uint32_t status, uint32_t caller)
+{
+    uint32_t start = cycle_count_now();
+
+    __disable_irq();
+    fault_capture_begin(FAULT_REASON_ERROR, status, __get_MSP());
+    fault_record.lr = caller;
+    fault_record.pc = caller;
+    fault_capture_finish(start);
+}
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+/*******************************************************************************
+* Function Name: fault_capture_hard_fault_entry
+********************************************************************************
+* Summary:
+* Hard fault vector. Bit 2 of EXC_RETURN in LR tells which stack the core
+* pushed the exception frame on: the process stack (PSP) when set, the main
+* stack (MSP) otherwise. The frame and EXC_RETURN go to
+* fault_capture_hard_fault; nothing is pushed before, so the frame address is
+* exact.
+*
+*******************************************************************************/
+__attribute__((naked)) static void fault_capture_hard_fault_entry(void)
+{
+    __asm volatile
+    (
+        "    tst     lr, #4                      \n"
+        "    ite     eq                          \n"
+        "    mrseq   r0, msp                     \n"
+        "    mrsne   r0, psp                     \n"
+        "    mov     r1, lr                      \n"
+        "    b       fault_capture_hard_fault    \n"
+    );
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_hard_fault
+********************************************************************************
+* Summary:
+* Records a hard fault from the exception frame: R0-R3, R12, LR, PC and xPSR
+* as stacked by the core, and the stack from the frame upwards. EXC_RETURN is
+* kept in the status field. Runs with the fault priority; only reads memory
+* that cannot fault.
+*
+* Parameters:
+*  frame       Exception frame, on the stack in use at the fault
+*  exc_return  LR at the handler entry
+*
+*******************************************************************************/
+void fault_capture_hard_fault(const uint32_t *frame, uint32_t exc_return)
+{
+    uint32_t start = cycle_count_now();
+
+    fault_capture_begin(FAULT_REASON_HARDFAULT, exc_return,
+                        (uint32_t)(uintptr_t)frame);
+    fault_record.r0 = frame[0];
+    fault_record.r1 = frame[1];
+    fault_record.r2 = frame[2];
+    fault_record.r3 = frame[3];
+    fault_record.r12 = frame[4];
+    fault_record.lr = frame[5];
+    fault_record.pc = frame[6];
+    fault_record.psr = frame[7];
+    fault_capture_finish(start);
+}
+#else
+/*******************************************************************************
+* Function Name: Cy_SysLib_ProcessingFault
+********************************************************************************
+* Summary:
+* Replaces the weak PDL function called by the hard fault handler after it
+* has copied the exception frame to cy_faultFrame, for the toolchains without
+* fault_capture_hard_fault_entry. Runs with the fault priority; only reads
+* memory that cannot fault.
+*
+*******************************************************************************/
+void Cy_SysLib_ProcessingFault(void)
+{
+    uint32_t start = cycle_count_now();
+
+    fault_capture_begin(FAULT_REASON_HARDFAULT, 0UL, __get_MSP());
+#if (CY_ARM_FAULT_DEBUG == CY_ARM_FAULT_DEBUG_ENABLED)
+    fault_record.r0 = cy_faultFrame.r0;
+    fault_record.r1 = cy_faultFrame.r1;
+    fault_record.r2 = cy_faultFrame.r2;
+    fault_record.r3 = cy_faultFrame.r3;
+    fault_record.r12 = cy_faultFrame.r12;
+    fault_record.lr = cy_faultFrame.lr;
+    fault_record.pc = cy_faultFrame.pc;
+    fault_record.psr = cy_faultFrame.psr;
+#endif
+    fault_capture_finish(start);
+}
+#endif
+
+/*******************************************************************************
+* Function Name: fault_capture_reset_reason
+********************************************************************************
+* Summary:
+* Returns the reset reason read (and cleared) by fault_capture_init.
+*
+*******************************************************************************/
+uint32_t fault_capture_reset_reason(void)
+{
+    return fault_reset_reason;
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_get_stats
+*******************************************************************************/
+const fault_capture_stats_t *fault_capture_get_stats(void)
+{
+    return &fault_stats;
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_begin
+********************************************************************************
+* Summary:
+* Fills the record with the state that does not depend on the fault type.
+*
+*******************************************************************************/
+static void fault_capture_begin(uint32_t reason, uint32_t status, uint32_t sp)
+{
+    fault_record_t *rec = &fault_record;
+    const uint32_t *stack = (const uint32_t *)(uintptr_t)sp;
+    uint32_t words = 0UL;
+
+    trace_set_recording(false);
+
+    memset(rec, 0, sizeof(*rec));
+    rec->reason = reason;
+    rec->status = status;
+    rec->total = fault_boot.total + 1UL;
+    rec->uptime_ms = sys_tick_ms();
+    rec->sp = sp;
+
+    rec->cfsr = SCB->CFSR;
+    rec->hfsr = SCB->HFSR;
+    rec->mmfar = SCB->MMFAR;
+    rec->bfar = SCB->BFAR;
+
+    if (NULL != fault_base)
+    {
+        rec->can_psr = canfd_errlog_read_psr(fault_base, fault_chan);
+        rec->can_ecr = CANFD_ECR(fault_base, fault_chan);
+        rec->can_ir = CANFD_IR(fault_base, fault_chan);
+        rec->can_cccr = CANFD_CCCR(fault_base, fault_chan);
+    }
+    rec->txq_depth = canfd_txq_depth();
+    rec->rxq_depth = canfd_rxq_depth();
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+    /* Stop at the top of the stack: reading past the end of RAM would fault
+     * again */
+    if ((sp <= (uint32_t)(uintptr_t)&__StackTop) && (0UL == (sp & 3UL)))
+    {
+        words = ((uint32_t)(uintptr_t)&__StackTop - sp) / 4UL;
+    }
+    if (words > FAULT_CAPTURE_STACK_WORDS)
+    {
+        words = FAULT_CAPTURE_STACK_WORDS;
+    }
+#endif
+    for (uint32_t idx = 0UL; idx < words; idx++)
+    {
+        rec->stack[idx] = stack[idx];
+    }
+    rec->stack_words = words;
+
+    rec->trace_events = trace_copy_last(rec->trace, FAULT_CAPTURE_TRACE_EVENTS);
+}
+
+/*******************************************************************************
+* Function Name: fault_capture_finish
+********************************************************************************
+* Summary:
+* Seals the record and resets the device. After FAULT_CAPTURE_MAX_RESTARTS
+* faults without reaching the bus, the device halts instead so that a fault
+* during start-up does not become a reset loop; the record stays in RAM for
+* the debugger.
+*
+*******************************************************************************/
+static void fault_capture_finish(uint32_t start)
+{
+    fault_boot.total++;
+    fault_boot.restarts++;
+    fault_boot.check = fault_boot_check();
+
+    fault_record.capture_us = cycle_count_to_us(cycle_count_now() - start);
+    fault_record.magic = FAULT_RECORD_MAGIC;
+    fault_record.checksum = fault_record_checksum();
+
+    if (fault_boot.restarts <= FAULT_CAPTURE_MAX_RESTARTS)
+    {
+        __DSB();
+        NVIC_SystemReset();
+    }
+
+    CY_ASSERT(0);
+    for (;;)
+    {
+    }
+}
+
+/*******************************************************************************
+* Function Name: fault_record_checksum
+********************************************************************************
+* Summary:
+* Rotating sum over the record up to the checksum field.
+*
+*******************************************************************************/
+static uint32_t fault_record_checksum(void)
+{
+    const uint32_t *words = (const uint32_t *)&fault_record;
+    uint32_t sum = 0UL;
+
+    for (uint32_t idx = 0UL;
+         idx < (offsetof(fault_record_t, checksum) / 4UL); idx++)
+    {
+        sum = ((sum << 1) | (sum >> 31)) + words[idx];
+    }
+    return sum;
+}
+
+static uint32_t fault_boot_check(void)
+{
+    return ~(fault_boot.magic ^ fault_boot.restarts ^ (fault_boot.total << 8));
+}
+
+/*******************************************************************************
+* Function Name: fault_report
+********************************************************************************
+* Summary:
+* Prints the fault record of the previous run and sends it as a binary log
+* record over the UART and the CAN FD bus.
+*
+*******************************************************************************/
+static void fault_report(void)
+{
+    fault_record_t *rec = &fault_record;
+
+    rec->recovery_us = fault_stats.recovery_us;
+    rec->reset_reason = fault_reset_reason;
+
+    printf("Fault %lu since power-on: %s, status 0x%08lX, at %lu ms\r\n",
+           (unsigned long)rec->total,
+           (FAULT_REASON_HARDFAULT == rec->reason) ? "hard fault" : "error",
+           (unsigned long)rec->status, (unsigned long)rec->uptime_ms);
+    printf("  pc 0x%08lX lr 0x%08lX sp 0x%08lX psr 0x%08lX\r\n",
+           (unsigned long)rec->pc, (unsigned long)rec->lr,
+           (unsigned long)rec->sp, (unsigned long)rec->psr);
+    printf("  cfsr 0x%08lX hfsr 0x%08lX mmfar 0x%08lX bfar 0x%08lX\r\n",
+           (unsigned long)rec->cfsr, (unsigned long)rec->hfsr,
+           (unsigned long)rec->mmfar, (unsigned long)rec->bfar);
+    printf("  CAN psr 0x%08lX ecr 0x%08lX ir 0x%08lX cccr 0x%08lX, "
+           "Tx queue %lu, Rx queue %lu\r\n",
+           (unsigned long)rec->can_psr, (unsigned long)rec->can_ecr,
+           (unsigned long)rec->can_ir, (unsigned long)rec->can_cccr,
+           (unsigned long)rec->txq_depth, (unsigned long)rec->rxq_depth);
+    printf("  recovery: capture %lu us, start-up to bus active %lu us, "
+           "reset reason 0x%lX\r\n\r\n",
+           (unsigned long)rec->capture_us, (unsigned long)rec->recovery_us,
+           (unsigned long)rec->reset_reason);
+
+    (void)binlog_record(BINLOG_CHANNEL_UART, BINLOG_TYPE_FAULT, rec,
+                        sizeof(*rec));
+    (void)binlog_record(BINLOG_CHANNEL_CAN, BINLOG_TYPE_FAULT, rec,
+                        sizeof(*rec));
+}
+
+/* [] END OF FILE */
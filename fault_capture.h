@@ -0,0 +1,135 @@
+/******************************************************************************
+* File Name:   fault_capture.h
+*
+* Description: Fault capture: on a hard fault or an unrecoverable error,
+*              registers, stack, recent trace events and CAN FD state are
+*              stored in no-init RAM and the device is reset; the record is
+*              reported once the channel is back on the bus.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef FAULT_CAPTURE_H_
+#define FAULT_CAPTURE_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Stack words saved from the stack pointer at the fault upwards */
+#ifndef FAULT_CAPTURE_STACK_WORDS
+#define FAULT_CAPTURE_STACK_WORDS   (32u)
+#endif
+
+/* Most recent trace events saved (TRACE_ENABLE builds) */
+#ifndef FAULT_CAPTURE_TRACE_EVENTS
+#define FAULT_CAPTURE_TRACE_EVENTS  (16u)
+#endif
+
+/* Faults in a row before the bus came up after which the device halts
+ * instead of resetting again */
+#ifndef FAULT_CAPTURE_MAX_RESTARTS
+#define FAULT_CAPTURE_MAX_RESTARTS  (3u)
+#endif
+
+/* fault_record_t.reason */
+#define FAULT_REASON_HARDFAULT      (1u)
+#define FAULT_REASON_ERROR          (2u)    /* handle_error */
+
+/* Return address of the calling function, for fault_capture_error */
+#if defined(__GNUC__)
+#define FAULT_CAPTURE_CALLER()      ((uint32_t)(uintptr_t)__builtin_return_address(0))
+#else
+#define FAULT_CAPTURE_CALLER()      (0UL)
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Kept in no-init RAM over the reset; sent as is in BINLOG_TYPE_FAULT
+ * records (little endian, no padding) */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t reason;            /* FAULT_REASON_xxx */
+    uint32_t status;            /* Result code passed to handle_error, or
+                                 * EXC_RETURN of a hard fault */
+    uint32_t total;             /* Faults since power-on, this one included */
+    uint32_t uptime_ms;         /* System tick at the fault */
+    uint32_t capture_us;        /* Fault entry to reset request */
+    uint32_t recovery_us;       /* Set on report: boot to bus active */
+    uint32_t reset_reason;      /* Set on report: Cy_SysLib_GetResetReason */
+    uint32_t r0, r1, r2, r3, r12, lr, pc, psr;
+    uint32_t cfsr, hfsr, mmfar, bfar;
+    uint32_t sp;                /* Exception frame of a hard fault, MSP of
+                                 * handle_error */
+    uint32_t can_psr, can_ecr, can_ir, can_cccr;
+    uint32_t txq_depth, rxq_depth;
+    uint32_t stack_words;
+    uint32_t stack[FAULT_CAPTURE_STACK_WORDS];
+    uint32_t trace_events;
+    trace_event_t trace[FAULT_CAPTURE_TRACE_EVENTS];
+    uint32_t checksum;
+} fault_record_t;
+
+typedef struct
+{
+    uint32_t total;             /* Faults since power-on */
+    uint32_t recovery_us;       /* This boot: fault_capture_init to bus active */
+    uint32_t capture_us;        /* Last fault: entry to reset request */
+    bool bus_active;
+} fault_capture_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool fault_capture_init(void);
+void fault_capture_attach(CANFD_Type *base, uint32_t chan);
+void fault_capture_process(void);
+uint32_t fault_capture_reset_reason(void);
+__NO_RETURN void fault_capture_error(uint32_t status, uint32_t caller);
+const fault_capture_stats_t *fault_capture_get_stats(void);
+
+#endif /* FAULT_CAPTURE_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,1040 @@
+/******************************************************************************
+* File Name:   flash_log.c
+*
+* Description: Records the received frames to the external QSPI flash: frames
+*              are batched into 4 KB pages in a RAM double buffer and
+*              programmed through SMIF from the main loop into an append-only
+*              log with a page index
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "cybsp.h"
+#include "flash_log.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+
+#if defined(CY_IP_MXSMIF) && defined(CYBSP_QSPI_SCK)
+/* Memory configuration of the kit, from the QSPI configurator */
+#include "cycfg_qspi_memslot.h"
+#define FLASH_LOG_HAVE_QSPI         (1)
+#endif
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Payload bytes of a page record */
+#define FLASH_LOG_PAYLOAD_MAX       (FLASH_LOG_PAGE_SIZE - BINLOG_HEADER_SIZE - \
+                                     BINLOG_TRAILER_SIZE)
+
+/* Largest address of the SMIF memory commands */
+#define FLASH_LOG_ADDR_BYTES_MAX    (4u)
+
+#define FLASH_LOG_ERASED_WORD       (0xFFFFFFFFUL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef enum
+{
+    FLASH_BUF_FREE,
+    FLASH_BUF_FILLING,      /* Frames are added by flash_log_frame */
+    FLASH_BUF_READY         /* Closed, waiting to be programmed */
+} flash_log_buf_state_t;
+
+typedef struct
+{
+    volatile flash_log_buf_state_t state;
+    uint32_t fill;                          /* Payload bytes */
+    flash_log_page_header_t header;
+    uint8_t record[FLASH_LOG_PAGE_SIZE];    /* Page as programmed */
+} flash_log_buf_t;
+
+typedef enum
+{
+    FLASH_OP_IDLE,
+    FLASH_OP_INDEX,         /* Index entry of the page in flash_op_buf */
+    FLASH_OP_PROGRAM,       /* Page record, one program page at a time */
+    FLASH_OP_ERASE,         /* Erase blocks up to flash_erase_end */
+    FLASH_OP_REGION         /* Region descriptor after an erase */
+} flash_log_op_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static flash_log_stats_t flash_stats;
+
+STATS_COUNTER(flash_frames, "flash_log.frames", &flash_stats.frames);
+STATS_COUNTER(flash_dropped, "flash_log.dropped", &flash_stats.dropped);
+STATS_COUNTER(flash_pages, "flash_log.pages", &flash_stats.pages);
+STATS_COUNTER(flash_errors, "flash_log.errors", &flash_stats.errors);
+STATS_GAUGE(flash_used, "flash_log.used_pages", &flash_stats.used_pages);
+
+#if defined(FLASH_LOG_HAVE_QSPI)
+static cyhal_qspi_t flash_qspi;
+static const cy_stc_smif_mem_config_t *flash_mem;
+static bool flash_ready;
+
+/* Layout of the region */
+static uint32_t flash_data_offset;
+static uint32_t flash_erase_size;
+static uint32_t flash_program_size;
+
+/* Double buffer: frames go into flash_bufs[flash_fill_idx] while
+ * flash_bufs[flash_prog_idx] is programmed */
+static flash_log_buf_t flash_bufs[2];
+static volatile uint32_t flash_fill_idx;
+static uint32_t flash_prog_idx;
+static volatile bool flash_recording;
+static uint16_t flash_session;
+static uint32_t flash_session_dropped;
+
+/* Operation in progress, main loop only */
+static flash_log_op_t flash_op;
+static flash_log_buf_t *flash_op_buf;
+static uint32_t flash_op_offset;
+static uint32_t flash_op_size;
+static uint32_t flash_op_start;
+static uint32_t flash_erase_addr;
+static uint32_t flash_erase_end;
+static uint32_t flash_dump_next;
+static uint32_t flash_dump_end;
+static binlog_channel_t flash_dump_channel;
+
+/* Programmed from these, so they must live until the transfer completes */
+static flash_log_index_t flash_index_entry;
+static flash_log_region_t flash_region;
+
+/* Data phase of the last program command completed */
+static volatile bool flash_sent = true;
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+#if defined(FLASH_LOG_HAVE_QSPI)
+static uint32_t flash_log_index_addr(uint32_t page);
+static uint32_t flash_log_page_addr(uint32_t page);
+static bool flash_log_read(uint32_t addr, void *data, uint32_t len);
+static bool flash_log_program(uint32_t addr, const void *data, uint32_t len);
+static bool flash_log_erase_block(uint32_t addr);
+static bool flash_log_busy(void);
+static void flash_log_wait(void);
+static void flash_log_sent(uint32_t event);
+static void flash_log_open(flash_log_buf_t *buf);
+static void flash_log_close(void);
+static void flash_log_begin_page(flash_log_buf_t *buf);
+static void flash_log_continue(void);
+static void flash_log_dump_page(void);
+static uint32_t flash_log_find_end(void);
+#endif
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+#if defined(FLASH_LOG_HAVE_QSPI)
+/*******************************************************************************
+* Function Name: flash_log_init
+********************************************************************************
+* Summary:
+* Initializes the QSPI interface with the memory configuration of the kit and
+* opens the log region: the index is searched for the end of the log, and a
+* blank region gets its descriptor. The HAL handles the SMIF interrupt that
+* completes the non-blocking program commands.
+*
+* Return:
+*  cy_rslt_t  HAL result, FLASH_LOG_RSLT_MEMORY if the memory does not
+*             respond or the region does not fit
+*
+*******************************************************************************/
+cy_rslt_t flash_log_init(void)
+{
+    cy_rslt_t result;
+    const cyhal_qspi_slave_pin_config_t pins =
+    {
+        .io   = { CYBSP_QSPI_D0, CYBSP_QSPI_D1, CYBSP_QSPI_D2, CYBSP_QSPI_D3,
+                  NC, NC, NC, NC },
+        .ssel = CYBSP_QSPI_SS
+    };
+    uint32_t size;
+    uint32_t align;
+    uint32_t total;
+
+    result = cyhal_qspi_init(&flash_qspi, CYBSP_QSPI_SCK, &pins,
+                             FLASH_LOG_QSPI_HZ, 0u, NULL);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    if (CY_SMIF_SUCCESS != Cy_SMIF_Memslot_Init(flash_qspi.base,
+                               (cy_stc_smif_block_config_t *)&smifBlockConfig,
+                               &flash_qspi.context))
+    {
+        cyhal_qspi_free(&flash_qspi);
+        return FLASH_LOG_RSLT_MEMORY;
+    }
+    Cy_SMIF_SetMode(flash_qspi.base, CY_SMIF_NORMAL);
+
+    flash_mem = smifMemConfigs[0];
+    flash_erase_size = flash_mem->deviceCfg->eraseSize;
+    flash_program_size = flash_mem->deviceCfg->programSize;
+    size = (0UL != FLASH_LOG_SIZE) ? FLASH_LOG_SIZE :
+           (flash_mem->deviceCfg->memSize - FLASH_LOG_OFFSET);
+
+    /* Pages start on an erase block after the index, so that erasing the
+     * index never touches a page */
+    align = (flash_erase_size > FLASH_LOG_PAGE_SIZE) ? flash_erase_size :
+            FLASH_LOG_PAGE_SIZE;
+    flash_data_offset = sizeof(flash_log_region_t) +
+                        ((size / FLASH_LOG_PAGE_SIZE) * sizeof(flash_log_index_t));
+    flash_data_offset = ((flash_data_offset + align - 1UL) / align) * align;
+
+    if ((FLASH_LOG_OFFSET + size > flash_mem->deviceCfg->memSize) ||
+        (0UL != (FLASH_LOG_OFFSET % align)) || (size <= flash_data_offset) ||
+        (flash_program_size > FLASH_LOG_PAGE_SIZE) ||
+        (0UL != (FLASH_LOG_PAGE_SIZE % flash_program_size)))
+    {
+        cyhal_qspi_free(&flash_qspi);
+        return FLASH_LOG_RSLT_MEMORY;
+    }
+    total = (size - flash_data_offset) / FLASH_LOG_PAGE_SIZE;
+    flash_stats.total_pages = total;
+
+    if (!flash_log_read(FLASH_LOG_OFFSET, &flash_region, sizeof(flash_region)))
+    {
+        cyhal_qspi_free(&flash_qspi);
+        return FLASH_LOG_RSLT_MEMORY;
+    }
+    flash_ready = true;
+
+    if (FLASH_LOG_ERASED_WORD == flash_region.magic)
+    {
+        /* Blank region */
+        flash_region.magic = FLASH_LOG_MAGIC;
+        flash_region.data_offset = flash_data_offset;
+        (void)flash_log_program(FLASH_LOG_OFFSET, &flash_region,
+                                sizeof(flash_region));
+        flash_log_wait();
+        flash_stats.used_pages = 0UL;
+    }
+    else if ((FLASH_LOG_MAGIC != flash_region.magic) ||
+             (flash_data_offset != flash_region.data_offset))
+    {
+        /* Other contents or another layout: nothing is appended until the
+         * region is erased */
+        printf("Flash log: region at 0x%08lX is not a log of this layout, "
+               "erase it first\r\n", (unsigned long)FLASH_LOG_OFFSET);
+        flash_stats.used_pages = total;
+    }
+    else
+    {
+        flash_stats.used_pages = flash_log_find_end();
+    }
+
+    printf("Flash log: %lu of %lu pages used (%lu KB)\r\n",
+           (unsigned long)flash_stats.used_pages, (unsigned long)total,
+           (unsigned long)((total * FLASH_LOG_PAGE_SIZE) / 1024UL));
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_start
+********************************************************************************
+* Summary:
+* Starts a new recording session behind the pages already in the log.
+*
+* Return:
+*  bool  false if the log is full, busy with an erase or dump, or not open
+*
+*******************************************************************************/
+bool flash_log_start(void)
+{
+    if (!flash_ready || flash_recording ||
+        (FLASH_OP_ERASE == flash_op) || (FLASH_OP_REGION == flash_op) ||
+        (flash_dump_next != flash_dump_end) ||
+        (flash_stats.used_pages >= flash_stats.total_pages))
+    {
+        return false;
+    }
+
+    flash_session++;
+    flash_session_dropped = 0UL;
+    flash_recording = true;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_stop
+********************************************************************************
+* Summary:
+* Ends the session. The page being filled is closed and programmed by
+* flash_log_process like a full one.
+*
+*******************************************************************************/
+void flash_log_stop(void)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+
+    flash_recording = false;
+    flash_log_close();
+    Cy_SysLib_ExitCriticalSection(intr);
+}
+
+/*******************************************************************************
+* Function Name: flash_log_is_recording
+*******************************************************************************/
+bool flash_log_is_recording(void)
+{
+    return flash_recording;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_erase
+********************************************************************************
+* Summary:
+* Starts erasing the blocks used by the log, from the index up to the last
+* written page, and rewrites the region descriptor. Runs in the background in
+* flash_log_process; a large log takes seconds (about 0.5 s per 256 KB).
+*
+* Return:
+*  bool  false while recording or busy
+*
+*******************************************************************************/
+bool flash_log_erase(void)
+{
+    uint32_t end;
+
+    if (!flash_ready || flash_recording || (FLASH_OP_IDLE != flash_op) ||
+        (FLASH_BUF_FREE != flash_bufs[flash_prog_idx].state) ||
+        (flash_dump_next != flash_dump_end))
+    {
+        return false;
+    }
+
+    end = flash_log_page_addr(flash_stats.used_pages) - FLASH_LOG_OFFSET;
+    end = ((end + flash_erase_size - 1UL) / flash_erase_size) *
+          flash_erase_size;
+    flash_erase_addr = FLASH_LOG_OFFSET;
+    flash_erase_end = FLASH_LOG_OFFSET + end;
+    flash_stats.used_pages = 0UL;
+    flash_op_start = cycle_count_now();
+
+    if (!flash_log_erase_block(flash_erase_addr))
+    {
+        flash_stats.errors++;
+        return false;
+    }
+    flash_op = FLASH_OP_ERASE;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_dump
+********************************************************************************
+* Summary:
+* Sends the last count pages of the log as binary log records, one page per
+* call of flash_log_process. Each record is the page as stored, so the host
+* reads a dump and a flash image the same way (scripts/flash_log.py).
+*
+* Parameters:
+*  channel    Output of the records
+*  count      Pages, 0 for FLASH_LOG_DUMP_PAGES
+*
+* Return:
+*  bool  false while recording or busy
+*
+*******************************************************************************/
+bool flash_log_dump(binlog_channel_t channel, uint32_t count)
+{
+    if (!flash_ready || flash_recording || (FLASH_OP_IDLE != flash_op) ||
+        (FLASH_BUF_FREE != flash_bufs[flash_prog_idx].state))
+    {
+        return false;
+    }
+
+    if (0UL == count)
+    {
+        count = FLASH_LOG_DUMP_PAGES;
+    }
+    if (count > flash_stats.used_pages)
+    {
+        count = flash_stats.used_pages;
+    }
+    flash_dump_channel = channel;
+    flash_dump_end = flash_stats.used_pages;
+    flash_dump_next = flash_dump_end - count;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_read_region
+********************************************************************************
+* Summary:
+* Reads the log region at offset, for a readback of the raw log. Only while
+* neither recording nor programming, and only within flash_log_used_size.
+*
+* Parameters:
+*  offset   From the start of the region (the region descriptor)
+*  data     Destination
+*  len      Bytes
+*
+* Return:
+*  bool  false if busy, out of range or the read failed
+*
+*******************************************************************************/
+bool flash_log_read_region(uint32_t offset, void *data, uint32_t len)
+{
+    if (!flash_ready || flash_recording || (FLASH_OP_IDLE != flash_op) ||
+        (offset > flash_log_used_size()) ||
+        (len > (flash_log_used_size() - offset)) || flash_log_busy())
+    {
+        return false;
+    }
+
+    return flash_log_read(FLASH_LOG_OFFSET + offset, data, len);
+}
+
+/*******************************************************************************
+* Function Name: flash_log_used_size / flash_log_data_offset
+********************************************************************************
+* Summary:
+* Size of the region up to the end of the last page, and start of the pages.
+* A copy of this part is an image for scripts/flash_log.py.
+*
+*******************************************************************************/
+uint32_t flash_log_used_size(void)
+{
+    return flash_ready ?
+           (flash_log_page_addr(flash_stats.used_pages) - FLASH_LOG_OFFSET) :
+           0UL;
+}
+
+uint32_t flash_log_data_offset(void)
+{
+    return flash_data_offset;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_frame
+********************************************************************************
+* Summary:
+* Adds a frame to the page being filled. A page is closed when the frame does
+* not fit or FLASH_LOG_PAGE_SPAN_MS after its first frame, and filling
+* continues in the other buffer. If that one is still being programmed the
+* frame is dropped and counted. Called for each received frame, from the
+* interrupt or the main loop; only copies.
+*
+* Parameters:
+*  frame    Received frame
+*
+*******************************************************************************/
+void flash_log_frame(const canfd_frame_t *frame)
+{
+    uint32_t size = FLASH_LOG_FRAME_HEADER + frame->len;
+    flash_log_buf_t *buf;
+    uint8_t *dst;
+
+    if (!flash_recording)
+    {
+        return;
+    }
+
+    buf = &flash_bufs[flash_fill_idx];
+    if ((FLASH_BUF_FILLING == buf->state) &&
+        (((buf->fill + size) > FLASH_LOG_PAYLOAD_MAX) ||
+         ((sys_tick_ms() - buf->header.time_ms) >= FLASH_LOG_PAGE_SPAN_MS)))
+    {
+        flash_log_close();
+        buf = &flash_bufs[flash_fill_idx];
+    }
+
+    if (FLASH_BUF_FREE == buf->state)
+    {
+        flash_log_open(buf);
+    }
+    else if (FLASH_BUF_FILLING != buf->state)
+    {
+        flash_stats.dropped++;
+        flash_session_dropped++;
+        return;
+    }
+
+    dst = &buf->record[BINLOG_HEADER_SIZE + buf->fill];
+    memcpy(&dst[0], &frame->timestamp, sizeof(frame->timestamp));
+    memcpy(&dst[4], &frame->id, sizeof(frame->id));
+    dst[8] = frame->flags;
+    dst[9] = frame->len;
+    memcpy(&dst[FLASH_LOG_FRAME_HEADER], frame->data, frame->len);
+    buf->fill += size;
+    buf->header.frames++;
+    flash_stats.frames++;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_process
+********************************************************************************
+* Summary:
+* Advances the flash operation in progress by at most one command and returns
+* while the memory is busy, so the main loop is never held for a program or
+* erase time. A closed page takes its index entry and one program command per
+* program page of the memory; an erase one command per block. When the memory
+* is idle, the next dump page is sent.
+*
+*******************************************************************************/
+void flash_log_process(void)
+{
+    flash_log_buf_t *buf;
+
+    if (!flash_ready || flash_log_busy())
+    {
+        return;
+    }
+
+    if (FLASH_OP_IDLE != flash_op)
+    {
+        flash_log_continue();
+        return;
+    }
+
+    buf = &flash_bufs[flash_prog_idx];
+    if (FLASH_BUF_READY == buf->state)
+    {
+        flash_log_begin_page(buf);
+    }
+    else if (flash_dump_next != flash_dump_end)
+    {
+        flash_log_dump_page();
+    }
+    else
+    {
+        /* Nothing to do */
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_log_print_stats
+*******************************************************************************/
+void flash_log_print_stats(void)
+{
+    printf("Flash log: %s, session %u, %lu of %lu pages, %lu frames, "
+           "%lu dropped, %lu errors, %lu us per page max\r\n",
+           flash_recording ? "recording" : "stopped",
+           (unsigned int)flash_session,
+           (unsigned long)flash_stats.used_pages,
+           (unsigned long)flash_stats.total_pages,
+           (unsigned long)flash_stats.frames,
+           (unsigned long)flash_stats.dropped,
+           (unsigned long)flash_stats.errors,
+           (unsigned long)flash_stats.max_page_us);
+}
+
+/*******************************************************************************
+* Function Name: flash_log_index_addr / flash_log_page_addr
+********************************************************************************
+* Summary:
+* Flash addresses of the index entry and of the record of a page.
+*
+*******************************************************************************/
+static uint32_t flash_log_index_addr(uint32_t page)
+{
+    return FLASH_LOG_OFFSET + sizeof(flash_log_region_t) +
+           (page * sizeof(flash_log_index_t));
+}
+
+static uint32_t flash_log_page_addr(uint32_t page)
+{
+    return FLASH_LOG_OFFSET + flash_data_offset +
+           (page * FLASH_LOG_PAGE_SIZE);
+}
+
+/*******************************************************************************
+* Function Name: flash_log_read
+********************************************************************************
+* Summary:
+* Blocking read with the read command of the memory configuration.
+*
+*******************************************************************************/
+static bool flash_log_read(uint32_t addr, void *data, uint32_t len)
+{
+    return (CY_SMIF_SUCCESS == Cy_SMIF_MemRead(flash_qspi.base, flash_mem,
+                                               addr, (uint8_t *)data, len,
+                                               &flash_qspi.context));
+}
+
+/*******************************************************************************
+* Function Name: flash_log_program
+********************************************************************************
+* Summary:
+* Starts programming len bytes within one program page. The data phase runs
+* from the SMIF interrupt and sets flash_sent; the program time of the memory
+* follows. Both are checked by flash_log_busy.
+*
+*******************************************************************************/
+static bool flash_log_program(uint32_t addr, const void *data, uint32_t len)
+{
+    uint8_t addr_bytes[FLASH_LOG_ADDR_BYTES_MAX];
+    uint32_t count = flash_mem->deviceCfg->numOfAddrBytes;
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        addr_bytes[idx] = (uint8_t)(addr >> (8UL * (count - 1UL - idx)));
+    }
+
+    if (CY_SMIF_SUCCESS != Cy_SMIF_MemCmdWriteEnable(flash_qspi.base,
+                                                     flash_mem,
+                                                     &flash_qspi.context))
+    {
+        return false;
+    }
+
+    flash_sent = false;
+    if (CY_SMIF_SUCCESS != Cy_SMIF_MemCmdProgram(flash_qspi.base, flash_mem,
+                                                 addr_bytes,
+                                                 (const uint8_t *)data, len,
+                                                 flash_log_sent,
+                                                 &flash_qspi.context))
+    {
+        flash_sent = true;
+        return false;
+    }
+    flash_stats.bytes += len;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_erase_block
+********************************************************************************
+* Summary:
+* Starts erasing the block at addr.
+*
+*******************************************************************************/
+static bool flash_log_erase_block(uint32_t addr)
+{
+    uint8_t addr_bytes[FLASH_LOG_ADDR_BYTES_MAX];
+    uint32_t count = flash_mem->deviceCfg->numOfAddrBytes;
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        addr_bytes[idx] = (uint8_t)(addr >> (8UL * (count - 1UL - idx)));
+    }
+
+    return (CY_SMIF_SUCCESS == Cy_SMIF_MemCmdWriteEnable(flash_qspi.base,
+                                                         flash_mem,
+                                                         &flash_qspi.context)) &&
+           (CY_SMIF_SUCCESS == Cy_SMIF_MemCmdSectorErase(flash_qspi.base,
+                                                         flash_mem,
+                                                         addr_bytes,
+                                                         &flash_qspi.context));
+}
+
+/*******************************************************************************
+* Function Name: flash_log_busy
+********************************************************************************
+* Summary:
+* True while a transfer is in progress or the memory reports a program or
+* erase in progress (one status read).
+*
+*******************************************************************************/
+static bool flash_log_busy(void)
+{
+    return (!flash_sent) || Cy_SMIF_BusyCheck(flash_qspi.base) ||
+           Cy_SMIF_MemIsBusy(flash_qspi.base, flash_mem, &flash_qspi.context);
+}
+
+/*******************************************************************************
+* Function Name: flash_log_wait
+*******************************************************************************/
+static void flash_log_wait(void)
+{
+    while (flash_log_busy())
+    {
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_log_sent
+********************************************************************************
+* Summary:
+* SMIF callback: the data of the program command is out.
+*
+*******************************************************************************/
+static void flash_log_sent(uint32_t event)
+{
+    (void)event;
+
+    flash_sent = true;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_open
+********************************************************************************
+* Summary:
+* Starts filling a free buffer. The time of the page is taken now in both
+* clocks; the host places the frames by their cycle offset from it.
+*
+*******************************************************************************/
+static void flash_log_open(flash_log_buf_t *buf)
+{
+    buf->header.session = flash_session;
+    buf->header.frames = 0u;
+    buf->header.time_ms = sys_tick_ms();
+    buf->header.cycles = cycle_count_now();
+    buf->header.clock_hz = SystemCoreClock;
+    buf->fill = sizeof(flash_log_page_header_t);
+    buf->state = FLASH_BUF_FILLING;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_close
+********************************************************************************
+* Summary:
+* Hands the page being filled, if any, to flash_log_process and switches to
+* the other buffer. Interrupts disabled or called from the context that adds
+* the frames.
+*
+*******************************************************************************/
+static void flash_log_close(void)
+{
+    flash_log_buf_t *buf = &flash_bufs[flash_fill_idx];
+
+    if (FLASH_BUF_FILLING == buf->state)
+    {
+        buf->state = FLASH_BUF_READY;
+        flash_fill_idx ^= 1UL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_log_begin_page
+********************************************************************************
+* Summary:
+* Completes the header of a closed page, frames it as a binary log record and
+* programs its index entry. The entry goes first, so a page cut short by a
+* reset is still skipped by the next append and found damaged (bad CRC) by
+* the host.
+*
+*******************************************************************************/
+static void flash_log_begin_page(flash_log_buf_t *buf)
+{
+    uint32_t page = flash_stats.used_pages;
+
+    flash_op_start = cycle_count_now();
+
+    if (page >= flash_stats.total_pages)
+    {
+        /* Full: the session ends here */
+        flash_log_stop();
+        flash_stats.dropped += buf->header.frames;
+        buf->state = FLASH_BUF_FREE;
+        flash_prog_idx ^= 1UL;
+        return;
+    }
+
+    buf->header.page = page;
+    buf->header.dropped = flash_session_dropped;
+    memcpy(&buf->record[BINLOG_HEADER_SIZE], &buf->header,
+           sizeof(buf->header));
+    flash_op_size = binlog_seal(buf->record, BINLOG_TYPE_CAPTURE, buf->fill);
+
+    flash_index_entry.time_ms = buf->header.time_ms;
+    flash_index_entry.session = buf->header.session;
+    flash_index_entry.frames = buf->header.frames;
+
+    flash_op_buf = buf;
+    flash_op_offset = 0UL;
+    flash_stats.used_pages = page + 1UL;
+    if (flash_log_program(flash_log_index_addr(page), &flash_index_entry,
+                          sizeof(flash_index_entry)))
+    {
+        flash_op = FLASH_OP_INDEX;
+    }
+    else
+    {
+        flash_stats.errors++;
+        buf->state = FLASH_BUF_FREE;
+        flash_prog_idx ^= 1UL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_log_continue
+********************************************************************************
+* Summary:
+* Issues the next command of the operation in progress, the memory being
+* idle. A failed command abandons the page (or the erase) and is counted.
+*
+*******************************************************************************/
+static void flash_log_continue(void)
+{
+    bool ok = true;
+    uint32_t us;
+
+    switch (flash_op)
+    {
+        case FLASH_OP_INDEX:
+        case FLASH_OP_PROGRAM:
+            if (flash_op_offset < flash_op_size)
+            {
+                uint32_t len = flash_op_size - flash_op_offset;
+
+                if (len > flash_program_size)
+                {
+                    len = flash_program_size;
+                }
+                ok = flash_log_program(
+                         flash_log_page_addr(flash_op_buf->header.page) +
+                         flash_op_offset,
+                         &flash_op_buf->record[flash_op_offset], len);
+                flash_op_offset += len;
+                flash_op = FLASH_OP_PROGRAM;
+                if (ok)
+                {
+                    break;
+                }
+            }
+
+            /* Page done (or abandoned): its buffer takes frames again */
+            flash_op_buf->state = FLASH_BUF_FREE;
+            flash_prog_idx ^= 1UL;
+            flash_op = FLASH_OP_IDLE;
+            if (ok)
+            {
+                flash_stats.pages++;
+                us = cycle_count_to_us(cycle_count_now() - flash_op_start);
+                if (us > flash_stats.max_page_us)
+                {
+                    flash_stats.max_page_us = us;
+                }
+            }
+            break;
+
+        case FLASH_OP_ERASE:
+            flash_erase_addr += flash_erase_size;
+            if (flash_erase_addr < flash_erase_end)
+            {
+                ok = flash_log_erase_block(flash_erase_addr);
+                break;
+            }
+            flash_region.magic = FLASH_LOG_MAGIC;
+            flash_region.data_offset = flash_data_offset;
+            ok = flash_log_program(FLASH_LOG_OFFSET, &flash_region,
+                                   sizeof(flash_region));
+            flash_op = FLASH_OP_REGION;
+            break;
+
+        case FLASH_OP_REGION:
+            printf("Flash log: erased in %lu ms\r\n",
+                   (unsigned long)(cycle_count_to_us(cycle_count_now() -
+                                                     flash_op_start) / 1000UL));
+            flash_op = FLASH_OP_IDLE;
+            break;
+
+        default:
+            flash_op = FLASH_OP_IDLE;
+            break;
+    }
+
+    if (!ok)
+    {
+        flash_stats.errors++;
+        if (FLASH_OP_IDLE != flash_op)
+        {
+            flash_op = FLASH_OP_IDLE;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_log_dump_page
+********************************************************************************
+* Summary:
+* Reads the next page of the dump and sends it. A page whose CRC does not
+* match (cut short by a reset) is skipped and counted as an error.
+*
+*******************************************************************************/
+static void flash_log_dump_page(void)
+{
+    uint8_t *record = flash_bufs[flash_prog_idx].record;
+    uint32_t len;
+    uint8_t crc[BINLOG_TRAILER_SIZE];
+
+    if (flash_log_read(flash_log_page_addr(flash_dump_next), record,
+                       FLASH_LOG_PAGE_SIZE))
+    {
+        len = (uint32_t)record[2] | ((uint32_t)record[3] << 8);
+        if ((BINLOG_SYNC == record[0]) && (BINLOG_TYPE_CAPTURE == record[1]) &&
+            (len <= FLASH_LOG_PAYLOAD_MAX))
+        {
+            /* Recompute the CRC in place and compare */
+            memcpy(crc, &record[BINLOG_HEADER_SIZE + len], sizeof(crc));
+            (void)binlog_seal(record, BINLOG_TYPE_CAPTURE, len);
+            if (0 == memcmp(crc, &record[BINLOG_HEADER_SIZE + len],
+                            sizeof(crc)))
+            {
+                (void)binlog_record(flash_dump_channel, BINLOG_TYPE_CAPTURE,
+                                    &record[BINLOG_HEADER_SIZE], len);
+                flash_dump_next++;
+                return;
+            }
+        }
+    }
+
+    flash_stats.errors++;
+    flash_dump_next++;
+}
+
+/*******************************************************************************
+* Function Name: flash_log_find_end
+********************************************************************************
+* Summary:
+* Binary search of the index for the first erased entry, which is the next
+* page to write; the session number continues from the entry before it.
+*
+*******************************************************************************/
+static uint32_t flash_log_find_end(void)
+{
+    uint32_t low = 0UL;
+    uint32_t high = flash_stats.total_pages;
+    flash_log_index_t entry;
+
+    while (low < high)
+    {
+        uint32_t mid = low + ((high - low) / 2UL);
+
+        if (flash_log_read(flash_log_index_addr(mid), &entry, sizeof(entry)) &&
+            (FLASH_LOG_ERASED_WORD == entry.time_ms) &&
+            (0xFFFFu == entry.session))
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1UL;
+        }
+    }
+
+    if ((0UL != low) &&
+        flash_log_read(flash_log_index_addr(low - 1UL), &entry, sizeof(entry)))
+    {
+        flash_session = entry.session;
+    }
+    return low;
+}
+
+#else /* FLASH_LOG_HAVE_QSPI */
+
+cy_rslt_t flash_log_init(void)
+{
+    return FLASH_LOG_RSLT_NO_SMIF;
+}
+
+bool flash_log_start(void)
+{
+    return false;
+}
+
+void flash_log_stop(void)
+{
+}
+
+bool flash_log_is_recording(void)
+{
+    return false;
+}
+
+bool flash_log_erase(void)
+{
+    return false;
+}
+
+bool flash_log_dump(binlog_channel_t channel, uint32_t count)
+{
+    (void)channel;
+    (void)count;
+    return false;
+}
+
+bool flash_log_read_region(uint32_t offset, void *data, uint32_t len)
+{
+    (void)offset;
+    (void)data;
+    (void)len;
+    return false;
+}
+
+uint32_t flash_log_used_size(void)
+{
+    return 0UL;
+}
+
+uint32_t flash_log_data_offset(void)
+{
+    return 0UL;
+}
+
+void flash_log_frame(const canfd_frame_t *frame)
+{
+    (void)frame;
+}
+
+void flash_log_process(void)
+{
+}
+
+void flash_log_print_stats(void)
+{
+    printf("Flash log: no QSPI memory on this kit\r\n");
+}
+
+#endif /* FLASH_LOG_HAVE_QSPI */
+
+/*******************************************************************************
+* Function Name: flash_log_get_stats
+*******************************************************************************/
+const flash_log_stats_t *flash_log_get_stats(void)
+{
+    return &flash_stats;
+}
+
+/* [] END OF FILE */
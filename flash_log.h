@@ -0,0 +1,159 @@
+/******************************************************************************
+* File Name:   flash_log.h
+*
+* Description: Long captures of the received frames to the external QSPI flash
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef FLASH_LOG_H_
+#define FLASH_LOG_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cyhal.h"
+#include "canfd_frame.h"
+#include "binlog.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Part of the external flash used by the log. The offset must be a multiple
+ * of the erase block size and outside a hybrid (parameter sector) region;
+ * a size of 0 uses the rest of the device. */
+#ifndef FLASH_LOG_OFFSET
+#define FLASH_LOG_OFFSET            (0UL)
+#endif
+#ifndef FLASH_LOG_SIZE
+#define FLASH_LOG_SIZE              (0UL)
+#endif
+
+/* SMIF clock */
+#ifndef FLASH_LOG_QSPI_HZ
+#define FLASH_LOG_QSPI_HZ           (50000000UL)
+#endif
+
+/* A page is closed after this time so that the cycle timestamps of its
+ * frames stay unambiguous */
+#ifndef FLASH_LOG_PAGE_SPAN_MS
+#define FLASH_LOG_PAGE_SPAN_MS      (10000UL)
+#endif
+
+/* Pages sent by flash_log_dump when no count is given */
+#ifndef FLASH_LOG_DUMP_PAGES
+#define FLASH_LOG_DUMP_PAGES        (16UL)
+#endif
+
+/* A log page is one binary log record of type BINLOG_TYPE_CAPTURE, padded
+ * with erased bytes to the page size:
+ *   flash_log_page_header_t
+ *   per frame: timestamp (cycles, u32), id (u32), flags (u8), len (u8), data
+ * The index in front of the pages holds the region descriptor followed by
+ * one flash_log_index_t per page, written before the page itself. */
+#define FLASH_LOG_PAGE_SIZE         (4096UL)
+#define FLASH_LOG_FRAME_HEADER      (10UL)
+#define FLASH_LOG_MAGIC             (0x474F4C43UL)  /* "CLOG" */
+
+#define FLASH_LOG_RSLT_NO_SMIF              \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 6u))
+#define FLASH_LOG_RSLT_MEMORY               \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 7u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Start of the record payload of every page */
+typedef struct
+{
+    uint32_t page;          /* Page number in the region */
+    uint16_t session;       /* Incremented by every flash_log_start */
+    uint16_t frames;
+    uint32_t time_ms;       /* sys_tick_ms when the first frame was added */
+    uint32_t cycles;        /* Cycle count at the same time */
+    uint32_t clock_hz;      /* SystemCoreClock */
+    uint32_t dropped;       /* Frames lost in the session so far */
+} flash_log_page_header_t;
+
+/* Entry 0 of the index: where the pages start */
+typedef struct
+{
+    uint32_t magic;         /* FLASH_LOG_MAGIC */
+    uint32_t data_offset;   /* First page, from the start of the region */
+} flash_log_region_t;
+
+/* Index entry of a page; an erased entry ends the log */
+typedef struct
+{
+    uint32_t time_ms;
+    uint16_t session;
+    uint16_t frames;
+} flash_log_index_t;
+
+typedef struct
+{
+    uint32_t frames;        /* Frames stored */
+    uint32_t dropped;       /* Frames lost: both page buffers busy */
+    uint32_t pages;         /* Pages written */
+    uint32_t bytes;         /* Bytes programmed */
+    uint32_t errors;        /* Failed commands, damaged pages in a dump */
+    uint32_t used_pages;    /* Pages in the log */
+    uint32_t total_pages;   /* Capacity of the region */
+    uint32_t max_page_us;   /* Longest index, CRC and program of a page */
+} flash_log_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t flash_log_init(void);
+bool flash_log_start(void);
+void flash_log_stop(void);
+bool flash_log_is_recording(void);
+bool flash_log_erase(void);
+bool flash_log_dump(binlog_channel_t channel, uint32_t count);
+bool flash_log_read_region(uint32_t offset, void *data, uint32_t len);
+uint32_t flash_log_used_size(void);
+uint32_t flash_log_data_offset(void);
+void flash_log_frame(const canfd_frame_t *frame);
+void flash_log_process(void);
+void flash_log_print_stats(void);
+const flash_log_stats_t *flash_log_get_stats(void);
+
+#endif /* FLASH_LOG_H_ */
+
+/* [] END OF FILE */
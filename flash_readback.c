@@ -0,0 +1,576 @@
+/******************************************************************************
+* File Name:   flash_readback.c
+*
+* Description: Streams a byte range of the flash log over CAN FD. The host
+*              acknowledges with the next missing frame and a bitmap of the
+*              frames behind it; missing frames are sent again selectively and
+*              the window adapts to the losses.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "flash_readback.h"
+#include "flash_log.h"
+#include "canfd_txq.h"
+#include "stats_registry.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Commands taken from the receive path, served by flash_readback_process */
+#define READBACK_PENDING_START      (0x01u)
+#define READBACK_PENDING_ACK        (0x02u)
+#define READBACK_PENDING_ABORT      (0x04u)
+
+/* Payload lengths of the commands and status frames */
+#define READBACK_START_LEN          (10u)
+#define READBACK_ACK_LEN            (7u)
+#define READBACK_STARTED_LEN        (20u)
+#define READBACK_DONE_LEN           (18u)
+
+/* Frames reported by the bitmap of an acknowledgement */
+#define READBACK_ACK_BITS           (32u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static flash_readback_stats_t readback_stats;
+
+STATS_COUNTER(readback_frames, "readback.frames", &readback_stats.frames);
+STATS_COUNTER(readback_retransmits, "readback.retransmits",
+              &readback_stats.retransmits);
+STATS_COUNTER(readback_timeouts, "readback.timeouts",
+              &readback_stats.timeouts);
+STATS_GAUGE(readback_window, "readback.window", &readback_stats.window);
+STATS_GAUGE(readback_goodput, "readback.goodput", &readback_stats.goodput);
+
+/* Last command of each kind; the fields are copied with interrupts off */
+static volatile uint8_t readback_pending;
+static uint32_t readback_req_offset;
+static uint32_t readback_req_length;
+static uint8_t readback_req_window;
+static uint16_t readback_ack_next;
+static uint32_t readback_ack_bitmap;
+
+/* Transfer in progress, main loop only. Bit i of the bitmaps is frame
+ * readback_base + i. */
+static bool readback_active;
+static uint32_t readback_offset;
+static uint32_t readback_length;
+static uint32_t readback_total;         /* Frames */
+static uint32_t readback_base;          /* First unacknowledged frame */
+static uint32_t readback_next;          /* First frame never sent */
+static uint32_t readback_max_window;    /* Window of the host */
+static uint64_t readback_acked;
+static uint64_t readback_resend;        /* Lost, to be sent again */
+static uint64_t readback_resent;        /* Sent again since the last timeout */
+static uint32_t readback_start_ms;
+static uint32_t readback_progress_ms;   /* Last move of the window */
+static uint32_t readback_retry_ms;      /* Last move or timeout */
+static uint32_t readback_frames_sent;
+static uint32_t readback_frames_resent;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void readback_start(uint32_t offset, uint32_t length, uint8_t window);
+static void readback_ack(uint16_t next, uint32_t bitmap);
+static void readback_finish(uint8_t result);
+static bool readback_send(uint32_t seq);
+static void readback_status(const uint8_t *payload, uint32_t len);
+static uint64_t readback_mask(uint32_t count);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: flash_readback_rx_frame
+********************************************************************************
+* Summary:
+* Takes a command frame (FLASH_READBACK_CMD_ID) out of the receive path. Safe
+* in interrupt context; the command is served by flash_readback_process.
+*
+* Return:
+*  bool  true if the frame was a readback command
+*
+*******************************************************************************/
+bool flash_readback_rx_frame(const canfd_frame_t *frame)
+{
+    const uint8_t *bytes = (const uint8_t *)frame->data;
+
+    if ((FLASH_READBACK_CMD_ID != frame->id) ||
+        (0U != (frame->flags & CANFD_FRAME_FLAG_XTD)))
+    {
+        return false;
+    }
+    if (0U == frame->len)
+    {
+        return true;
+    }
+
+    switch (bytes[0])
+    {
+        case FLASH_READBACK_CMD_START:
+            if (frame->len >= READBACK_START_LEN)
+            {
+                memcpy(&readback_req_offset, &bytes[1], sizeof(uint32_t));
+                memcpy(&readback_req_length, &bytes[5], sizeof(uint32_t));
+                readback_req_window = bytes[9];
+                readback_pending |= READBACK_PENDING_START;
+            }
+            break;
+
+        case FLASH_READBACK_CMD_ACK:
+            if (frame->len >= READBACK_ACK_LEN)
+            {
+                memcpy(&readback_ack_next, &bytes[1], sizeof(uint16_t));
+                memcpy(&readback_ack_bitmap, &bytes[3], sizeof(uint32_t));
+                readback_pending |= READBACK_PENDING_ACK;
+            }
+            break;
+
+        case FLASH_READBACK_CMD_ABORT:
+            readback_pending |= READBACK_PENDING_ABORT;
+            break;
+
+        default:
+            break;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: flash_readback_process
+********************************************************************************
+* Summary:
+* Serves the commands and keeps the window full: lost frames first, then new
+* ones, as long as the Tx queue has room beyond FLASH_READBACK_TXQ_RESERVE.
+* The bus paces the transfer through the Tx queue; the congestion window
+* limits it to what the host takes without losses.
+*
+*******************************************************************************/
+void flash_readback_process(void)
+{
+    uint32_t intr;
+    uint8_t pending;
+    uint32_t offset;
+    uint32_t length;
+    uint8_t window;
+    uint16_t ack_next;
+    uint32_t ack_bitmap;
+    uint32_t now;
+
+    intr = Cy_SysLib_EnterCriticalSection();
+    pending = readback_pending;
+    readback_pending = 0U;
+    offset = readback_req_offset;
+    length = readback_req_length;
+    window = readback_req_window;
+    ack_next = readback_ack_next;
+    ack_bitmap = readback_ack_bitmap;
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    if (0U != (pending & READBACK_PENDING_ABORT))
+    {
+        if (readback_active)
+        {
+            readback_finish(FLASH_READBACK_ABORTED);
+        }
+        return;
+    }
+    if (0U != (pending & READBACK_PENDING_START))
+    {
+        readback_start(offset, length, window);
+    }
+    if (!readback_active)
+    {
+        return;
+    }
+    if (0U != (pending & READBACK_PENDING_ACK))
+    {
+        readback_ack(ack_next, ack_bitmap);
+    }
+    if (readback_base >= readback_total)
+    {
+        readback_finish(FLASH_READBACK_OK);
+        return;
+    }
+
+    now = sys_tick_ms();
+    if ((now - readback_progress_ms) >= FLASH_READBACK_ABORT_MS)
+    {
+        readback_finish(FLASH_READBACK_TIMEOUT);
+        return;
+    }
+    if ((readback_next != readback_base) &&
+        ((now - readback_retry_ms) >= FLASH_READBACK_TIMEOUT_MS))
+    {
+        /* No progress: the oldest frame is sent again from a small window.
+         * The acknowledgement it brings shows what else is missing, and the
+         * lost frames may be sent once more. */
+        readback_resend |= 1ULL;
+        readback_resent = 0ULL;
+        readback_stats.window = FLASH_READBACK_MIN_WINDOW;
+        readback_stats.timeouts++;
+        readback_retry_ms = now;
+    }
+
+    while (canfd_txq_space() > FLASH_READBACK_TXQ_RESERVE)
+    {
+        uint32_t seq;
+
+        if (0ULL != readback_resend)
+        {
+            uint32_t bit = 0UL;
+
+            while (0ULL == (readback_resend & (1ULL << bit)))
+            {
+                bit++;
+            }
+            seq = readback_base + bit;
+            readback_resend &= ~(1ULL << bit);
+            readback_resent |= (1ULL << bit);
+            readback_frames_resent++;
+            readback_stats.retransmits++;
+        }
+        else if ((readback_next < readback_total) &&
+                 ((readback_next - readback_base) < readback_stats.window))
+        {
+            seq = readback_next;
+            readback_next++;
+        }
+        else
+        {
+            break;
+        }
+
+        if (!readback_send(seq))
+        {
+            readback_finish(FLASH_READBACK_READ_ERROR);
+            return;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: flash_readback_print_stats
+*******************************************************************************/
+void flash_readback_print_stats(void)
+{
+    printf("Readback: %lu transfers, %lu frames, %lu retransmitted, "
+           "%lu timeouts, window %lu, last %lu bytes/s\r\n",
+           (unsigned long)readback_stats.transfers,
+           (unsigned long)readback_stats.frames,
+           (unsigned long)readback_stats.retransmits,
+           (unsigned long)readback_stats.timeouts,
+           (unsigned long)readback_stats.window,
+           (unsigned long)readback_stats.goodput);
+}
+
+/*******************************************************************************
+* Function Name: flash_readback_get_stats
+*******************************************************************************/
+const flash_readback_stats_t *flash_readback_get_stats(void)
+{
+    return &readback_stats;
+}
+
+/*******************************************************************************
+* Function Name: readback_start
+********************************************************************************
+* Summary:
+* Starts a transfer of length bytes of the log region from offset (a new
+* START replaces a transfer in progress) and answers with STARTED, which
+* carries the layout of the log so that the host can ask for the index first
+* and then for selected pages.
+*
+*******************************************************************************/
+static void readback_start(uint32_t offset, uint32_t length, uint8_t window)
+{
+    uint8_t status[READBACK_STARTED_LEN];
+    uint32_t used = flash_log_used_size();
+    uint32_t value;
+    uint8_t result = FLASH_READBACK_OK;
+
+    if ((0UL == length) && (offset < used))
+    {
+        length = used - offset;
+    }
+
+    if ((offset > used) || (0UL == length) || (length > (used - offset)))
+    {
+        result = FLASH_READBACK_RANGE;
+    }
+    else if (flash_log_is_recording() ||
+             !flash_log_read_region(offset, status, 1UL))   /* Log idle */
+    {
+        result = FLASH_READBACK_BUSY;
+    }
+    else
+    {
+        readback_active = true;
+        readback_offset = offset;
+        readback_length = length;
+        readback_total = (length + FLASH_READBACK_CHUNK - 1UL) /
+                         FLASH_READBACK_CHUNK;
+        readback_base = 0UL;
+        readback_next = 0UL;
+        readback_acked = 0ULL;
+        readback_resend = 0ULL;
+        readback_resent = 0ULL;
+        readback_max_window = ((0U == window) ||
+                               (window > FLASH_READBACK_MAX_WINDOW)) ?
+                              FLASH_READBACK_MAX_WINDOW : window;
+        readback_stats.window = (readback_max_window > 16UL) ?
+                                (readback_max_window / 2UL) :
+                                readback_max_window;
+        readback_start_ms = sys_tick_ms();
+        readback_progress_ms = readback_start_ms;
+        readback_retry_ms = readback_start_ms;
+        readback_frames_sent = 0UL;
+        readback_frames_resent = 0UL;
+    }
+
+    status[0] = FLASH_READBACK_STS_STARTED;
+    status[1] = result;
+    status[2] = (uint8_t)FLASH_READBACK_CHUNK;
+    status[3] = 0U;
+    memcpy(&status[4], &offset, sizeof(uint32_t));
+    memcpy(&status[8], &length, sizeof(uint32_t));
+    value = flash_log_data_offset();
+    memcpy(&status[12], &value, sizeof(uint32_t));
+    value = flash_log_get_stats()->used_pages;
+    memcpy(&status[16], &value, sizeof(uint32_t));
+    readback_status(status, sizeof(status));
+}
+
+/*******************************************************************************
+* Function Name: readback_ack
+********************************************************************************
+* Summary:
+* Applies an acknowledgement. The window moves to the next missing frame and
+* the bitmap marks the frames received behind it. Unacknowledged frames below
+* the highest acknowledged one are lost: they are sent again (once per
+* timeout period) and the window halves. A clean acknowledgement grows the
+* window by one frame.
+*
+*******************************************************************************/
+static void readback_ack(uint16_t next, uint32_t bitmap)
+{
+    uint32_t cum = readback_base +
+                   (uint32_t)(int32_t)(int16_t)(uint16_t)(next -
+                                                (uint16_t)readback_base);
+    uint32_t shift;
+    uint64_t lost;
+    uint32_t highest;
+
+    if ((cum < readback_base) || (cum > readback_next))
+    {
+        /* Stale or invalid */
+        return;
+    }
+
+    shift = cum - readback_base;
+    if (0UL != shift)
+    {
+        readback_acked = (shift < 64UL) ? (readback_acked >> shift) : 0ULL;
+        readback_resend = (shift < 64UL) ? (readback_resend >> shift) : 0ULL;
+        readback_resent = (shift < 64UL) ? (readback_resent >> shift) : 0ULL;
+        readback_base = cum;
+        readback_progress_ms = sys_tick_ms();
+        readback_retry_ms = readback_progress_ms;
+    }
+
+    if (0UL == bitmap)
+    {
+        if ((0UL != shift) && (readback_stats.window < readback_max_window))
+        {
+            readback_stats.window++;
+        }
+        return;
+    }
+
+    /* Frame base + 1 + i received */
+    readback_acked |= ((uint64_t)bitmap << 1);
+    readback_acked &= readback_mask(readback_next - readback_base);
+    if (0ULL == readback_acked)
+    {
+        return;
+    }
+
+    highest = (0UL != (uint32_t)(readback_acked >> 32)) ?
+              (63UL - (uint32_t)__CLZ((uint32_t)(readback_acked >> 32))) :
+              (31UL - (uint32_t)__CLZ((uint32_t)readback_acked));
+    lost = readback_mask(highest) & ~readback_acked & ~readback_resent;
+    if (0ULL != lost)
+    {
+        readback_resend |= lost;
+        readback_stats.window /= 2UL;
+        if (readback_stats.window < FLASH_READBACK_MIN_WINDOW)
+        {
+            readback_stats.window = FLASH_READBACK_MIN_WINDOW;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: readback_finish
+********************************************************************************
+* Summary:
+* Ends the transfer and reports it with DONE and on the terminal. The goodput
+* counts each byte of the range once, over the time from START to the last
+* acknowledgement.
+*
+*******************************************************************************/
+static void readback_finish(uint8_t result)
+{
+    uint8_t status[READBACK_DONE_LEN];
+    uint32_t ms = sys_tick_ms() - readback_start_ms;
+    uint32_t us = ms * 1000UL;
+    uint32_t goodput = 0UL;
+
+    readback_active = false;
+    if ((FLASH_READBACK_OK == result) && (0UL != ms))
+    {
+        goodput = (uint32_t)(((uint64_t)readback_length * 1000ULL) / ms);
+        readback_stats.goodput = goodput;
+        readback_stats.transfers++;
+    }
+
+    status[0] = FLASH_READBACK_STS_DONE;
+    status[1] = result;
+    memcpy(&status[2], &readback_frames_sent, sizeof(uint32_t));
+    memcpy(&status[6], &readback_frames_resent, sizeof(uint32_t));
+    memcpy(&status[10], &us, sizeof(uint32_t));
+    memcpy(&status[14], &goodput, sizeof(uint32_t));
+    readback_status(status, sizeof(status));
+
+    printf("Readback: %lu bytes in %lu ms, %lu frames (%lu again), "
+           "%lu bytes/s, result %u\r\n",
+           (unsigned long)readback_length, (unsigned long)ms,
+           (unsigned long)readback_frames_sent,
+           (unsigned long)readback_frames_resent, (unsigned long)goodput,
+           (unsigned int)result);
+}
+
+/*******************************************************************************
+* Function Name: readback_send
+********************************************************************************
+* Summary:
+* Queues data frame seq, read straight from the flash into the Tx queue slot;
+* a frame sent again is read again, so the node keeps no copy of the window.
+*
+* Return:
+*  bool  false if the flash cannot be read
+*
+*******************************************************************************/
+static bool readback_send(uint32_t seq)
+{
+    uint32_t pos = seq * FLASH_READBACK_CHUNK;
+    uint32_t len = readback_length - pos;
+    canfd_frame_t *frame = canfd_txq_alloc();
+    uint8_t *bytes;
+    uint32_t frame_len;
+
+    if (NULL == frame)
+    {
+        /* Counted as sent; the host reports it missing */
+        return true;
+    }
+
+    if (len > FLASH_READBACK_CHUNK)
+    {
+        len = FLASH_READBACK_CHUNK;
+    }
+    bytes = canfd_frame_bytes(frame);
+    if (!flash_log_read_region(readback_offset + pos,
+                               &bytes[FLASH_READBACK_SEQ_SIZE], len))
+    {
+        return false;
+    }
+
+    frame_len = canfd_dlc_to_len(canfd_len_to_dlc(FLASH_READBACK_SEQ_SIZE +
+                                                  len));
+    bytes[0] = (uint8_t)seq;
+    bytes[1] = (uint8_t)(seq >> 8);
+    memset(&bytes[FLASH_READBACK_SEQ_SIZE + len], 0,
+           frame_len - FLASH_READBACK_SEQ_SIZE - len);
+    frame->id = FLASH_READBACK_DATA_ID;
+    frame->flags = CANFD_FRAME_FLAG_FDF | CANFD_FRAME_FLAG_BRS;
+    frame->len = (uint8_t)frame_len;
+    canfd_txq_commit();
+
+    readback_frames_sent++;
+    readback_stats.frames++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: readback_status
+*******************************************************************************/
+static void readback_status(const uint8_t *payload, uint32_t len)
+{
+    canfd_frame_t frame;
+    uint32_t frame_len = canfd_dlc_to_len(canfd_len_to_dlc(len));
+
+    frame.id = FLASH_READBACK_STATUS_ID;
+    frame.flags = CANFD_FRAME_FLAG_FDF | CANFD_FRAME_FLAG_BRS;
+    frame.len = (uint8_t)frame_len;
+    memset(frame.data, 0, sizeof(frame.data));
+    memcpy(frame.data, payload, len);
+    (void)canfd_txq_push(&frame);
+}
+
+/*******************************************************************************
+* Function Name: readback_mask
+********************************************************************************
+* Summary:
+* Bitmap of the first count frames of the window.
+*
+*******************************************************************************/
+static uint64_t readback_mask(uint32_t count)
+{
+    return (count >= 64UL) ? ~0ULL : ((1ULL << count) - 1ULL);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,136 @@
+/******************************************************************************
+* File Name:   flash_readback.h
+*
+* Description: Readback of the flash log over CAN FD with a windowed,
+*              selectively acknowledged transfer
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef FLASH_READBACK_H_
+#define FLASH_READBACK_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Identifiers: commands from the host, data and status from the node */
+#ifndef FLASH_READBACK_CMD_ID
+#define FLASH_READBACK_CMD_ID       (0x7E0u)
+#endif
+#define FLASH_READBACK_DATA_ID      (FLASH_READBACK_CMD_ID + 1u)
+#define FLASH_READBACK_STATUS_ID    (FLASH_READBACK_CMD_ID + 2u)
+
+/* Data frame: 16-bit sequence number (LE), then up to 62 bytes of the
+ * region. Frame n carries the bytes from offset + n * 62. */
+#define FLASH_READBACK_SEQ_SIZE     (2u)
+#define FLASH_READBACK_CHUNK        (CANFD_FRAME_MAX_LEN - FLASH_READBACK_SEQ_SIZE)
+
+/* Frames in flight: the host's window caps the congestion window, which
+ * grows by one per clean acknowledgement and halves on a loss */
+#define FLASH_READBACK_MAX_WINDOW   (64u)
+#ifndef FLASH_READBACK_MIN_WINDOW
+#define FLASH_READBACK_MIN_WINDOW   (4u)
+#endif
+
+/* Without progress, the oldest unacknowledged frame is sent again after the
+ * timeout and the transfer is abandoned after the abort time */
+#ifndef FLASH_READBACK_TIMEOUT_MS
+#define FLASH_READBACK_TIMEOUT_MS   (50u)
+#endif
+#ifndef FLASH_READBACK_ABORT_MS
+#define FLASH_READBACK_ABORT_MS     (2000u)
+#endif
+
+/* Tx queue slots left to the other senders */
+#ifndef FLASH_READBACK_TXQ_RESERVE
+#define FLASH_READBACK_TXQ_RESERVE  (8u)
+#endif
+
+/* Commands, byte 0 of a FLASH_READBACK_CMD_ID frame:
+ *   START  offset (u32), length (u32, 0 for the rest of the log), window (u8)
+ *   ACK    next missing frame (u16), bitmap (u32) of frames next + 1 ...
+ *   ABORT */
+#define FLASH_READBACK_CMD_START    (0x01u)
+#define FLASH_READBACK_CMD_ACK      (0x02u)
+#define FLASH_READBACK_CMD_ABORT    (0x03u)
+
+/* Status, byte 0 of a FLASH_READBACK_STATUS_ID frame:
+ *   STARTED  result (u8), chunk (u16), offset (u32), length (u32),
+ *            log data offset (u32), log pages (u32)
+ *   DONE     result (u8), frames sent (u32), retransmitted (u32),
+ *            duration in us (u32), goodput in bytes/s (u32) */
+#define FLASH_READBACK_STS_STARTED  (0x81u)
+#define FLASH_READBACK_STS_DONE     (0x82u)
+
+/* Results */
+#define FLASH_READBACK_OK           (0u)
+#define FLASH_READBACK_BUSY         (1u)    /* Log recording or programming */
+#define FLASH_READBACK_RANGE        (2u)    /* Outside the written log */
+#define FLASH_READBACK_ABORTED      (3u)
+#define FLASH_READBACK_TIMEOUT      (4u)
+#define FLASH_READBACK_READ_ERROR   (5u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t transfers;     /* Transfers completed */
+    uint32_t frames;        /* Data frames sent, retransmissions included */
+    uint32_t retransmits;   /* Frames sent again */
+    uint32_t timeouts;      /* Windows sent again after a timeout */
+    uint32_t window;        /* Current congestion window */
+    uint32_t goodput;       /* Bytes/s of the last transfer */
+} flash_readback_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool flash_readback_rx_frame(const canfd_frame_t *frame);
+void flash_readback_process(void);
+void flash_readback_print_stats(void);
+const flash_readback_stats_t *flash_readback_get_stats(void);
+
+#endif /* FLASH_READBACK_H_ */
+
+/* [] END OF FILE */
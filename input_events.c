@@ -0,0 +1,471 @@
+/******************************************************************************
+* File Name:   input_events.c
+*
+* Description: Debounced input events. The GPIO interrupt only timestamps edges
+*              into a lock-free queue. The 1 ms system tick consumes the edges,
+*              restarts a debounce period on every edge and accepts the new
+*              level once it was stable for INPUT_DEBOUNCE_MS. The accepted
+*              transitions drive a gesture detector (press, release, multi-
+*              click, long press) whose events go through a second lock-free
+*              queue to the main loop, where input_process runs the mapped
+*              actions. Presses that arrive while an action runs are queued,
+*              not lost.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "input_events.h"
+#include "sys_tick.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t time_ms;
+    uint32_t input;
+} input_edge_t;
+
+typedef struct
+{
+    cyhal_gpio_t pin;
+    bool active_low;
+    cyhal_gpio_callback_data_t callback;
+
+    /* Debouncing, tick only */
+    bool pressed;               /* Debounced state */
+    uint32_t settle_ms;         /* Remaining debounce time, 0 when idle */
+    uint32_t burst_ms;          /* First edge of the current burst */
+
+    /* Gesture detection, tick only */
+    uint32_t press_ms;          /* Current press */
+    uint32_t release_ms;
+    uint32_t click_ms;          /* First press of a multi-click */
+    uint8_t clicks;
+    bool long_sent;
+} input_state_t;
+
+typedef struct
+{
+    uint8_t input;
+    uint8_t type;
+    uint8_t count;              /* 0 matches any count */
+    input_action_t action;
+} input_mapping_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static input_state_t input_states[INPUT_MAX_INPUTS];
+static uint32_t input_count;
+
+static input_mapping_t input_actions[INPUT_MAX_ACTIONS];
+static uint32_t input_action_count;
+
+/* GPIO interrupt -> tick */
+static input_edge_t edge_queue[INPUT_EDGE_QUEUE_SIZE];
+static volatile uint32_t edge_head;
+static volatile uint32_t edge_tail;
+
+/* Tick -> main loop */
+static input_event_t event_queue[INPUT_EVENT_QUEUE_SIZE];
+static volatile uint32_t event_head;
+static volatile uint32_t event_tail;
+
+static input_stats_t input_stats;
+
+STATS_COUNTER(edges, "input.edges", &input_stats.edges);
+STATS_COUNTER(glitches, "input.glitches", &input_stats.glitches);
+STATS_COUNTER(events, "input.events", &input_stats.events);
+STATS_COUNTER(edges_lost, "input.edges_lost", &input_stats.edges_lost);
+STATS_COUNTER(events_lost, "input.events_lost", &input_stats.events_lost);
+STATS_COUNTER(unmapped, "input.unmapped", &input_stats.unmapped);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void input_edge_isr(void *callback_arg, cyhal_gpio_event_t event);
+static void input_tick(uint32_t now_ms);
+static void input_settled(input_state_t *state, uint32_t idx);
+static void input_emit(uint32_t idx, input_event_type_t type, uint32_t time_ms,
+                       uint8_t count);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: input_init
+********************************************************************************
+* Summary:
+* Starts the system tick and installs the debouncing handler. Call before
+* input_register.
+*
+* Return:
+*  cy_rslt_t  result of sys_tick_init, INPUT_RSLT_NO_TICK if the tick handler
+*             table is full
+*
+*******************************************************************************/
+cy_rslt_t input_init(void)
+{
+    cy_rslt_t result = sys_tick_init();
+
+    if ((CY_RSLT_SUCCESS == result) && !sys_tick_register(input_tick, 1UL))
+    {
+        result = INPUT_RSLT_NO_TICK;
+    }
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: input_register
+********************************************************************************
+* Summary:
+* Adds an input on an already initialized GPIO and enables its edge interrupt.
+*
+* Parameters:
+*  pin          Input pin
+*  active_low   true if the pressed level is low
+*
+* Return:
+*  int32_t  input index for input_map, -1 if the table is full
+*
+*******************************************************************************/
+int32_t input_register(cyhal_gpio_t pin, bool active_low)
+{
+    uint32_t idx = input_count;
+    input_state_t *state;
+
+    if (idx >= INPUT_MAX_INPUTS)
+    {
+        return -1;
+    }
+
+    state = &input_states[idx];
+    state->pin = pin;
+    state->active_low = active_low;
+    state->pressed = (cyhal_gpio_read(pin) != active_low);
+    state->callback.callback = input_edge_isr;
+    state->callback.callback_arg = (void *)(uintptr_t)idx;
+
+    /* The tick may run handlers for inputs up to input_count */
+    __DMB();
+    input_count = idx + 1UL;
+
+    cyhal_gpio_register_callback(pin, &state->callback);
+    cyhal_gpio_enable_event(pin, CYHAL_GPIO_IRQ_BOTH, INPUT_GPIO_PRIORITY, true);
+
+    return (int32_t)idx;
+}
+
+/*******************************************************************************
+* Function Name: input_map
+********************************************************************************
+* Summary:
+* Maps an event of an input to an action.
+*
+* Parameters:
+*  input      Index returned by input_register
+*  type       Event type
+*  count      Number of clicks for INPUT_EVENT_CLICK, 0 for any
+*  action     Called by input_process
+*
+* Return:
+*  bool  false if the action table is full
+*
+*******************************************************************************/
+bool input_map(uint8_t input, input_event_type_t type, uint8_t count,
+               input_action_t action)
+{
+    input_mapping_t *mapping;
+
+    if (input_action_count >= INPUT_MAX_ACTIONS)
+    {
+        return false;
+    }
+
+    mapping = &input_actions[input_action_count];
+    mapping->input = input;
+    mapping->type = (uint8_t)type;
+    mapping->count = count;
+    mapping->action = action;
+    input_action_count++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: input_process
+********************************************************************************
+* Summary:
+* Runs the actions of the queued events in order. Thread context only.
+*
+* Return:
+*  uint32_t  number of events taken from the queue
+*
+*******************************************************************************/
+uint32_t input_process(void)
+{
+    uint32_t count = 0UL;
+
+    while (event_tail != event_head)
+    {
+        input_event_t event;
+        bool mapped = false;
+
+        __DMB();
+        event = event_queue[event_tail & (INPUT_EVENT_QUEUE_SIZE - 1UL)];
+        __DMB();
+        event_tail = event_tail + 1UL;
+        count++;
+
+        for (uint32_t idx = 0UL; idx < input_action_count; idx++)
+        {
+            const input_mapping_t *mapping = &input_actions[idx];
+
+            if ((mapping->input == event.input) &&
+                (mapping->type == event.type) &&
+                ((0U == mapping->count) || (mapping->count == event.count)))
+            {
+                mapping->action(&event);
+                mapped = true;
+            }
+        }
+
+        if (!mapped)
+        {
+            input_stats.unmapped++;
+        }
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: input_edge_isr
+********************************************************************************
+* Summary:
+* GPIO interrupt of all inputs: queues the edge with its time.
+*
+*******************************************************************************/
+static void input_edge_isr(void *callback_arg, cyhal_gpio_event_t event)
+{
+    uint32_t head = edge_head;
+
+    (void)event;
+
+    input_stats.edges++;
+    if ((head - edge_tail) >= INPUT_EDGE_QUEUE_SIZE)
+    {
+        input_stats.edges_lost++;
+        return;
+    }
+
+    edge_queue[head & (INPUT_EDGE_QUEUE_SIZE - 1UL)].time_ms = sys_tick_ms();
+    edge_queue[head & (INPUT_EDGE_QUEUE_SIZE - 1UL)].input =
+        (uint32_t)(uintptr_t)callback_arg;
+    __DMB();
+    edge_head = head + 1UL;
+}
+
+/*******************************************************************************
+* Function Name: input_tick
+********************************************************************************
+* Summary:
+* 1 ms tick: consumes the edges, debounces and detects gestures.
+*
+*******************************************************************************/
+static void input_tick(uint32_t now_ms)
+{
+    uint32_t count = input_count;
+
+    /* Every edge restarts the debounce period of its input */
+    while (edge_tail != edge_head)
+    {
+        const input_edge_t *edge;
+        input_state_t *state;
+
+        __DMB();
+        edge = &edge_queue[edge_tail & (INPUT_EDGE_QUEUE_SIZE - 1UL)];
+        if (edge->input < count)
+        {
+            state = &input_states[edge->input];
+            if (0UL == state->settle_ms)
+            {
+                state->burst_ms = edge->time_ms;
+            }
+            state->settle_ms = INPUT_DEBOUNCE_MS;
+        }
+        __DMB();
+        edge_tail = edge_tail + 1UL;
+    }
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        input_state_t *state = &input_states[idx];
+
+        if (0UL != state->settle_ms)
+        {
+            state->settle_ms--;
+            if (0UL == state->settle_ms)
+            {
+                input_settled(state, idx);
+            }
+        }
+
+        if (state->pressed && !state->long_sent &&
+            ((now_ms - state->press_ms) >= INPUT_LONG_PRESS_MS))
+        {
+            state->long_sent = true;
+            state->clicks = 0U;
+            input_emit(idx, INPUT_EVENT_LONG_PRESS, state->press_ms, 0U);
+        }
+
+        if (!state->pressed && (0U != state->clicks) &&
+            ((now_ms - state->release_ms) >= INPUT_MULTI_CLICK_MS))
+        {
+            input_emit(idx, INPUT_EVENT_CLICK, state->click_ms, state->clicks);
+            state->clicks = 0U;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: input_settled
+********************************************************************************
+* Summary:
+* The level of an input has been stable for INPUT_DEBOUNCE_MS. A change of
+* the debounced state is dated to the first edge of the burst.
+*
+*******************************************************************************/
+static void input_settled(input_state_t *state, uint32_t idx)
+{
+    bool pressed = (cyhal_gpio_read(state->pin) != state->active_low);
+
+    if (pressed == state->pressed)
+    {
+        input_stats.glitches++;
+        return;
+    }
+
+    state->pressed = pressed;
+    if (pressed)
+    {
+        state->long_sent = false;
+        state->press_ms = state->burst_ms;
+        if (0U == state->clicks)
+        {
+            state->click_ms = state->burst_ms;
+        }
+        input_emit(idx, INPUT_EVENT_PRESS, state->burst_ms, 0U);
+    }
+    else
+    {
+        if (!state->long_sent && (state->clicks < UINT8_MAX))
+        {
+            state->clicks++;
+        }
+        state->release_ms = state->burst_ms;
+        input_emit(idx, INPUT_EVENT_RELEASE, state->burst_ms, 0U);
+    }
+}
+
+/*******************************************************************************
+* Function Name: input_emit
+********************************************************************************
+* Summary:
+* Queues an event for the main loop.
+*
+*******************************************************************************/
+static void input_emit(uint32_t idx, input_event_type_t type, uint32_t time_ms,
+                       uint8_t count)
+{
+    uint32_t head = event_head;
+    input_event_t *event;
+
+    if ((head - event_tail) >= INPUT_EVENT_QUEUE_SIZE)
+    {
+        input_stats.events_lost++;
+        return;
+    }
+
+    event = &event_queue[head & (INPUT_EVENT_QUEUE_SIZE - 1UL)];
+    event->time_ms = time_ms;
+    event->input = (uint8_t)idx;
+    event->type = (uint8_t)type;
+    event->count = count;
+    event->reserved = 0U;
+    __DMB();
+    event_head = head + 1UL;
+    input_stats.events++;
+}
+
+/*******************************************************************************
+* Function Name: input_get_stats
+********************************************************************************
+* Summary:
+* Returns the input counters.
+*
+*******************************************************************************/
+const input_stats_t *input_get_stats(void)
+{
+    return &input_stats;
+}
+
+/*******************************************************************************
+* Function Name: input_print_stats
+********************************************************************************
+* Summary:
+* Prints the input counters.
+*
+*******************************************************************************/
+void input_print_stats(void)
+{
+    printf("Input: %lu edges, %lu glitches, %lu events, %lu unmapped, "
+           "%lu edges lost, %lu events lost\r\n",
+           (unsigned long)input_stats.edges,
+           (unsigned long)input_stats.glitches,
+           (unsigned long)input_stats.events,
+           (unsigned long)input_stats.unmapped,
+           (unsigned long)input_stats.edges_lost,
+           (unsigned long)input_stats.events_lost);
+}
+
+/* [] END OF FILE */
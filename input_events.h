@@ -0,0 +1,143 @@
+/******************************************************************************
+* File Name:   input_events.h
+*
+* Description: Debounced input events with gesture detection and action
+*              mapping.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef INPUT_EVENTS_H_
+#define INPUT_EVENTS_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cyhal.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Inputs that can be registered */
+#ifndef INPUT_MAX_INPUTS
+#define INPUT_MAX_INPUTS            (4u)
+#endif
+
+/* Actions that can be mapped */
+#ifndef INPUT_MAX_ACTIONS
+#define INPUT_MAX_ACTIONS           (8u)
+#endif
+
+/* Queue sizes (powers of two): raw edges from the GPIO interrupt, events for
+ * the main loop */
+#ifndef INPUT_EDGE_QUEUE_SIZE
+#define INPUT_EDGE_QUEUE_SIZE       (16u)
+#endif
+#ifndef INPUT_EVENT_QUEUE_SIZE
+#define INPUT_EVENT_QUEUE_SIZE      (16u)
+#endif
+
+/* A level counts once it was stable this long */
+#ifndef INPUT_DEBOUNCE_MS
+#define INPUT_DEBOUNCE_MS           (20u)
+#endif
+
+/* Holding longer than this is a long press instead of a click */
+#ifndef INPUT_LONG_PRESS_MS
+#define INPUT_LONG_PRESS_MS         (800u)
+#endif
+
+/* Presses closer than this are counted as one multi-click */
+#ifndef INPUT_MULTI_CLICK_MS
+#define INPUT_MULTI_CLICK_MS        (300u)
+#endif
+
+/* Interrupt priority of the edge interrupts */
+#ifndef INPUT_GPIO_PRIORITY
+#define INPUT_GPIO_PRIORITY         (7u)
+#endif
+
+/* Returned by input_init if the tick handler cannot be installed */
+#define INPUT_RSLT_NO_TICK          \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 4u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef enum
+{
+    INPUT_EVENT_PRESS = 0,      /* Debounced press */
+    INPUT_EVENT_RELEASE,        /* Debounced release */
+    INPUT_EVENT_CLICK,          /* count presses, then INPUT_MULTI_CLICK_MS idle */
+    INPUT_EVENT_LONG_PRESS,     /* Held for INPUT_LONG_PRESS_MS */
+} input_event_type_t;
+
+typedef struct
+{
+    uint32_t time_ms;           /* First edge of the press or release */
+    uint8_t input;              /* Index returned by input_register */
+    uint8_t type;               /* input_event_type_t */
+    uint8_t count;              /* Clicks for INPUT_EVENT_CLICK */
+    uint8_t reserved;
+} input_event_t;
+
+/* Action run by input_process in thread context */
+typedef void (*input_action_t)(const input_event_t *event);
+
+typedef struct
+{
+    uint32_t edges;             /* Raw edges seen by the GPIO interrupt */
+    uint32_t glitches;          /* Edge bursts that ended at the old level */
+    uint32_t events;            /* Events queued for the main loop */
+    uint32_t edges_lost;        /* Edge queue full */
+    uint32_t events_lost;       /* Event queue full */
+    uint32_t unmapped;          /* Events without an action */
+} input_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t input_init(void);
+int32_t input_register(cyhal_gpio_t pin, bool active_low);
+bool input_map(uint8_t input, input_event_type_t type, uint8_t count,
+               input_action_t action);
+uint32_t input_process(void);
+const input_stats_t *input_get_stats(void);
+void input_print_stats(void);
+
+#endif /* INPUT_EVENTS_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,238 @@
+/******************************************************************************
+* File Name:   led_activity.c
+*
+* Description: Bus activity indicator. Frames only increment a counter; every
+*              LED_ACTIVITY_UPDATE_MS the system tick turns the counters into
+*              an LED state: off when the bus is idle, a brightness that grows
+*              with the estimated bus load while frames are exchanged, and fast
+*              blinking during an error state (error passive or bus off) or
+*              after error events. The brightness is set through a TCPWM PWM on
+*              the user LED; on boards where the LED pin has no TCPWM output
+*              the LED is switched on or off instead.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cybsp.h"
+#include "led_activity.h"
+#include "canfd_bitrate.h"
+#include "canfd_errlog.h"
+#include "canfd_frame.h"
+#include "canfd_txq.h"
+#include "sys_tick.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+led_activity_stats_t led_activity_stats;
+
+STATS_COUNTER(rx, "bus.rx", &led_activity_stats.rx);
+STATS_COUNTER(tx, "bus.tx", &led_activity_stats.tx);
+STATS_COUNTER(errors, "bus.errors", &led_activity_stats.errors);
+STATS_GAUGE(load, "bus.load_permille", &led_activity_stats.load_permille);
+
+static CANFD_Type *led_base;
+static uint32_t led_chan;
+static cyhal_pwm_t led_pwm;
+
+/* Bus time of a 64-byte frame with bit rate switching, for the load estimate */
+static uint32_t led_frame_ns;
+
+/* Counter values at the last update */
+static uint32_t led_last_frames;
+static uint32_t led_last_errors;
+static uint32_t led_error_until_ms;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void led_update(uint32_t now_ms);
+static void led_set_duty(uint32_t percent);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: led_activity_init
+********************************************************************************
+* Summary:
+* Takes over the user LED and starts the periodic update. Replaces the GPIO
+* initialization of the LED.
+*
+* Parameters:
+*  base       CAN FD block, for the error state
+*  chan       Channel number
+*
+* Return:
+*  cy_rslt_t  result of the LED and tick setup
+*
+*******************************************************************************/
+cy_rslt_t led_activity_init(CANFD_Type *base, uint32_t chan)
+{
+    cy_rslt_t result;
+
+    led_base = base;
+    led_chan = chan;
+    led_frame_ns = canfd_bitrate_frame_time_ns(canfd_bitrate_get_active(),
+                                               CANFD_FRAME_MAX_LEN, false,
+                                               true);
+
+    result = cyhal_pwm_init(&led_pwm, CYBSP_USER_LED, NULL);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        led_activity_stats.pwm = true;
+        led_set_duty(0UL);
+        result = cyhal_pwm_start(&led_pwm);
+    }
+    else
+    {
+        result = cyhal_gpio_init(CYBSP_USER_LED, CYHAL_GPIO_DIR_OUTPUT,
+                                 CYHAL_GPIO_DRIVE_STRONG, CYBSP_LED_STATE_OFF);
+    }
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = sys_tick_init();
+    }
+    if ((CY_RSLT_SUCCESS == result) &&
+        !sys_tick_register(led_update, LED_ACTIVITY_UPDATE_MS))
+    {
+        result = LED_ACTIVITY_RSLT_NO_TICK;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: led_update
+********************************************************************************
+* Summary:
+* Periodic update from the system tick. The PSR goes through the error log,
+* which keeps the error codes reset by the read.
+*
+*******************************************************************************/
+static void led_update(uint32_t now_ms)
+{
+    uint32_t psr = canfd_errlog_read_psr(led_base, led_chan);
+    uint32_t errors = led_activity_stats.errors;
+    uint32_t frames;
+    uint32_t delta;
+
+    led_activity_stats.tx = canfd_txq_get_stats()->completed;
+    frames = led_activity_stats.rx + led_activity_stats.tx;
+    delta = frames - led_last_frames;
+    led_last_frames = frames;
+
+    /* Share of the period the bus carried these frames */
+    led_activity_stats.load_permille =
+        (uint32_t)(((uint64_t)delta * led_frame_ns) /
+                   (LED_ACTIVITY_UPDATE_MS * 1000UL));
+    if (led_activity_stats.load_permille > 1000UL)
+    {
+        led_activity_stats.load_permille = 1000UL;
+    }
+
+    if ((errors != led_last_errors) ||
+        (0UL != (psr & (CANFD_CH_M_TTCAN_PSR_EP_Msk | CANFD_CH_M_TTCAN_PSR_BO_Msk))))
+    {
+        led_last_errors = errors;
+        led_error_until_ms = now_ms + LED_ACTIVITY_ERROR_HOLD_MS;
+    }
+
+    if ((int32_t)(led_error_until_ms - now_ms) > 0)
+    {
+        led_set_duty((0UL != ((now_ms / LED_ACTIVITY_BLINK_MS) & 1UL)) ?
+                     100UL : 0UL);
+    }
+    else if (0UL != delta)
+    {
+        led_set_duty(LED_ACTIVITY_MIN_DUTY +
+                     (((100UL - LED_ACTIVITY_MIN_DUTY) *
+                       led_activity_stats.load_permille) / 1000UL));
+    }
+    else
+    {
+        led_set_duty(0UL);
+    }
+}
+
+/*******************************************************************************
+* Function Name: led_set_duty
+********************************************************************************
+* Summary:
+* Sets the LED brightness in percent. Without PWM the LED is on for any
+* non-zero brightness.
+*
+*******************************************************************************/
+static void led_set_duty(uint32_t percent)
+{
+    bool on = (0UL != percent);
+
+    if (led_activity_stats.pwm)
+    {
+        /* The PWM drives the pin high for the duty cycle */
+        if (0u == CYBSP_LED_STATE_ON)
+        {
+            percent = 100UL - percent;
+        }
+        (void)cyhal_pwm_set_duty_cycle(&led_pwm, (float)percent,
+                                       LED_ACTIVITY_PWM_HZ);
+    }
+    else
+    {
+        cyhal_gpio_write(CYBSP_USER_LED, on ? CYBSP_LED_STATE_ON :
+                                              CYBSP_LED_STATE_OFF);
+    }
+}
+
+/*******************************************************************************
+* Function Name: led_activity_get_stats
+********************************************************************************
+* Summary:
+* Returns the activity counters.
+*
+*******************************************************************************/
+const led_activity_stats_t *led_activity_get_stats(void)
+{
+    return &led_activity_stats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,120 @@
+/******************************************************************************
+* File Name:   led_activity.h
+*
+* Description: Bus activity indicator on the user LED, driven by a TCPWM PWM.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef LED_ACTIVITY_H_
+#define LED_ACTIVITY_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cyhal.h"
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Update period of the LED */
+#ifndef LED_ACTIVITY_UPDATE_MS
+#define LED_ACTIVITY_UPDATE_MS      (50u)
+#endif
+
+/* Brightness at the lowest activity, in percent; full load is 100 % */
+#ifndef LED_ACTIVITY_MIN_DUTY
+#define LED_ACTIVITY_MIN_DUTY       (5u)
+#endif
+
+/* The LED blinks for this long after an error event */
+#ifndef LED_ACTIVITY_ERROR_HOLD_MS
+#define LED_ACTIVITY_ERROR_HOLD_MS  (2000u)
+#endif
+
+/* Half period of the error blinking */
+#ifndef LED_ACTIVITY_BLINK_MS
+#define LED_ACTIVITY_BLINK_MS       (100u)
+#endif
+
+#define LED_ACTIVITY_PWM_HZ         (1000u)
+
+/* Returned by led_activity_init if the tick handler cannot be installed */
+#define LED_ACTIVITY_RSLT_NO_TICK   \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 5u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    volatile uint32_t rx;       /* Frames received */
+    volatile uint32_t errors;   /* Error events reported by the error path */
+    uint32_t tx;                /* Transmissions completed, from the Tx queue */
+    uint32_t load_permille;     /* Estimated bus load of the last period */
+    bool pwm;                   /* false: TCPWM not available on the LED pin */
+} led_activity_stats_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+extern led_activity_stats_t led_activity_stats;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t led_activity_init(CANFD_Type *base, uint32_t chan);
+const led_activity_stats_t *led_activity_get_stats(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/* Per-frame cost of the indicator: one increment, any context */
+__STATIC_INLINE void led_activity_rx(void)
+{
+    led_activity_stats.rx++;
+}
+
+__STATIC_INLINE void led_activity_error(void)
+{
+    led_activity_stats.errors++;
+}
+
+#endif /* LED_ACTIVITY_H_ */
+
+/* [] END OF FILE */
@@ -47,6 +47,37 @@
 #include "cy_pdl.h"
 #include "cybsp.h"
 #include "cy_retarget_io.h"
+#include "payload_simd.h"
+#include "canfd_cfg.h"
+#include "canfd_frame.h"
+#include "canfd_txq.h"
+#include "canfd_rxq.h"
+#include "canfd_coalesce.h"
+#include "canfd_poll.h"
+#include "canfd_lean_isr.h"
+#include "canfd_perf.h"
+#include "sensor_stream.h"
+#include "stream_reasm.h"
+#include "cycle_count.h"
+#include "input_events.h"
+#include "led_activity.h"
+#include "stats_registry.h"
+#include "trace.h"
+#include "fault_capture.h"
+#include "supervisor.h"
+#include "flash_log.h"
+#include "flash_readback.h"
+#include "task.h"
+#include "canfd_mram.h"
+#include "canfd_errlog.h"
+#include "canfd_autobaud.h"
+#include "canfd_calib.h"
+#include "config_store.h"
+#include "canfd_filter.h"
+#include "canfd_classify.h"
+#include "canfd_dispatch.h"
+#include "canfd_pack.h"
+#include "sys_tick.h"
 
 /*******************************************************************************
 * Macros
@@ -61,12 +92,157 @@
 #define CANFD_HW_CHANNEL        0
 /* CAN-FD data buffer index to send data from */
 #define CANFD_BUFFER_INDEX      0
-/* Maximum incoming data length supported */
-#define CANFD_DLC               8
 
 #define CANFD_INTERRUPT         canfd_0_interrupts0_0_IRQn
 
-#define GPIO_INTERRUPT_PRIORITY (7u)
+/* Set to 1 to print the payload kernel benchmark at start-up */
+#define ENABLE_PAYLOAD_SIMD_BENCHMARK   (0u)
+
+/* Set to 1 to stream SAR ADC samples from Node-1 to Node-2 */
+#define ENABLE_SENSOR_STREAM            (0u)
+
+/* Set to 1 to queue received frames and coalesce the Rx interrupts at high
+ * frame rates */
+#define ENABLE_RX_COALESCING            (0u)
+
+/* Set to 1 to run the channel without its interrupt; the main loop polls the
+ * hardware instead. Cannot be combined with ENABLE_RX_COALESCING */
+#define ENABLE_CANFD_POLLING            (0u)
+
+/* Set to 1 to replace Cy_CANFD_IrqHandler by a handler specialized for Rx
+ * FIFO 0 and Tx complete; received frames are handled in the main loop */
+#define ENABLE_CANFD_LEAN_ISR           (0u)
+
+/* Set to 1 to print the cycles per frame of the Rx interrupt */
+#define ENABLE_RX_PERF_REPORT           (0u)
+
+/* Set to 1 to record the received frames to the external QSPI flash; 'r' on
+ * the terminal starts and stops a recording. The log is read back over the
+ * UART ('d') or over CAN FD with scripts/readback.py. */
+#define ENABLE_FLASH_LOG                (0u)
+
+/* Set to 1 to reset the device through the hardware watchdog when a main loop
+ * stage does not complete; the stage deadlines are monitored either way */
+#define ENABLE_WATCHDOG                 (0u)
+#define WATCHDOG_TIMEOUT_MS             (2000u)
+
+/* Set to 1 to run the terminal commands, the Rx report and the handling of
+ * the Rx queue as cooperative tasks that wait for the UART and Rx interrupts
+ * and for timers, instead of being polled in every pass of the main loop */
+#define ENABLE_TASKS                    (0u)
+#define UART_RX_IRQ_PRIORITY            (7u)
+
+/* Set to 1 to handle message RAM bit errors and access failures: damaged
+ * filter and Tx buffer elements are restored from copies without
+ * re-initializing the channel; 'M' on the terminal changes a filter word to
+ * test the scrubbing */
+#define ENABLE_MRAM_CHECK               (0u)
+
+/* Set to 1 to detect the bit rate of the bus at start-up: the channel
+ * listens with each profile of canfd_bitrate.c, without acknowledging or
+ * sending, and runs with the one that receives frames without errors */
+#define ENABLE_AUTOBAUD                 (0u)
+
+/* Set to 1 to calibrate the sample point and SJW of both phases from the
+ * errors measured at each setting: 'c' on the terminal sends test frames to
+ * the other nodes, 'l' in external loopback without them. The timing found
+ * is kept in flash, with the profile found by ENABLE_AUTOBAUD, and loaded at
+ * start-up */
+#define ENABLE_CALIBRATION              (0u)
+
+/* Set to 1 to log bus errors, error state changes and protocol exceptions
+ * with timestamps and to keep per-minute error rates next to the frame
+ * throughput; 'e' on the terminal prints the log */
+#define ENABLE_ERROR_LOG                (0u)
+
+/* Set to 1 to change the acceptance filters at run time without stopping
+ * the controller; 'F' on the terminal switches between the configured
+ * filters and filters that accept every identifier */
+#define ENABLE_FILTER_SWAP              (0u)
+
+/* Set to 1 to route received frames to handlers by identifier and
+ * multiplexer value in software, behind coarse acceptance filters
+ * (with ENABLE_FILTER_SWAP) */
+#define ENABLE_CLASSIFY                 (0u)
+#define CLASSIFY_SID_RANGES             (4u)
+#define CLASSIFY_XID_RANGES             (2u)
+
+/* Set to 1 to route received frames through a table of handlers per
+ * identifier: the statistics, readback and stream frames are handled in the
+ * receive context, the printing of the other frames is deferred to the
+ * main loop */
+#define ENABLE_DISPATCH                 (0u)
+
+/* Set to 1 to send status messages of 1 to 4 bytes packed into shared
+ * frames (ID 0x180 + node), more of them per frame the busier the bus, and
+ * to unpack those of the other node */
+#define ENABLE_PACKING                  (0u)
+#define PACK_CAN_ID_BASE                (0x180u)
+
+/* Identifier of the frames sent by the Tx batch benchmark ('x'). It must
+ * not be one of the identifiers reserved by the modules: the button frame
+ * (node), the sensor stream, the packed status frames (base + node), the
+ * readback command, data and status, the binary log, the statistics
+ * request and the calibration frames. */
+#define TX_BENCH_ID                     (0x7F4u)
+
+#if ((TX_BENCH_ID == SENSOR_STREAM_CAN_ID) || \
+     ((TX_BENCH_ID >= PACK_CAN_ID_BASE) && \
+      (TX_BENCH_ID <= (PACK_CAN_ID_BASE + 2u))) || \
+     ((TX_BENCH_ID >= FLASH_READBACK_CMD_ID) && \
+      (TX_BENCH_ID <= FLASH_READBACK_STATUS_ID)) || \
+     (TX_BENCH_ID == BINLOG_CAN_ID) || \
+     (TX_BENCH_ID == STATS_REQUEST_CAN_ID) || \
+     (TX_BENCH_ID == CANFD_CALIB_CAN_ID) || \
+     (TX_BENCH_ID <= 2u))
+#error "TX_BENCH_ID clashes with a reserved identifier"
+#endif
+#define PACK_STATUS_PERIOD_MS           (10u)
+
+/* Signals of the packed status messages */
+#define PACK_SIG_TICK_MS                (0u)    /* u32, 50 ms budget */
+#define PACK_SIG_TXQ_DEPTH              (1u)    /* u8, 20 ms budget */
+#define PACK_SIG_BUS_LOAD               (2u)    /* u16 permille, 100 ms */
+#define PACK_SIG_RX_FRAMES              (3u)    /* u32, 100 ms budget */
+#define PACK_SIGNALS                    (4u)
+
+/* Deadlines of the main loop stages. The Rx stage includes the logging of
+ * received frames, the log and shell stages the blocking UART output. */
+#define STAGE_TX_DEADLINE_US            (200u)
+#define STAGE_RX_DEADLINE_US            (50000u)
+#define STAGE_LOG_DEADLINE_US           (250000u)
+#define STAGE_SHELL_DEADLINE_US         (250000u)
+#define STAGE_TASKS_DEADLINE_US         (250000u)
+
+/* Longest wait of a button click for space in the Tx queue */
+#define TX_SEND_TIMEOUT_MS              (100u)
+
+/* Interval of the Rx report, printed for the options above */
+#define RX_REPORT_INTERVAL_MS           (5000u)
+#define RX_REPORT                       (ENABLE_RX_COALESCING || \
+                                         ENABLE_CANFD_POLLING || \
+                                         ENABLE_CANFD_LEAN_ISR || \
+                                         ENABLE_RX_PERF_REPORT)
+
+/* Single-character commands on the debug UART */
+#define UART_CMD_STATS          ('s')   /* Statistics schema and values */
+#define UART_CMD_STATS_VALUES   ('v')   /* Statistics values */
+#define UART_CMD_TRACE_DUMP     ('t')   /* Trace ring contents */
+#define UART_CMD_TRACE_STREAM   ('T')   /* Start or stop trace streaming */
+#define UART_CMD_FLASH_RECORD   ('r')   /* Start or stop a flash recording */
+#define UART_CMD_FLASH_DUMP     ('d')   /* Last pages of the flash log */
+#define UART_CMD_FLASH_ERASE    ('E')   /* Erase the flash log */
+#define UART_CMD_TASK_BENCH     ('b')   /* Measure the task switch */
+#define UART_CMD_MRAM_INJECT    ('M')   /* Change a filter word */
+#define UART_CMD_FILTER_SWAP    ('F')   /* Switch the filter table */
+#define UART_CMD_TX_BENCH       ('x')   /* Tx frame rate per batch size */
+#define UART_CMD_ERROR_LOG      ('e')   /* Bus error log and rates */
+#define UART_CMD_CALIBRATE      ('c')   /* Calibrate against the other nodes */
+#define UART_CMD_CALIBRATE_LOOP ('l')   /* Calibrate in loopback */
+
+#if ((ENABLE_RX_COALESCING + ENABLE_CANFD_POLLING + ENABLE_CANFD_LEAN_ISR) > 1u)
+#error "ENABLE_RX_COALESCING, ENABLE_CANFD_POLLING and ENABLE_CANFD_LEAN_ISR are exclusive"
+#endif
 
 /*******************************************************************************
 * Global Variables
@@ -74,10 +250,54 @@
 /* This is a shared context structure, unique for each can-fd channel */
 static cy_stc_canfd_context_t canfd_context;
 
-/* Variable which holds the button pressed status */
-volatile bool gpio_intr_flag = false;
+/* Input index of the user button */
+static uint8_t user_btn_input;
+
+/* Supervised main loop stages */
+SUPERVISOR_STAGE(stage_tx, "loop.tx", STAGE_TX_DEADLINE_US);
+SUPERVISOR_STAGE(stage_rx, "loop.rx", STAGE_RX_DEADLINE_US);
+SUPERVISOR_STAGE(stage_log, "loop.log", STAGE_LOG_DEADLINE_US);
+SUPERVISOR_STAGE(stage_shell, "loop.shell", STAGE_SHELL_DEADLINE_US);
+#if (ENABLE_TASKS)
+SUPERVISOR_STAGE(stage_tasks, "loop.tasks", STAGE_TASKS_DEADLINE_US);
+
+/* Signalled by the UART interrupt when a character was received */
+static task_event_t uart_rx_event;
+#if (ENABLE_RX_COALESCING || ENABLE_CANFD_LEAN_ISR)
+/* Signalled when the Rx interrupt or drain timer queued frames */
+static task_event_t rxq_event;
+#endif
+#endif
+
+#if (ENABLE_FILTER_SWAP)
+/* Filter table loaded by switch_filters */
+static bool filters_accept_all;
+#endif
 
-cyhal_gpio_callback_data_t gpio_btn_callback_data;
+#if (ENABLE_AUTOBAUD || ENABLE_CALIBRATION)
+/* Index of the bit rate profile in use */
+static uint8_t bitrate_profile = CANFD_BITRATE_DEFAULT_PROFILE;
+#endif
+
+#if (ENABLE_CALIBRATION)
+/* Bit rates of bitrate_profile with the calibrated timing */
+static canfd_bitrate_profile_t calibrated_profile;
+#endif
+
+#if (ENABLE_PACKING)
+/* Latest status values of the other node, by signal, and the time of the
+ * last own status */
+static uint32_t pack_peer_status[PACK_SIGNALS];
+static uint32_t pack_status_ms;
+#endif
+
+#if (RX_REPORT)
+/* Cost of the Rx interrupt, frames received in the current interrupt and
+ * cycles spent in the application handler during it */
+static canfd_perf_t isr_perf;
+static uint32_t isr_rx_frames;
+static uint32_t isr_handler_cycles;
+#endif
 
 /* Populate the configuration structure for CAN-FD Interrupt */
 cy_stc_sysint_t canfd_irq_cfg =
@@ -95,11 +315,104 @@ cy_stc_sysint_t canfd_irq_cfg =
 /* can-fd interrupt handler */
 static void isr_canfd (void);
 
-/* button press interrupt handler */
-static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event);
+/* user button actions */
+static void action_send_frame(const input_event_t *event);
+static void action_benchmark(const input_event_t *event);
+static void action_dump_stats(const input_event_t *event);
+static void action_export_stats(const input_event_t *event);
+
+/* error counters of the channel, for the statistics registry */
+static uint32_t read_can_tec(void);
+static uint32_t read_can_rec(void);
+STATS_GAUGE_FN(can_tec, "can.tec", read_can_tec);
+STATS_GAUGE_FN(can_rec, "can.rec", read_can_rec);
+
+/* application handling of a received frame */
+static void process_rx_frame(const canfd_frame_t *frame);
+static void print_rx_frame(const canfd_frame_t *frame);
+
+#if (ENABLE_DISPATCH)
+/* receive handlers, cheapest first; budgets in us */
+static void rx_stats_frame(const canfd_frame_t *frame);
+CANFD_DISPATCH_HANDLER(rx_stats_handler, "rx.stats", rx_stats_frame,
+                       CANFD_DISPATCH_FAST, 10u);
+#if (ENABLE_FLASH_LOG)
+static void rx_readback_frame(const canfd_frame_t *frame);
+CANFD_DISPATCH_HANDLER(rx_readback_handler, "rx.readback", rx_readback_frame,
+                       CANFD_DISPATCH_FAST, 20u);
+#endif
+#if (ENABLE_SENSOR_STREAM)
+static void rx_stream_frame(const canfd_frame_t *frame);
+CANFD_DISPATCH_HANDLER(rx_stream_handler, "rx.stream", rx_stream_frame,
+                       CANFD_DISPATCH_FAST, 20u);
+#endif
+#if (ENABLE_PACKING)
+static void rx_pack_frame(const canfd_frame_t *frame);
+CANFD_DISPATCH_HANDLER(rx_pack_handler, "rx.pack", rx_pack_frame,
+                       CANFD_DISPATCH_FAST, 20u);
+#endif
+CANFD_DISPATCH_HANDLER(rx_print_handler, "rx.print", print_rx_frame,
+                       CANFD_DISPATCH_DEFERRED, 30000u);
+#endif
+
+/* commands received on the debug UART */
+static bool process_uart_command(void);
+
+#if (RX_REPORT)
+/* periodic report of the Rx path */
+static void print_rx_report(void);
+#endif
+
+#if (ENABLE_TASKS)
+/* tasks of the main loop, in priority order */
+#if (ENABLE_RX_COALESCING || ENABLE_CANFD_LEAN_ISR)
+static uint32_t task_rx(task_t *task);
+TASK_DEFINE(rx_task, "task.rx", task_rx);
+#endif
+static uint32_t task_shell(task_t *task);
+TASK_DEFINE(shell_task, "task.shell", task_shell);
+#if (RX_REPORT)
+static uint32_t task_report(task_t *task);
+TASK_DEFINE(report_task, "task.report", task_report);
+#endif
+
+/* wakes the shell task */
+static void uart_rx_callback(void *arg, cyhal_uart_event_t event);
+#endif
+
+#if (ENABLE_FILTER_SWAP)
+/* loads the configured or the accept-all filter table */
+static void switch_filters(bool accept_all);
+#endif
+
+#if (ENABLE_CALIBRATION)
+/* sample point and SJW calibration, kept in the configuration store */
+static void calibrate(bool loopback);
+#endif
+
+#if (ENABLE_PACKING)
+/* packed status messages of both nodes */
+static void send_status_messages(void);
+static bool pack_rx_frame(const canfd_frame_t *frame);
+static void pack_status_message(uint32_t signal, const uint8_t *data,
+                                uint32_t len, const canfd_frame_t *frame);
+#endif
+
+#if (ENABLE_CLASSIFY)
+/* classified identifiers and their handlers */
+static void classify_setup(void);
+static void classify_frame(const canfd_frame_t *frame);
+static void classify_mux_frame(const canfd_frame_t *frame);
+#endif
 
-/* handler for general errors */
-void handle_error(uint32_t status);
+#if (ENABLE_ERROR_LOG)
+/* bus error events, also shown by the user LED */
+static void log_bus_errors(void);
+#endif
+
+/* handler for general errors; not inlined so that the fault record shows
+ * the calling line */
+CY_NOINLINE void handle_error(uint32_t status);
 
 /*******************************************************************************
 * Function Definitions
@@ -110,10 +423,10 @@ void handle_error(uint32_t status);
 ********************************************************************************
 * Summary:
 * This is the main function. It initializes the CAN-FD channel and interrupt.
-* User button and User LED are also initialized. The main loop checks for the
-* button pressed interrupt flag and when it is set, a CAN-FD frame is sent.
-* Whenever a CAN-FD frame is received from other nodes, the user LED toggles and
-* the received data is logged over serial terminal.
+* User button and User LED are also initialized. The main loop runs the actions
+* of the debounced button events; a click sends a CAN-FD frame.
+* Whenever a CAN-FD frame is received from other nodes, the received data is
+* logged over serial terminal; the user LED shows the bus activity.
 *
 * Parameters:
 *  none
@@ -125,102 +438,520 @@ void handle_error(uint32_t status);
 int main(void)
 {
     cy_rslt_t result;
+    /* The previous run ended with a fault */
+    bool recovering;
 
     cy_en_canfd_status_t status;
+#if (RX_REPORT && !ENABLE_TASKS)
+    /* Start of the current Rx report interval */
+    uint32_t rx_report_cycles;
+#endif
     /* Initialize the device and board peripherals */
     result = cybsp_init();
     /* Board init failed. Stop program execution */
     handle_error(result);
+
+    /* Check for a fault record and start timing the recovery */
+    recovering = fault_capture_init();
     /* Initialize retarget-io for uart logging */
     result = cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX,
                                 CY_RETARGET_IO_BAUDRATE);
     /* Retarget-io init failed. Stop program execution */
     handle_error(result);
 
-    printf("===========================================================\r\n");
-    printf("Welcome to CAN-FD example\r\n");
-    printf("===========================================================\r\n\n");
+    /* After a fault, get back on the bus first; the record is reported
+     * once the channel is active */
+    if (recovering)
+    {
+        printf("CAN-FD Node-%d restarted after a fault\r\n", USE_CANFD_NODE);
+    }
+    else
+    {
+        printf("===========================================================\r\n");
+        printf("Welcome to CAN-FD example\r\n");
+        printf("===========================================================\r\n\n");
+
+        printf("===========================================================\r\n");
+        printf("CAN-FD Node-%d (message id)\r\n", USE_CANFD_NODE);
+        printf("===========================================================\r\n\n");
 
-    printf("===========================================================\r\n");
-    printf("CAN-FD Node-%d (message id)\r\n", USE_CANFD_NODE);
-    printf("===========================================================\r\n\n");
+#if (ENABLE_PAYLOAD_SIMD_BENCHMARK)
+        payload_simd_benchmark();
+#endif
+    }
+
+    /* Record trace events from here on (TRACE_ENABLE builds only) */
+    trace_init();
 
     /* Hook the interrupt service routine */
     (void) Cy_SysInt_Init(&canfd_irq_cfg, &isr_canfd);
     /* enable the CAN-FD interrupt */
     NVIC_EnableIRQ(CANFD_INTERRUPT);
 
-    /* Initialize the user LED */
-    result = cyhal_gpio_init(CYBSP_USER_LED, CYHAL_GPIO_DIR_OUTPUT,
-                    CYHAL_GPIO_DRIVE_STRONG, CYBSP_LED_STATE_OFF);
-    /* User LED init failed. Stop program execution */
-    handle_error(result);
-
     /* Initialize the user button */
     result = cyhal_gpio_init(CYBSP_USER_BTN, CYHAL_GPIO_DIR_INPUT,
                     CYBSP_USER_BTN_DRIVE, CYBSP_BTN_OFF);
     /* User button init failed. Stop program execution */
     handle_error(result);
 
-    /* Configure GPIO interrupt */
-    gpio_btn_callback_data.callback = gpio_interrupt_handler;
-    cyhal_gpio_register_callback(CYBSP_USER_BTN,
-                                 &gpio_btn_callback_data);
-    cyhal_gpio_enable_event(CYBSP_USER_BTN, CYHAL_GPIO_IRQ_FALL,
-                                     GPIO_INTERRUPT_PRIORITY, true);
+    /* Debounced button events: click sends the frame, double click runs the
+     * payload benchmark, triple click exports a binary statistics snapshot,
+     * long press prints the statistics */
+    result = input_init();
+    handle_error(result);
+    user_btn_input = (uint8_t)input_register(CYBSP_USER_BTN,
+                                             (CYBSP_BTN_PRESSED == 0u));
+    (void)input_map(user_btn_input, INPUT_EVENT_CLICK, 1u, action_send_frame);
+    (void)input_map(user_btn_input, INPUT_EVENT_CLICK, 2u, action_benchmark);
+    (void)input_map(user_btn_input, INPUT_EVENT_CLICK, 3u,
+                    action_export_stats);
+    (void)input_map(user_btn_input, INPUT_EVENT_LONG_PRESS, 0u,
+                    action_dump_stats);
 
     /* Enable global interrupts */
     __enable_irq();
 
+#if (ENABLE_DISPATCH)
+    /* Receive handlers by identifier; the other frames are printed */
+    (void)canfd_dispatch_add(&rx_stats_handler, STATS_REQUEST_CAN_ID,
+                             STATS_REQUEST_CAN_ID, false);
+#if (ENABLE_FLASH_LOG)
+    (void)canfd_dispatch_add(&rx_readback_handler, FLASH_READBACK_CMD_ID,
+                             FLASH_READBACK_CMD_ID, false);
+#endif
+#if (ENABLE_SENSOR_STREAM)
+    (void)canfd_dispatch_add(&rx_stream_handler, SENSOR_STREAM_CAN_ID,
+                             SENSOR_STREAM_CAN_ID, false);
+#endif
+#if (ENABLE_PACKING)
+    (void)canfd_dispatch_add(&rx_pack_handler, PACK_CAN_ID_BASE + CANFD_NODE_1,
+                             PACK_CAN_ID_BASE + CANFD_NODE_2, false);
+#endif
+    (void)canfd_dispatch_set_default(&rx_print_handler);
+#endif
+
     /* Initialize CAN-FD Channel */
-    status = Cy_CANFD_Init(CANFD_HW, CANFD_HW_CHANNEL, &CANFD_config,
+    status = Cy_CANFD_Init(CANFD_HW, CANFD_HW_CHANNEL, canfd_cfg_init(),
                            &canfd_context);
 
     handle_error(status);
 
+    /* Add the Tx FIFO used by the Tx queue */
+    status = canfd_txq_init(CANFD_HW, CANFD_HW_CHANNEL, canfd_cfg_get(),
+                            &canfd_context);
+
+    handle_error(status);
+
+#if (ENABLE_AUTOBAUD || ENABLE_CALIBRATION)
+    /* Settings found in earlier runs; without internal flash they only last
+     * until the next reset */
+    result = config_store_init();
+    if ((CONFIG_STORE_RSLT_EMPTY != result) &&
+        (CONFIG_STORE_RSLT_NO_FLASH != result))
+    {
+        handle_error(result);
+    }
+#endif
+
+#if (ENABLE_AUTOBAUD)
+    /* Find the bit rate before taking part in the bus traffic, starting
+     * with the profile stored in flash, or the timing of design.modus if
+     * none is stored. Without a lock, the best effort is used, or the
+     * starting profile stays. Only a locked profile is stored */
+    if (config_store_get()->bitrate_profile < canfd_bitrate_profile_count)
+    {
+        bitrate_profile = config_store_get()->bitrate_profile;
+    }
+    result = canfd_autobaud_run(CANFD_HW, CANFD_HW_CHANNEL, bitrate_profile);
+    canfd_autobaud_print_stats();
+    if ((CANFD_AUTOBAUD_RSLT_NO_TRAFFIC != result) &&
+        (CANFD_AUTOBAUD_RSLT_NO_MATCH != result) &&
+        (CANFD_AUTOBAUD_RSLT_BEST_EFFORT != result))
+    {
+        handle_error(result);
+    }
+    bitrate_profile = (uint8_t)canfd_autobaud_get_stats()->profile;
+    canfd_cfg_set_bitrate(&canfd_bitrate_profiles[bitrate_profile]);
+    if (canfd_autobaud_get_stats()->locked &&
+        (config_store_get()->bitrate_profile != bitrate_profile))
+    {
+        config_store_get()->bitrate_profile = bitrate_profile;
+        (void)config_store_save();
+    }
+#endif
+
+#if (ENABLE_CALIBRATION)
+    /* Calibrated timing, if it was measured at the bit rates in use */
+    if (config_store_get()->timing_profile == bitrate_profile)
+    {
+        calibrated_profile.name = canfd_bitrate_profiles[bitrate_profile].name;
+        calibrated_profile.nominal = config_store_get()->nominal;
+        calibrated_profile.data = config_store_get()->data;
+        status = canfd_calib_apply(CANFD_HW, CANFD_HW_CHANNEL,
+                                   &calibrated_profile);
+        handle_error(status);
+        canfd_cfg_set_bitrate(&calibrated_profile);
+        printf("Calibrated timing of %s loaded\r\n", calibrated_profile.name);
+    }
+#endif
+
+    /* Faults from here on also record the channel state */
+    fault_capture_attach(CANFD_HW, CANFD_HW_CHANNEL);
+
+#if (ENABLE_RX_COALESCING)
+    /* Take over Rx FIFO 0 from the PDL handler */
+    result = canfd_coalesce_init(CANFD_HW, CANFD_HW_CHANNEL, &canfd_context);
+    handle_error(result);
+#endif
+
+#if (ENABLE_CANFD_LEAN_ISR)
+    /* isr_canfd calls the specialized handler */
+    canfd_lean_isr_init(CANFD_HW, CANFD_HW_CHANNEL, &canfd_context);
+#endif
+
+#if (ENABLE_CANFD_POLLING)
+    /* The main loop replaces the CAN-FD interrupt */
+    canfd_poll_init(CANFD_HW, CANFD_HW_CHANNEL, &canfd_context,
+                    CANFD_INTERRUPT);
+#endif
+
+#if (ENABLE_FILTER_SWAP)
+    /* Move the filter lists to two switchable regions; before the message
+     * RAM check, which shadows them */
+    result = canfd_filter_init(CANFD_HW, CANFD_HW_CHANNEL, canfd_cfg_get(),
+                               &canfd_context);
+    handle_error(result);
+#endif
+
+#if (ENABLE_CLASSIFY)
+    /* Second stage behind the acceptance filters */
+    classify_setup();
+    canfd_classify_benchmark();
+#if (ENABLE_FILTER_SWAP)
+    /* First stage: coarse ranges around the classified identifiers */
+    switch_filters(false);
+#endif
+#endif
+
+#if (ENABLE_MRAM_CHECK)
+    /* Shadow the filter lists; dedicated Tx buffer 0 is restored from its
+     * configuration */
+    result = canfd_mram_init(CANFD_HW, CANFD_HW_CHANNEL, &canfd_context);
+    handle_error(result);
+    (void)canfd_mram_attach_tx_buffer(CANFD_BUFFER_INDEX, &CANFD_txBuffer_0);
+#endif
+
+#if (ENABLE_ERROR_LOG)
+    /* Protocol error and error state interrupts */
+    result = canfd_errlog_init(CANFD_HW, CANFD_HW_CHANNEL);
+    handle_error(result);
+#endif
+
+#if (RX_REPORT && !ENABLE_TASKS)
+    rx_report_cycles = cycle_count_now();
+#endif
+
+    /* The user LED shows bus activity, load and errors */
+    result = led_activity_init(CANFD_HW, CANFD_HW_CHANNEL);
+    handle_error(result);
+
+#if (ENABLE_FLASH_LOG)
+    /* Open the log in the external flash */
+    result = flash_log_init();
+    handle_error(result);
+#endif
+
+#if (ENABLE_PACKING)
+    /* Status messages to the other node, packed by bus load */
+    canfd_pack_init();
+    (void)canfd_pack_open(0UL, PACK_CAN_ID_BASE + USE_CANFD_NODE, false);
+#endif
+
     /* Setting Node(message) Identifier to global setting of "USE_CANFD_NODE" */
     CANFD_T0RegisterBuffer_0.id = USE_CANFD_NODE;
 
+#if (ENABLE_SENSOR_STREAM)
+    sensor_stream_report_capacity();
+#if (USE_CANFD_NODE == CANFD_NODE_1)
+    result = sensor_stream_init();
+    handle_error(result);
+    result = sensor_stream_start();
+    handle_error(result);
+#else
+    result = sensor_stream_rx_init();
+    handle_error(result);
+#endif
+#endif
+
+    /* Deadline monitoring of the main loop, and the watchdog */
+    result = supervisor_init((0u != ENABLE_WATCHDOG) ? WATCHDOG_TIMEOUT_MS : 0UL);
+    handle_error(result);
+    (void)supervisor_add(&stage_tx);
+    (void)supervisor_add(&stage_rx);
+    (void)supervisor_add(&stage_log);
+    (void)supervisor_add(&stage_shell);
+
+#if (ENABLE_TASKS)
+    /* The tasks wait for their interrupts; the sleeps use the tick started
+     * by input_init */
+    (void)supervisor_add(&stage_tasks);
+#if (ENABLE_RX_COALESCING || ENABLE_CANFD_LEAN_ISR)
+    canfd_rxq_set_event(&rxq_event);
+    (void)task_add(&rx_task);
+#endif
+    cyhal_uart_register_callback(&cy_retarget_io_uart_obj, uart_rx_callback,
+                                 NULL);
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj,
+                            CYHAL_UART_IRQ_RX_NOT_EMPTY, UART_RX_IRQ_PRIORITY,
+                            true);
+    (void)task_add(&shell_task);
+#if (RX_REPORT)
+    (void)task_add(&report_task);
+#endif
+#endif
+
     for(;;)
     {
-        if (true == gpio_intr_flag)
-        {
-            /* Sending CAN-FD frame to other node */
-            status = Cy_CANFD_UpdateAndTransmitMsgBuffer(CANFD_HW,
-                                                    CANFD_HW_CHANNEL,
-                                                    &CANFD_txBuffer_0,
-                                                    CANFD_BUFFER_INDEX,
-                                                    &canfd_context);
-            if(CY_CANFD_SUCCESS == status)
-            {
-                printf("CAN-FD Frame sent with message ID-%d\r\n\r\n",
-                        USE_CANFD_NODE);
-            }
-            else
-            {
-                printf("Error sending CAN-FD Frame with message ID-%d\r\n\r\n",
-                        USE_CANFD_NODE);
-            }
+        TRACE_LOOP_ITERATION();
+
+        /* Refill the hardware Tx FIFO from the Tx queue */
+        supervisor_begin(&stage_tx);
+#if (ENABLE_PACKING)
+        /* Pack the status messages; the wait for more depends on the load */
+        send_status_messages();
+        (void)canfd_pack_service(led_activity_get_stats()->load_permille);
+#endif
+        (void)canfd_txq_service();
+        supervisor_end(&stage_tx);
 
-            gpio_intr_flag = false;
+        supervisor_begin(&stage_rx);
+#if (ENABLE_CANFD_POLLING)
+#if (ENABLE_MRAM_CHECK)
+        (void)canfd_mram_isr();
+#endif
+#if (ENABLE_ERROR_LOG)
+        log_bus_errors();
+#endif
+        /* Receive, complete transmissions and handle channel events */
+        (void)canfd_poll(process_rx_frame);
+#endif
+
+#if ((ENABLE_RX_COALESCING || ENABLE_CANFD_LEAN_ISR) && !ENABLE_TASKS)
+        /* Handle the frames queued by the Rx interrupt or drain timer */
+        (void)canfd_rxq_process(process_rx_frame, 0UL);
+#endif
+
+#if (ENABLE_SENSOR_STREAM)
+        sensor_stream_process();
+#endif
+        supervisor_end(&stage_rx);
+
+        supervisor_begin(&stage_log);
+#if (RX_REPORT && !ENABLE_TASKS)
+        if ((cycle_count_now() - rx_report_cycles) >=
+            ((SystemCoreClock / 1000UL) * RX_REPORT_INTERVAL_MS))
+        {
+            print_rx_report();
+            rx_report_cycles = cycle_count_now();
         }
+#endif
+
+        /* Answer statistics requests and send the trace */
+        stats_process();
+        trace_process();
+
+        /* Recovery time and fault report, once the channel is on the bus */
+        fault_capture_process();
+
+#if (ENABLE_FLASH_LOG)
+        /* Program the closed log pages, one command at a time, and send the
+         * log to a host that reads it back */
+        flash_log_process();
+        flash_readback_process();
+#endif
+
+#if (ENABLE_MRAM_CHECK)
+        /* Compare a few filter words with their shadow */
+        canfd_mram_process();
+#endif
+
+#if (ENABLE_ERROR_LOG)
+        /* Close the minute of the error rates */
+        canfd_errlog_process(led_activity_get_stats()->rx +
+                             led_activity_get_stats()->tx);
+#endif
+
+#if (ENABLE_DISPATCH)
+        /* Run the deferred receive handlers */
+        (void)canfd_dispatch_process(0UL);
+#endif
+        supervisor_end(&stage_log);
+
+        /* Run the actions of the button events and UART commands */
+        supervisor_begin(&stage_shell);
+        (void)input_process();
+#if (!ENABLE_TASKS)
+        (void)process_uart_command();
+#endif
+        supervisor_end(&stage_shell);
+
+#if (ENABLE_TASKS)
+        /* Resume the tasks woken by their events and timers */
+        supervisor_begin(&stage_tasks);
+        (void)task_run();
+        supervisor_end(&stage_tasks);
+#endif
+
+        /* The watchdog is serviced once every stage has completed */
+        supervisor_service();
     }
 }
 
 /*******************************************************************************
-* Function Name: gpio_interrupt_handler
+* Function Name: action_send_frame
+********************************************************************************
+* Summary:
+*   Button click: queues the CAN-FD frame of this node, configured in
+*   CANFD_txBuffer_0, waiting up to TX_SEND_TIMEOUT_MS while the Tx queue is
+*   full.
+*
+* Parameters:
+*  const input_event_t *event (unused)
+*
+*******************************************************************************/
+static void action_send_frame(const input_event_t *event)
+{
+    canfd_frame_t frame;
+    cy_rslt_t result;
+
+    (void)event;
+
+    /* Sending CAN-FD frame to other node */
+    canfd_frame_from_tx_buffer(&CANFD_txBuffer_0, &frame);
+    result = canfd_txq_send(&frame, TX_SEND_TIMEOUT_MS);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        printf("CAN-FD Frame sent with message ID-%d\r\n\r\n",
+                USE_CANFD_NODE);
+    }
+    else
+    {
+        printf("CAN-FD Frame with message ID-%d not sent: Tx queue full "
+               "for %u ms\r\n\r\n", USE_CANFD_NODE, TX_SEND_TIMEOUT_MS);
+    }
+}
+
+/*******************************************************************************
+* Function Name: action_benchmark
+********************************************************************************
+* Summary:
+*   Button double click: runs the payload kernel benchmark.
+*
+* Parameters:
+*  const input_event_t *event (unused)
+*
+*******************************************************************************/
+static void action_benchmark(const input_event_t *event)
+{
+    (void)event;
+
+    payload_simd_benchmark();
+}
+
+/*******************************************************************************
+* Function Name: action_dump_stats
 ********************************************************************************
 * Summary:
-*   GPIO interrupt handler.
+*   Button long press: prints the statistics registry and the stream counters.
 *
 * Parameters:
-*  void *handler_arg (unused)
-*  cyhal_gpio_event_t (unused)
+*  const input_event_t *event (unused)
 *
 *******************************************************************************/
-static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event)
+static void action_dump_stats(const input_event_t *event)
 {
-    gpio_intr_flag = true;
+    (void)event;
+
+    stats_print();
+    supervisor_print_stats();
+#if (ENABLE_AUTOBAUD)
+    canfd_autobaud_print_stats();
+#endif
+#if (ENABLE_CALIBRATION)
+    canfd_calib_print_stats();
+#endif
+#if (ENABLE_TASKS)
+    task_print_stats();
+#endif
+#if (ENABLE_MRAM_CHECK)
+    canfd_mram_print_stats();
+#endif
+#if (ENABLE_ERROR_LOG)
+    canfd_errlog_print_stats();
+#endif
+#if (ENABLE_FILTER_SWAP)
+    canfd_filter_print_stats();
+#endif
+#if (ENABLE_CLASSIFY)
+    canfd_classify_print_stats();
+#endif
+#if (ENABLE_DISPATCH)
+    canfd_dispatch_print_stats();
+#endif
+#if (ENABLE_FLASH_LOG)
+    flash_log_print_stats();
+    flash_readback_print_stats();
+#endif
+#if (ENABLE_PACKING)
+    canfd_pack_print_stats();
+    printf("Peer status: %lu ms, Tx queue %lu, load %lu permille, %lu frames "
+           "received\r\n", (unsigned long)pack_peer_status[PACK_SIG_TICK_MS],
+           (unsigned long)pack_peer_status[PACK_SIG_TXQ_DEPTH],
+           (unsigned long)pack_peer_status[PACK_SIG_BUS_LOAD],
+           (unsigned long)pack_peer_status[PACK_SIG_RX_FRAMES]);
+#endif
+#if (ENABLE_SENSOR_STREAM)
+    printf("Stream:\r\n");
+    sensor_stream_print_stats();
+#endif
+    printf("\r\n");
+}
+
+/*******************************************************************************
+* Function Name: action_export_stats
+********************************************************************************
+* Summary:
+*   Button triple click: sends the statistics schema and values over the
+*   UART, for scripts/stats_view.py.
+*
+* Parameters:
+*  const input_event_t *event (unused)
+*
+*******************************************************************************/
+static void action_export_stats(const input_event_t *event)
+{
+    (void)event;
+
+    stats_request(BINLOG_CHANNEL_UART, true);
+}
+
+/*******************************************************************************
+* Function Name: read_can_tec / read_can_rec
+********************************************************************************
+* Summary:
+*   Transmit and receive error counters of the channel.
+*
+*******************************************************************************/
+static uint32_t read_can_tec(void)
+{
+    return _FLD2VAL(CANFD_CH_M_TTCAN_ECR_TEC,
+                    CANFD_ECR(CANFD_HW, CANFD_HW_CHANNEL));
+}
+
+static uint32_t read_can_rec(void)
+{
+    return _FLD2VAL(CANFD_CH_M_TTCAN_ECR_REC,
+                    CANFD_ECR(CANFD_HW, CANFD_HW_CHANNEL));
 }
 
 /*******************************************************************************
@@ -235,15 +966,57 @@ static void gpio_interrupt_handler(void *handler_arg, cyhal_gpio_event_t event)
 *******************************************************************************/
 static void isr_canfd(void)
 {
+#if (RX_REPORT)
+    uint32_t start = cycle_count_now();
+    isr_rx_frames = 0UL;
+    isr_handler_cycles = 0UL;
+#endif
+
+    TRACE(TRACE_ISR_ENTER, 0u, 0u);
+
+#if (ENABLE_MRAM_CHECK)
+    /* Message RAM errors first, so the other handlers see a repaired RAM */
+    (void)canfd_mram_isr();
+#endif
+
+#if (ENABLE_ERROR_LOG)
+    /* Bus errors before the PDL handler, which would clear their flags */
+    log_bus_errors();
+#endif
+
+#if (ENABLE_CANFD_LEAN_ISR)
+    isr_rx_frames = canfd_lean_isr();
+#else
+#if (ENABLE_RX_COALESCING)
+    /* Rx FIFO 0 goes to the Rx queue; the PDL handles the other sources */
+    isr_rx_frames = canfd_coalesce_isr();
+#endif
+
     /* Just call the IRQ handler with the current channel number and context */
     Cy_CANFD_IrqHandler(CANFD_HW, CANFD_HW_CHANNEL, &canfd_context);
+#endif
+
+#if (RX_REPORT)
+    /* Interrupts without received frames (Tx complete, errors) are not
+     * part of the Rx cost, and neither is the application handling */
+    if (0UL != isr_rx_frames)
+    {
+        canfd_perf_add(&isr_perf,
+                       cycle_count_now() - start - isr_handler_cycles,
+                       isr_rx_frames);
+    }
+#endif
+
+    TRACE(TRACE_ISR_EXIT, 0u, 0u);
 }
 
 /*******************************************************************************
 * Function Name: canfd_rx_callback
 ********************************************************************************
 * Summary:
-* This is the callback function for can-fd reception
+* This is the callback function for can-fd reception. Frames read from
+* message RAM with an uncorrected bit error are dropped and counted by
+* canfd_mram.c.
 *
 * Parameters:
 *    msg_valid                     Message received properly or not
@@ -254,50 +1027,604 @@ static void isr_canfd(void)
 void canfd_rx_callback (bool  msg_valid, uint8_t msg_buf_fifo_num,
                         cy_stc_canfd_rx_buffer_t* canfd_rx_buf)
 {
-    /* Array to hold the data bytes of the CAN-FD frame */
-    uint8_t canfd_data_buffer[CANFD_DLC];
-    /* Variable to hold the data length code of the CAN-FD frame */
-    uint32_t canfd_dlc;
-    /* Variable to hold the Identifier of the CAN-FD frame */
-    uint32_t canfd_id;
+    /* Received frame in the application format */
+    canfd_frame_t frame;
 
     if (true == msg_valid)
     {
-        /* Checking whether the frame received is a data frame */
-        if(CY_CANFD_RTR_DATA_FRAME == canfd_rx_buf->r0_f->rtr)
+#if (RX_REPORT)
+        isr_rx_frames++;
+#endif
+        canfd_frame_from_rx_buffer(canfd_rx_buf, &frame);
+        /* The PDL has just read the element from message RAM; a frame read
+         * with an uncorrected bit error is dropped, as by the Rx queue */
+        if (canfd_mram_rx_error(CANFD_HW, CANFD_HW_CHANNEL))
+        {
+            return;
+        }
+        frame.timestamp = cycle_count_now();
+        process_rx_frame(&frame);
+#if (RX_REPORT)
+        isr_handler_cycles += cycle_count_now() - frame.timestamp;
+#endif
+    }
+}
+
+/*******************************************************************************
+* Function Name: process_rx_frame
+********************************************************************************
+* Summary:
+* Handles a received frame: every frame is counted for the activity LED and
+* recorded in the flash log. With ENABLE_DISPATCH the frame then goes to the
+* handler registered for its identifier; otherwise statistics requests,
+* readback commands and stream frames go to their modules and the other
+* frames are printed, except while the flash log records. Called from
+* canfd_rx_callback, or from the main loop when the Rx queue is used.
+*
+* Parameters:
+*    frame                         Received frame
+*
+*******************************************************************************/
+static void process_rx_frame(const canfd_frame_t *frame)
+{
+    led_activity_rx();
+    TRACE(TRACE_RX_FRAME, frame->len, frame->id);
+
+#if (ENABLE_FLASH_LOG)
+    /* Every frame on the bus is recorded */
+    flash_log_frame(frame);
+#endif
+
+#if (ENABLE_CALIBRATION)
+    /* Test frames of a calibration are only counted */
+    if (canfd_calib_rx_frame(frame))
+    {
+        return;
+    }
+#endif
+
+#if (ENABLE_DISPATCH)
+    (void)canfd_dispatch_rx(frame);
+#else
+    /* Statistics requests are answered from the main loop */
+    if (stats_rx_frame(frame))
+    {
+        return;
+    }
+
+#if (ENABLE_FLASH_LOG)
+    /* So are the commands of a log readback */
+    if (flash_readback_rx_frame(frame))
+    {
+        return;
+    }
+#endif
+
+#if (ENABLE_SENSOR_STREAM)
+    /* Frames of a registered stream go to its reassembler */
+    if (stream_reasm_push_frame(frame))
+    {
+        return;
+    }
+#endif
+
+#if (ENABLE_PACKING)
+    /* Packed status messages are unpacked */
+    if (pack_rx_frame(frame))
+    {
+        return;
+    }
+#endif
+
+    print_rx_frame(frame);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: print_rx_frame
+********************************************************************************
+* Summary:
+* Prints a data frame over the serial terminal, unless the classifier has
+* a handler for it (ENABLE_CLASSIFY). While the flash log records, the frames
+* are not printed so that the UART does not limit the frame rate.
+*
+* Parameters:
+*    frame                         Received frame
+*
+*******************************************************************************/
+static void print_rx_frame(const canfd_frame_t *frame)
+{
+    /* Data bytes of the CAN-FD frame */
+    const uint8_t *canfd_data = (const uint8_t *)frame->data;
+
+#if (ENABLE_CLASSIFY)
+    /* Classified identifiers go to their handlers */
+    if (canfd_classify_dispatch(frame))
+    {
+        return;
+    }
+#endif
+
+#if (ENABLE_FLASH_LOG)
+    if (flash_log_is_recording())
+    {
+        return;
+    }
+#endif
+
+    /* Checking whether the frame received is a data frame */
+    if (0U == (frame->flags & CANFD_FRAME_FLAG_RTR))
+    {
+        printf("%d bytes received with message identifier %d\r\n\r\n",
+                                                    (int)frame->len,
+                                                    (int)frame->id);
+
+        printf("Rx Data : ");
+
+        for (uint8_t msg_idx = 0U; msg_idx < frame->len ; msg_idx++)
         {
+            printf(" %d ", canfd_data[msg_idx]);
+        }
+
+        printf("\r\n\r\n");
+    }
+}
+
+#if (ENABLE_DISPATCH)
+/*******************************************************************************
+* Function Name: rx_stats_frame / rx_readback_frame / rx_stream_frame
+********************************************************************************
+* Summary:
+* Fast receive handlers: the modules only take the frame, the work is done
+* from the main loop.
+*
+*******************************************************************************/
+static void rx_stats_frame(const canfd_frame_t *frame)
+{
+    (void)stats_rx_frame(frame);
+}
+
+#if (ENABLE_FLASH_LOG)
+static void rx_readback_frame(const canfd_frame_t *frame)
+{
+    (void)flash_readback_rx_frame(frame);
+}
+#endif
+
+#if (ENABLE_SENSOR_STREAM)
+static void rx_stream_frame(const canfd_frame_t *frame)
+{
+    (void)stream_reasm_push_frame(frame);
+}
+#endif
 
-            cyhal_gpio_toggle(CYBSP_USER_LED);
+#if (ENABLE_PACKING)
+static void rx_pack_frame(const canfd_frame_t *frame)
+{
+    (void)pack_rx_frame(frame);
+}
+#endif
+#endif
 
-            canfd_dlc = canfd_rx_buf->r1_f->dlc;
-            canfd_id  = canfd_rx_buf->r0_f->id;
+#if (ENABLE_PACKING)
+/*******************************************************************************
+* Function Name: send_status_messages
+********************************************************************************
+* Summary:
+* Every PACK_STATUS_PERIOD_MS, passes four status values of 1 to 4 bytes to
+* the packer. On a quiet bus each set leaves in one frame right away; on a
+* busy bus several sets share a frame within the budgets of the values.
+*
+*******************************************************************************/
+static void send_status_messages(void)
+{
+    uint32_t now = sys_tick_ms();
+    uint8_t depth;
+    uint16_t load;
+    uint32_t rx_frames;
 
-            printf("%d bytes received with message identifier %d\r\n\r\n",
-                                                        (int)canfd_dlc,
-                                                        (int)canfd_id);
+    if ((now - pack_status_ms) < PACK_STATUS_PERIOD_MS)
+    {
+        return;
+    }
+    pack_status_ms = now;
 
-            memcpy(canfd_data_buffer,canfd_rx_buf->data_area_f,canfd_dlc);
+    depth = (uint8_t)canfd_txq_depth();
+    load = (uint16_t)led_activity_get_stats()->load_permille;
+    rx_frames = led_activity_get_stats()->rx;
+    (void)canfd_pack_send(0UL, PACK_SIG_TICK_MS, &now, sizeof(now), 50UL);
+    (void)canfd_pack_send(0UL, PACK_SIG_TXQ_DEPTH, &depth, sizeof(depth),
+                          20UL);
+    (void)canfd_pack_send(0UL, PACK_SIG_BUS_LOAD, &load, sizeof(load), 100UL);
+    (void)canfd_pack_send(0UL, PACK_SIG_RX_FRAMES, &rx_frames,
+                          sizeof(rx_frames), 100UL);
+}
 
-            printf("Rx Data : ");
+/*******************************************************************************
+* Function Name: pack_rx_frame
+********************************************************************************
+* Summary:
+* Unpacks the status messages of a packed frame of either node.
+*
+* Return:
+*  bool  false if the frame is not a packed frame
+*
+*******************************************************************************/
+static bool pack_rx_frame(const canfd_frame_t *frame)
+{
+    if ((0U != (frame->flags & CANFD_FRAME_FLAG_XTD)) ||
+        (frame->id < (PACK_CAN_ID_BASE + CANFD_NODE_1)) ||
+        (frame->id > (PACK_CAN_ID_BASE + CANFD_NODE_2)))
+    {
+        return false;
+    }
+    (void)canfd_pack_unpack(frame, pack_status_message);
+    return true;
+}
 
-            for (uint8_t msg_idx = 0U; msg_idx < canfd_dlc ; msg_idx++)
+/*******************************************************************************
+* Function Name: pack_status_message
+********************************************************************************
+* Summary:
+* Keeps the latest value of each known status signal of the other node.
+*
+*******************************************************************************/
+static void pack_status_message(uint32_t signal, const uint8_t *data,
+                                uint32_t len, const canfd_frame_t *frame)
+{
+    uint32_t value = 0UL;
+
+    (void)frame;
+    if ((signal < PACK_SIGNALS) && (len <= sizeof(value)))
+    {
+        memcpy(&value, data, len);
+        pack_peer_status[signal] = value;
+    }
+}
+#endif
+
+/*******************************************************************************
+* Function Name: process_uart_command
+********************************************************************************
+* Summary:
+* Reads one character from the debug UART, if any, and runs the command:
+* statistics snapshot ('s' with schema, 'v' values only), trace dump ('t'),
+* start/stop of the trace streaming ('T'), the Tx batch benchmark ('x'), and
+* with ENABLE_FLASH_LOG start/stop of a recording ('r'), dump of the last log
+* pages ('d') or erase of the log ('E'), with ENABLE_TASKS the task switch
+* benchmark ('b'), with ENABLE_MRAM_CHECK a changed filter word for the scrub
+* to find ('M'), with ENABLE_FILTER_SWAP a switch of the filter table
+* ('F'), with ENABLE_ERROR_LOG the bus error log and rates ('e'), and with
+* ENABLE_CALIBRATION a sample point calibration against the other nodes
+* ('c') or in loopback ('l').
+* The answers are binary log records for the scripts in the scripts
+* directory.
+*
+* Return:
+*  bool  true if a character was read
+*
+*******************************************************************************/
+static bool process_uart_command(void)
+{
+    uint8_t command;
+    canfd_frame_t frame;
+
+    if ((0UL == cyhal_uart_readable(&cy_retarget_io_uart_obj)) ||
+        (CY_RSLT_SUCCESS != cyhal_uart_getc(&cy_retarget_io_uart_obj,
+                                            &command, 1UL)))
+    {
+        return false;
+    }
+
+    switch (command)
+    {
+        case UART_CMD_STATS:
+        case UART_CMD_STATS_VALUES:
+            stats_request(BINLOG_CHANNEL_UART, UART_CMD_STATS == command);
+            break;
+
+        case UART_CMD_TRACE_DUMP:
+            trace_dump(BINLOG_CHANNEL_UART);
+            break;
+
+        case UART_CMD_TRACE_STREAM:
+            trace_set_streaming(BINLOG_CHANNEL_UART, !trace_is_streaming());
+            break;
+
+        case UART_CMD_TX_BENCH:
+            canfd_frame_from_tx_buffer(&CANFD_txBuffer_0, &frame);
+            frame.id = TX_BENCH_ID;
+            frame.flags &= (uint8_t)~CANFD_FRAME_FLAG_XTD;
+            canfd_txq_benchmark(&frame);
+            break;
+
+#if (ENABLE_FLASH_LOG)
+        case UART_CMD_FLASH_RECORD:
+            if (flash_log_is_recording())
+            {
+                flash_log_stop();
+                printf("Flash log: recording stopped\r\n");
+            }
+            else
             {
-                printf(" %d ", canfd_data_buffer[msg_idx]);
+                printf("Flash log: %s\r\n", flash_log_start() ?
+                       "recording" : "cannot record (full or busy)");
             }
+            break;
+
+        case UART_CMD_FLASH_DUMP:
+            (void)flash_log_dump(BINLOG_CHANNEL_UART, 0UL);
+            break;
+
+        case UART_CMD_FLASH_ERASE:
+            printf("Flash log: %s\r\n", flash_log_erase() ?
+                   "erasing" : "cannot erase while recording or busy");
+            break;
+#endif
+
+#if (ENABLE_MRAM_CHECK)
+        case UART_CMD_MRAM_INJECT:
+            printf("Message RAM: %s\r\n", canfd_mram_inject(0UL) ?
+                   "filter word 0 changed" : "no filters");
+            break;
+#endif
+
+#if (ENABLE_ERROR_LOG)
+        case UART_CMD_ERROR_LOG:
+            canfd_errlog_print_events();
+            canfd_errlog_print_stats();
+            break;
+#endif
+
+#if (ENABLE_CALIBRATION)
+        case UART_CMD_CALIBRATE:
+        case UART_CMD_CALIBRATE_LOOP:
+            calibrate(UART_CMD_CALIBRATE_LOOP == command);
+            break;
+#endif
+
+#if (ENABLE_FILTER_SWAP)
+        case UART_CMD_FILTER_SWAP:
+            switch_filters(!filters_accept_all);
+            break;
+#endif
+
+#if (ENABLE_TASKS)
+        case UART_CMD_TASK_BENCH:
+            if (!task_benchmark_start())
+            {
+                printf("Task benchmark: running, or no free task\r\n");
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+    return true;
+}
+
+#if (ENABLE_CALIBRATION)
+/*******************************************************************************
+* Function Name: calibrate
+********************************************************************************
+* Summary:
+* Calibrates the timing of the bit rates in use and keeps it in the
+* configuration store for the next start-up. Without an error-free setting
+* the timing in use before is restored. Blocks for up to a few seconds,
+* longer than the watchdog timeout, so the watchdog is stopped meanwhile.
+*
+* Parameters:
+*  loopback   true to run in external loopback, false to send the test
+*             frames to the other nodes
+*
+*******************************************************************************/
+static void calibrate(bool loopback)
+{
+    const canfd_calib_stats_t *stats = canfd_calib_get_stats();
+    config_store_t *store = config_store_get();
+    canfd_bitrate_profile_t result;
+    cy_rslt_t status;
+
+    printf("Calibration of %s %s...\r\n",
+           canfd_bitrate_profiles[bitrate_profile].name,
+           loopback ? "in loopback" : "with the other nodes");
+    supervisor_suspend();
+    status = canfd_calib_run(CANFD_HW, CANFD_HW_CHANNEL,
+                             &canfd_bitrate_profiles[bitrate_profile],
+                             loopback, &result);
+    supervisor_resume();
+    canfd_calib_print_stats();
+    if (CY_RSLT_SUCCESS != status)
+    {
+        (void)canfd_calib_apply(CANFD_HW, CANFD_HW_CHANNEL,
+                                canfd_bitrate_get_active());
+        printf("Calibration failed (0x%08lX), timing unchanged\r\n",
+               (unsigned long)status);
+        return;
+    }
+
+    calibrated_profile = result;
+    canfd_cfg_set_bitrate(&calibrated_profile);
+
+    store->timing_profile = bitrate_profile;
+    store->nominal = calibrated_profile.nominal;
+    store->data = calibrated_profile.data;
+    store->sp_margin_permille = stats->data_margin_permille;
+    printf("Calibrated timing %s\r\n",
+           (CY_RSLT_SUCCESS == config_store_save()) ?
+           "saved" : "in use until the next reset");
+}
+#endif
+
+#if (ENABLE_FILTER_SWAP)
+/*******************************************************************************
+* Function Name: switch_filters
+********************************************************************************
+* Summary:
+* Loads the filters configured by the device configurator, with
+* ENABLE_CLASSIFY followed by ranges around the classified identifiers, or
+* filters that accept all standard and extended identifiers to Rx FIFO 0,
+* while the channel keeps receiving, and prints the switch window. Filters
+* that do not fit are reported; they are also counted as filter.rejected.
+*
+* Parameters:
+*  accept_all  true for the accept-all filters
+*
+*******************************************************************************/
+static void switch_filters(bool accept_all)
+{
+    static const canfd_filter_t all_filters[] =
+    {
+        { 0UL, 0x7FFUL, CANFD_FILTER_RANGE, CANFD_FILTER_TO_FIFO0, false },
+        { 0UL, 0x1FFFFFFFUL, CANFD_FILTER_RANGE, CANFD_FILTER_TO_FIFO0,
+          true },
+    };
 
-            printf("\r\n\r\n");
+    bool complete = true;
+
+    canfd_filter_begin();
+    if (accept_all)
+    {
+        for (uint32_t idx = 0UL;
+             idx < (sizeof(all_filters) / sizeof(all_filters[0])); idx++)
+        {
+            complete = canfd_filter_add(&all_filters[idx]) && complete;
         }
     }
+    else
+    {
+        complete = canfd_filter_add_initial();
+#if (ENABLE_CLASSIFY)
+        complete = canfd_classify_add_filters(CLASSIFY_SID_RANGES,
+                                              CLASSIFY_XID_RANGES) &&
+                   complete;
+#endif
+    }
+    canfd_filter_commit();
+    filters_accept_all = accept_all;
+
+    printf("Filters: %s, switched in %lu cycles%s\r\n",
+           accept_all ? "all identifiers" : "configured",
+           (unsigned long)canfd_filter_get_stats()->window_cycles,
+           complete ? "" : ", table full: some filters not loaded");
+}
+#endif
+
+#if (ENABLE_CLASSIFY)
+/*******************************************************************************
+* Function Name: classify_setup
+********************************************************************************
+* Summary:
+* Fills the classifier with an example table: the standard identifiers
+* 0x200 to 0x27F, eight message types multiplexed by the low nibble of byte
+* 0 of identifier 0x300, and 64 extended identifiers 0x18FFxx01 in J1939
+* style.
+*
+*******************************************************************************/
+static void classify_setup(void)
+{
+    for (uint32_t id = 0x200UL; id < 0x280UL; id++)
+    {
+        (void)canfd_classify_add(id, false, classify_frame);
+    }
+    for (uint8_t value = 0U; value < 8U; value++)
+    {
+        (void)canfd_classify_add_mux(0x300UL, false, 0U, 0U, 0x0FU, value,
+                                     classify_mux_frame);
+    }
+    for (uint32_t idx = 0UL; idx < 64UL; idx++)
+    {
+        (void)canfd_classify_add(0x18FF0001UL | (idx << 8), true,
+                                 classify_frame);
+    }
+}
+
+/*******************************************************************************
+* Function Name: classify_frame
+********************************************************************************
+* Summary:
+* Handler of the classified identifiers. The classifier counts the frames
+* per handler; they are not printed, so that the terminal does not limit
+* the frame rate.
+*
+*******************************************************************************/
+static void classify_frame(const canfd_frame_t *frame)
+{
+    (void)frame;
 }
 
+/*******************************************************************************
+* Function Name: classify_mux_frame
+********************************************************************************
+* Summary:
+* Handler of the multiplexed identifier, counted separately.
+*
+*******************************************************************************/
+static void classify_mux_frame(const canfd_frame_t *frame)
+{
+    (void)frame;
+}
+#endif
+
+#if (ENABLE_ERROR_LOG)
+/*******************************************************************************
+* Function Name: log_bus_errors
+********************************************************************************
+* Summary:
+* Logs the pending bus errors and reports each event to the activity LED,
+* from the CAN FD interrupt or the polling loop.
+*
+*******************************************************************************/
+static void log_bus_errors(void)
+{
+    for (uint32_t events = canfd_errlog_isr(); 0UL != events; events--)
+    {
+        led_activity_error();
+    }
+}
+#endif
+
+#if (RX_REPORT)
+/*******************************************************************************
+* Function Name: print_rx_report
+********************************************************************************
+* Summary:
+* Prints the cost of the Rx path in use: the polling loop, or the Rx interrupt
+* with the coalescing state. The interrupt cost excludes the application
+* handling, so builds with Cy_CANFD_IrqHandler, the lean handler and polling
+* can be compared frame for frame.
+*
+*******************************************************************************/
+static void print_rx_report(void)
+{
+#if (ENABLE_CANFD_POLLING)
+    canfd_poll_print_stats();
+#else
+#if (ENABLE_RX_COALESCING)
+    canfd_coalesce_print_stats();
+#endif
+    printf("Rx interrupt, including %u cycles entry and return:\r\n",
+           (unsigned int)CANFD_PERF_IRQ_ENTRY_CYCLES);
+#if (ENABLE_CANFD_LEAN_ISR)
+    canfd_perf_print("lean isr", &isr_perf, CANFD_PERF_IRQ_ENTRY_CYCLES);
+#else
+    canfd_perf_print("pdl isr", &isr_perf, CANFD_PERF_IRQ_ENTRY_CYCLES);
+#endif
+    printf("\r\n");
+#endif
+}
+#endif
+
 /*******************************************************************************
 * Function Name: handle_error
 ********************************************************************************
 *
 * Summary:
 * User defined error handling function. This function processes unrecoverable
-* errors such as any initialization errors etc. In case of such error the system
-* will enter into assert.
+* errors such as any initialization errors etc. In case of such error the
+* state is saved by fault_capture_error and the device restarts; the record is
+* reported once the channel is back on the bus.
 *
 * Parameters:
 *  uint32_t status - status indicates success or failure
@@ -310,8 +1637,97 @@ void handle_error(uint32_t status)
 {
     if (status != CY_RSLT_SUCCESS)
     {
-        CY_ASSERT(0);
+        fault_capture_error(status, FAULT_CAPTURE_CALLER());
     }
 }
 
+#if (ENABLE_TASKS)
+#if (ENABLE_RX_COALESCING || ENABLE_CANFD_LEAN_ISR)
+/*******************************************************************************
+* Function Name: task_rx
+********************************************************************************
+* Summary:
+* Task that handles the received frames whenever the Rx interrupt or the
+* drain timer has queued some.
+*
+*******************************************************************************/
+static uint32_t task_rx(task_t *task)
+{
+    TASK_BEGIN(task);
+    for (;;)
+    {
+        TASK_AWAIT(task, &rxq_event);
+        (void)canfd_rxq_process(process_rx_frame, 0UL);
+    }
+    TASK_END(task);
+}
+#endif
+
+/*******************************************************************************
+* Function Name: task_shell
+********************************************************************************
+* Summary:
+* Task that runs the UART commands once the UART has received characters.
+*
+*******************************************************************************/
+static uint32_t task_shell(task_t *task)
+{
+    TASK_BEGIN(task);
+    for (;;)
+    {
+        TASK_AWAIT(task, &uart_rx_event);
+        while (process_uart_command())
+        {
+        }
+
+        /* A character received since the FIFO was found empty interrupts
+         * right away */
+        cyhal_uart_enable_event(&cy_retarget_io_uart_obj,
+                                CYHAL_UART_IRQ_RX_NOT_EMPTY,
+                                UART_RX_IRQ_PRIORITY, true);
+    }
+    TASK_END(task);
+}
+
+#if (RX_REPORT)
+/*******************************************************************************
+* Function Name: task_report
+********************************************************************************
+* Summary:
+* Task that prints the Rx report every RX_REPORT_INTERVAL_MS.
+*
+*******************************************************************************/
+static uint32_t task_report(task_t *task)
+{
+    TASK_BEGIN(task);
+    for (;;)
+    {
+        TASK_SLEEP(task, RX_REPORT_INTERVAL_MS);
+        print_rx_report();
+    }
+    TASK_END(task);
+}
+#endif
+
+/*******************************************************************************
+* Function Name: uart_rx_callback
+********************************************************************************
+* Summary:
+* UART interrupt on a received character: wakes the shell task. The
+* interrupt is asserted until the FIFO is read, so it is disabled until the
+* task has read all characters.
+*
+*******************************************************************************/
+static void uart_rx_callback(void *arg, cyhal_uart_event_t event)
+{
+    (void)arg;
+    (void)event;
+
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj,
+                            CYHAL_UART_IRQ_RX_NOT_EMPTY,
+                            UART_RX_IRQ_PRIORITY, false);
+    task_event_signal(&uart_rx_event);
+}
+#endif
+
 /* [] END OF FILE */
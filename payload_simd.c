@@ -0,0 +1,493 @@
+/******************************************************************************
+* File Name:   payload_simd.c
+*
+* Description: Bulk payload kernels for CAN FD frames. Every kernel has a
+*              portable reference implementation; on cores with the DSP
+*              extension the public entry points use SIMD instructions (USADA8,
+*              USUB8/SEL, SXTB16, UQADD16, QADD16) that process four bytes or
+*              two halfwords per instruction. This file has no PDL dependency
+*              so that it also builds on a host.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <string.h>
+#include "payload_simd.h"
+
+#if (PAYLOAD_SIMD_USE_DSP)
+#include "cmsis_compiler.h"
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static inline uint32_t load_word(const void *src);
+static inline void store_word(void *dst, uint32_t value);
+static inline uint16_t sat_add_u16(uint16_t a, uint16_t b);
+static inline int16_t sat_add_s16(int16_t a, int16_t b);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: load_word / store_word
+********************************************************************************
+* Summary:
+* Alignment-safe 32-bit little-endian access. Compilers turn these into a
+* single LDR/STR on Cortex-M.
+*
+*******************************************************************************/
+static inline uint32_t load_word(const void *src)
+{
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline void store_word(void *dst, uint32_t value)
+{
+    memcpy(dst, &value, sizeof(value));
+}
+
+static inline uint16_t sat_add_u16(uint16_t a, uint16_t b)
+{
+    uint32_t sum = (uint32_t)a + (uint32_t)b;
+    return (sum > 0xFFFFUL) ? 0xFFFFU : (uint16_t)sum;
+}
+
+static inline int16_t sat_add_s16(int16_t a, int16_t b)
+{
+    int32_t sum = (int32_t)a + (int32_t)b;
+
+    if (sum > INT16_MAX)
+    {
+        sum = INT16_MAX;
+    }
+    else if (sum < INT16_MIN)
+    {
+        sum = INT16_MIN;
+    }
+    return (int16_t)sum;
+}
+
+/*******************************************************************************
+* Portable reference implementations
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_checksum
+********************************************************************************
+* Summary:
+* Sum of all payload bytes, modulo 2^32.
+*
+*******************************************************************************/
+uint32_t payload_simd_ref_checksum(const uint8_t *data, uint32_t len)
+{
+    uint32_t sum = 0UL;
+
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        sum += data[idx];
+    }
+    return sum;
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_equal
+********************************************************************************
+* Summary:
+* Returns true when both payloads hold the same bytes.
+*
+*******************************************************************************/
+bool payload_simd_ref_equal(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        if (a[idx] != b[idx])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_diff_mask
+********************************************************************************
+* Summary:
+* Returns a bit mask with bit n set when byte n differs. Only the first
+* PAYLOAD_SIMD_MAX_LEN bytes are compared.
+*
+*******************************************************************************/
+uint64_t payload_simd_ref_diff_mask(const uint8_t *a, const uint8_t *b,
+                                    uint32_t len)
+{
+    uint64_t mask = 0ULL;
+
+    if (len > PAYLOAD_SIMD_MAX_LEN)
+    {
+        len = PAYLOAD_SIMD_MAX_LEN;
+    }
+
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        if (a[idx] != b[idx])
+        {
+            mask |= (1ULL << idx);
+        }
+    }
+    return mask;
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_delta_sad
+********************************************************************************
+* Summary:
+* Sum of absolute byte differences, a cheap magnitude of change between two
+* consecutive payloads of the same ID.
+*
+*******************************************************************************/
+uint32_t payload_simd_ref_delta_sad(const uint8_t *a, const uint8_t *b,
+                                    uint32_t len)
+{
+    uint32_t sad = 0UL;
+
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        sad += (a[idx] > b[idx]) ? (uint32_t)(a[idx] - b[idx])
+                                 : (uint32_t)(b[idx] - a[idx]);
+    }
+    return sad;
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_unpack_s8
+********************************************************************************
+* Summary:
+* Sign extends count 8-bit samples into 16-bit samples.
+*
+*******************************************************************************/
+void payload_simd_ref_unpack_s8(const uint8_t *src, int16_t *dst,
+                                uint32_t count)
+{
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        dst[idx] = (int16_t)(int8_t)src[idx];
+    }
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_unpack_s16
+********************************************************************************
+* Summary:
+* Sign extends count little-endian 16-bit samples into 32-bit samples.
+*
+*******************************************************************************/
+void payload_simd_ref_unpack_s16(const uint8_t *src, int32_t *dst,
+                                 uint32_t count)
+{
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        uint16_t raw = (uint16_t)src[2UL * idx] |
+                       (uint16_t)((uint16_t)src[(2UL * idx) + 1UL] << 8);
+        dst[idx] = (int32_t)(int16_t)raw;
+    }
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_accumulate_u8
+********************************************************************************
+* Summary:
+* Adds each payload byte into its own 16-bit lane, saturating at 0xFFFF.
+*
+*******************************************************************************/
+void payload_simd_ref_accumulate_u8(uint16_t *acc, const uint8_t *src,
+                                    uint32_t len)
+{
+    for (uint32_t idx = 0UL; idx < len; idx++)
+    {
+        acc[idx] = sat_add_u16(acc[idx], src[idx]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_accumulate_s16
+********************************************************************************
+* Summary:
+* Adds count signed 16-bit samples into acc with signed saturation.
+*
+*******************************************************************************/
+void payload_simd_ref_accumulate_s16(int16_t *acc, const int16_t *src,
+                                     uint32_t count)
+{
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        acc[idx] = sat_add_s16(acc[idx], src[idx]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_ref_narrow_s32
+********************************************************************************
+* Summary:
+* Truncates count 32-bit samples to their low 16 bits, e.g. to move 12-bit
+* ADC results from the 32-bit HAL result buffer into a frame payload.
+*
+*******************************************************************************/
+void payload_simd_ref_narrow_s32(const int32_t *src, int16_t *dst,
+                                 uint32_t count)
+{
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        dst[idx] = (int16_t)(uint16_t)(uint32_t)src[idx];
+    }
+}
+
+#if (PAYLOAD_SIMD_USE_DSP)
+/*******************************************************************************
+* DSP implementations
+*
+* The main loops handle one 32-bit word per iteration; the remaining bytes or
+* samples fall through to the reference implementation.
+*******************************************************************************/
+
+uint32_t payload_simd_checksum(const uint8_t *data, uint32_t len)
+{
+    uint32_t sum = 0UL;
+    uint32_t idx = 0UL;
+
+    /* USADA8 against zero adds the four bytes of a word to the accumulator */
+    for (; (idx + 4UL) <= len; idx += 4UL)
+    {
+        sum = __USADA8(load_word(&data[idx]), 0UL, sum);
+    }
+    return sum + payload_simd_ref_checksum(&data[idx], len - idx);
+}
+
+bool payload_simd_equal(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    uint32_t diff = 0UL;
+    uint32_t idx = 0UL;
+
+    /* Branch-free over the whole payload; the CAN FD sizes are word multiples
+     * above 8 bytes so the tail loop is only used for classic frames */
+    for (; (idx + 4UL) <= len; idx += 4UL)
+    {
+        diff |= load_word(&a[idx]) ^ load_word(&b[idx]);
+    }
+    return (0UL == diff) && payload_simd_ref_equal(&a[idx], &b[idx], len - idx);
+}
+
+uint64_t payload_simd_diff_mask(const uint8_t *a, const uint8_t *b,
+                                uint32_t len)
+{
+    uint64_t mask = 0ULL;
+    uint32_t idx = 0UL;
+
+    if (len > PAYLOAD_SIMD_MAX_LEN)
+    {
+        len = PAYLOAD_SIMD_MAX_LEN;
+    }
+
+    for (; (idx + 4UL) <= len; idx += 4UL)
+    {
+        uint32_t lanes;
+
+        /* USUB8 0 - x sets GE[n] only for bytes where x is zero, i.e. equal.
+         * SEL then picks a per-byte marker bit for the differing bytes. */
+        (void)__USUB8(0UL, load_word(&a[idx]) ^ load_word(&b[idx]));
+        lanes = __SEL(0UL, 0x08040201UL);
+        lanes |= lanes >> 16;
+        lanes |= lanes >> 8;
+        mask |= (uint64_t)(lanes & 0x0FUL) << idx;
+    }
+    if (idx < len)
+    {
+        mask |= payload_simd_ref_diff_mask(&a[idx], &b[idx], len - idx) << idx;
+    }
+    return mask;
+}
+
+uint32_t payload_simd_delta_sad(const uint8_t *a, const uint8_t *b,
+                                uint32_t len)
+{
+    uint32_t sad = 0UL;
+    uint32_t idx = 0UL;
+
+    for (; (idx + 4UL) <= len; idx += 4UL)
+    {
+        sad = __USADA8(load_word(&a[idx]), load_word(&b[idx]), sad);
+    }
+    return sad + payload_simd_ref_delta_sad(&a[idx], &b[idx], len - idx);
+}
+
+void payload_simd_unpack_s8(const uint8_t *src, int16_t *dst, uint32_t count)
+{
+    uint32_t idx = 0UL;
+
+    for (; (idx + 4UL) <= count; idx += 4UL)
+    {
+        uint32_t word = load_word(&src[idx]);
+        /* even: bytes 0 and 2, odd: bytes 1 and 3, each as two halfwords */
+        uint32_t even = __SXTB16(word);
+        uint32_t odd  = __SXTB16(__ROR(word, 8U));
+
+        store_word(&dst[idx], __PKHBT(even, odd, 16));
+        store_word(&dst[idx + 2UL], __PKHTB(odd, even, 16));
+    }
+    payload_simd_ref_unpack_s8(&src[idx], &dst[idx], count - idx);
+}
+
+void payload_simd_unpack_s16(const uint8_t *src, int32_t *dst, uint32_t count)
+{
+    uint32_t idx = 0UL;
+
+    /* One load per two samples; the extension is SXTH and ASR */
+    for (; (idx + 2UL) <= count; idx += 2UL)
+    {
+        uint32_t word = load_word(&src[2UL * idx]);
+
+        dst[idx]       = (int32_t)(int16_t)(uint16_t)word;
+        dst[idx + 1UL] = ((int32_t)word) >> 16;
+    }
+    payload_simd_ref_unpack_s16(&src[2UL * idx], &dst[idx], count - idx);
+}
+
+void payload_simd_accumulate_u8(uint16_t *acc, const uint8_t *src,
+                                uint32_t len)
+{
+    uint32_t idx = 0UL;
+
+    for (; (idx + 4UL) <= len; idx += 4UL)
+    {
+        uint32_t word = load_word(&src[idx]);
+        uint32_t even = __UXTB16(word);
+        uint32_t odd  = __UXTB16(__ROR(word, 8U));
+
+        store_word(&acc[idx], __UQADD16(load_word(&acc[idx]),
+                                        __PKHBT(even, odd, 16)));
+        store_word(&acc[idx + 2UL], __UQADD16(load_word(&acc[idx + 2UL]),
+                                              __PKHTB(odd, even, 16)));
+    }
+    payload_simd_ref_accumulate_u8(&acc[idx], &src[idx], len - idx);
+}
+
+void payload_simd_accumulate_s16(int16_t *acc, const int16_t *src,
+                                 uint32_t count)
+{
+    uint32_t idx = 0UL;
+
+    for (; (idx + 2UL) <= count; idx += 2UL)
+    {
+        store_word(&acc[idx], __QADD16(load_word(&acc[idx]),
+                                       load_word(&src[idx])));
+    }
+    payload_simd_ref_accumulate_s16(&acc[idx], &src[idx], count - idx);
+}
+
+void payload_simd_narrow_s32(const int32_t *src, int16_t *dst, uint32_t count)
+{
+    uint32_t idx = 0UL;
+
+    /* PKHBT packs the low halfwords of two samples into one word */
+    for (; (idx + 2UL) <= count; idx += 2UL)
+    {
+        store_word(&dst[idx], __PKHBT((uint32_t)src[idx],
+                                      (uint32_t)src[idx + 1UL], 16));
+    }
+    payload_simd_ref_narrow_s32(&src[idx], &dst[idx], count - idx);
+}
+
+#else /* PAYLOAD_SIMD_USE_DSP */
+/*******************************************************************************
+* No DSP extension: the public kernels are the reference implementations
+*******************************************************************************/
+
+uint32_t payload_simd_checksum(const uint8_t *data, uint32_t len)
+{
+    return payload_simd_ref_checksum(data, len);
+}
+
+bool payload_simd_equal(const uint8_t *a, const uint8_t *b, uint32_t len)
+{
+    return payload_simd_ref_equal(a, b, len);
+}
+
+uint64_t payload_simd_diff_mask(const uint8_t *a, const uint8_t *b,
+                                uint32_t len)
+{
+    return payload_simd_ref_diff_mask(a, b, len);
+}
+
+uint32_t payload_simd_delta_sad(const uint8_t *a, const uint8_t *b,
+                                uint32_t len)
+{
+    return payload_simd_ref_delta_sad(a, b, len);
+}
+
+void payload_simd_unpack_s8(const uint8_t *src, int16_t *dst, uint32_t count)
+{
+    payload_simd_ref_unpack_s8(src, dst, count);
+}
+
+void payload_simd_unpack_s16(const uint8_t *src, int32_t *dst, uint32_t count)
+{
+    payload_simd_ref_unpack_s16(src, dst, count);
+}
+
+void payload_simd_accumulate_u8(uint16_t *acc, const uint8_t *src,
+                                uint32_t len)
+{
+    payload_simd_ref_accumulate_u8(acc, src, len);
+}
+
+void payload_simd_accumulate_s16(int16_t *acc, const int16_t *src,
+                                 uint32_t count)
+{
+    payload_simd_ref_accumulate_s16(acc, src, count);
+}
+
+void payload_simd_narrow_s32(const int32_t *src, int16_t *dst, uint32_t count)
+{
+    payload_simd_ref_narrow_s32(src, dst, count);
+}
+
+#endif /* PAYLOAD_SIMD_USE_DSP */
+
+/* [] END OF FILE */
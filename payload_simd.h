@@ -0,0 +1,114 @@
+/******************************************************************************
+* File Name:   payload_simd.h
+*
+* Description: Bulk payload kernels (checksum, change detection, sample
+*              unpacking and saturating accumulation) for CAN FD frames. Uses
+*              the Cortex-M4 SIMD DSP instructions when available, and a
+*              portable C fallback otherwise.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef PAYLOAD_SIMD_H_
+#define PAYLOAD_SIMD_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* The DSP variants are used whenever the compiler targets a core that has the
+ * SIMD extension (Cortex-M4, Cortex-M33 with DSP). Define PAYLOAD_SIMD_NO_DSP
+ * to force the portable C implementation, e.g. for a host build. */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1) && \
+    !defined(PAYLOAD_SIMD_NO_DSP)
+#define PAYLOAD_SIMD_USE_DSP    (1u)
+#else
+#define PAYLOAD_SIMD_USE_DSP    (0u)
+#endif
+
+/* Largest CAN FD payload, the size the benchmark runs on */
+#define PAYLOAD_SIMD_MAX_LEN    (64u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+/* Kernels: DSP implementation when PAYLOAD_SIMD_USE_DSP, else portable C */
+uint32_t payload_simd_checksum(const uint8_t *data, uint32_t len);
+bool     payload_simd_equal(const uint8_t *a, const uint8_t *b, uint32_t len);
+uint64_t payload_simd_diff_mask(const uint8_t *a, const uint8_t *b,
+                                uint32_t len);
+uint32_t payload_simd_delta_sad(const uint8_t *a, const uint8_t *b,
+                                uint32_t len);
+void     payload_simd_unpack_s8(const uint8_t *src, int16_t *dst,
+                                uint32_t count);
+void     payload_simd_unpack_s16(const uint8_t *src, int32_t *dst,
+                                 uint32_t count);
+void     payload_simd_accumulate_u8(uint16_t *acc, const uint8_t *src,
+                                    uint32_t len);
+void     payload_simd_accumulate_s16(int16_t *acc, const int16_t *src,
+                                     uint32_t count);
+void     payload_simd_narrow_s32(const int32_t *src, int16_t *dst,
+                                 uint32_t count);
+
+/* Portable reference implementations, always built */
+uint32_t payload_simd_ref_checksum(const uint8_t *data, uint32_t len);
+bool     payload_simd_ref_equal(const uint8_t *a, const uint8_t *b,
+                                uint32_t len);
+uint64_t payload_simd_ref_diff_mask(const uint8_t *a, const uint8_t *b,
+                                    uint32_t len);
+uint32_t payload_simd_ref_delta_sad(const uint8_t *a, const uint8_t *b,
+                                    uint32_t len);
+void     payload_simd_ref_unpack_s8(const uint8_t *src, int16_t *dst,
+                                    uint32_t count);
+void     payload_simd_ref_unpack_s16(const uint8_t *src, int32_t *dst,
+                                     uint32_t count);
+void     payload_simd_ref_accumulate_u8(uint16_t *acc, const uint8_t *src,
+                                        uint32_t len);
+void     payload_simd_ref_accumulate_s16(int16_t *acc, const int16_t *src,
+                                         uint32_t count);
+void     payload_simd_ref_narrow_s32(const int32_t *src, int16_t *dst,
+                                     uint32_t count);
+
+/* Target only: compares both implementations on a 64-byte payload */
+void     payload_simd_benchmark(void);
+
+#endif /* PAYLOAD_SIMD_H_ */
+
+/* [] END OF FILE */
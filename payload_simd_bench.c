@@ -0,0 +1,369 @@
+/******************************************************************************
+* File Name:   payload_simd_bench.c
+*
+* Description: On-target benchmark of the payload kernels. Runs each kernel on
+*              a 64-byte payload with the reference and the SIMD
+*              implementation, checks that both agree and prints the cycles per
+*              call measured with the DWT cycle counter.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "cy_pdl.h"
+#include "cycle_count.h"
+#include "payload_simd.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Calls per measurement; the result is averaged over all of them */
+#define BENCH_ITERATIONS        (256u)
+
+/* Number of samples in a 64-byte payload for the unpack kernels */
+#define BENCH_S8_SAMPLES        (PAYLOAD_SIMD_MAX_LEN)
+#define BENCH_S16_SAMPLES       (PAYLOAD_SIMD_MAX_LEN / 2u)
+#define BENCH_S32_SAMPLES       (PAYLOAD_SIMD_MAX_LEN / 4u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+CY_ALIGN(4) static uint8_t bench_payload_a[PAYLOAD_SIMD_MAX_LEN];
+CY_ALIGN(4) static uint8_t bench_payload_b[PAYLOAD_SIMD_MAX_LEN];
+static int16_t  bench_s16_out[BENCH_S8_SAMPLES];
+static int32_t  bench_s32_out[BENCH_S16_SAMPLES];
+static uint16_t bench_u16_acc[PAYLOAD_SIMD_MAX_LEN];
+static int16_t  bench_s16_acc[BENCH_S16_SAMPLES];
+
+/* Outputs of the reference kernels for the cross-check */
+static int16_t  bench_ref_s16_out[BENCH_S8_SAMPLES];
+static int32_t  bench_ref_s32_out[BENCH_S16_SAMPLES];
+static uint16_t bench_ref_u16_acc[PAYLOAD_SIMD_MAX_LEN];
+static int16_t  bench_ref_s16_acc[BENCH_S16_SAMPLES];
+
+/* Kernels whose result differs from the reference, bit per kernel index */
+static uint32_t bench_mismatch;
+
+/* Sink that keeps the compiler from discarding kernel results */
+static volatile uint32_t bench_sink;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t bench_run(uint32_t kernel, bool use_ref);
+static uint32_t bench_cross_check(void);
+static void bench_report(const char *name, uint32_t kernel);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: bench_run
+********************************************************************************
+* Summary:
+* Runs one kernel BENCH_ITERATIONS times and returns the average cycles per
+* call, including the call overhead.
+*
+* Parameters:
+*  kernel    Kernel index, see bench_report callers in payload_simd_benchmark
+*  use_ref   true to run the portable implementation
+*
+* Return:
+*  uint32_t  average cycles per call
+*
+*******************************************************************************/
+static uint32_t bench_run(uint32_t kernel, bool use_ref)
+{
+    uint32_t start;
+    uint32_t acc = 0UL;
+    const uint8_t *a = bench_payload_a;
+    const uint8_t *b = bench_payload_b;
+
+    start = cycle_count_now();
+    for (uint32_t iter = 0UL; iter < BENCH_ITERATIONS; iter++)
+    {
+        switch (kernel)
+        {
+            case 0UL:
+                acc += use_ref ? payload_simd_ref_checksum(a, PAYLOAD_SIMD_MAX_LEN)
+                               : payload_simd_checksum(a, PAYLOAD_SIMD_MAX_LEN);
+                break;
+            case 1UL:
+                acc += use_ref ? payload_simd_ref_equal(a, b, PAYLOAD_SIMD_MAX_LEN)
+                               : payload_simd_equal(a, b, PAYLOAD_SIMD_MAX_LEN);
+                break;
+            case 2UL:
+                acc += (uint32_t)(use_ref ?
+                        payload_simd_ref_diff_mask(a, b, PAYLOAD_SIMD_MAX_LEN) :
+                        payload_simd_diff_mask(a, b, PAYLOAD_SIMD_MAX_LEN));
+                break;
+            case 3UL:
+                acc += use_ref ? payload_simd_ref_delta_sad(a, b, PAYLOAD_SIMD_MAX_LEN)
+                               : payload_simd_delta_sad(a, b, PAYLOAD_SIMD_MAX_LEN);
+                break;
+            case 4UL:
+                if (use_ref)
+                {
+                    payload_simd_ref_unpack_s8(a, bench_s16_out, BENCH_S8_SAMPLES);
+                }
+                else
+                {
+                    payload_simd_unpack_s8(a, bench_s16_out, BENCH_S8_SAMPLES);
+                }
+                break;
+            case 5UL:
+                if (use_ref)
+                {
+                    payload_simd_ref_unpack_s16(a, bench_s32_out, BENCH_S16_SAMPLES);
+                }
+                else
+                {
+                    payload_simd_unpack_s16(a, bench_s32_out, BENCH_S16_SAMPLES);
+                }
+                break;
+            case 6UL:
+                if (use_ref)
+                {
+                    payload_simd_ref_accumulate_u8(bench_u16_acc, a,
+                                                   PAYLOAD_SIMD_MAX_LEN);
+                }
+                else
+                {
+                    payload_simd_accumulate_u8(bench_u16_acc, a,
+                                               PAYLOAD_SIMD_MAX_LEN);
+                }
+                break;
+            case 7UL:
+                if (use_ref)
+                {
+                    payload_simd_ref_accumulate_s16(bench_s16_acc,
+                            (const int16_t *)(const void *)a, BENCH_S16_SAMPLES);
+                }
+                else
+                {
+                    payload_simd_accumulate_s16(bench_s16_acc,
+                            (const int16_t *)(const void *)a, BENCH_S16_SAMPLES);
+                }
+                break;
+            default:
+                if (use_ref)
+                {
+                    payload_simd_ref_narrow_s32((const int32_t *)(const void *)a,
+                                                bench_s16_out, BENCH_S32_SAMPLES);
+                }
+                else
+                {
+                    payload_simd_narrow_s32((const int32_t *)(const void *)a,
+                                            bench_s16_out, BENCH_S32_SAMPLES);
+                }
+                break;
+        }
+    }
+    bench_sink = acc;
+
+    return (cycle_count_now() - start) / BENCH_ITERATIONS;
+}
+
+/*******************************************************************************
+* Function Name: bench_cross_check
+********************************************************************************
+* Summary:
+* Runs every kernel and its reference on the same input and compares the
+* results, before the timing. The accumulators start near both limits and
+* the words of the payload reach them, so the saturation is covered;
+* equal is checked with equal and with different payloads.
+*
+* Return:
+*  uint32_t  kernels with a different result, bit per kernel index
+*
+*******************************************************************************/
+static uint32_t bench_cross_check(void)
+{
+    const uint8_t *a = bench_payload_a;
+    const uint8_t *b = bench_payload_b;
+    const int16_t *a_s16 = (const int16_t *)(const void *)a;
+    const int32_t *a_s32 = (const int32_t *)(const void *)a;
+    uint32_t mismatch = 0UL;
+
+    if (payload_simd_checksum(a, PAYLOAD_SIMD_MAX_LEN) !=
+        payload_simd_ref_checksum(a, PAYLOAD_SIMD_MAX_LEN))
+    {
+        mismatch |= 1UL << 0;
+    }
+
+    if ((payload_simd_equal(a, b, PAYLOAD_SIMD_MAX_LEN) !=
+         payload_simd_ref_equal(a, b, PAYLOAD_SIMD_MAX_LEN)) ||
+        (payload_simd_equal(a, a, PAYLOAD_SIMD_MAX_LEN) !=
+         payload_simd_ref_equal(a, a, PAYLOAD_SIMD_MAX_LEN)))
+    {
+        mismatch |= 1UL << 1;
+    }
+
+    if (payload_simd_diff_mask(a, b, PAYLOAD_SIMD_MAX_LEN) !=
+        payload_simd_ref_diff_mask(a, b, PAYLOAD_SIMD_MAX_LEN))
+    {
+        mismatch |= 1UL << 2;
+    }
+
+    if (payload_simd_delta_sad(a, b, PAYLOAD_SIMD_MAX_LEN) !=
+        payload_simd_ref_delta_sad(a, b, PAYLOAD_SIMD_MAX_LEN))
+    {
+        mismatch |= 1UL << 3;
+    }
+
+    payload_simd_unpack_s8(a, bench_s16_out, BENCH_S8_SAMPLES);
+    payload_simd_ref_unpack_s8(a, bench_ref_s16_out, BENCH_S8_SAMPLES);
+    if (0 != memcmp(bench_s16_out, bench_ref_s16_out,
+                    BENCH_S8_SAMPLES * sizeof(int16_t)))
+    {
+        mismatch |= 1UL << 4;
+    }
+
+    payload_simd_unpack_s16(a, bench_s32_out, BENCH_S16_SAMPLES);
+    payload_simd_ref_unpack_s16(a, bench_ref_s32_out, BENCH_S16_SAMPLES);
+    if (0 != memcmp(bench_s32_out, bench_ref_s32_out,
+                    BENCH_S16_SAMPLES * sizeof(int32_t)))
+    {
+        mismatch |= 1UL << 5;
+    }
+
+    memset(bench_u16_acc, 0xF0, sizeof(bench_u16_acc));
+    memcpy(bench_ref_u16_acc, bench_u16_acc, sizeof(bench_ref_u16_acc));
+    payload_simd_accumulate_u8(bench_u16_acc, a, PAYLOAD_SIMD_MAX_LEN);
+    payload_simd_ref_accumulate_u8(bench_ref_u16_acc, a, PAYLOAD_SIMD_MAX_LEN);
+    if (0 != memcmp(bench_u16_acc, bench_ref_u16_acc, sizeof(bench_u16_acc)))
+    {
+        mismatch |= 1UL << 6;
+    }
+
+    for (uint32_t idx = 0UL; idx < BENCH_S16_SAMPLES; idx++)
+    {
+        bench_s16_acc[idx] = (0UL != (idx & 1UL)) ? (int16_t)0x7070 :
+                                                    (int16_t)-0x7070;
+    }
+    memcpy(bench_ref_s16_acc, bench_s16_acc, sizeof(bench_ref_s16_acc));
+    payload_simd_accumulate_s16(bench_s16_acc, a_s16, BENCH_S16_SAMPLES);
+    payload_simd_ref_accumulate_s16(bench_ref_s16_acc, a_s16,
+                                    BENCH_S16_SAMPLES);
+    if (0 != memcmp(bench_s16_acc, bench_ref_s16_acc, sizeof(bench_s16_acc)))
+    {
+        mismatch |= 1UL << 7;
+    }
+
+    payload_simd_narrow_s32(a_s32, bench_s16_out, BENCH_S32_SAMPLES);
+    payload_simd_ref_narrow_s32(a_s32, bench_ref_s16_out, BENCH_S32_SAMPLES);
+    if (0 != memcmp(bench_s16_out, bench_ref_s16_out,
+                    BENCH_S32_SAMPLES * sizeof(int16_t)))
+    {
+        mismatch |= 1UL << 8;
+    }
+
+    return mismatch;
+}
+
+/*******************************************************************************
+* Function Name: bench_report
+********************************************************************************
+* Summary:
+* Measures one kernel in both implementations and prints a result line,
+* marked if the cross-check found a different result.
+*
+*******************************************************************************/
+static void bench_report(const char *name, uint32_t kernel)
+{
+    uint32_t ref_cycles  = bench_run(kernel, true);
+    uint32_t simd_cycles = bench_run(kernel, false);
+    uint32_t reduction = 0UL;
+
+    if ((0UL != ref_cycles) && (simd_cycles < ref_cycles))
+    {
+        reduction = ((ref_cycles - simd_cycles) * 100UL) / ref_cycles;
+    }
+
+    printf("  %-14s %6lu %6lu   %3lu%%%s\r\n", name,
+           (unsigned long)ref_cycles, (unsigned long)simd_cycles,
+           (unsigned long)reduction,
+           (0UL != (bench_mismatch & (1UL << kernel))) ? "  MISMATCH" : "");
+}
+
+/*******************************************************************************
+* Function Name: payload_simd_benchmark
+********************************************************************************
+* Summary:
+* Checks every SIMD kernel against its reference on a 64-byte payload and
+* prints the cycles per call of both implementations over the debug UART.
+*
+*******************************************************************************/
+void payload_simd_benchmark(void)
+{
+    cycle_count_init();
+
+    for (uint32_t idx = 0UL; idx < PAYLOAD_SIMD_MAX_LEN; idx++)
+    {
+        bench_payload_a[idx] = (uint8_t)((idx * 37UL) + 11UL);
+        /* Every fifth byte changes, the rest are equal */
+        bench_payload_b[idx] = (0UL == (idx % 5UL)) ?
+                               (uint8_t)(bench_payload_a[idx] ^ 0x5AU) :
+                               bench_payload_a[idx];
+    }
+
+    /* Cross-check the kernels before timing them */
+    bench_mismatch = bench_cross_check();
+
+    printf("===========================================================\r\n");
+    printf("Payload kernel benchmark, %u-byte payload, DSP %s\r\n",
+           (unsigned int)PAYLOAD_SIMD_MAX_LEN,
+           (PAYLOAD_SIMD_USE_DSP != 0u) ? "enabled" : "not available");
+    printf("Results %s\r\n", (0UL == bench_mismatch) ? "match" : "MISMATCH");
+    printf("  kernel          C cyc  SIMD   saved\r\n");
+
+    bench_report("checksum", 0UL);
+    bench_report("equal", 1UL);
+    bench_report("diff_mask", 2UL);
+    bench_report("delta_sad", 3UL);
+    bench_report("unpack_s8", 4UL);
+    bench_report("unpack_s16", 5UL);
+    bench_report("acc_u8", 6UL);
+    bench_report("acc_s16", 7UL);
+    bench_report("narrow_s32", 8UL);
+    printf("===========================================================\r\n\n");
+}
+
+/* [] END OF FILE */
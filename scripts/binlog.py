@@ -0,0 +1,110 @@
+"""Reader of the binary log channel (binlog.c).
+
+Records are framed as: sync (0x1E), type (u8), payload length (u16 LE),
+payload, CRC-16/CCITT (u16 LE) over type, length and payload. On the UART
+they are interleaved with the printf text; over CAN FD each frame with
+BINLOG_CAN_ID carries a sequence number, a byte count and that many bytes
+of the same stream.
+"""
+
+import re
+import struct
+
+SYNC = 0x1E
+HEADER_SIZE = 4
+TRAILER_SIZE = 2
+
+TYPE_STATS_SCHEMA = 0x01
+TYPE_STATS_VALUES = 0x02
+TYPE_TRACE = 0x03
+TYPE_FAULT = 0x04
+TYPE_CAPTURE = 0x05
+
+CAN_ID = 0x7F0
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT (poly 0x1021), as computed by binlog_crc_update."""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+class Parser:
+    """Splits a byte stream into text and binary log records.
+
+    feed() returns a list of ('text', str) and ('record', type, payload)
+    items. Bytes that do not form a valid record are returned as text.
+    """
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.crc_errors = 0
+
+    def reset(self):
+        self.buf.clear()
+
+    def feed(self, data):
+        self.buf += data
+        out = []
+        while self.buf:
+            sync = self.buf.find(SYNC)
+            if sync < 0:
+                out.append(('text', self.buf.decode('ascii', 'replace')))
+                self.buf.clear()
+                break
+            if sync > 0:
+                out.append(('text', self.buf[:sync].decode('ascii', 'replace')))
+                del self.buf[:sync]
+            if len(self.buf) < HEADER_SIZE:
+                break
+            rtype = self.buf[1]
+            length = self.buf[2] | (self.buf[3] << 8)
+            total = HEADER_SIZE + length + TRAILER_SIZE
+            if len(self.buf) < total:
+                break
+            body = bytes(self.buf[1:HEADER_SIZE + length])
+            (crc,) = struct.unpack_from('<H', self.buf, HEADER_SIZE + length)
+            if crc16(body) != crc:
+                # Not a record, or a damaged one: resynchronize after the sync
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+            out.append(('record', rtype, body[HEADER_SIZE - 1:]))
+            del self.buf[:total]
+        return out
+
+
+class CanStream:
+    """Rebuilds the byte stream from the CAN FD frames of the binary log."""
+
+    def __init__(self, parser=None):
+        self.parser = parser if parser is not None else Parser()
+        self.next_seq = None
+        self.lost = 0
+
+    def feed_frame(self, data):
+        if len(data) < 2:
+            return []
+        seq, count = data[0], data[1]
+        if self.next_seq is not None and seq != self.next_seq:
+            # A frame was lost: the record in progress cannot be completed
+            self.lost += (seq - self.next_seq) & 0xFF
+            self.parser.reset()
+        self.next_seq = (seq + 1) & 0xFF
+        return self.parser.feed(bytes(data[2:2 + count]))
+
+
+# candump -L: "(1700000000.123456) can0 7F0##1<hex>" or "... 7F0#<hex>"
+_CANDUMP = re.compile(r'\S+\s+\S+\s+([0-9A-Fa-f]+)#(#[0-9A-Fa-f])?([0-9A-Fa-f]*)')
+
+
+def candump_frames(lines, can_id=CAN_ID):
+    """Yields the payloads of the frames with can_id in a candump -L log."""
+    for line in lines:
+        match = _CANDUMP.search(line)
+        if match and int(match.group(1), 16) == can_id:
+            yield bytes.fromhex(match.group(3))
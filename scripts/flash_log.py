@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Extracts the frames recorded by flash_log.c.
+
+Every log page is one binary log record (type 5), stored in the external
+flash exactly as binlog.c would send it, so the same pages are read from a
+flash image or from a dump sent by the node.
+
+Sources:
+  --image FILE      raw image of the log region, read from the external flash
+                    with a programmer; the page index is used to find the
+                    selected session and time range without reading the rest
+  --serial PORT     debug UART of the node (needs pyserial); sends 'd' to
+                    dump the last pages
+  --file FILE       raw capture of the UART output
+  --candump FILE    candump -L log with the frames of BINLOG_CAN_ID
+
+The frames are written as candump -L lines (replay them with canplayer) or
+as CSV. Times are seconds since the start-up of the node.
+"""
+
+import argparse
+import bisect
+import struct
+import sys
+import time
+
+import binlog
+
+PAGE_SIZE = 4096
+MAGIC = 0x474F4C43
+REGION = struct.Struct('<II')           # magic, data offset
+INDEX = struct.Struct('<IHH')           # time_ms, session, frames
+PAGE_HEADER = struct.Struct('<IHHIIII')  # page, session, frames, time_ms,
+                                         # cycles, clock_hz, dropped
+FRAME_HEADER = struct.Struct('<IIBB')   # cycles, id, flags, len
+
+FLAG_XTD, FLAG_FDF, FLAG_BRS, FLAG_RTR, FLAG_ESI = 0x01, 0x02, 0x04, 0x08, 0x10
+
+
+def read_page(payload):
+    """Returns the header fields and the frames of a page record payload as
+    (time_s, id, flags, data) tuples."""
+    (page, session, count, time_ms, cycles, clock_hz,
+     dropped) = PAGE_HEADER.unpack_from(payload)
+    header = {'page': page, 'session': session, 'frames': count,
+              'time_ms': time_ms, 'dropped': dropped}
+    frames = []
+    pos = PAGE_HEADER.size
+    for _ in range(count):
+        fcycles, can_id, flags, length = FRAME_HEADER.unpack_from(payload, pos)
+        pos += FRAME_HEADER.size
+        data = bytes(payload[pos:pos + length])
+        pos += length
+        # Cycle offset from the page time; frames queued before the page was
+        # opened have a small negative offset
+        delta = (fcycles - cycles) & 0xFFFFFFFF
+        if delta & 0x80000000:
+            delta -= 1 << 32
+        frames.append((time_ms / 1000.0 + delta / clock_hz, can_id, flags,
+                       data))
+    return header, frames
+
+
+def read_index(image):
+    """Returns the offset of the first page and the index entries of a flash
+    image, up to the first erased entry."""
+    magic, data_offset = REGION.unpack_from(image)
+    if magic != MAGIC:
+        sys.exit('no log region descriptor at the start of the image')
+
+    index = []
+    for pos in range(REGION.size, data_offset, INDEX.size):
+        entry = INDEX.unpack_from(image, pos)
+        if entry[0] == 0xFFFFFFFF and entry[1] == 0xFFFF:
+            break
+        index.append(entry)
+    return data_offset, index
+
+
+def image_pages(image, data_offset, index, session, start, end):
+    """Yields the valid page payloads of a flash image in the selected
+    session (None for all, -1 for the last) and time range."""
+    if not index:
+        return
+
+    if session == -1:
+        session = index[-1][1]
+    keys = [(entry[1], entry[0]) for entry in index]
+    if session is None:
+        first, last = 0, len(index)
+    else:
+        first = bisect.bisect_left(keys, (session, 0))
+        last = bisect.bisect_right(keys, (session, 0xFFFFFFFF))
+    if first < last:
+        session, origin = keys[first]
+        if start is not None:
+            # Page that contains the start time: the last one opened before it
+            t0 = origin + int(start * 1000)
+            first = max(first, bisect.bisect_right(keys, (session, t0),
+                                                   first, last) - 1)
+        if end is not None:
+            t1 = origin + int(end * 1000)
+            last = bisect.bisect_right(keys, (session, t1), first, last)
+
+    damaged = 0
+    for page in range(first, last):
+        pos = data_offset + page * PAGE_SIZE
+        items = binlog.Parser().feed(image[pos:pos + PAGE_SIZE])
+        records = [item for item in items
+                   if item[0] == 'record' and item[1] == binlog.TYPE_CAPTURE]
+        if records:
+            yield records[0][2]
+        else:
+            damaged += 1
+    if damaged:
+        print('%u damaged pages skipped' % damaged, file=sys.stderr)
+
+
+def stream_pages(items):
+    for item in items:
+        if item[0] == 'record' and item[1] == binlog.TYPE_CAPTURE:
+            yield item[2]
+
+
+def capture_serial(args):
+    import serial  # pyserial
+
+    data = bytearray()
+    with serial.Serial(args.serial, args.baud, timeout=1.0) as port:
+        port.write(b'd')
+        while True:
+            chunk = port.read(4096)
+            if not chunk:
+                break
+            data += chunk
+    return binlog.Parser().feed(bytes(data))
+
+
+def candump_line(frame, interface):
+    time_s, can_id, flags, data = frame
+    ident = '%08X' % can_id if flags & FLAG_XTD else '%03X' % can_id
+    if flags & FLAG_FDF:
+        fd_flags = (1 if flags & FLAG_BRS else 0) | \
+                   (2 if flags & FLAG_ESI else 0)
+        body = '#%X%s' % (fd_flags, data.hex().upper())
+    elif flags & FLAG_RTR:
+        body = 'R'
+    else:
+        body = data.hex().upper()
+    return '(%.6f) %s %s#%s' % (time_s, interface, ident, body)
+
+
+def csv_line(frame):
+    time_s, can_id, flags, data = frame
+    return '%.6f,0x%X,%u,%u,%s' % (time_s, can_id, flags, len(data),
+                                   data.hex().upper())
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawTextHelpFormatter)
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument('--image', help='raw image of the log region')
+    src.add_argument('--serial', help='serial port of the node')
+    src.add_argument('--file', help='raw UART capture')
+    src.add_argument('--candump', help='candump -L log')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--can-id', type=lambda x: int(x, 0), default=binlog.CAN_ID)
+    ap.add_argument('--session', type=int, default=None,
+                    help='session to extract, -1 for the last (default all)')
+    ap.add_argument('--start', type=float, default=None,
+                    help='seconds from the start of the session')
+    ap.add_argument('--end', type=float, default=None,
+                    help='seconds from the start of the session')
+    ap.add_argument('--format', choices=('candump', 'csv'), default='candump')
+    ap.add_argument('--interface', default='can0',
+                    help='interface name of the candump lines')
+    ap.add_argument('-o', '--output', default='-')
+    args = ap.parse_args()
+
+    # Time of the first page of each session
+    session_start = {}
+    if args.image:
+        with open(args.image, 'rb') as image:
+            data = image.read()
+        data_offset, index = read_index(data)
+        for entry in index:
+            session_start.setdefault(entry[1], entry[0] / 1000.0)
+        pages = image_pages(data, data_offset, index, args.session,
+                            args.start, args.end)
+    else:
+        if args.serial:
+            items = capture_serial(args)
+        elif args.file:
+            with open(args.file, 'rb') as capture:
+                items = binlog.Parser().feed(capture.read())
+        else:
+            items = []
+            stream = binlog.CanStream()
+            with open(args.candump) as log:
+                for data in binlog.candump_frames(log, args.can_id):
+                    items += stream.feed_frame(data)
+        pages = list(stream_pages(items))
+        if args.session == -1 and pages:
+            args.session = max(PAGE_HEADER.unpack_from(page)[1]
+                               for page in pages)
+
+    out = sys.stdout if args.output == '-' else open(args.output, 'w')
+    if args.format == 'csv':
+        out.write('time,id,flags,len,data\n')
+
+    count = 0
+    sessions = {}
+    started = time.monotonic()
+    for payload in pages:
+        header, frames = read_page(payload)
+        session = header['session']
+        if args.session not in (None, -1) and session != args.session:
+            continue
+        first = session_start.setdefault(session, header['time_ms'] / 1000.0)
+        for frame in frames:
+            offset = frame[0] - first
+            if args.start is not None and offset < args.start:
+                continue
+            if args.end is not None and offset > args.end:
+                continue
+            out.write((candump_line(frame, args.interface)
+                       if args.format == 'candump' else csv_line(frame)) + '\n')
+            count += 1
+        sessions[session] = header['dropped']
+
+    if out is not sys.stdout:
+        out.close()
+    for session, dropped in sorted(sessions.items()):
+        print('session %u: %u frames dropped on the node' % (session, dropped),
+              file=sys.stderr)
+    print('%u frames extracted in %.2f s' % (count, time.monotonic() - started),
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""Downloads the flash log of flash_log.c over CAN FD (flash_readback.c).
+
+Needs python-can and a CAN FD interface, for example SocketCAN:
+  ip link set can0 up type can bitrate 500000 dbitrate 2000000 fd on
+  readback.py --channel can0 -o image.bin
+  flash_log.py --image image.bin
+
+Without --offset and --length the whole written log is read, which gives an
+image for flash_log.py. The bytes are written at their offset in the output
+file, so a partial read (for example the index, then selected pages) can be
+added to an existing image.
+
+The node sends 64-byte frames with a 16-bit sequence number and 62 bytes of
+the log. This script acknowledges every --ack-every frames with the next
+missing frame and a bitmap of the 32 frames behind it; the node sends the
+missing frames again and adapts its window to the losses. The goodput is
+compared with the frame rate the bit rates allow.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+CMD_ID = 0x7E0
+DATA_ID = CMD_ID + 1
+STATUS_ID = CMD_ID + 2
+
+CMD_START, CMD_ACK, CMD_ABORT = 0x01, 0x02, 0x03
+STS_STARTED, STS_DONE = 0x81, 0x82
+
+RESULTS = {0: 'ok', 1: 'busy', 2: 'out of range', 3: 'aborted',
+           4: 'timeout', 5: 'read error'}
+
+STARTED = struct.Struct('<xBHIIII')    # result, chunk, offset, length,
+                                       # data offset, pages
+DONE = struct.Struct('<xBIIII')        # result, frames, again, us, bytes/s
+ACK_BITS = 32
+
+
+def message(can_id, data):
+    import can
+
+    # Pad to a valid CAN FD length
+    for size in (8, 12, 16, 20, 24, 32, 48, 64):
+        if len(data) <= size:
+            break
+    return can.Message(arbitration_id=can_id, is_extended_id=False,
+                       is_fd=True, bitrate_switch=True,
+                       data=bytes(data) + bytes(size - len(data)))
+
+
+def wait_status(bus, code, timeout):
+    end = time.monotonic() + timeout
+    while time.monotonic() < end:
+        msg = bus.recv(timeout=end - time.monotonic())
+        if msg is not None and msg.arbitration_id == STATUS_ID and \
+                msg.data[0] == code:
+            return bytes(msg.data)
+    return None
+
+
+def frame_time(bitrate, dbitrate):
+    """Seconds per 64-byte CAN FD frame with bit rate switching, 11-bit
+    identifier, without stuff bits: 30 bits at the nominal rate (SOF to
+    BRS, CRC delimiter to interframe space), 549 bits at the data rate (ESI,
+    DLC, data, stuff count, CRC-21 with its fixed stuff bits)."""
+    return 30.0 / bitrate + 549.0 / dbitrate
+
+
+class Download:
+    def __init__(self, bus, ack_every, ack_interval):
+        self.bus = bus
+        self.ack_every = ack_every
+        self.ack_interval = ack_interval
+        self.duplicates = 0
+        self.frames = 0
+        self.acks = 0
+
+    def start(self, offset, length, window):
+        start = struct.pack('<BIIB', CMD_START, offset, length, window)
+        for _ in range(3):
+            self.bus.send(message(CMD_ID, start))
+            status = wait_status(self.bus, STS_STARTED, 1.0)
+            if status is not None:
+                return STARTED.unpack_from(status)
+        sys.exit('no answer from the node')
+
+    def ack(self, got, missing):
+        bitmap = 0
+        for bit in range(ACK_BITS):
+            seq = missing + 1 + bit
+            if seq < len(got) and got[seq]:
+                bitmap |= 1 << bit
+        self.bus.send(message(CMD_ID, struct.pack('<BHI', CMD_ACK,
+                                                  missing & 0xFFFF, bitmap)))
+        self.acks += 1
+
+    def run(self, length, chunk):
+        total = (length + chunk - 1) // chunk
+        data = bytearray(length)
+        got = bytearray(total)
+        missing = 0
+        unacked = 0
+        last_ack = time.monotonic()
+        started = last_ack
+        done = None
+
+        while missing < total:
+            msg = self.bus.recv(timeout=self.ack_interval)
+            now = time.monotonic()
+            if msg is not None and msg.arbitration_id == DATA_ID:
+                seq16 = msg.data[0] | (msg.data[1] << 8)
+                seq = missing + ((seq16 - missing + 0x8000) & 0xFFFF) - 0x8000
+                self.frames += 1
+                unacked += 1
+                if 0 <= seq < total:
+                    if got[seq]:
+                        self.duplicates += 1
+                    else:
+                        pos = seq * chunk
+                        size = min(chunk, length - pos)
+                        data[pos:pos + size] = msg.data[2:2 + size]
+                        got[seq] = 1
+                        while missing < total and got[missing]:
+                            missing += 1
+            elif msg is not None and msg.arbitration_id == STATUS_ID and \
+                    msg.data[0] == STS_DONE:
+                done = DONE.unpack_from(bytes(msg.data))
+                break
+            if unacked >= self.ack_every or \
+                    (unacked and now - last_ack >= self.ack_interval) or \
+                    now - last_ack >= 5 * self.ack_interval:
+                self.ack(got, missing)
+                unacked = 0
+                last_ack = now
+
+        elapsed = time.monotonic() - started
+        if done is None:
+            # The final acknowledgement ends the transfer on the node
+            for _ in range(3):
+                self.ack(got, missing)
+                status = wait_status(self.bus, STS_DONE, 0.5)
+                if status is not None:
+                    done = DONE.unpack_from(status)
+                    break
+        return data, missing == total, elapsed, done
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawTextHelpFormatter)
+    ap.add_argument('--interface', default='socketcan')
+    ap.add_argument('--channel', default='can0')
+    ap.add_argument('--bitrate', type=int, default=500000,
+                    help='nominal bit rate, for the goodput report')
+    ap.add_argument('--dbitrate', type=int, default=2000000,
+                    help='data phase bit rate, for the goodput report')
+    ap.add_argument('--offset', type=lambda x: int(x, 0), default=0,
+                    help='offset in the log region')
+    ap.add_argument('--length', type=lambda x: int(x, 0), default=0,
+                    help='bytes to read, 0 for the rest of the log')
+    ap.add_argument('--window', type=int, default=64,
+                    help='frames in flight, up to 64')
+    ap.add_argument('--ack-every', type=int, default=16)
+    ap.add_argument('--ack-interval', type=float, default=0.005,
+                    help='seconds without frames before acknowledging')
+    ap.add_argument('-o', '--output', default='image.bin')
+    args = ap.parse_args()
+
+    import can
+
+    with can.Bus(interface=args.interface, channel=args.channel,
+                 fd=True) as bus:
+        bus.set_filters([{'can_id': DATA_ID, 'can_mask': 0x7FF},
+                         {'can_id': STATUS_ID, 'can_mask': 0x7FF}])
+        download = Download(bus, args.ack_every, args.ack_interval)
+        result, chunk, offset, length, data_offset, pages = \
+            download.start(args.offset, args.length, args.window)
+        if result != 0:
+            sys.exit('node refused the transfer: %s' % RESULTS.get(result))
+        print('reading %u bytes at 0x%X (log: %u pages from 0x%X)' %
+              (length, offset, pages, data_offset))
+        try:
+            data, complete, elapsed, done = download.run(length, chunk)
+        except KeyboardInterrupt:
+            bus.send(message(CMD_ID, bytes([CMD_ABORT])))
+            raise
+
+    mode = 'r+b' if os.path.exists(args.output) else 'wb'
+    with open(args.output, mode) as out:
+        out.seek(offset)
+        out.write(data)
+
+    frames = (length + chunk - 1) // chunk
+    limit = (chunk / frame_time(args.bitrate, args.dbitrate))
+    goodput = length / elapsed if elapsed > 0 else 0.0
+    print('%s: %u bytes in %.3f s, %.1f kB/s goodput (%.0f%% of %.1f kB/s '
+          'for %u/%u bit/s)' %
+          ('complete' if complete else 'INCOMPLETE', length, elapsed,
+           goodput / 1000.0, 100.0 * goodput / limit, limit / 1000.0,
+           args.bitrate, args.dbitrate))
+    print('%u frames for %u, %u duplicates, %u acknowledgements' %
+          (download.frames, frames, download.duplicates, download.acks))
+    if done is not None:
+        result, sent, again, us, node_goodput = done
+        print('node: %s, %u frames sent, %u again, %.3f s, %.1f kB/s' %
+              (RESULTS.get(result, result), sent, again, us / 1e6,
+               node_goodput / 1000.0))
+    if not complete:
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
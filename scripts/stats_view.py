@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Renders the statistics snapshots of stats_registry.c, and the fault
+records of fault_capture.c sent after a fault restart.
+
+Sources:
+  --serial PORT     debug UART of the node (needs pyserial); sends the 's'
+                    request, then 'v' every --interval seconds
+  --file FILE       raw capture of the UART output
+  --candump FILE    candump -L log with the frames of BINLOG_CAN_ID; request
+                    them with "cansend can0 7F1##101" (schema and values)
+
+Counters are shown with their rate since the previous snapshot.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+import binlog
+
+TYPE_NAMES = {1: 'counter', 2: 'gauge', 3: 'histogram'}
+
+
+class Viewer:
+    def __init__(self, show_text=False):
+        self.schemas = {}
+        self.previous = {}
+        self.show_text = show_text
+
+    def handle(self, items):
+        for item in items:
+            if item[0] == 'text':
+                if self.show_text:
+                    sys.stdout.write(item[1])
+            elif item[1] == binlog.TYPE_STATS_SCHEMA:
+                self.on_schema(item[2])
+            elif item[1] == binlog.TYPE_STATS_VALUES:
+                self.on_values(item[2])
+            elif item[1] == binlog.TYPE_FAULT:
+                print_fault(item[2])
+
+    def on_schema(self, payload):
+        count, _values, schema_hash = struct.unpack_from('<HHI', payload)
+        pos = 8
+        entries = []
+        for _ in range(count):
+            etype, nvalues, name_len = struct.unpack_from('<BBB', payload, pos)
+            pos += 3
+            name = payload[pos:pos + name_len].decode('ascii', 'replace')
+            pos += name_len
+            entries.append((name, etype, nvalues))
+        self.schemas[schema_hash] = entries
+
+    def on_values(self, payload):
+        schema_hash, time_ms = struct.unpack_from('<II', payload)
+        entries = self.schemas.get(schema_hash)
+        if entries is None:
+            print('values for unknown schema %08x, request the schema' %
+                  schema_hash)
+            return
+        values = struct.unpack_from('<%dI' % ((len(payload) - 8) // 4),
+                                    payload, 8)
+        prev = self.previous.get(schema_hash)
+        self.previous[schema_hash] = (time_ms, values)
+        dt = (time_ms - prev[0]) / 1000.0 if prev else 0.0
+
+        print('--- snapshot at %.3f s ---' % (time_ms / 1000.0))
+        pos = 0
+        for name, etype, nvalues in entries:
+            chunk = values[pos:pos + nvalues]
+            if etype == 3:
+                self.print_histogram(name, chunk)
+            else:
+                line = '%-24s %10u' % (name, chunk[0])
+                if etype == 1 and dt > 0:
+                    delta = (chunk[0] - prev[1][pos]) & 0xFFFFFFFF
+                    line += '  %10.1f/s' % (delta / dt)
+                print(line)
+            pos += nvalues
+        print()
+
+    @staticmethod
+    def print_histogram(name, bins):
+        total = sum(bins)
+        print('%-24s %10u samples' % (name, total))
+        if total == 0:
+            return
+        peak = max(bins)
+        for idx, count in enumerate(bins):
+            if count == 0:
+                continue
+            low = 0 if idx == 0 else 1 << (idx - 1)
+            high = 0 if idx == 0 else (1 << idx) - 1
+            label = '%u' % low if idx == 0 else '%u-%u' % (low, high)
+            if idx == len(bins) - 1:
+                label = '>=%u' % low
+            print('  %18s %10u %s' % (label, count, '#' * (40 * count // peak)))
+
+
+# fault_record_t up to the stack words
+FAULT_FIELDS = ('magic reason status total uptime_ms capture_us recovery_us '
+                'reset_reason r0 r1 r2 r3 r12 lr pc psr cfsr hfsr mmfar bfar '
+                'sp can_psr can_ecr can_ir can_cccr txq_depth rxq_depth '
+                'stack_words').split()
+FAULT_STACK_WORDS = 32
+FAULT_REASONS = {1: 'hard fault', 2: 'error'}
+
+
+def print_fault(payload):
+    rec = dict(zip(FAULT_FIELDS, struct.unpack_from('<%dI' % len(FAULT_FIELDS),
+                                                   payload)))
+    pos = 4 * len(FAULT_FIELDS)
+    stack = struct.unpack_from('<%dI' % FAULT_STACK_WORDS, payload, pos)
+    pos += 4 * FAULT_STACK_WORDS
+    (trace_count,) = struct.unpack_from('<I', payload, pos)
+    pos += 4
+
+    print('=== fault %(total)u since power-on at %(uptime_ms)u ms' % rec,
+          FAULT_REASONS.get(rec['reason'], rec['reason']),
+          'status 0x%08X' % rec['status'])
+    for group in (('pc', 'lr', 'sp', 'psr'), ('r0', 'r1', 'r2', 'r3', 'r12'),
+                  ('cfsr', 'hfsr', 'mmfar', 'bfar'),
+                  ('can_psr', 'can_ecr', 'can_ir', 'can_cccr')):
+        print('  ' + ' '.join('%s %08X' % (name, rec[name]) for name in group))
+    print('  Tx queue %(txq_depth)u, Rx queue %(rxq_depth)u, capture '
+          '%(capture_us)u us, start-up to bus active %(recovery_us)u us, '
+          'reset reason 0x%(reset_reason)X' % rec)
+    for idx in range(0, rec['stack_words'], 8):
+        print('  stack %08X:' % (rec['sp'] + 4 * idx),
+              ' '.join('%08X' % word for word in stack[idx:idx + 8]))
+    for idx in range(trace_count):
+        ts, etype, arg8, arg16 = struct.unpack_from('<IBBH', payload,
+                                                    pos + 8 * idx)
+        print('  trace %10u type %u arg8 %u arg16 0x%04X' %
+              (ts, etype, arg8, arg16))
+    print()
+
+
+def run_serial(args, viewer):
+    import serial  # pyserial
+
+    parser = binlog.Parser()
+    with serial.Serial(args.serial, args.baud, timeout=0.1) as port:
+        port.write(b's')
+        next_request = time.monotonic() + args.interval
+        while True:
+            viewer.handle(parser.feed(port.read(4096)))
+            if args.interval > 0 and time.monotonic() >= next_request:
+                port.write(b'v')
+                next_request += args.interval
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawTextHelpFormatter)
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument('--serial', help='serial port of the node')
+    src.add_argument('--file', help='raw UART capture')
+    src.add_argument('--candump', help='candump -L log')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--interval', type=float, default=5.0,
+                    help='seconds between requests on --serial, 0 for once')
+    ap.add_argument('--can-id', type=lambda x: int(x, 0), default=binlog.CAN_ID)
+    ap.add_argument('--text', action='store_true',
+                    help='also print the text output of the node')
+    args = ap.parse_args()
+
+    viewer = Viewer(args.text)
+    if args.serial:
+        run_serial(args, viewer)
+    elif args.file:
+        with open(args.file, 'rb') as capture:
+            viewer.handle(binlog.Parser().feed(capture.read()))
+    else:
+        stream = binlog.CanStream()
+        with open(args.candump) as log:
+            for data in binlog.candump_frames(log, args.can_id):
+                viewer.handle(stream.feed_frame(data))
+        if stream.lost:
+            print('%u frames lost' % stream.lost)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,220 @@
+#!/usr/bin/env python3
+"""Converts the trace records of trace.c into Chrome trace JSON.
+
+The output opens in https://ui.perfetto.dev or chrome://tracing and shows
+isr_canfd and the main loop iterations as slices, the frames and queue
+operations as instant events and the queue depths as counters.
+
+Sources:
+  --serial PORT     debug UART of the node (needs pyserial); sends 't' to
+                    dump the ring, or 'T' with --stream SECONDS to stream
+  --file FILE       raw capture of the UART output
+  --candump FILE    candump -L log with the frames of BINLOG_CAN_ID
+"""
+
+import argparse
+import json
+import struct
+import sys
+import time
+
+import binlog
+
+ISR_ENTER, ISR_EXIT, RX_FRAME, TXQ_PUSH, TXQ_SUBMIT, TX_DONE, \
+    RXQ_DRAIN, RXQ_PROCESS, LOOP, DEADLINE, MRAM_ERROR, \
+    CAN_ERROR = range(1, 13)
+
+STAGE_NAMES = ['loop.tx', 'loop.rx', 'loop.log', 'loop.shell', 'loop.tasks']
+
+# Message RAM error flags of MRAM_ERROR: IR bits from bit 17 (MRAF)
+MRAM_FLAGS = [(0x01, 'access failure'), (0x08, 'corrected'),
+              (0x10, 'uncorrected')]
+
+# Bus error events of CAN_ERROR (canfd_errlog.h) and protocol error codes
+CAN_ERROR_TYPES = {1: 'protocol', 2: 'state', 3: 'exception', 4: 'overflow'}
+LEC_NAMES = ['none', 'stuff', 'form', 'ACK', 'bit1', 'bit0', 'CRC', '-']
+
+PID = 1
+TID_LOOP, TID_ISR, TID_CAN = 1, 2, 3
+THREAD_NAMES = {TID_LOOP: 'main loop', TID_ISR: 'isr_canfd',
+                TID_CAN: 'frames and queues'}
+
+
+def read_records(items, events, info):
+    """Collects (index, timestamp, type, arg8, arg16) from trace records."""
+    for item in items:
+        if item[0] != 'record' or item[1] != binlog.TYPE_TRACE:
+            continue
+        payload = item[2]
+        first, clock_hz, lost, count = struct.unpack_from('<IIIH', payload)
+        info['clock_hz'] = clock_hz
+        info['lost'] = lost
+        for idx in range(count):
+            ts, etype, arg8, arg16 = struct.unpack_from('<IBBH', payload,
+                                                        16 + 8 * idx)
+            events[first + idx] = (ts, etype, arg8, arg16)
+
+
+def unwrap(events):
+    """Orders the events and extends the 32-bit cycle counts.
+
+    Consecutive events are less than half a counter period apart; small
+    negative steps come from events written by an interrupt between the
+    slot reservation and the timestamp of another writer.
+    """
+    out = []
+    total = None
+    prev = None
+    for index in sorted(events):
+        ts, etype, arg8, arg16 = events[index]
+        if prev is None:
+            total = 0
+        else:
+            delta = (ts - prev) & 0xFFFFFFFF
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            total += delta
+        prev = ts
+        out.append((total, etype, arg8, arg16))
+    return out
+
+
+def to_chrome(events, clock_hz):
+    us_per_cycle = 1e6 / clock_hz
+    trace = []
+    for tid, name in THREAD_NAMES.items():
+        trace.append({'ph': 'M', 'pid': PID, 'tid': tid, 'name': 'thread_name',
+                      'args': {'name': name}})
+
+    loop_start = None
+    for cycles, etype, arg8, arg16 in events:
+        ts = cycles * us_per_cycle
+
+        def instant(name, args=None):
+            trace.append({'ph': 'i', 's': 't', 'pid': PID, 'tid': TID_CAN,
+                          'ts': ts, 'name': name, 'args': args or {}})
+
+        def counter(name, value):
+            trace.append({'ph': 'C', 'pid': PID, 'ts': ts, 'name': name,
+                          'args': {'depth': value}})
+
+        if etype == ISR_ENTER:
+            trace.append({'ph': 'B', 'pid': PID, 'tid': TID_ISR, 'ts': ts,
+                          'name': 'isr_canfd'})
+        elif etype == ISR_EXIT:
+            trace.append({'ph': 'E', 'pid': PID, 'tid': TID_ISR, 'ts': ts})
+        elif etype == LOOP:
+            if loop_start is not None:
+                start, merged = loop_start
+                trace.append({'ph': 'X', 'pid': PID, 'tid': TID_LOOP,
+                              'ts': start, 'dur': ts - start,
+                              'name': 'loop' if merged <= 1 else 'idle',
+                              'args': {'iterations': merged}})
+            loop_start = (ts, arg16)
+        elif etype == RX_FRAME:
+            instant('rx 0x%03X' % arg16, {'len': arg8})
+        elif etype == TXQ_PUSH:
+            instant('txq push 0x%03X' % arg16)
+            counter('txq depth', arg8)
+        elif etype == TXQ_SUBMIT:
+            instant('txq submit', {'frames': arg8})
+            counter('txq depth', arg16)
+        elif etype == TX_DONE:
+            instant('tx done')
+        elif etype == RXQ_DRAIN:
+            instant('rxq drain', {'frames': arg8})
+            counter('rxq depth', arg16)
+        elif etype == RXQ_PROCESS:
+            instant('rxq process', {'frames': arg16})
+        elif etype == DEADLINE:
+            stage = STAGE_NAMES[arg8] if arg8 < len(STAGE_NAMES) else \
+                'stage %u' % arg8
+            trace.append({'ph': 'i', 's': 't', 'pid': PID, 'tid': TID_LOOP,
+                          'ts': ts, 'name': 'deadline %s' % stage,
+                          'args': {'overrun_us': arg16}})
+        elif etype == MRAM_ERROR:
+            flags = [name for bit, name in MRAM_FLAGS if arg8 & bit]
+            instant('mram %s' % ', '.join(flags),
+                    {'recoveries': arg16})
+        elif etype == CAN_ERROR:
+            code = arg16 & 0xFF
+            args = {'tec': arg16 >> 8}
+            if arg8 == 1:
+                args['phase'] = 'data' if code & 0x08 else 'arbitration'
+                args['node'] = 'transmitter' if code & 0x10 else 'receiver'
+                name = 'can %s error' % LEC_NAMES[code & 0x07]
+            else:
+                args['code'] = code
+                name = 'can %s' % CAN_ERROR_TYPES.get(arg8, arg8)
+            instant(name, args)
+        else:
+            instant('event %u' % etype, {'arg8': arg8, 'arg16': arg16})
+
+    # The last loop slice has no end and is left out
+    return {'traceEvents': trace, 'displayTimeUnit': 'ns'}
+
+
+def capture_serial(args):
+    import serial  # pyserial
+
+    data = bytearray()
+    with serial.Serial(args.serial, args.baud, timeout=0.2) as port:
+        if args.stream > 0:
+            port.write(b'T')
+            end = time.monotonic() + args.stream
+            while time.monotonic() < end:
+                data += port.read(4096)
+            port.write(b'T')
+        else:
+            port.write(b't')
+        # Rest of the dump, or of the records in flight
+        while True:
+            chunk = port.read(4096)
+            if not chunk:
+                break
+            data += chunk
+    return binlog.Parser().feed(bytes(data))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawTextHelpFormatter)
+    src = ap.add_mutually_exclusive_group(required=True)
+    src.add_argument('--serial', help='serial port of the node')
+    src.add_argument('--file', help='raw UART capture')
+    src.add_argument('--candump', help='candump -L log')
+    ap.add_argument('--baud', type=int, default=115200)
+    ap.add_argument('--stream', type=float, default=0.0,
+                    help='seconds to stream on --serial, 0 to dump the ring')
+    ap.add_argument('--can-id', type=lambda x: int(x, 0), default=binlog.CAN_ID)
+    ap.add_argument('-o', '--output', default='trace.json')
+    args = ap.parse_args()
+
+    if args.serial:
+        items = capture_serial(args)
+    elif args.file:
+        with open(args.file, 'rb') as capture:
+            items = binlog.Parser().feed(capture.read())
+    else:
+        items = []
+        stream = binlog.CanStream()
+        with open(args.candump) as log:
+            for data in binlog.candump_frames(log, args.can_id):
+                items += stream.feed_frame(data)
+
+    raw = {}
+    info = {'clock_hz': 0, 'lost': 0}
+    read_records(items, raw, info)
+    if not raw:
+        sys.exit('no trace records found')
+
+    events = unwrap(raw)
+    with open(args.output, 'w') as out:
+        json.dump(to_chrome(events, info['clock_hz']), out)
+    span = events[-1][0] / info['clock_hz']
+    print('%u events over %.6f s, %u lost on the node -> %s' %
+          (len(events), span, info['lost'], args.output))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,476 @@
+/******************************************************************************
+* File Name:   sensor_stream.c
+*
+* Description: Streaming of SAR ADC samples over CAN FD. The SAR scans
+*              continuously and the HAL moves the results with DMA into one
+*              half of a double buffer while the main loop packs the other
+*              half, a block of whole frames at a time, directly into Tx queue
+*              slots. The receiving node checks the sequence numbers of the
+*              stream frames and counts lost and late frames.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "cy_pdl.h"
+#include "sensor_stream.h"
+#include "canfd_bitrate.h"
+#include "canfd_txq.h"
+#include "cycle_count.h"
+#include "payload_simd.h"
+#include "stream_reasm.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define STREAM_ADC_INTR_PRIORITY    (3u)
+
+/* Minimum acquisition time of the SAR input */
+#define STREAM_ADC_ACQUISITION_NS   (220u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static sensor_stream_stats_t stream_stats;
+
+/* Receiver state */
+static stream_reasm_t stream_rx;
+static uint8_t stream_rx_buffer[SENSOR_STREAM_RX_BUFFER_SIZE];
+static bool stream_rx_enabled;
+
+#if defined(CY_IP_MXS40PASS_SAR)
+static cyhal_adc_t stream_adc;
+static cyhal_adc_channel_t stream_adc_chan;
+
+/* DMA double buffer; the HAL stores each result as a 32-bit value */
+static int32_t stream_block[2][SENSOR_STREAM_BLOCK_SAMPLES];
+static volatile bool stream_block_ready[2];
+static volatile uint32_t stream_block_cycles[2];
+static volatile uint32_t stream_dma_half;
+
+/* Packing state, main loop only */
+static uint32_t stream_pack_half;
+static uint32_t stream_last_cycles;
+static uint32_t stream_time_us;
+static uint16_t stream_tx_seq;
+static uint8_t stream_tx_flags;
+#endif
+
+/* Report state */
+static uint32_t stream_report_cycles;
+static uint32_t stream_report_samples;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+#if defined(CY_IP_MXS40PASS_SAR)
+static void stream_adc_event(void *callback_arg, cyhal_adc_event_t event);
+static void stream_pack_block(uint32_t half);
+#endif
+static void stream_rx_drain(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+#if defined(CY_IP_MXS40PASS_SAR)
+/*******************************************************************************
+* Function Name: sensor_stream_init
+********************************************************************************
+* Summary:
+* Initializes the SAR ADC for continuous scanning of SENSOR_STREAM_ADC_PIN at
+* SENSOR_STREAM_SAMPLE_RATE_HZ with DMA transfer of the results.
+*
+* Return:
+*  cy_rslt_t  HAL result, SENSOR_STREAM_RSLT_NO_ADC without a SAR ADC
+*
+*******************************************************************************/
+cy_rslt_t sensor_stream_init(void)
+{
+    cy_rslt_t result;
+    const cyhal_adc_config_t adc_config =
+    {
+        .continuous_scanning = true,
+        .average_count       = 1u,
+        .vref                = CYHAL_ADC_REF_VDDA_DIV_2,
+        .vneg                = CYHAL_ADC_VNEG_VSSA,
+        .resolution          = 12u,
+        .ext_vref            = NC,
+        .bypass_pin          = NC,
+    };
+    const cyhal_adc_channel_config_t chan_config =
+    {
+        .enabled            = true,
+        .enable_averaging   = false,
+        .min_acquisition_ns = STREAM_ADC_ACQUISITION_NS,
+    };
+
+    result = cyhal_adc_init(&stream_adc, SENSOR_STREAM_ADC_PIN, NULL);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_adc_channel_init_diff(&stream_adc_chan, &stream_adc,
+                                             SENSOR_STREAM_ADC_PIN,
+                                             CYHAL_ADC_VNEG, &chan_config);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_adc_configure(&stream_adc, &adc_config);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_adc_set_sample_rate(&stream_adc,
+                                           SENSOR_STREAM_SAMPLE_RATE_HZ);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_adc_set_async_mode(&stream_adc, CYHAL_ASYNC_DMA,
+                                          CYHAL_DMA_PRIORITY_DEFAULT);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        cyhal_adc_register_callback(&stream_adc, stream_adc_event, NULL);
+        cyhal_adc_enable_event(&stream_adc, CYHAL_ADC_ASYNC_READ_COMPLETE,
+                               STREAM_ADC_INTR_PRIORITY, true);
+        cycle_count_init();
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: sensor_stream_start
+********************************************************************************
+* Summary:
+* Starts the DMA transfer into the first half buffer.
+*
+*******************************************************************************/
+cy_rslt_t sensor_stream_start(void)
+{
+    stream_dma_half = 0UL;
+    stream_pack_half = 0UL;
+    stream_block_ready[0] = false;
+    stream_block_ready[1] = false;
+    stream_time_us = 0UL;
+    stream_last_cycles = cycle_count_now();
+
+    return cyhal_adc_read_async(&stream_adc, SENSOR_STREAM_BLOCK_SAMPLES,
+                                stream_block[0]);
+}
+
+/*******************************************************************************
+* Function Name: stream_adc_event
+********************************************************************************
+* Summary:
+* ADC event callback, runs when DMA has filled a half buffer. Hands the half
+* buffer to the main loop and restarts the transfer into the other half.
+*
+*******************************************************************************/
+static void stream_adc_event(void *callback_arg, cyhal_adc_event_t event)
+{
+    uint32_t done = stream_dma_half;
+    uint32_t next = done ^ 1UL;
+
+    (void)callback_arg;
+
+    if (0U != ((uint32_t)event & (uint32_t)CYHAL_ADC_ASYNC_READ_COMPLETE))
+    {
+        stream_block_cycles[done] = cycle_count_now();
+
+        if (stream_block_ready[next])
+        {
+            /* The main loop has not packed the other half yet; drop it */
+            stream_block_ready[next] = false;
+            stream_stats.overruns++;
+        }
+
+        stream_dma_half = next;
+        (void)cyhal_adc_read_async(&stream_adc, SENSOR_STREAM_BLOCK_SAMPLES,
+                                   stream_block[next]);
+
+        stream_stats.blocks++;
+        stream_block_ready[done] = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stream_pack_block
+********************************************************************************
+* Summary:
+* Packs one completed half buffer into SENSOR_STREAM_FRAMES_PER_BLOCK frames
+* that are built in place in the Tx queue, after waiting up to
+* SENSOR_STREAM_TX_WAIT_MS for space. Frames that still do not fit into the
+* queue consume a sequence number so that the receiver sees the gap.
+*
+*******************************************************************************/
+static void stream_pack_block(uint32_t half)
+{
+    uint32_t block_cycles = stream_block_cycles[half];
+    uint32_t sample_us_x256 = (1000000UL * 256UL) / SENSOR_STREAM_SAMPLE_RATE_HZ;
+    uint32_t first_us;
+
+    /* Advance the stream clock; blocks complete well within a counter wrap */
+    stream_time_us += cycle_count_to_us(block_cycles - stream_last_cycles);
+    stream_last_cycles = block_cycles;
+    first_us = stream_time_us -
+               ((SENSOR_STREAM_BLOCK_SAMPLES * sample_us_x256) / 256UL);
+
+    /* A burst faster than the bus waits for the queue to drain */
+    (void)canfd_txq_wait_space(SENSOR_STREAM_FRAMES_PER_BLOCK,
+                               SENSOR_STREAM_TX_WAIT_MS);
+
+    for (uint32_t frame_idx = 0UL; frame_idx < SENSOR_STREAM_FRAMES_PER_BLOCK;
+         frame_idx++)
+    {
+        uint32_t first_sample = frame_idx * SENSOR_STREAM_SAMPLES_PER_FRAME;
+        canfd_frame_t *frame = canfd_txq_alloc();
+
+        if (NULL == frame)
+        {
+            stream_stats.tx_dropped++;
+            stream_tx_flags |= SENSOR_STREAM_FLAG_OVERRUN;
+        }
+        else
+        {
+            frame->id = SENSOR_STREAM_CAN_ID;
+            frame->len = CANFD_FRAME_MAX_LEN;
+            frame->flags = CANFD_FRAME_FLAG_FDF | CANFD_FRAME_FLAG_BRS;
+            frame->data[0] = (uint32_t)stream_tx_seq |
+                             ((uint32_t)SENSOR_STREAM_SAMPLES_PER_FRAME << 16) |
+                             ((uint32_t)stream_tx_flags << 24);
+            frame->data[1] = first_us +
+                             ((first_sample * sample_us_x256) / 256UL);
+            payload_simd_narrow_s32(&stream_block[half][first_sample],
+                                    (int16_t *)(void *)&frame->data[2],
+                                    SENSOR_STREAM_SAMPLES_PER_FRAME);
+            canfd_txq_commit();
+
+            stream_tx_flags = 0U;
+            stream_stats.tx_frames++;
+            stream_stats.tx_samples += SENSOR_STREAM_SAMPLES_PER_FRAME;
+        }
+        stream_tx_seq++;
+    }
+}
+
+#else /* CY_IP_MXS40PASS_SAR */
+
+cy_rslt_t sensor_stream_init(void)
+{
+    return SENSOR_STREAM_RSLT_NO_ADC;
+}
+
+cy_rslt_t sensor_stream_start(void)
+{
+    return SENSOR_STREAM_RSLT_NO_ADC;
+}
+
+#endif /* CY_IP_MXS40PASS_SAR */
+
+/*******************************************************************************
+* Function Name: sensor_stream_process
+********************************************************************************
+* Summary:
+* Main loop part of the stream: packs the completed half buffers in order,
+* starts their transmission, consumes the reassembled samples on the
+* receiving side and prints the statistics periodically.
+*
+*******************************************************************************/
+void sensor_stream_process(void)
+{
+#if defined(CY_IP_MXS40PASS_SAR)
+    while (stream_block_ready[stream_pack_half])
+    {
+        stream_pack_block(stream_pack_half);
+        stream_block_ready[stream_pack_half] = false;
+        stream_pack_half ^= 1UL;
+    }
+
+    (void)canfd_txq_service();
+#endif
+
+    if (stream_rx_enabled)
+    {
+        stream_rx_drain();
+    }
+
+#if (SENSOR_STREAM_REPORT_INTERVAL_MS > 0u)
+    if ((cycle_count_now() - stream_report_cycles) >=
+        ((SystemCoreClock / 1000UL) * SENSOR_STREAM_REPORT_INTERVAL_MS))
+    {
+        uint32_t samples = stream_stats.tx_samples + stream_stats.rx_samples;
+
+        printf("Stream: %lu samples/s\r\n",
+               (unsigned long)(((samples - stream_report_samples) * 1000UL) /
+                               SENSOR_STREAM_REPORT_INTERVAL_MS));
+        sensor_stream_print_stats();
+
+        stream_report_samples = samples;
+        stream_report_cycles = cycle_count_now();
+    }
+#endif
+}
+
+/*******************************************************************************
+* Function Name: sensor_stream_rx_init
+********************************************************************************
+* Summary:
+* Registers the receiving side of the stream with the reassembler. Frames with
+* SENSOR_STREAM_CAN_ID are then reordered by their sequence number and their
+* samples collected in stream_rx_buffer.
+*
+* Return:
+*  cy_rslt_t  CY_RSLT_SUCCESS, SENSOR_STREAM_RSLT_NO_RX if the registration
+*             failed
+*
+*******************************************************************************/
+cy_rslt_t sensor_stream_rx_init(void)
+{
+    const stream_reasm_config_t config =
+    {
+        .can_id = SENSOR_STREAM_CAN_ID,
+        .seq_offset = 0u,
+        .data_offset = SENSOR_STREAM_HEADER_LEN,
+        .reorder_window = SENSOR_STREAM_REORDER_WINDOW,
+        .buffer = stream_rx_buffer,
+        .buffer_size = sizeof(stream_rx_buffer),
+    };
+
+    if (!stream_reasm_register(&stream_rx, &config))
+    {
+        return SENSOR_STREAM_RSLT_NO_RX;
+    }
+
+    stream_rx_enabled = true;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: stream_rx_drain
+********************************************************************************
+* Summary:
+* Consumes the reassembled samples in place and updates the receiver counters.
+*
+*******************************************************************************/
+static void stream_rx_drain(void)
+{
+    stream_reasm_span_t span = stream_reasm_peek(&stream_rx);
+
+    /* Payloads and the buffer size are even, so no sample is split by the
+     * wrap-around. At most two spans are available at a time. */
+    while (0UL != span.len)
+    {
+        /* The samples are only counted; an application would process
+         * span.data here */
+        stream_stats.rx_samples += span.len / sizeof(int16_t);
+        stream_reasm_consume(&stream_rx, span.len);
+        span = stream_reasm_peek(&stream_rx);
+    }
+
+    stream_stats.rx_frames = stream_rx.stats.frames;
+    stream_stats.rx_lost = stream_rx.stats.lost;
+    stream_stats.rx_out_of_order = stream_rx.stats.duplicates;
+}
+
+/*******************************************************************************
+* Function Name: sensor_stream_report_capacity
+********************************************************************************
+* Summary:
+* Prints the highest sustainable sample rate of the frame format for every bit
+* rate profile, assuming the stream has the bus to itself.
+*
+*******************************************************************************/
+void sensor_stream_report_capacity(void)
+{
+    printf("Stream capacity, %u samples per %u-byte frame:\r\n",
+           (unsigned int)SENSOR_STREAM_SAMPLES_PER_FRAME,
+           (unsigned int)CANFD_FRAME_MAX_LEN);
+
+    for (uint32_t idx = 0UL; idx < canfd_bitrate_profile_count; idx++)
+    {
+        const canfd_bitrate_profile_t *profile = &canfd_bitrate_profiles[idx];
+        uint32_t frame_ns = canfd_bitrate_frame_time_ns(profile,
+                                                        CANFD_FRAME_MAX_LEN,
+                                                        false, true);
+        uint32_t frames_per_s = 1000000000UL / frame_ns;
+
+        printf("  %-8s %5lu us/frame %6lu frames/s %8lu samples/s\r\n",
+               profile->name, (unsigned long)(frame_ns / 1000UL),
+               (unsigned long)frames_per_s,
+               (unsigned long)(frames_per_s * SENSOR_STREAM_SAMPLES_PER_FRAME));
+    }
+    printf("\r\n");
+}
+
+/*******************************************************************************
+* Function Name: sensor_stream_print_stats
+********************************************************************************
+* Summary:
+* Prints the producer and receiver counters.
+*
+*******************************************************************************/
+void sensor_stream_print_stats(void)
+{
+    printf("  tx: %lu frames, %lu dropped, %lu overruns\r\n",
+           (unsigned long)stream_stats.tx_frames,
+           (unsigned long)stream_stats.tx_dropped,
+           (unsigned long)stream_stats.overruns);
+    printf("  rx: %lu frames, %lu lost, %lu out of order\r\n\r\n",
+           (unsigned long)stream_stats.rx_frames,
+           (unsigned long)stream_stats.rx_lost,
+           (unsigned long)stream_stats.rx_out_of_order);
+
+    if (stream_rx_enabled)
+    {
+        stream_reasm_print_stats(&stream_rx);
+        printf("\r\n");
+    }
+}
+
+/*******************************************************************************
+* Function Name: sensor_stream_get_stats
+********************************************************************************
+* Summary:
+* Returns the stream counters.
+*
+*******************************************************************************/
+const sensor_stream_stats_t *sensor_stream_get_stats(void)
+{
+    return &stream_stats;
+}
+
+/* [] END OF FILE */
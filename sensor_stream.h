@@ -0,0 +1,145 @@
+/******************************************************************************
+* File Name:   sensor_stream.h
+*
+* Description: Streaming of SAR ADC samples in 64-byte CAN FD frames and the
+*              receiving side sequence check.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef SENSOR_STREAM_H_
+#define SENSOR_STREAM_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cyhal.h"
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Identifier of the stream frames */
+#ifndef SENSOR_STREAM_CAN_ID
+#define SENSOR_STREAM_CAN_ID                (0x100u)
+#endif
+
+/* SAR ADC input and conversion rate */
+#ifndef SENSOR_STREAM_ADC_PIN
+#define SENSOR_STREAM_ADC_PIN               (P10_0)
+#endif
+#ifndef SENSOR_STREAM_SAMPLE_RATE_HZ
+#define SENSOR_STREAM_SAMPLE_RATE_HZ        (20000u)
+#endif
+
+/* Frame layout: 8-byte header followed by 16-bit little-endian samples.
+ *  byte 0-1  sequence number
+ *  byte 2    number of samples
+ *  byte 3    SENSOR_STREAM_FLAG_xxx
+ *  byte 4-7  time of the first sample in microseconds since the stream start */
+#define SENSOR_STREAM_HEADER_LEN            (8u)
+#define SENSOR_STREAM_SAMPLES_PER_FRAME     \
+    ((CANFD_FRAME_MAX_LEN - SENSOR_STREAM_HEADER_LEN) / 2u)
+
+#define SENSOR_STREAM_FLAG_OVERRUN          (0x01u) /* Samples lost before */
+
+/* Frames per DMA half buffer */
+#ifndef SENSOR_STREAM_FRAMES_PER_BLOCK
+#define SENSOR_STREAM_FRAMES_PER_BLOCK      (4u)
+#endif
+#define SENSOR_STREAM_BLOCK_SAMPLES         \
+    (SENSOR_STREAM_FRAMES_PER_BLOCK * SENSOR_STREAM_SAMPLES_PER_FRAME)
+
+/* Longest wait for Tx queue space for a block before its frames are
+ * dropped; half the block period, so that the other half buffer is packed
+ * in time */
+#ifndef SENSOR_STREAM_TX_WAIT_MS
+#define SENSOR_STREAM_TX_WAIT_MS            \
+    ((SENSOR_STREAM_BLOCK_SAMPLES * 500u) / SENSOR_STREAM_SAMPLE_RATE_HZ)
+#endif
+
+/* Receiver: reassembly buffer (power of two) and frames held for reordering */
+#ifndef SENSOR_STREAM_RX_BUFFER_SIZE
+#define SENSOR_STREAM_RX_BUFFER_SIZE        (4096u)
+#endif
+#ifndef SENSOR_STREAM_REORDER_WINDOW
+#define SENSOR_STREAM_REORDER_WINDOW        (4u)
+#endif
+
+/* Interval of the statistics print, 0 to disable */
+#ifndef SENSOR_STREAM_REPORT_INTERVAL_MS
+#define SENSOR_STREAM_REPORT_INTERVAL_MS    (5000u)
+#endif
+
+/* Returned by sensor_stream_init on devices without a SAR ADC */
+#define SENSOR_STREAM_RSLT_NO_ADC           \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 1u))
+
+/* Returned by sensor_stream_rx_init if the reassembler is not available */
+#define SENSOR_STREAM_RSLT_NO_RX            \
+    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 2u))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    /* Producer */
+    uint32_t blocks;            /* DMA half buffers completed */
+    uint32_t overruns;          /* Half buffers overwritten before packing */
+    uint32_t tx_frames;         /* Frames queued for transmission */
+    uint32_t tx_dropped;        /* Frames dropped because the Tx queue was full */
+    uint32_t tx_samples;
+    /* Receiver */
+    uint32_t rx_frames;
+    uint32_t rx_lost;           /* Frames missing in the sequence */
+    uint32_t rx_out_of_order;   /* Duplicate or too late frames */
+    uint32_t rx_samples;
+} sensor_stream_stats_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t sensor_stream_init(void);
+cy_rslt_t sensor_stream_start(void);
+void sensor_stream_process(void);
+cy_rslt_t sensor_stream_rx_init(void);
+void sensor_stream_report_capacity(void);
+void sensor_stream_print_stats(void);
+const sensor_stream_stats_t *sensor_stream_get_stats(void);
+
+#endif /* SENSOR_STREAM_H_ */
+
+/* [] END OF FILE */
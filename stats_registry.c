@@ -0,0 +1,387 @@
+/******************************************************************************
+* File Name:   stats_registry.c
+*
+* Description: Runtime statistics registry: counters, gauges and histograms
+*              described by constant entries that the linker collects into one
+*              table, exported as a binary snapshot over the binary log
+*              channel.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "stats_registry.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Snapshot layout, all fields little endian:
+ * schema: entries (u16), values (u16), hash (u32), then per entry
+ *         type (u8), count (u8), name length (u8), name
+ * values: hash (u32), time in ms (u32), then count values (u32) per entry
+ * The hash identifies the schema, so a host only needs the schema once per
+ * firmware build. */
+#define STATS_SCHEMA_HEADER     (8u)
+#define STATS_ENTRY_HEADER      (3u)
+#define STATS_VALUES_HEADER     (8u)
+#define STATS_NAME_MAX          (255u)
+
+#define STATS_FNV_BASIS         (2166136261UL)
+#define STATS_FNV_PRIME         (16777619UL)
+
+/* stats_can_request: a request is pending, with STATS_REQUEST_SCHEMA */
+#define STATS_PENDING           (0x80u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+#if (STATS_REGISTRY_SUPPORTED)
+extern const stats_entry_t __start_stats_registry[];
+extern const stats_entry_t __stop_stats_registry[];
+#define STATS_FIRST             (__start_stats_registry)
+#define STATS_LAST              (__stop_stats_registry)
+#else
+#define STATS_FIRST             ((const stats_entry_t *)NULL)
+#define STATS_LAST              ((const stats_entry_t *)NULL)
+#endif
+
+/* Requests taken from the CAN FD interrupt, served by stats_process */
+static volatile uint8_t stats_can_request;
+
+static uint32_t stats_hash;
+static uint32_t stats_last_export_ms;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t stats_name_len(const stats_entry_t *entry);
+static void stats_schema_info(uint32_t *schema_len, uint32_t *values);
+static void stats_write_u32(uint32_t value);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: stats_registry_count
+********************************************************************************
+* Summary:
+* Returns the number of registered entries.
+*
+*******************************************************************************/
+uint32_t stats_registry_count(void)
+{
+#if (STATS_REGISTRY_SUPPORTED)
+    return (uint32_t)(STATS_LAST - STATS_FIRST);
+#else
+    return 0UL;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: stats_read
+********************************************************************************
+* Summary:
+* Returns value idx of an entry: 0 for counters and gauges, the bin for
+* histograms.
+*
+*******************************************************************************/
+uint32_t stats_read(const stats_entry_t *entry, uint32_t idx)
+{
+    if (NULL != entry->read)
+    {
+        return entry->read();
+    }
+    return entry->value[idx];
+}
+
+/*******************************************************************************
+* Function Name: stats_export
+********************************************************************************
+* Summary:
+* Sends a values record, preceded by the schema record if requested, over
+* the binary log channel. Thread context only. The values are read one word
+* at a time while the record is written, without stopping the writers; each
+* value is consistent, the snapshot as a whole is not.
+*
+* Parameters:
+*  channel    UART or CAN FD
+*  schema     true to send the names and types as well
+*
+* Return:
+*  bool  false if a binary log record was in progress
+*
+*******************************************************************************/
+bool stats_export(binlog_channel_t channel, bool schema)
+{
+    uint32_t schema_len;
+    uint32_t values;
+    uint8_t header[STATS_SCHEMA_HEADER];
+
+    stats_schema_info(&schema_len, &values);
+
+    if (schema)
+    {
+        if (!binlog_begin(channel, BINLOG_TYPE_STATS_SCHEMA, schema_len))
+        {
+            return false;
+        }
+
+        header[0] = (uint8_t)stats_registry_count();
+        header[1] = (uint8_t)(stats_registry_count() >> 8);
+        header[2] = (uint8_t)values;
+        header[3] = (uint8_t)(values >> 8);
+        binlog_write(header, 4UL);
+        stats_write_u32(stats_hash);
+
+        for (const stats_entry_t *entry = STATS_FIRST; entry < STATS_LAST;
+             entry++)
+        {
+            uint32_t len = stats_name_len(entry);
+
+            header[0] = entry->type;
+            header[1] = entry->count;
+            header[2] = (uint8_t)len;
+            binlog_write(header, STATS_ENTRY_HEADER);
+            binlog_write(entry->name, len);
+        }
+        binlog_end();
+    }
+
+    if (!binlog_begin(channel, BINLOG_TYPE_STATS_VALUES,
+                      STATS_VALUES_HEADER + (values * 4UL)))
+    {
+        return false;
+    }
+
+    stats_write_u32(stats_hash);
+    stats_write_u32(sys_tick_ms());
+    for (const stats_entry_t *entry = STATS_FIRST; entry < STATS_LAST; entry++)
+    {
+        for (uint32_t idx = 0UL; idx < entry->count; idx++)
+        {
+            stats_write_u32(stats_read(entry, idx));
+        }
+    }
+    binlog_end();
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: stats_request
+********************************************************************************
+* Summary:
+* Exports a snapshot: immediately over the UART, from the main loop
+* (stats_process) over CAN FD so that the Tx queue is only filled from thread
+* context.
+*
+*******************************************************************************/
+void stats_request(binlog_channel_t channel, bool schema)
+{
+    if (BINLOG_CHANNEL_UART == channel)
+    {
+        (void)stats_export(channel, schema);
+    }
+    else
+    {
+        /* The CAN FD interrupt writes the request as well */
+        uint32_t intr = Cy_SysLib_EnterCriticalSection();
+
+        stats_can_request |= (uint8_t)(STATS_PENDING |
+                                       (schema ? STATS_REQUEST_SCHEMA : 0u));
+        Cy_SysLib_ExitCriticalSection(intr);
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_rx_frame
+********************************************************************************
+* Summary:
+* Takes a request frame (STATS_REQUEST_CAN_ID) out of the receive path. Safe
+* in interrupt context; the snapshot is sent by stats_process.
+*
+* Return:
+*  bool  true if the frame was a request
+*
+*******************************************************************************/
+bool stats_rx_frame(const canfd_frame_t *frame)
+{
+    const uint8_t *bytes = (const uint8_t *)frame->data;
+
+    if ((STATS_REQUEST_CAN_ID != frame->id) ||
+        (0U != (frame->flags & CANFD_FRAME_FLAG_XTD)))
+    {
+        return false;
+    }
+
+    stats_can_request = (uint8_t)(STATS_PENDING |
+                                  (((0U != frame->len) ? bytes[0] : 0u) &
+                                   STATS_REQUEST_SCHEMA));
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: stats_process
+********************************************************************************
+* Summary:
+* Main loop part of the export: serves CAN FD requests and the periodic
+* export when STATS_EXPORT_INTERVAL_MS is set. The request is taken and
+* cleared in one critical section, so a request frame that arrives in between
+* is not lost.
+*
+*******************************************************************************/
+void stats_process(void)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+    uint8_t request = stats_can_request;
+
+    stats_can_request = 0U;
+    Cy_SysLib_ExitCriticalSection(intr);
+
+    if (0U != request)
+    {
+        (void)stats_export(BINLOG_CHANNEL_CAN,
+                           0U != (request & STATS_REQUEST_SCHEMA));
+    }
+
+#if (STATS_EXPORT_INTERVAL_MS > 0u)
+    if ((sys_tick_ms() - stats_last_export_ms) >= STATS_EXPORT_INTERVAL_MS)
+    {
+        stats_last_export_ms = sys_tick_ms();
+        (void)stats_export(BINLOG_CHANNEL_UART, false);
+    }
+#else
+    (void)stats_last_export_ms;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: stats_print
+********************************************************************************
+* Summary:
+* Prints every entry as text: one line per counter or gauge, the non-empty
+* bins of a histogram as "lower bound: count".
+*
+*******************************************************************************/
+void stats_print(void)
+{
+    for (const stats_entry_t *entry = STATS_FIRST; entry < STATS_LAST; entry++)
+    {
+        if (STATS_TYPE_HISTOGRAM != entry->type)
+        {
+            printf("%-24s %lu\r\n", entry->name,
+                   (unsigned long)stats_read(entry, 0UL));
+            continue;
+        }
+
+        printf("%-24s", entry->name);
+        for (uint32_t idx = 0UL; idx < entry->count; idx++)
+        {
+            uint32_t count = stats_read(entry, idx);
+
+            if (0UL != count)
+            {
+                printf(" %lu:%lu",
+                       (unsigned long)((0UL == idx) ? 0UL : (1UL << (idx - 1UL))),
+                       (unsigned long)count);
+            }
+        }
+        printf("\r\n");
+    }
+}
+
+/*******************************************************************************
+* Function Name: stats_name_len
+*******************************************************************************/
+static uint32_t stats_name_len(const stats_entry_t *entry)
+{
+    uint32_t len = (uint32_t)strlen(entry->name);
+
+    return (len > STATS_NAME_MAX) ? STATS_NAME_MAX : len;
+}
+
+/*******************************************************************************
+* Function Name: stats_schema_info
+********************************************************************************
+* Summary:
+* Returns the schema record length and the number of values, and updates
+* the schema hash (FNV-1a over types, counts and names).
+*
+*******************************************************************************/
+static void stats_schema_info(uint32_t *schema_len, uint32_t *values)
+{
+    uint32_t hash = STATS_FNV_BASIS;
+
+    *schema_len = STATS_SCHEMA_HEADER;
+    *values = 0UL;
+
+    for (const stats_entry_t *entry = STATS_FIRST; entry < STATS_LAST; entry++)
+    {
+        uint32_t len = stats_name_len(entry);
+
+        *schema_len += STATS_ENTRY_HEADER + len;
+        *values += entry->count;
+
+        hash = (hash ^ entry->type) * STATS_FNV_PRIME;
+        hash = (hash ^ entry->count) * STATS_FNV_PRIME;
+        for (uint32_t idx = 0UL; idx < len; idx++)
+        {
+            hash = (hash ^ (uint8_t)entry->name[idx]) * STATS_FNV_PRIME;
+        }
+    }
+
+    stats_hash = hash;
+}
+
+/*******************************************************************************
+* Function Name: stats_write_u32
+*******************************************************************************/
+static void stats_write_u32(uint32_t value)
+{
+    uint8_t bytes[4];
+
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+    bytes[2] = (uint8_t)(value >> 16);
+    bytes[3] = (uint8_t)(value >> 24);
+    binlog_write(bytes, sizeof(bytes));
+}
+
+/* [] END OF FILE */
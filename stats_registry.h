@@ -0,0 +1,204 @@
+/******************************************************************************
+* File Name:   stats_registry.h
+*
+* Description: Runtime statistics registry: counters, gauges and histograms
+*              described by constant entries that the linker collects into one
+*              table, exported as a binary snapshot over the binary log
+*              channel.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef STATS_REGISTRY_H_
+#define STATS_REGISTRY_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "binlog.h"
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Frames to this identifier request a snapshot over CAN FD; bit 0 of the
+ * first payload byte asks for the schema as well */
+#ifndef STATS_REQUEST_CAN_ID
+#define STATS_REQUEST_CAN_ID    (0x7F1u)
+#endif
+#define STATS_REQUEST_SCHEMA    (0x01u)
+
+/* Snapshots sent without a request, 0 to disable */
+#ifndef STATS_EXPORT_INTERVAL_MS
+#define STATS_EXPORT_INTERVAL_MS    (0u)
+#endif
+
+/* Histogram bins: bin 0 counts the value 0, bin n the values 2^(n-1) to
+ * 2^n - 1; the last bin also takes everything above */
+#ifndef STATS_HIST_BINS
+#define STATS_HIST_BINS         (20u)
+#endif
+
+/* Entry types, also used in the snapshot */
+#define STATS_TYPE_COUNTER      (1u)
+#define STATS_TYPE_GAUGE        (2u)
+#define STATS_TYPE_HISTOGRAM    (3u)
+
+/* The entries are placed in the section stats_registry. GNU ld keeps it and
+ * defines __start_stats_registry and __stop_stats_registry around it without
+ * any change to the linker script. Other toolchains build with an empty
+ * registry. */
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION)
+#define STATS_REGISTRY_SUPPORTED    (1u)
+#define STATS_SECTION           __attribute__((section("stats_registry"), \
+                                               used, aligned(4)))
+#else
+#define STATS_REGISTRY_SUPPORTED    (0u)
+#define STATS_SECTION
+#endif
+
+/* Registers a 32-bit variable as a counter or gauge. Use at file scope next
+ * to the variable; tag only has to be unique within the file. */
+#define STATS_COUNTER(tag, name, ptr)   \
+    STATS_ENTRY_(tag, name, STATS_TYPE_COUNTER, 1u, ptr, NULL)
+#define STATS_GAUGE(tag, name, ptr)     \
+    STATS_ENTRY_(tag, name, STATS_TYPE_GAUGE, 1u, ptr, NULL)
+
+/* Registers a gauge computed by fn when the snapshot is taken */
+#define STATS_GAUGE_FN(tag, name, fn)   \
+    STATS_ENTRY_(tag, name, STATS_TYPE_GAUGE, 1u, NULL, fn)
+
+/* Registers a stats_hist_t */
+#define STATS_HISTOGRAM(tag, name, hist) \
+    STATS_ENTRY_(tag, name, STATS_TYPE_HISTOGRAM, STATS_HIST_BINS, \
+                 (hist)->bins, NULL)
+
+#define STATS_ENTRY_(tag, name, type, count, ptr, fn)                   \
+    static const stats_entry_t stats_entry_##tag STATS_SECTION =         \
+    {                                                                    \
+        (name), (ptr), (fn), (type), (count), 0u                         \
+    }
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    const char *name;               /* Dotted name, e.g. "txq.queued" */
+    const volatile uint32_t *value; /* Value or histogram bins */
+    uint32_t (*read)(void);         /* Gauge computed on export, or NULL */
+    uint8_t type;                   /* STATS_TYPE_xxx */
+    uint8_t count;                  /* Values: 1, or STATS_HIST_BINS */
+    uint16_t reserved;
+} stats_entry_t;
+
+typedef struct
+{
+    volatile uint32_t bins[STATS_HIST_BINS];
+} stats_hist_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t stats_registry_count(void);
+uint32_t stats_read(const stats_entry_t *entry, uint32_t idx);
+bool stats_export(binlog_channel_t channel, bool schema);
+void stats_request(binlog_channel_t channel, bool schema);
+bool stats_rx_frame(const canfd_frame_t *frame);
+void stats_process(void);
+void stats_print(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: stats_inc / stats_add
+********************************************************************************
+* Summary:
+* Increments a counter from any context. A counter that has a single writer
+* (one interrupt, or the main loop) can use a plain ++ instead; the export
+* reads each value with one word load. Counters written from several
+* priorities need this exclusive-access update, which is retried only when an
+* interrupt intervened.
+*
+*******************************************************************************/
+__STATIC_INLINE void stats_add(volatile uint32_t *counter, uint32_t n)
+{
+#if (__CORTEX_M >= 3U)
+    uint32_t value;
+
+    do
+    {
+        value = __LDREXW(counter) + n;
+    } while (0UL != __STREXW(value, counter));
+#else
+    uint32_t saved_intr = Cy_SysLib_EnterCriticalSection();
+
+    *counter += n;
+    Cy_SysLib_ExitCriticalSection(saved_intr);
+#endif
+}
+
+__STATIC_INLINE void stats_inc(volatile uint32_t *counter)
+{
+    stats_add(counter, 1UL);
+}
+
+/*******************************************************************************
+* Function Name: stats_hist_add
+********************************************************************************
+* Summary:
+* Counts value in its power-of-two bin; the bin index is one CLZ.
+*
+*******************************************************************************/
+__STATIC_INLINE void stats_hist_add(stats_hist_t *hist, uint32_t value)
+{
+    uint32_t bin = 32UL - __CLZ(value);
+
+    if (bin >= STATS_HIST_BINS)
+    {
+        bin = STATS_HIST_BINS - 1UL;
+    }
+    stats_inc(&hist->bins[bin]);
+}
+
+#endif /* STATS_REGISTRY_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,436 @@
+/******************************************************************************
+* File Name:   stream_reasm.c
+*
+* Description: Receiver-side stream reassembly. Frames of a registered stream
+*              are identified by their CAN ID and ordered by a 16-bit sequence
+*              number in the payload. In-order payloads are appended to a
+*              contiguous circular buffer; frames that arrive early are held in
+*              a small reorder window until the gap is filled or the window is
+*              exceeded, at which point the missing frames are counted as lost.
+*              Consumers read the buffer in place through spans. The receive
+*              path (usually the CAN FD interrupt) is the only producer and one
+*              consumer reads from thread context.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "stream_reasm.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static stream_reasm_t *reasm_streams[STREAM_REASM_MAX_STREAMS];
+static uint32_t reasm_stream_count;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint16_t reasm_get_seq(const stream_reasm_t *stream,
+                              const canfd_frame_t *frame);
+static void reasm_deliver(stream_reasm_t *stream, const canfd_frame_t *frame);
+static bool reasm_take_pending(stream_reasm_t *stream, uint16_t seq);
+static void reasm_advance_to(stream_reasm_t *stream, uint16_t target);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: stream_reasm_register
+********************************************************************************
+* Summary:
+* Registers a stream. Must be called before frames of the stream arrive.
+*
+* Parameters:
+*  stream     Stream state, owned by the caller
+*  config     Stream description; copied
+*
+* Return:
+*  bool  false if the table is full or the configuration is invalid
+*
+*******************************************************************************/
+bool stream_reasm_register(stream_reasm_t *stream,
+                           const stream_reasm_config_t *config)
+{
+    uint32_t window = config->reorder_window;
+
+    if ((reasm_stream_count >= STREAM_REASM_MAX_STREAMS) ||
+        (window > STREAM_REASM_MAX_WINDOW) ||
+        (0UL != (window & (window - 1UL))) ||
+        (0UL == config->buffer_size) ||
+        (0UL != (config->buffer_size & (config->buffer_size - 1UL))) ||
+        ((uint32_t)config->seq_offset + 2UL > CANFD_FRAME_MAX_LEN))
+    {
+        return false;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    stream->config = *config;
+    cycle_count_init();
+
+    reasm_streams[reasm_stream_count] = stream;
+    reasm_stream_count++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_find
+********************************************************************************
+* Summary:
+* Returns the stream registered for can_id, or NULL.
+*
+*******************************************************************************/
+stream_reasm_t *stream_reasm_find(uint32_t can_id)
+{
+    for (uint32_t idx = 0UL; idx < reasm_stream_count; idx++)
+    {
+        if (reasm_streams[idx]->config.can_id == can_id)
+        {
+            return reasm_streams[idx];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_push_frame
+********************************************************************************
+* Summary:
+* Passes a received frame to the stream registered for its ID.
+*
+* Return:
+*  bool  true if the frame belonged to a registered stream
+*
+*******************************************************************************/
+bool stream_reasm_push_frame(const canfd_frame_t *frame)
+{
+    stream_reasm_t *stream = stream_reasm_find(frame->id);
+
+    if (NULL == stream)
+    {
+        return false;
+    }
+    stream_reasm_push(stream, frame);
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_push
+********************************************************************************
+* Summary:
+* Adds one frame of the stream. The frame is delivered if it is the expected
+* one, held if it is within the reorder window ahead of it, or dropped as a
+* duplicate if it is behind. A frame beyond the window forces the oldest
+* missing sequence numbers out as lost.
+*
+* Parameters:
+*  stream     Registered stream
+*  frame      Received frame; frame->timestamp is the reception cycle count
+*
+*******************************************************************************/
+void stream_reasm_push(stream_reasm_t *stream, const canfd_frame_t *frame)
+{
+    uint16_t seq = reasm_get_seq(stream, frame);
+    uint16_t window = stream->config.reorder_window;
+    uint16_t ahead;
+    uint32_t slot;
+
+    if (!stream->synced)
+    {
+        stream->expected = seq;
+        stream->synced = true;
+    }
+
+    ahead = (uint16_t)(seq - stream->expected);
+    if ((ahead < 0x8000U) && (ahead > window))
+    {
+        reasm_advance_to(stream, (uint16_t)(seq - window));
+
+        /* Frames held right after the gap are in order now; they must leave
+         * their slots before this frame takes one */
+        while (reasm_take_pending(stream, stream->expected))
+        {
+            stream->expected++;
+        }
+        ahead = (uint16_t)(seq - stream->expected);
+    }
+
+    if (ahead >= 0x8000U)
+    {
+        stream->stats.duplicates++;
+        return;
+    }
+
+    if (0U == ahead)
+    {
+        reasm_deliver(stream, frame);
+        stream->expected++;
+
+        /* Release the frames that were waiting for this one */
+        while (reasm_take_pending(stream, stream->expected))
+        {
+            stream->expected++;
+        }
+    }
+    else
+    {
+        slot = (uint32_t)seq & (window - 1UL);
+        if ((0U != (stream->pending_mask & (1U << slot))) &&
+            (stream->pending_seq[slot] == seq))
+        {
+            stream->stats.duplicates++;
+        }
+        else
+        {
+            stream->pending[slot] = *frame;
+            stream->pending_seq[slot] = seq;
+            stream->pending_mask |= (uint8_t)(1U << slot);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: reasm_get_seq
+********************************************************************************
+* Summary:
+* Reads the little-endian sequence number of a frame.
+*
+*******************************************************************************/
+static uint16_t reasm_get_seq(const stream_reasm_t *stream,
+                              const canfd_frame_t *frame)
+{
+    const uint8_t *bytes = (const uint8_t *)frame->data;
+    uint32_t offset = stream->config.seq_offset;
+
+    return (uint16_t)((uint16_t)bytes[offset] |
+                      (uint16_t)((uint16_t)bytes[offset + 1UL] << 8));
+}
+
+/*******************************************************************************
+* Function Name: reasm_take_pending
+********************************************************************************
+* Summary:
+* Delivers the held frame with sequence number seq, if there is one.
+*
+*******************************************************************************/
+static bool reasm_take_pending(stream_reasm_t *stream, uint16_t seq)
+{
+    uint32_t slot;
+
+    if (0U == stream->config.reorder_window)
+    {
+        return false;
+    }
+
+    slot = (uint32_t)seq & ((uint32_t)stream->config.reorder_window - 1UL);
+    if ((0U == (stream->pending_mask & (1U << slot))) ||
+        (stream->pending_seq[slot] != seq))
+    {
+        return false;
+    }
+
+    stream->pending_mask &= (uint8_t)~(1U << slot);
+    reasm_deliver(stream, &stream->pending[slot]);
+    stream->stats.reordered++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: reasm_advance_to
+********************************************************************************
+* Summary:
+* Moves the expected sequence number forward to target, delivering held frames
+* on the way and counting every other sequence number as lost.
+*
+*******************************************************************************/
+static void reasm_advance_to(stream_reasm_t *stream, uint16_t target)
+{
+    uint16_t distance = (uint16_t)(target - stream->expected);
+    uint16_t scan = distance;
+
+    /* Only the window right after expected can hold frames */
+    if (scan > (uint16_t)(stream->config.reorder_window + 1U))
+    {
+        scan = (uint16_t)(stream->config.reorder_window + 1U);
+    }
+
+    for (uint16_t step = 0U; step < scan; step++)
+    {
+        if (!reasm_take_pending(stream, stream->expected))
+        {
+            stream->stats.lost++;
+        }
+        stream->expected++;
+    }
+
+    stream->stats.lost += (uint32_t)distance - scan;
+    stream->expected = target;
+
+    /* Frames held for sequence numbers at or after target stay valid */
+    for (uint32_t slot = 0UL; slot < stream->config.reorder_window; slot++)
+    {
+        uint16_t ahead = (uint16_t)(stream->pending_seq[slot] - target);
+
+        if (ahead >= stream->config.reorder_window)
+        {
+            stream->pending_mask &= (uint8_t)~(1U << slot);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: reasm_deliver
+********************************************************************************
+* Summary:
+* Appends the payload of a frame to the circular buffer and updates the
+* counters.
+*
+*******************************************************************************/
+static void reasm_deliver(stream_reasm_t *stream, const canfd_frame_t *frame)
+{
+    const uint8_t *src = (const uint8_t *)frame->data;
+    uint32_t offset = stream->config.data_offset;
+    uint32_t len = (frame->len > offset) ? ((uint32_t)frame->len - offset) : 0UL;
+    uint32_t size = stream->config.buffer_size;
+    uint32_t head = stream->head;
+    uint32_t pos = head & (size - 1UL);
+    uint32_t first = size - pos;
+    uint32_t latency = cycle_count_now() - frame->timestamp;
+
+    if ((size - (head - stream->tail)) < len)
+    {
+        stream->stats.overflows++;
+        return;
+    }
+
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(&stream->config.buffer[pos], &src[offset], first);
+    memcpy(stream->config.buffer, &src[offset + first], len - first);
+
+    __DMB();
+    stream->head = head + len;
+
+    stream->stats.frames++;
+    stream->stats.bytes += len;
+    stream->stats.latency_sum += latency;
+    if (latency > stream->stats.latency_max)
+    {
+        stream->stats.latency_max = latency;
+    }
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_peek
+********************************************************************************
+* Summary:
+* Returns the contiguous readable data at the read position. The span ends at
+* the end of the buffer; after consuming it, the next peek returns the data
+* that wrapped to the start.
+*
+*******************************************************************************/
+stream_reasm_span_t stream_reasm_peek(const stream_reasm_t *stream)
+{
+    stream_reasm_span_t span;
+    uint32_t size = stream->config.buffer_size;
+    uint32_t tail = stream->tail;
+    uint32_t pos = tail & (size - 1UL);
+    uint32_t avail = stream->head - tail;
+
+    __DMB();
+    span.data = &stream->config.buffer[pos];
+    span.len = ((size - pos) < avail) ? (size - pos) : avail;
+    return span;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_consume
+********************************************************************************
+* Summary:
+* Releases len bytes at the read position.
+*
+*******************************************************************************/
+void stream_reasm_consume(stream_reasm_t *stream, uint32_t len)
+{
+    uint32_t avail = stream->head - stream->tail;
+
+    __DMB();
+    stream->tail += (len < avail) ? len : avail;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_available
+********************************************************************************
+* Summary:
+* Returns the number of bytes waiting to be consumed.
+*
+*******************************************************************************/
+uint32_t stream_reasm_available(const stream_reasm_t *stream)
+{
+    return stream->head - stream->tail;
+}
+
+/*******************************************************************************
+* Function Name: stream_reasm_print_stats
+********************************************************************************
+* Summary:
+* Prints the counters of a stream.
+*
+*******************************************************************************/
+void stream_reasm_print_stats(const stream_reasm_t *stream)
+{
+    const stream_reasm_stats_t *stats = &stream->stats;
+    uint32_t avg = (0UL != stats->frames) ?
+                   (stats->latency_sum / stats->frames) : 0UL;
+
+    printf("  stream 0x%lx: %lu frames, %lu lost, %lu duplicate, "
+           "%lu reordered, %lu overflow\r\n",
+           (unsigned long)stream->config.can_id, (unsigned long)stats->frames,
+           (unsigned long)stats->lost, (unsigned long)stats->duplicates,
+           (unsigned long)stats->reordered, (unsigned long)stats->overflows);
+    printf("  latency avg %lu us, max %lu us\r\n",
+           (unsigned long)cycle_count_to_us(avg),
+           (unsigned long)cycle_count_to_us(stats->latency_max));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,122 @@
+/******************************************************************************
+* File Name:   stream_reasm.h
+*
+* Description: Receiver-side reassembly of multi-frame streams into a
+*              contiguous circular buffer.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef STREAM_REASM_H_
+#define STREAM_REASM_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "canfd_frame.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Streams that can be registered at the same time */
+#ifndef STREAM_REASM_MAX_STREAMS
+#define STREAM_REASM_MAX_STREAMS        (4u)
+#endif
+
+/* Largest reorder window in frames (power of two) */
+#define STREAM_REASM_MAX_WINDOW         (8u)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Stream description, provided at registration */
+typedef struct
+{
+    uint32_t can_id;            /* Frames of the stream (standard or extended) */
+    uint8_t  seq_offset;        /* Byte offset of the 16-bit sequence number */
+    uint8_t  data_offset;       /* First payload byte written to the buffer */
+    uint8_t  reorder_window;    /* 0, 1, 2, 4 or 8 frames held for reordering */
+    uint8_t  *buffer;           /* Reassembly buffer */
+    uint32_t buffer_size;       /* Power of two */
+} stream_reasm_config_t;
+
+typedef struct
+{
+    uint32_t frames;            /* Frames delivered in order */
+    uint32_t bytes;             /* Payload bytes delivered */
+    uint32_t lost;              /* Sequence numbers never received */
+    uint32_t duplicates;        /* Duplicate or too late frames */
+    uint32_t reordered;         /* Frames delivered from the reorder window */
+    uint32_t overflows;         /* Frames dropped because the buffer was full */
+    uint32_t latency_max;       /* Cycles from reception to delivery */
+    uint32_t latency_sum;       /* For the average: latency_sum / frames */
+} stream_reasm_stats_t;
+
+/* Contiguous readable part of the reassembly buffer */
+typedef struct
+{
+    const uint8_t *data;
+    uint32_t len;
+} stream_reasm_span_t;
+
+typedef struct
+{
+    stream_reasm_config_t config;
+    stream_reasm_stats_t stats;
+    volatile uint32_t head;     /* Written by the receive path */
+    volatile uint32_t tail;     /* Written by the consumer */
+    uint16_t expected;          /* Next sequence number to deliver */
+    bool synced;
+    uint8_t pending_mask;       /* Valid reorder slots */
+    uint16_t pending_seq[STREAM_REASM_MAX_WINDOW];
+    canfd_frame_t pending[STREAM_REASM_MAX_WINDOW];
+} stream_reasm_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool stream_reasm_register(stream_reasm_t *stream,
+                           const stream_reasm_config_t *config);
+stream_reasm_t *stream_reasm_find(uint32_t can_id);
+bool stream_reasm_push_frame(const canfd_frame_t *frame);
+void stream_reasm_push(stream_reasm_t *stream, const canfd_frame_t *frame);
+stream_reasm_span_t stream_reasm_peek(const stream_reasm_t *stream);
+void stream_reasm_consume(stream_reasm_t *stream, uint32_t len);
+uint32_t stream_reasm_available(const stream_reasm_t *stream);
+void stream_reasm_print_stats(const stream_reasm_t *stream);
+
+#endif /* STREAM_REASM_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,242 @@
+/******************************************************************************
+* File Name:   supervisor.c
+*
+* Description: Main loop supervision: per-stage deadline monitoring with DWT
+*              cycle counts, and a hardware watchdog that is serviced only when
+*              every stage has completed.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "supervisor.h"
+#include "fault_capture.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+uint32_t supervisor_checked;
+
+/* Not cleared by the start-up code: after a watchdog reset it still names
+ * the stage that did not complete */
+CY_NOINIT volatile uint32_t supervisor_active;
+
+static supervisor_stage_t *supervisor_stages[SUPERVISOR_MAX_STAGES];
+static uint32_t supervisor_count;
+static uint32_t supervisor_all;
+
+static cyhal_wdt_t supervisor_wdt;
+static bool supervisor_wdt_running;
+static uint32_t supervisor_suspended;
+static uint32_t supervisor_kicks;
+
+/* Stage in progress at a watchdog reset, index + 1, reported once */
+static uint32_t supervisor_wdt_stage;
+static bool supervisor_wdt_reset;
+
+STATS_COUNTER(kicks, "wdt.kicks", &supervisor_kicks);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: supervisor_init
+********************************************************************************
+* Summary:
+* Starts the hardware watchdog. Call after fault_capture_init, which reads
+* the reset reason. The watchdog keeps running while a debugger halts the
+* core.
+*
+* Parameters:
+*  wdt_timeout_ms   Reset timeout, limited to the hardware maximum; 0 to
+*                   monitor the deadlines without the watchdog
+*
+* Return:
+*  cy_rslt_t  HAL result of the watchdog setup
+*
+*******************************************************************************/
+cy_rslt_t supervisor_init(uint32_t wdt_timeout_ms)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    cycle_count_init();
+
+    supervisor_wdt_reset = (0UL != (fault_capture_reset_reason() &
+                                    CY_SYSLIB_RESET_HWWDT));
+    supervisor_wdt_stage = supervisor_active;
+    supervisor_active = 0UL;
+
+    if (0UL != wdt_timeout_ms)
+    {
+        if (wdt_timeout_ms > cyhal_wdt_get_max_timeout_ms())
+        {
+            wdt_timeout_ms = cyhal_wdt_get_max_timeout_ms();
+        }
+        result = cyhal_wdt_init(&supervisor_wdt, wdt_timeout_ms);
+        supervisor_wdt_running = (CY_RSLT_SUCCESS == result);
+    }
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: supervisor_add
+********************************************************************************
+* Summary:
+* Adds a stage defined with SUPERVISOR_STAGE. From now on the watchdog is
+* only serviced when it has completed.
+*
+* Return:
+*  bool  false if SUPERVISOR_MAX_STAGES stages are supervised already
+*
+*******************************************************************************/
+bool supervisor_add(supervisor_stage_t *stage)
+{
+    if (supervisor_count >= SUPERVISOR_MAX_STAGES)
+    {
+        return false;
+    }
+
+    stage->deadline_cycles = (uint32_t)(((uint64_t)stage->deadline_us *
+                                         SystemCoreClock) / 1000000ULL);
+    stage->index = supervisor_count;
+    supervisor_stages[supervisor_count] = stage;
+    supervisor_all |= 1UL << supervisor_count;
+    supervisor_count++;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: supervisor_service
+********************************************************************************
+* Summary:
+* Call once per main loop iteration. Services the watchdog if every stage
+* has checked in since the last service; a stage that hangs, or an interrupt
+* that starves the loop, lets the watchdog reset the device. The first call
+* also reports a watchdog reset of the previous run, when the stages are
+* known.
+*
+*******************************************************************************/
+void supervisor_service(void)
+{
+    if (supervisor_wdt_reset)
+    {
+        supervisor_wdt_reset = false;
+        if ((0UL != supervisor_wdt_stage) &&
+            (supervisor_wdt_stage <= supervisor_count))
+        {
+            printf("Watchdog reset in stage %s\r\n\r\n",
+                   supervisor_stages[supervisor_wdt_stage - 1UL]->name);
+        }
+        else
+        {
+            printf("Watchdog reset outside the stages\r\n\r\n");
+        }
+    }
+
+    if ((0UL == supervisor_all) || (supervisor_checked != supervisor_all))
+    {
+        return;
+    }
+
+    supervisor_checked = 0UL;
+    if (supervisor_wdt_running)
+    {
+        cyhal_wdt_kick(&supervisor_wdt);
+    }
+    supervisor_kicks++;
+}
+
+/*******************************************************************************
+* Function Name: supervisor_suspend / supervisor_resume
+********************************************************************************
+* Summary:
+* Stop the watchdog around an operation that blocks the main loop for longer
+* than the watchdog timeout on purpose, such as a bus calibration, and start
+* it again with a full timeout. Calls may nest. The deadline of the stage
+* that blocks is still monitored and shows the overrun.
+*
+*******************************************************************************/
+void supervisor_suspend(void)
+{
+    if ((0UL == supervisor_suspended) && supervisor_wdt_running)
+    {
+        cyhal_wdt_stop(&supervisor_wdt);
+    }
+    supervisor_suspended++;
+}
+
+void supervisor_resume(void)
+{
+    if (0UL == supervisor_suspended)
+    {
+        return;
+    }
+
+    supervisor_suspended--;
+    if ((0UL == supervisor_suspended) && supervisor_wdt_running)
+    {
+        cyhal_wdt_kick(&supervisor_wdt);
+        cyhal_wdt_start(&supervisor_wdt);
+    }
+}
+
+/*******************************************************************************
+* Function Name: supervisor_print_stats
+********************************************************************************
+* Summary:
+* Prints the deadline, runs, overruns and worst case of every stage.
+*
+*******************************************************************************/
+void supervisor_print_stats(void)
+{
+    printf("Stage            deadline us     runs  overruns   max us  "
+           "last overrun us\r\n");
+    for (uint32_t idx = 0UL; idx < supervisor_count; idx++)
+    {
+        const supervisor_stage_t *stage = supervisor_stages[idx];
+
+        printf("%-16s %11lu %8lu %9lu %8lu %16lu\r\n", stage->name,
+               (unsigned long)stage->deadline_us, (unsigned long)stage->runs,
+               (unsigned long)stage->overruns,
+               (unsigned long)cycle_count_to_us(stage->max_cycles),
+               (unsigned long)cycle_count_to_us(stage->last_overrun_cycles));
+    }
+}
+
+/* [] END OF FILE */
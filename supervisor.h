@@ -0,0 +1,160 @@
+/******************************************************************************
+* File Name:   supervisor.h
+*
+* Description: Main loop supervision: per-stage deadline monitoring with DWT
+*              cycle counts, and a hardware watchdog that is serviced only when
+*              every stage has completed.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef SUPERVISOR_H_
+#define SUPERVISOR_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cyhal.h"
+#include "cycle_count.h"
+#include "stats_registry.h"
+#include "trace.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Stages that can be supervised; one check-in bit each */
+#define SUPERVISOR_MAX_STAGES       (32u)
+
+/* Trace event of a deadline overrun: stage index, overrun in us */
+#define TRACE_DEADLINE              (10u)
+
+/* Defines a stage and registers its counters: <name>.runs, .overruns and
+ * .max_cycles. stage_name must be a string literal. */
+#define SUPERVISOR_STAGE(var, stage_name, deadline)                          \
+    static supervisor_stage_t var = { .name = (stage_name),                  \
+                                      .deadline_us = (deadline) };           \
+    STATS_COUNTER(var##_runs, stage_name ".runs", &var.runs);                \
+    STATS_COUNTER(var##_overruns, stage_name ".overruns", &var.overruns);    \
+    STATS_GAUGE(var##_max, stage_name ".max_cycles", &var.max_cycles)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    const char *name;
+    uint32_t deadline_us;
+    uint32_t deadline_cycles;   /* Set by supervisor_add */
+    uint32_t index;             /* Check-in bit, set by supervisor_add */
+    uint32_t start;             /* Cycle count of supervisor_begin */
+    uint32_t runs;
+    uint32_t overruns;          /* Runs longer than the deadline */
+    uint32_t max_cycles;
+    uint32_t last_overrun_cycles;
+} supervisor_stage_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* Check-in bits of the stages completed since the last watchdog service */
+extern uint32_t supervisor_checked;
+
+/* Stage in progress, index + 1; kept over a watchdog reset */
+extern volatile uint32_t supervisor_active;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t supervisor_init(uint32_t wdt_timeout_ms);
+bool supervisor_add(supervisor_stage_t *stage);
+void supervisor_service(void);
+void supervisor_suspend(void);
+void supervisor_resume(void);
+void supervisor_print_stats(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: supervisor_begin / supervisor_end
+********************************************************************************
+* Summary:
+* Bracket one main loop stage. The time between them includes the interrupts
+* taken meanwhile, so a wedged or overloaded interrupt shows up as an overrun
+* of the stage it preempted. An overrun is counted, its cycles kept and a
+* TRACE_DEADLINE event recorded; the stage still checks in.
+*
+*******************************************************************************/
+__STATIC_INLINE void supervisor_begin(supervisor_stage_t *stage)
+{
+    supervisor_active = stage->index + 1UL;
+    stage->start = cycle_count_now();
+}
+
+__STATIC_INLINE void supervisor_end(supervisor_stage_t *stage)
+{
+    uint32_t cycles = cycle_count_now() - stage->start;
+
+    stage->runs++;
+    if (cycles > stage->max_cycles)
+    {
+        stage->max_cycles = cycles;
+    }
+    if (cycles > stage->deadline_cycles)
+    {
+        stage->overruns++;
+        stage->last_overrun_cycles = cycles;
+#if (TRACE_ENABLE)
+        {
+            uint32_t over_us = cycle_count_to_us(cycles -
+                                                 stage->deadline_cycles);
+
+            TRACE(TRACE_DEADLINE, stage->index,
+                  (over_us > 0xFFFFUL) ? 0xFFFFUL : over_us);
+        }
+#endif
+    }
+
+    supervisor_checked |= 1UL << stage->index;
+    supervisor_active = 0UL;
+}
+
+#endif /* SUPERVISOR_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,205 @@
+/******************************************************************************
+* File Name:   sys_tick.c
+*
+* Description: Millisecond system tick. A TCPWM timer interrupts every
+*              millisecond, advances the time and calls the registered handlers
+*              at their period.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define SYS_TICK_TIMER_HZ       (1000000UL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    sys_tick_handler_t handler;
+    uint32_t period_ms;
+    uint32_t next_ms;
+} sys_tick_entry_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static cyhal_timer_t tick_timer;
+static volatile uint32_t tick_ms;
+static bool tick_running;
+
+static sys_tick_entry_t tick_handlers[SYS_TICK_MAX_HANDLERS];
+static volatile uint32_t tick_handler_count;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static void tick_event(void *callback_arg, cyhal_timer_event_t event);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: sys_tick_init
+********************************************************************************
+* Summary:
+* Starts the tick. Calling it again after a successful start does nothing, so
+* every module that needs the tick can call it.
+*
+* Return:
+*  cy_rslt_t  HAL result of the timer setup
+*
+*******************************************************************************/
+cy_rslt_t sys_tick_init(void)
+{
+    const cyhal_timer_cfg_t timer_cfg =
+    {
+        .compare_value = 0UL,
+        .period = (SYS_TICK_TIMER_HZ / 1000UL) - 1UL,
+        .direction = CYHAL_TIMER_DIR_UP,
+        .is_compare = false,
+        .is_continuous = true,
+        .value = 0UL,
+    };
+    cy_rslt_t result;
+
+    if (tick_running)
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = cyhal_timer_init(&tick_timer, NC, NULL);
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_configure(&tick_timer, &timer_cfg);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        result = cyhal_timer_set_frequency(&tick_timer, SYS_TICK_TIMER_HZ);
+    }
+    if (CY_RSLT_SUCCESS == result)
+    {
+        cyhal_timer_register_callback(&tick_timer, tick_event, NULL);
+        cyhal_timer_enable_event(&tick_timer, CYHAL_TIMER_IRQ_TERMINAL_COUNT,
+                                 SYS_TICK_PRIORITY, true);
+        result = cyhal_timer_start(&tick_timer);
+    }
+
+    tick_running = (CY_RSLT_SUCCESS == result);
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: sys_tick_register
+********************************************************************************
+* Summary:
+* Adds a handler called every period_ms milliseconds from the tick interrupt.
+* Thread context only.
+*
+* Return:
+*  bool  false if the handler table is full
+*
+*******************************************************************************/
+bool sys_tick_register(sys_tick_handler_t handler, uint32_t period_ms)
+{
+    uint32_t idx = tick_handler_count;
+
+    if ((idx >= SYS_TICK_MAX_HANDLERS) || (0UL == period_ms))
+    {
+        return false;
+    }
+
+    tick_handlers[idx].handler = handler;
+    tick_handlers[idx].period_ms = period_ms;
+    tick_handlers[idx].next_ms = tick_ms + period_ms;
+
+    /* The entry must be complete before the tick sees it */
+    __DMB();
+    tick_handler_count = idx + 1UL;
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: sys_tick_ms
+********************************************************************************
+* Summary:
+* Returns the milliseconds since sys_tick_init. Wraps after 49 days; compute
+* intervals with unsigned subtraction.
+*
+*******************************************************************************/
+uint32_t sys_tick_ms(void)
+{
+    return tick_ms;
+}
+
+/*******************************************************************************
+* Function Name: tick_event
+********************************************************************************
+* Summary:
+* Timer interrupt: advances the time and runs the handlers that are due.
+*
+*******************************************************************************/
+static void tick_event(void *callback_arg, cyhal_timer_event_t event)
+{
+    uint32_t now = tick_ms + 1UL;
+    uint32_t count = tick_handler_count;
+
+    (void)callback_arg;
+    (void)event;
+
+    tick_ms = now;
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        sys_tick_entry_t *entry = &tick_handlers[idx];
+
+        if ((int32_t)(now - entry->next_ms) >= 0)
+        {
+            entry->next_ms += entry->period_ms;
+            entry->handler(now);
+        }
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name:   sys_tick.h
+*
+* Description: Millisecond system tick with periodic handlers, driven by a
+*              TCPWM timer.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef SYS_TICK_H_
+#define SYS_TICK_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cyhal.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Handlers that can be registered */
+#ifndef SYS_TICK_MAX_HANDLERS
+#define SYS_TICK_MAX_HANDLERS   (4u)
+#endif
+
+/* Interrupt priority of the tick; below the CAN FD interrupt, above the GPIO
+ * interrupt so that edge events are consumed promptly */
+#ifndef SYS_TICK_PRIORITY
+#define SYS_TICK_PRIORITY       (6u)
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* Called from the tick interrupt with the current time in milliseconds */
+typedef void (*sys_tick_handler_t)(uint32_t now_ms);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t sys_tick_init(void);
+bool sys_tick_register(sys_tick_handler_t handler, uint32_t period_ms);
+uint32_t sys_tick_ms(void);
+
+#endif /* SYS_TICK_H_ */
+
+/* [] END OF FILE */
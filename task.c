@@ -0,0 +1,523 @@
+/******************************************************************************
+* File Name:   task.c
+*
+* Description: Cooperative stackless tasks for the main loop: run queue, event
+*              and timer wake-ups, and a signal-to-resume benchmark.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+#include "task.h"
+#include "cycle_count.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t task_take_ready(void);
+static void task_make_ready(uint32_t bits);
+static void task_check_timers(void);
+static uint32_t task_bench_ping(task_t *task);
+static uint32_t task_bench_pong(task_t *task);
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static task_t *task_table[TASK_MAX];
+
+/* Run queue: one bit per ready task, the lowest bit runs first. Written by
+ * interrupts through task_event_signal. */
+static volatile uint32_t task_ready;
+
+/* Tasks with a running sleep, and the earliest end among them */
+static uint32_t task_sleeping;
+static uint32_t task_next_wake;
+
+static uint32_t task_resumes;
+static uint32_t task_switch_cycles;
+
+/* Benchmark: a pair of tasks that wake each other through two events */
+static task_t task_bench_ping_task = { .fn = task_bench_ping,
+                                       .name = "task.bench.ping" };
+static task_t task_bench_pong_task = { .fn = task_bench_pong,
+                                       .name = "task.bench.pong" };
+static task_event_t task_bench_ping_event;
+static task_event_t task_bench_pong_event;
+static uint32_t task_bench_round;
+static uint32_t task_bench_stamp;
+static uint32_t task_bench_total;
+static uint32_t task_bench_min;
+
+STATS_COUNTER(resumes, "task.resumes", &task_resumes);
+STATS_GAUGE(switch_cycles, "task.switch_cycles", &task_switch_cycles);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: task_add
+********************************************************************************
+* Summary:
+* Starts a task defined with TASK_DEFINE; it runs from TASK_BEGIN in the next
+* task_run. Tasks added first have the lower run queue bits and run first
+* when several are ready. A task that returned TASK_DONE can be added again.
+* Thread context only; sys_tick_init must have been called for the sleeps.
+*
+* Return:
+*  bool  false if TASK_MAX tasks are running already
+*
+*******************************************************************************/
+bool task_add(task_t *task)
+{
+    for (uint32_t idx = 0UL; idx < TASK_MAX; idx++)
+    {
+        if (NULL == task_table[idx])
+        {
+            task->resume = 0UL;
+            task->bit = 1UL << idx;
+            task->timed_out = false;
+            task_table[idx] = task;
+            task_make_ready(task->bit);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: task_run
+********************************************************************************
+* Summary:
+* One pass of the scheduler, called from the main loop: wakes the tasks whose
+* sleep has ended, then resumes the ready tasks, lowest run queue bit first.
+* Tasks woken by an event during the pass also run in this pass, so a chain
+* of events completes without waiting for the rest of the main loop; tasks
+* that yield run again in the next pass.
+*
+* Return:
+*  uint32_t  number of tasks resumed
+*
+*******************************************************************************/
+uint32_t task_run(void)
+{
+    uint32_t ready;
+    uint32_t again = 0UL;
+    uint32_t resumed = 0UL;
+    uint32_t idx;
+    uint32_t start;
+    uint32_t cycles;
+    uint32_t state;
+    task_t *task;
+
+    if (0UL != task_sleeping)
+    {
+        task_check_timers();
+    }
+
+    while (0UL != (ready = task_take_ready()))
+    {
+        while (0UL != ready)
+        {
+            /* Lowest set bit */
+            idx = 31UL - (uint32_t)__CLZ(ready & (0UL - ready));
+            ready &= ready - 1UL;
+
+            task = task_table[idx];
+            if (NULL == task)
+            {
+                continue;
+            }
+
+            start = cycle_count_now();
+            state = task->fn(task);
+            cycles = cycle_count_now() - start;
+
+            task->runs++;
+            if (cycles > task->max_cycles)
+            {
+                task->max_cycles = cycles;
+            }
+            resumed++;
+
+            if (TASK_READY == state)
+            {
+                again |= task->bit;
+            }
+            else if (TASK_DONE == state)
+            {
+                task_sleeping &= ~task->bit;
+                task_table[idx] = NULL;
+            }
+            else
+            {
+                /* Blocked: an event or the timer readies it */
+            }
+        }
+    }
+
+    if (0UL != again)
+    {
+        task_make_ready(again);
+    }
+    task_resumes += resumed;
+    return resumed;
+}
+
+/*******************************************************************************
+* Function Name: task_sleep
+********************************************************************************
+* Summary:
+* Starts the sleep of TASK_SLEEP and TASK_AWAIT_FOR. The timer only readies
+* the task; the task then returns TASK_BLOCKED until it is due.
+*
+* Parameters:
+*  task   Task calling it
+*  ms     Sleep time; 0 resumes the task in the next pass
+*
+*******************************************************************************/
+void task_sleep(task_t *task, uint32_t ms)
+{
+    task->wake_ms = sys_tick_ms() + ms;
+    task->timed_out = false;
+    if ((0UL == task_sleeping) ||
+        ((int32_t)(task->wake_ms - task_next_wake) < 0))
+    {
+        task_next_wake = task->wake_ms;
+    }
+    task_sleeping |= task->bit;
+}
+
+/*******************************************************************************
+* Function Name: task_event_take
+********************************************************************************
+* Summary:
+* Takes the signal of an event, or adds the task to its waiters so that the
+* next signal readies it. Used by TASK_AWAIT.
+*
+* Return:
+*  bool  true if the event was signalled
+*
+*******************************************************************************/
+bool task_event_take(task_t *task, task_event_t *event)
+{
+    uint32_t intr;
+    bool taken;
+
+    intr = Cy_SysLib_EnterCriticalSection();
+    taken = event->pending;
+    if (taken)
+    {
+        event->pending = false;
+        event->waiters &= ~task->bit;
+    }
+    else
+    {
+        event->waiters |= task->bit;
+    }
+    Cy_SysLib_ExitCriticalSection(intr);
+    return taken;
+}
+
+/*******************************************************************************
+* Function Name: task_event_take_timed
+********************************************************************************
+* Summary:
+* task_event_take with the sleep of TASK_AWAIT_FOR as timeout. Sets
+* task->timed_out when the sleep ended first.
+*
+* Return:
+*  bool  true if the event was signalled or the timeout passed
+*
+*******************************************************************************/
+bool task_event_take_timed(task_t *task, task_event_t *event)
+{
+    uint32_t intr;
+
+    if (task_event_take(task, event))
+    {
+        task_sleeping &= ~task->bit;
+        task->timed_out = false;
+        return true;
+    }
+    if (task->timed_out)
+    {
+        intr = Cy_SysLib_EnterCriticalSection();
+        event->waiters &= ~task->bit;
+        Cy_SysLib_ExitCriticalSection(intr);
+        return true;
+    }
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: task_event_signal
+********************************************************************************
+* Summary:
+* Signals an event and readies its waiting tasks. Interrupt safe; the tasks
+* run in the next task_run, or later in the current one.
+*
+*******************************************************************************/
+void task_event_signal(task_event_t *event)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+
+    event->pending = true;
+    task_ready |= event->waiters;
+    event->waiters = 0UL;
+    Cy_SysLib_ExitCriticalSection(intr);
+}
+
+/*******************************************************************************
+* Function Name: task_benchmark_start
+********************************************************************************
+* Summary:
+* Starts two tasks that wake each other TASK_BENCH_ROUNDS times through a
+* pair of events. Each switch is timed from task_event_signal in one task to
+* the return of TASK_AWAIT in the other, which covers the blocking of the
+* signalling task and the scheduler. The result is printed and kept in
+* task.switch_cycles.
+*
+* Return:
+*  bool  false if the benchmark is running or no task slots are free
+*
+*******************************************************************************/
+bool task_benchmark_start(void)
+{
+    for (uint32_t idx = 0UL; idx < TASK_MAX; idx++)
+    {
+        if ((task_table[idx] == &task_bench_ping_task) ||
+            (task_table[idx] == &task_bench_pong_task))
+        {
+            return false;
+        }
+    }
+
+    task_bench_ping_event.pending = false;
+    task_bench_pong_event.pending = false;
+    if (!task_add(&task_bench_pong_task))
+    {
+        return false;
+    }
+    if (!task_add(&task_bench_ping_task))
+    {
+        /* The pong task ends on the round count */
+        task_bench_round = TASK_BENCH_ROUNDS;
+        task_event_signal(&task_bench_pong_event);
+        return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: task_print_stats
+********************************************************************************
+* Summary:
+* Prints the running tasks with their state, runs and longest run.
+*
+*******************************************************************************/
+void task_print_stats(void)
+{
+    task_t *task;
+    const char *state;
+
+    printf("Tasks (%u resumes, %u cycles per switch):\r\n",
+           (unsigned int)task_resumes, (unsigned int)task_switch_cycles);
+    for (uint32_t idx = 0UL; idx < TASK_MAX; idx++)
+    {
+        task = task_table[idx];
+        if (NULL == task)
+        {
+            continue;
+        }
+        if (0UL != (task_ready & task->bit))
+        {
+            state = "ready";
+        }
+        else if (0UL != (task_sleeping & task->bit))
+        {
+            state = "sleeping";
+        }
+        else
+        {
+            state = "waiting";
+        }
+        printf("  %-16s %-8s %10u runs, max %u us\r\n", task->name, state,
+               (unsigned int)task->runs,
+               (unsigned int)cycle_count_to_us(task->max_cycles));
+    }
+}
+
+/*******************************************************************************
+* Function Name: task_take_ready / task_make_ready
+********************************************************************************
+* Summary:
+* Take the whole run queue, and add tasks to it.
+*
+*******************************************************************************/
+static uint32_t task_take_ready(void)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+    uint32_t ready = task_ready;
+
+    task_ready = 0UL;
+    Cy_SysLib_ExitCriticalSection(intr);
+    return ready;
+}
+
+static void task_make_ready(uint32_t bits)
+{
+    uint32_t intr = Cy_SysLib_EnterCriticalSection();
+
+    task_ready |= bits;
+    Cy_SysLib_ExitCriticalSection(intr);
+}
+
+/*******************************************************************************
+* Function Name: task_check_timers
+********************************************************************************
+* Summary:
+* Readies the tasks whose sleep has ended. The sleeping tasks are only
+* scanned once the earliest sleep is due.
+*
+*******************************************************************************/
+static void task_check_timers(void)
+{
+    uint32_t now = sys_tick_ms();
+    uint32_t pending;
+    uint32_t expired = 0UL;
+    uint32_t next = now + 0x7FFFFFFFUL;
+    uint32_t idx;
+    task_t *task;
+
+    if ((int32_t)(now - task_next_wake) < 0)
+    {
+        return;
+    }
+
+    pending = task_sleeping;
+    while (0UL != pending)
+    {
+        idx = 31UL - (uint32_t)__CLZ(pending & (0UL - pending));
+        pending &= pending - 1UL;
+
+        task = task_table[idx];
+        if ((int32_t)(now - task->wake_ms) >= 0)
+        {
+            task->timed_out = true;
+            expired |= task->bit;
+        }
+        else if ((int32_t)(task->wake_ms - next) < 0)
+        {
+            next = task->wake_ms;
+        }
+    }
+
+    task_sleeping &= ~expired;
+    task_next_wake = next;
+    task_make_ready(expired);
+}
+
+/*******************************************************************************
+* Function Name: task_bench_ping / task_bench_pong
+********************************************************************************
+* Summary:
+* The benchmark tasks. Each stamps the cycle count before it signals the
+* other; the other adds the time to its resume.
+*
+*******************************************************************************/
+static uint32_t task_bench_ping(task_t *task)
+{
+    uint32_t cycles;
+
+    TASK_BEGIN(task);
+    task_bench_total = 0UL;
+    task_bench_min = UINT32_MAX;
+    for (task_bench_round = 0UL; task_bench_round < TASK_BENCH_ROUNDS;
+         task_bench_round++)
+    {
+        task_bench_stamp = cycle_count_now();
+        task_event_signal(&task_bench_pong_event);
+        TASK_AWAIT(task, &task_bench_ping_event);
+
+        cycles = cycle_count_now() - task_bench_stamp;
+        task_bench_total += cycles;
+        if (cycles < task_bench_min)
+        {
+            task_bench_min = cycles;
+        }
+    }
+
+    /* Let the pong task see the round count and end */
+    task_event_signal(&task_bench_pong_event);
+
+    task_switch_cycles = task_bench_total / (2UL * TASK_BENCH_ROUNDS);
+    printf("Task switch: %u cycles average, %u min, over %u switches\r\n",
+           (unsigned int)task_switch_cycles, (unsigned int)task_bench_min,
+           (unsigned int)(2UL * TASK_BENCH_ROUNDS));
+    TASK_END(task);
+}
+
+static uint32_t task_bench_pong(task_t *task)
+{
+    uint32_t cycles;
+
+    TASK_BEGIN(task);
+    for (;;)
+    {
+        TASK_AWAIT(task, &task_bench_pong_event);
+        if (task_bench_round >= TASK_BENCH_ROUNDS)
+        {
+            TASK_EXIT(task);
+        }
+
+        cycles = cycle_count_now() - task_bench_stamp;
+        task_bench_total += cycles;
+        if (cycles < task_bench_min)
+        {
+            task_bench_min = cycles;
+        }
+
+        task_bench_stamp = cycle_count_now();
+        task_event_signal(&task_bench_ping_event);
+    }
+    TASK_END(task);
+}
+
+/* [] END OF FILE */
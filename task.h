@@ -0,0 +1,170 @@
+/******************************************************************************
+* File Name:   task.h
+*
+* Description: Cooperative stackless tasks for the main loop: protothread-style
+*              coroutines resumed by a run queue bitmap, with events that
+*              interrupts signal and millisecond sleeps.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+
+#ifndef TASK_H_
+#define TASK_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Tasks that can run at the same time; one run queue bit each */
+#ifndef TASK_MAX
+#define TASK_MAX                (8u)
+#endif
+
+#if (TASK_MAX > 32u)
+#error "TASK_MAX is limited to the 32 bits of the run queue"
+#endif
+
+/* Signal and await round trips of task_benchmark_start */
+#ifndef TASK_BENCH_ROUNDS
+#define TASK_BENCH_ROUNDS       (1000u)
+#endif
+
+/* Returned by a task function; the TASK_xxx macros below return them */
+#define TASK_READY              (0u)    /* Yielded, resume in the next pass */
+#define TASK_BLOCKED            (1u)    /* Waits for an event or a timer */
+#define TASK_DONE               (2u)    /* Finished, the slot is free */
+
+/* Defines a task and registers its counters: <name>.runs and .max_cycles.
+ * task_name must be a string literal. */
+#define TASK_DEFINE(var, task_name, task_fn)                                 \
+    static task_t var = { .fn = (task_fn), .name = (task_name) };            \
+    STATS_COUNTER(var##_runs, task_name ".runs", &var.runs);                 \
+    STATS_GAUGE(var##_max, task_name ".max_cycles", &var.max_cycles)
+
+/* The body of a task function is enclosed in TASK_BEGIN and TASK_END. A task
+ * gives up the processor by returning from its function; the macros record
+ * the source line to continue at, and TASK_BEGIN jumps back there on the
+ * next call. Local variables are not kept across the macros that wait, so
+ * state that spans them lives in static variables or in task->arg, and the
+ * macros cannot be used inside a switch statement of the task. */
+#define TASK_BEGIN(t)           switch ((t)->resume) { case 0u:
+
+#define TASK_END(t)             } (t)->resume = 0UL; return TASK_DONE
+
+/* Ends the task from anywhere in its body */
+#define TASK_EXIT(t)                                                         \
+    do { (t)->resume = 0UL; return TASK_DONE; } while (0)
+
+/* Lets the other ready tasks and the rest of the main loop run first */
+#define TASK_YIELD(t)                                                        \
+    do { (t)->resume = __LINE__; return TASK_READY;                          \
+         case __LINE__:; } while (0)
+
+/* Polls cond once per pass; for conditions without an event */
+#define TASK_WAIT_UNTIL(t, cond)                                             \
+    do { (t)->resume = __LINE__; case __LINE__:                              \
+         if (!(cond)) { return TASK_READY; } } while (0)
+
+/* Blocks until the event is signalled; takes the signal */
+#define TASK_AWAIT(t, ev)                                                    \
+    do { (t)->resume = __LINE__; case __LINE__:                              \
+         if (!task_event_take((t), (ev))) { return TASK_BLOCKED; } } while (0)
+
+/* Blocks until the event is signalled or ms have passed; (t)->timed_out
+ * tells which */
+#define TASK_AWAIT_FOR(t, ev, ms)                                            \
+    do { task_sleep((t), (ms)); (t)->resume = __LINE__; case __LINE__:       \
+         if (!task_event_take_timed((t), (ev))) { return TASK_BLOCKED; }     \
+    } while (0)
+
+/* Blocks for at least ms milliseconds */
+#define TASK_SLEEP(t, ms)                                                    \
+    do { task_sleep((t), (ms)); (t)->resume = __LINE__;                      \
+         return TASK_BLOCKED; case __LINE__:; } while (0)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct task task_t;
+
+/* Runs the task up to its next wait; returns TASK_READY, _BLOCKED or _DONE */
+typedef uint32_t (*task_fn_t)(task_t *task);
+
+struct task
+{
+    task_fn_t fn;
+    const char *name;
+    void *arg;                  /* For the task function */
+    uint32_t resume;            /* Source line to continue at, 0 at start */
+    uint32_t bit;               /* Run queue bit, set by task_add */
+    uint32_t wake_ms;           /* End of the current sleep */
+    bool timed_out;             /* The last TASK_AWAIT_FOR timed out */
+    uint32_t runs;
+    uint32_t max_cycles;        /* Longest run up to a wait */
+};
+
+/* Binary event: a signal is kept until one waiting task takes it, and
+ * several signals before that count as one. task_event_signal may be called
+ * from interrupts. */
+typedef struct
+{
+    volatile uint32_t waiters;  /* Run queue bits of the waiting tasks */
+    volatile bool pending;
+} task_event_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+bool task_add(task_t *task);
+uint32_t task_run(void);
+void task_sleep(task_t *task, uint32_t ms);
+bool task_event_take(task_t *task, task_event_t *event);
+bool task_event_take_timed(task_t *task, task_event_t *event);
+void task_event_signal(task_event_t *event);
+bool task_benchmark_start(void);
+void task_print_stats(void);
+
+#endif /* TASK_H_ */
+
+/* [] END OF FILE */
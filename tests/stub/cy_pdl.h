@@ -0,0 +1,190 @@
+/******************************************************************************
+* File Name:   cy_pdl.h
+*
+* Description: Host stand-in for the parts of the PDL and CMSIS used by the
+*              modules under test. Registers are plain RAM, the cycle counter
+*              is a variable the tests set, and critical sections only count
+*              their nesting.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef CY_PDL_H_
+#define CY_PDL_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define __STATIC_INLINE             static inline
+#define __DMB()                     do { } while (0)
+#define __DSB()                     do { } while (0)
+#define __WFI()                     do { } while (0)
+#define CY_ASSERT(x)                do { (void)(x); } while (0)
+#define __CLZ(x)                    ((uint8_t)__builtin_clz(x))
+
+#define _FLD2VAL(f, v)              (((uint32_t)(v) & f##_Msk) >> f##_Pos)
+#define _VAL2FLD(f, v)              (((uint32_t)(v) << f##_Pos) & f##_Msk)
+
+typedef uint32_t cy_rslt_t;
+#define CY_RSLT_SUCCESS             (0UL)
+#define CY_RSLT_TYPE_ERROR          (2UL)
+#define CY_RSLT_MODULE_MIDDLEWARE_BASE  (0x0A0UL)
+#define CY_RSLT_CREATE(type, module, code) \
+    ((((module) & 0x3FFFUL) << 18) | (((type) & 0x3UL) << 16) | \
+     ((code) & 0xFFFFUL))
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+/* DWT cycle counter */
+typedef struct { volatile uint32_t DEMCR; } CoreDebug_Type;
+typedef struct { volatile uint32_t CTRL; volatile uint32_t CYCCNT; } DWT_Type;
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL)
+
+/* CAN FD buffer views, only passed by pointer */
+typedef struct cy_stc_canfd_rx_buffer cy_stc_canfd_rx_buffer_t;
+typedef struct cy_stc_canfd_tx_buffer cy_stc_canfd_tx_buffer_t;
+
+/* Registers of one M_TTCAN channel; the channel number is ignored */
+typedef struct
+{
+    volatile uint32_t SIDFC;
+    volatile uint32_t IE;
+    volatile uint32_t TXBC;
+    volatile uint32_t TXESC;
+    volatile uint32_t TXFQS;
+    volatile uint32_t TXBRP;
+    volatile uint32_t TXBAR;
+    volatile uint32_t TXBCR;
+    volatile uint32_t TXBTO;
+    volatile uint32_t TXBCF;
+    volatile uint32_t TXBTIE;
+} CANFD_Type;
+
+typedef enum
+{
+    CY_CANFD_SUCCESS = 0,
+    CY_CANFD_BAD_PARAM,
+    CY_CANFD_ERROR_TIMEOUT,
+} cy_en_canfd_status_t;
+
+typedef struct
+{
+    uint32_t messageRAMsize;
+} cy_stc_canfd_config_t;
+
+typedef struct
+{
+    uint32_t unused;
+} cy_stc_canfd_context_t;
+
+/* Every register access goes through stub_reg, which calls stub_reg_hook
+ * first when it is set: a test can change the hardware state between two
+ * accesses of the code under test */
+#define CANFD_REG_(base, reg)       (*stub_reg((base), &(base)->reg))
+#define CANFD_SIDFC(base, chan)     CANFD_REG_(base, SIDFC)
+#define CANFD_TXBC(base, chan)      CANFD_REG_(base, TXBC)
+#define CANFD_TXESC(base, chan)     CANFD_REG_(base, TXESC)
+#define CANFD_TXFQS(base, chan)     CANFD_REG_(base, TXFQS)
+#define CANFD_TXBRP(base, chan)     CANFD_REG_(base, TXBRP)
+#define CANFD_TXBAR(base, chan)     CANFD_REG_(base, TXBAR)
+#define CANFD_TXBCR(base, chan)     CANFD_REG_(base, TXBCR)
+#define CANFD_TXBTO(base, chan)     CANFD_REG_(base, TXBTO)
+#define CANFD_TXBCF(base, chan)     CANFD_REG_(base, TXBCF)
+#define CANFD_TXBTIE(base, chan)    CANFD_REG_(base, TXBTIE)
+
+#define CANFD_CH_M_TTCAN_SIDFC_FLSSA_Pos    (2u)
+#define CANFD_CH_M_TTCAN_SIDFC_FLSSA_Msk    (0x0000FFFCUL)
+#define CANFD_CH_M_TTCAN_TXBC_TBSA_Pos      (2u)
+#define CANFD_CH_M_TTCAN_TXBC_TBSA_Msk      (0x0000FFFCUL)
+#define CANFD_CH_M_TTCAN_TXBC_NDTB_Pos      (16u)
+#define CANFD_CH_M_TTCAN_TXBC_NDTB_Msk      (0x003F0000UL)
+#define CANFD_CH_M_TTCAN_TXBC_TFQS_Pos      (24u)
+#define CANFD_CH_M_TTCAN_TXBC_TFQS_Msk      (0x3F000000UL)
+#define CANFD_CH_M_TTCAN_TXBC_TFQM_Pos      (30u)
+#define CANFD_CH_M_TTCAN_TXBC_TFQM_Msk      (0x40000000UL)
+#define CANFD_CH_M_TTCAN_TXESC_TBDS_Pos     (0u)
+#define CANFD_CH_M_TTCAN_TXESC_TBDS_Msk     (0x00000007UL)
+#define CANFD_CH_M_TTCAN_TXFQS_TFFL_Pos     (0u)
+#define CANFD_CH_M_TTCAN_TXFQS_TFFL_Msk     (0x0000003FUL)
+#define CANFD_CH_M_TTCAN_TXFQS_TFGI_Pos     (8u)
+#define CANFD_CH_M_TTCAN_TXFQS_TFGI_Msk     (0x00001F00UL)
+#define CANFD_CH_M_TTCAN_TXFQS_TFQPI_Pos    (16u)
+#define CANFD_CH_M_TTCAN_TXFQS_TFQPI_Msk    (0x001F0000UL)
+#define CANFD_CH_M_TTCAN_IR_TC_Msk          (0x00000200UL)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+extern CoreDebug_Type *CoreDebug;
+extern DWT_Type *DWT;
+extern uint32_t SystemCoreClock;
+
+/* Depth of Cy_SysLib_EnterCriticalSection nesting */
+extern uint32_t stub_critical_depth;
+
+/* Called before every register access while set */
+extern void (*stub_reg_hook)(CANFD_Type *base, volatile uint32_t *reg);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void);
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus);
+volatile uint32_t *stub_reg(CANFD_Type *base, volatile uint32_t *reg);
+
+cy_en_canfd_status_t Cy_CANFD_ConfigChangesEnable(CANFD_Type *base,
+                                                  uint32_t chan);
+cy_en_canfd_status_t Cy_CANFD_ConfigChangesDisable(CANFD_Type *base,
+                                                   uint32_t chan);
+uint32_t Cy_CANFD_GetInterruptMask(CANFD_Type const *base, uint32_t chan);
+void Cy_CANFD_SetInterruptMask(CANFD_Type *base, uint32_t chan,
+                               uint32_t interrupt);
+/* Returns a host pointer, which does not fit the uint32_t of the PDL */
+uintptr_t Cy_CANFD_CalcTxBufAdrs(CANFD_Type const *base, uint32_t chan,
+                                 uint32_t index,
+                                 cy_stc_canfd_context_t const *context);
+
+#endif /* CY_PDL_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/******************************************************************************
+* File Name:   stub.c
+*
+* Description: Definitions behind the host stand-in of cy_pdl.h.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include "cy_pdl.h"
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CoreDebug_Type stub_core_debug;
+static DWT_Type stub_dwt;
+
+CoreDebug_Type *CoreDebug = &stub_core_debug;
+DWT_Type *DWT = &stub_dwt;
+uint32_t SystemCoreClock = 100000000UL;
+
+uint32_t stub_critical_depth;
+
+void (*stub_reg_hook)(CANFD_Type *base, volatile uint32_t *reg);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+uint32_t Cy_SysLib_EnterCriticalSection(void)
+{
+    stub_critical_depth++;
+    return 0UL;
+}
+
+void Cy_SysLib_ExitCriticalSection(uint32_t savedIntrStatus)
+{
+    (void)savedIntrStatus;
+    stub_critical_depth--;
+}
+
+volatile uint32_t *stub_reg(CANFD_Type *base, volatile uint32_t *reg)
+{
+    if (NULL != stub_reg_hook)
+    {
+        stub_reg_hook(base, reg);
+    }
+    return reg;
+}
+
+cy_en_canfd_status_t Cy_CANFD_ConfigChangesEnable(CANFD_Type *base,
+                                                  uint32_t chan)
+{
+    (void)base;
+    (void)chan;
+    return CY_CANFD_SUCCESS;
+}
+
+cy_en_canfd_status_t Cy_CANFD_ConfigChangesDisable(CANFD_Type *base,
+                                                   uint32_t chan)
+{
+    (void)base;
+    (void)chan;
+    return CY_CANFD_SUCCESS;
+}
+
+uint32_t Cy_CANFD_GetInterruptMask(CANFD_Type const *base, uint32_t chan)
+{
+    (void)chan;
+    return base->IE;
+}
+
+void Cy_CANFD_SetInterruptMask(CANFD_Type *base, uint32_t chan,
+                               uint32_t interrupt)
+{
+    (void)chan;
+    base->IE = interrupt;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/******************************************************************************
+* File Name:   test.h
+*
+* Description: Minimal checks for the host tests: a failed CHECK prints the
+*              file, the line and the expression, and test_result() gives the
+*              exit status.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdio.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define CHECK(expr)                                                         \
+    do                                                                      \
+    {                                                                       \
+        test_checks++;                                                      \
+        if (!(expr))                                                        \
+        {                                                                   \
+            test_failures++;                                                \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                          \
+    do                                                                      \
+    {                                                                       \
+        unsigned long test_a = (unsigned long)(actual);                     \
+        unsigned long test_e = (unsigned long)(expected);                   \
+        test_checks++;                                                      \
+        if (test_a != test_e)                                               \
+        {                                                                   \
+            test_failures++;                                                \
+            printf("%s:%d: %s is %lu, expected %lu\n", __FILE__, __LINE__,  \
+                   #actual, test_a, test_e);                                \
+        }                                                                   \
+    } while (0)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static unsigned int test_checks;
+static unsigned int test_failures;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+static inline int test_result(const char *name)
+{
+    printf("%s: %u checks, %u failed\n", name, test_checks, test_failures);
+    return (0u == test_failures) ? 0 : 1;
+}
+
+#endif /* TEST_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,302 @@
+/******************************************************************************
+* File Name:   test_canfd_classify.c
+*
+* Description: Host tests of canfd_classify.c: lookups of standard, extended
+*              and multiplexed identifiers, adds that fail on a full table
+*              without changing the tables, and range filters that fit the room
+*              left in the filter table.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <string.h>
+#include "test.h"
+#include "canfd_classify.h"
+#include "canfd_filter.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TEST_SID_BASE       (0x200UL)
+#define TEST_SID_COUNT      (16UL)
+#define TEST_MUX_ID         (0x300UL)
+#define TEST_FILL_BASE      (0x400UL)
+#define TEST_XID_BASE       (0x18FF0001UL)
+#define TEST_XID_COUNT      (4UL)
+#define TEST_MAX_FILTERS    (32UL)
+
+#define TEST_HANDLER(n)                                                     \
+    static void test_handler_##n(const canfd_frame_t *frame)                \
+    {                                                                       \
+        (void)frame;                                                        \
+    }
+
+/* Handlers that differ only in their address */
+TEST_HANDLER(0)  TEST_HANDLER(1)  TEST_HANDLER(2)  TEST_HANDLER(3)
+TEST_HANDLER(4)  TEST_HANDLER(5)  TEST_HANDLER(6)  TEST_HANDLER(7)
+TEST_HANDLER(8)  TEST_HANDLER(9)  TEST_HANDLER(10) TEST_HANDLER(11)
+TEST_HANDLER(12) TEST_HANDLER(13) TEST_HANDLER(14) TEST_HANDLER(15)
+TEST_HANDLER(16) TEST_HANDLER(17)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* One more than the handler table holds */
+static const canfd_classify_handler_t test_handlers[] =
+{
+    test_handler_0,  test_handler_1,  test_handler_2,  test_handler_3,
+    test_handler_4,  test_handler_5,  test_handler_6,  test_handler_7,
+    test_handler_8,  test_handler_9,  test_handler_10, test_handler_11,
+    test_handler_12, test_handler_13, test_handler_14, test_handler_15,
+    test_handler_16, test_handler_17
+};
+
+/* Filter table model: free elements and the filters added */
+static uint32_t test_sid_space;
+static uint32_t test_xid_space;
+static canfd_filter_t test_filters[TEST_MAX_FILTERS];
+static uint32_t test_filter_count;
+static uint32_t test_rejected;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+bool canfd_filter_add(const canfd_filter_t *filter)
+{
+    uint32_t *space = filter->extended ? &test_xid_space : &test_sid_space;
+
+    if ((0UL == *space) || (test_filter_count >= TEST_MAX_FILTERS))
+    {
+        test_rejected++;
+        return false;
+    }
+    (*space)--;
+    test_filters[test_filter_count++] = *filter;
+    return true;
+}
+
+uint32_t canfd_filter_space(bool extended)
+{
+    return extended ? test_xid_space : test_sid_space;
+}
+
+static canfd_classify_handler_t lookup(uint32_t id, bool extended,
+                                       uint8_t byte0)
+{
+    canfd_frame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    frame.flags = extended ? CANFD_FRAME_FLAG_XTD : 0U;
+    frame.len = 8U;
+    canfd_frame_bytes(&frame)[0] = byte0;
+    return canfd_classify_lookup(&frame);
+}
+
+/* True if one of the filters added accepts the identifier */
+static bool filtered(uint32_t id, bool extended)
+{
+    for (uint32_t idx = 0UL; idx < test_filter_count; idx++)
+    {
+        const canfd_filter_t *filter = &test_filters[idx];
+
+        if ((filter->extended == extended) && (filter->id1 <= id) &&
+            (id <= filter->id2))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_lookup(void)
+{
+    for (uint32_t idx = 0UL; idx < TEST_SID_COUNT; idx++)
+    {
+        CHECK(canfd_classify_add(TEST_SID_BASE + idx, false,
+                                 test_handlers[0]));
+    }
+    CHECK(canfd_classify_add_mux(TEST_MUX_ID, false, 0U, 0U, 0x0FU, 1U,
+                                 test_handlers[1]));
+    CHECK(canfd_classify_add_mux(TEST_MUX_ID, false, 0U, 0U, 0x0FU, 2U,
+                                 test_handlers[2]));
+    for (uint32_t idx = 0UL; idx < TEST_XID_COUNT; idx++)
+    {
+        CHECK(canfd_classify_add(TEST_XID_BASE + (idx << 8), true,
+                                 test_handlers[3]));
+    }
+
+    CHECK(lookup(TEST_SID_BASE, false, 0U) == test_handlers[0]);
+    CHECK(lookup(TEST_SID_BASE + TEST_SID_COUNT - 1UL, false, 0U) ==
+          test_handlers[0]);
+    CHECK(lookup(TEST_SID_BASE + TEST_SID_COUNT, false, 0U) == NULL);
+    CHECK(lookup(TEST_MUX_ID, false, 0x21U) == test_handlers[1]);
+    CHECK(lookup(TEST_MUX_ID, false, 0x02U) == test_handlers[2]);
+    CHECK(lookup(TEST_MUX_ID, false, 0x03U) == NULL);
+    CHECK(lookup(TEST_XID_BASE + 0x300UL, true, 0U) == test_handlers[3]);
+    CHECK(lookup(TEST_XID_BASE + 0x301UL, true, 0U) == NULL);
+    CHECK(lookup(TEST_SID_BASE, true, 0U) == NULL);
+
+    /* A plain identifier cannot become multiplexed and the reverse */
+    CHECK(!canfd_classify_add(TEST_MUX_ID, false, test_handlers[0]));
+    CHECK(!canfd_classify_add_mux(TEST_SID_BASE, false, 0U, 0U, 0x0FU, 1U,
+                                  test_handlers[0]));
+    CHECK(!canfd_classify_add_mux(TEST_MUX_ID, false, 1U, 0U, 0x0FU, 3U,
+                                  test_handlers[1]));
+    CHECK(lookup(TEST_MUX_ID, false, 0x21U) == test_handlers[1]);
+}
+
+/* Regression: a multiplexed identifier used to stay in the tables, without
+ * a route, when the multiplexer tables were full */
+static void test_mux_tables_full(void)
+{
+    uint32_t sid_count;
+
+    for (uint32_t idx = 1UL; idx < CANFD_CLASSIFY_MUX_TABLES; idx++)
+    {
+        CHECK(canfd_classify_add_mux(TEST_MUX_ID + idx, false, 0U, 0U, 0x0FU,
+                                     1U, test_handlers[1]));
+    }
+    CHECK_EQ(canfd_classify_get_stats()->mux_count, CANFD_CLASSIFY_MUX_TABLES);
+
+    sid_count = canfd_classify_get_stats()->sid_count;
+    CHECK(!canfd_classify_add_mux(TEST_MUX_ID + CANFD_CLASSIFY_MUX_TABLES,
+                                  false, 0U, 0U, 0x0FU, 1U, test_handlers[1]));
+    CHECK_EQ(canfd_classify_get_stats()->sid_count, sid_count);
+    CHECK(lookup(TEST_MUX_ID + CANFD_CLASSIFY_MUX_TABLES, false, 1U) == NULL);
+
+    /* Another value of a known multiplexer still fits */
+    CHECK(canfd_classify_add_mux(TEST_MUX_ID + 1UL, false, 0U, 0U, 0x0FU, 2U,
+                                 test_handlers[2]));
+    CHECK(lookup(TEST_MUX_ID + 1UL, false, 2U) == test_handlers[2]);
+}
+
+/* Regression: a new handler used to be registered before the identifier
+ * was found to have no room, so it took a handler slot for nothing */
+static void test_id_table_full(void)
+{
+    uint32_t fill = CANFD_CLASSIFY_SID_MAX -
+                    canfd_classify_get_stats()->sid_count;
+
+    for (uint32_t idx = 0UL; idx < fill; idx++)
+    {
+        CHECK(canfd_classify_add(TEST_FILL_BASE + idx, false,
+                                 test_handlers[0]));
+    }
+    CHECK_EQ(canfd_classify_get_stats()->sid_count, CANFD_CLASSIFY_SID_MAX);
+
+    /* Handlers 0 to 3 are in use; 4 must not be registered by this call */
+    CHECK(!canfd_classify_add(0x7F0UL, false, test_handlers[4]));
+    CHECK_EQ(canfd_classify_get_stats()->sid_count, CANFD_CLASSIFY_SID_MAX);
+    CHECK(lookup(0x7F0UL, false, 0U) == NULL);
+    CHECK(lookup(TEST_FILL_BASE + fill - 1UL, false, 0U) == test_handlers[0]);
+
+    /* So the twelve handlers 5 to 16 still fill the handler table */
+    for (uint32_t idx = 5UL; idx <= 16UL; idx++)
+    {
+        CHECK(canfd_classify_add(TEST_FILL_BASE + idx, false,
+                                 test_handlers[idx]));
+        CHECK(lookup(TEST_FILL_BASE + idx, false, 0U) == test_handlers[idx]);
+    }
+}
+
+/* Regression: an identifier used to be inserted without a route when the
+ * handler table was full */
+static void test_handler_table_full(void)
+{
+    uint32_t xid = TEST_XID_BASE + (TEST_XID_COUNT << 8);
+    uint32_t xid_count = canfd_classify_get_stats()->xid_count;
+
+    CHECK(!canfd_classify_add(xid, true, test_handlers[17]));
+    CHECK_EQ(canfd_classify_get_stats()->xid_count, xid_count);
+    CHECK(lookup(xid, true, 0U) == NULL);
+
+    CHECK(!canfd_classify_add_mux(xid, true, 0U, 0U, 0x0FU, 1U,
+                                  test_handlers[17]));
+    CHECK_EQ(canfd_classify_get_stats()->xid_count, xid_count);
+    CHECK_EQ(canfd_classify_get_stats()->mux_count, CANFD_CLASSIFY_MUX_TABLES);
+
+    /* A registered handler still takes the identifier */
+    CHECK(canfd_classify_add(xid, true, test_handlers[3]));
+    CHECK_EQ(canfd_classify_get_stats()->xid_count, xid_count + 1UL);
+    CHECK(lookup(xid, true, 0U) == test_handlers[3]);
+}
+
+/* The ranges merge to fit the free elements and cover every identifier */
+static void test_filters_fit(void)
+{
+    test_sid_space = 3UL;
+    test_xid_space = 2UL;
+    test_filter_count = 0UL;
+    test_rejected = 0UL;
+
+    CHECK(canfd_classify_add_filters(8UL, 8UL));
+    CHECK_EQ(test_filter_count, 4UL);
+    CHECK_EQ(test_rejected, 0UL);
+    for (uint32_t idx = 0UL; idx < TEST_SID_COUNT; idx++)
+    {
+        CHECK(filtered(TEST_SID_BASE + idx, false));
+    }
+    for (uint32_t idx = 0UL; idx < CANFD_CLASSIFY_MUX_TABLES; idx++)
+    {
+        CHECK(filtered(TEST_MUX_ID + idx, false));
+    }
+    CHECK(filtered(TEST_FILL_BASE, false));
+    for (uint32_t idx = 0UL; idx <= TEST_XID_COUNT; idx++)
+    {
+        CHECK(filtered(TEST_XID_BASE + (idx << 8), true));
+    }
+
+    /* Without room the result tells that identifiers are not covered */
+    test_sid_space = 4UL;
+    test_xid_space = 0UL;
+    test_filter_count = 0UL;
+    CHECK(!canfd_classify_add_filters(2UL, 2UL));
+    CHECK_EQ(test_filter_count, 2UL);
+    CHECK_EQ(test_rejected, 1UL);
+}
+
+int main(void)
+{
+    test_lookup();
+    test_mux_tables_full();
+    test_id_table_full();
+    test_handler_table_full();
+    test_filters_fit();
+    return test_result("canfd_classify");
+}
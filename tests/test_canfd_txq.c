@@ -0,0 +1,372 @@
+/******************************************************************************
+* File Name:   test_canfd_txq.c
+*
+* Description: Host tests of canfd_txq.c against a model of the M_TTCAN Tx
+*              FIFO: queueing behind a full FIFO, completion callbacks of sent
+*              and cancelled frames, and an element that completes while the
+*              queue refills the FIFO.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <string.h>
+#include "test.h"
+#include "canfd_txq.h"
+#include "sys_tick.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Dedicated Tx buffers in front of the FIFO */
+#define TEST_DEDICATED      (2UL)
+#define TEST_ELEMENTS       (TEST_DEDICATED + CANFD_TXQ_FIFO_SIZE)
+#define TEST_ELEM_WORDS     (18UL)
+#define TEST_LOG_SIZE       (64UL)
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t id;
+    bool sent;
+} test_done_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static CANFD_Type test_can;
+static cy_stc_canfd_context_t test_context;
+static uint32_t test_ram[TEST_ELEMENTS][TEST_ELEM_WORDS];
+
+/* FIFO model: get and put as FIFO positions, fill level */
+static uint32_t hw_get;
+static uint32_t hw_put;
+static uint32_t hw_fill;
+
+/* Completion callbacks, in call order */
+static test_done_t test_log[TEST_LOG_SIZE];
+static uint32_t test_log_count;
+
+/* Frames the register hook transmits at the next TXBCF access */
+static uint32_t hook_transmit;
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/* Functions of the other modules used by canfd_txq.c */
+uint32_t sys_tick_ms(void)
+{
+    return 0UL;
+}
+
+void task_event_signal(task_event_t *event)
+{
+    (void)event;
+}
+
+uint32_t canfd_dlc_to_len(uint32_t dlc)
+{
+    static const uint8_t len[16] =
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+    return len[dlc & 0xFUL];
+}
+
+/* Only the identifier is needed to tell the elements apart */
+void canfd_frame_to_element(const canfd_frame_t *frame,
+                            volatile uint32_t *element)
+{
+    element[0] = frame->id;
+}
+
+uintptr_t Cy_CANFD_CalcTxBufAdrs(CANFD_Type const *base, uint32_t chan,
+                                 uint32_t index,
+                                 cy_stc_canfd_context_t const *context)
+{
+    (void)base;
+    (void)chan;
+    (void)context;
+    CHECK(index < TEST_ELEMENTS);
+    return (uintptr_t)test_ram[index % TEST_ELEMENTS];
+}
+
+/* Buffer bit of a FIFO position */
+static uint32_t hw_bit(uint32_t pos)
+{
+    return 1UL << (TEST_DEDICATED + (pos % CANFD_TXQ_FIFO_SIZE));
+}
+
+static void hw_update_fqs(void)
+{
+    test_can.TXFQS =
+        _VAL2FLD(CANFD_CH_M_TTCAN_TXFQS_TFFL, CANFD_TXQ_FIFO_SIZE - hw_fill) |
+        _VAL2FLD(CANFD_CH_M_TTCAN_TXFQS_TFGI,
+                 TEST_DEDICATED + (hw_get % CANFD_TXQ_FIFO_SIZE)) |
+        _VAL2FLD(CANFD_CH_M_TTCAN_TXFQS_TFQPI,
+                 TEST_DEDICATED + (hw_put % CANFD_TXQ_FIFO_SIZE));
+}
+
+/* Takes the TXBAR write of the last canfd_txq_service: the requests must
+ * be the next positions of the FIFO */
+static void hw_sync(void)
+{
+    uint32_t request = test_can.TXBAR;
+
+    test_can.TXBAR = 0UL;
+    while (0UL != request)
+    {
+        uint32_t bit = hw_bit(hw_put);
+
+        CHECK(0UL != (request & bit));
+        CHECK(hw_fill < CANFD_TXQ_FIFO_SIZE);
+        if ((0UL == (request & bit)) || (hw_fill >= CANFD_TXQ_FIFO_SIZE))
+        {
+            return;
+        }
+        request &= ~bit;
+        test_can.TXBRP |= bit;
+        test_can.TXBTO &= ~bit;
+        test_can.TXBCF &= ~bit;
+        hw_put++;
+        hw_fill++;
+    }
+    hw_update_fqs();
+}
+
+/* Ends the oldest requests, sent or cancelled */
+static void hw_finish(uint32_t count, bool sent)
+{
+    while ((0UL != count) && (0UL != hw_fill))
+    {
+        uint32_t bit = hw_bit(hw_get);
+
+        test_can.TXBRP &= ~bit;
+        if (sent)
+        {
+            test_can.TXBTO |= bit;
+        }
+        else
+        {
+            test_can.TXBCF |= bit;
+        }
+        hw_get++;
+        hw_fill--;
+        count--;
+    }
+    hw_update_fqs();
+}
+
+static uint32_t service(void)
+{
+    uint32_t count = canfd_txq_service();
+
+    CHECK_EQ(stub_critical_depth, 0u);
+    hw_sync();
+    return count;
+}
+
+static void on_done(void *arg, bool sent)
+{
+    CHECK(test_log_count < TEST_LOG_SIZE);
+    if (test_log_count < TEST_LOG_SIZE)
+    {
+        test_log[test_log_count].id = (uint32_t)(uintptr_t)arg;
+        test_log[test_log_count].sent = sent;
+        test_log_count++;
+    }
+}
+
+/* Each frame of 0..count-1 was called back once, as sent. Frames that
+ * complete together are called back in buffer order, not queue order */
+static void expect_all_sent(uint32_t count)
+{
+    uint32_t calls;
+
+    CHECK_EQ(test_log_count, count);
+    for (uint32_t id = 0UL; id < count; id++)
+    {
+        calls = 0UL;
+        for (uint32_t idx = 0UL; idx < test_log_count; idx++)
+        {
+            if (test_log[idx].id == id)
+            {
+                calls++;
+                CHECK(test_log[idx].sent);
+            }
+        }
+        CHECK_EQ(calls, 1u);
+    }
+}
+
+static void send(uint32_t id)
+{
+    canfd_frame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = id;
+    CHECK_EQ(canfd_txq_send_async(&frame, on_done, (void *)(uintptr_t)id),
+             CY_RSLT_SUCCESS);
+}
+
+/* Completes a frame right after canfd_txq_service has looked for
+ * completions (TXBTO, then TXBCF) */
+static void hook_finish(CANFD_Type *base, volatile uint32_t *reg)
+{
+    if ((&base->TXBCF == reg) && (0UL != hook_transmit))
+    {
+        hw_finish(hook_transmit, true);
+        hook_transmit = 0UL;
+    }
+}
+
+static void setup(void)
+{
+    static const cy_stc_canfd_config_t config =
+    {
+        .messageRAMsize = sizeof(test_ram),
+    };
+
+    memset(&test_can, 0, sizeof(test_can));
+    memset(test_ram, 0, sizeof(test_ram));
+    hw_get = 0UL;
+    hw_put = 0UL;
+    hw_fill = 0UL;
+    test_log_count = 0UL;
+    stub_reg_hook = NULL;
+
+    test_can.TXBC = _VAL2FLD(CANFD_CH_M_TTCAN_TXBC_NDTB, TEST_DEDICATED);
+    test_can.TXESC = _VAL2FLD(CANFD_CH_M_TTCAN_TXESC_TBDS, 7UL);
+    CHECK_EQ(canfd_txq_init(&test_can, 0UL, &config, &test_context),
+             CY_CANFD_SUCCESS);
+    CHECK_EQ(_FLD2VAL(CANFD_CH_M_TTCAN_TXBC_TFQS, test_can.TXBC),
+             CANFD_TXQ_FIFO_SIZE);
+    hw_update_fqs();
+}
+
+/* Frames beyond the FIFO wait in the queue and follow in order */
+static void test_queue_behind_fifo(void)
+{
+    setup();
+    for (uint32_t id = 0UL; id < 12UL; id++)
+    {
+        send(id);
+    }
+    CHECK_EQ(service(), CANFD_TXQ_FIFO_SIZE);
+    CHECK_EQ(canfd_txq_depth(), 4u);
+
+    hw_finish(3UL, true);
+    CHECK_EQ(service(), 3u);
+    CHECK_EQ(canfd_txq_depth(), 1u);
+    CHECK_EQ(test_log_count, 3u);
+    for (uint32_t idx = 0UL; idx < 3UL; idx++)
+    {
+        CHECK_EQ(test_log[idx].id, idx);
+        CHECK(test_log[idx].sent);
+        /* Refilled with the frames that waited */
+        CHECK_EQ(test_ram[TEST_DEDICATED + idx][0], 8UL + idx);
+    }
+
+    hw_finish(CANFD_TXQ_FIFO_SIZE, true);
+    (void)service();
+    hw_finish(CANFD_TXQ_FIFO_SIZE, true);
+    (void)service();
+    CHECK_EQ(canfd_txq_depth(), 0u);
+    expect_all_sent(12UL);
+}
+
+/* A cancelled request calls back with sent false */
+static void test_cancelled(void)
+{
+    setup();
+    send(0x10UL);
+    send(0x11UL);
+    (void)service();
+    hw_finish(1UL, false);
+    hw_finish(1UL, true);
+    (void)service();
+    CHECK_EQ(test_log_count, 2u);
+    CHECK_EQ(test_log[0].id, 0x10u);
+    CHECK(!test_log[0].sent);
+    CHECK_EQ(test_log[1].id, 0x11u);
+    CHECK(test_log[1].sent);
+}
+
+/* Regression: an element that completed after the completions were read
+ * was refilled with its callback still due; the new request reset its
+ * TXBTO bit and the callback was lost or called for the new frame */
+static void test_complete_during_refill(void)
+{
+    setup();
+    for (uint32_t id = 0UL; id <= CANFD_TXQ_FIFO_SIZE; id++)
+    {
+        send(id);
+    }
+    CHECK_EQ(service(), CANFD_TXQ_FIFO_SIZE);
+
+    hook_transmit = 1UL;
+    stub_reg_hook = hook_finish;
+    (void)service();
+    stub_reg_hook = NULL;
+    CHECK_EQ(hook_transmit, 0u);
+
+    /* The transmission complete interrupt of the frame */
+    (void)service();
+    CHECK_EQ(test_log_count, 1u);
+    CHECK_EQ(test_log[0].id, 0u);
+    CHECK(test_log[0].sent);
+    CHECK_EQ(canfd_txq_depth(), 0u);
+    CHECK_EQ(test_ram[TEST_DEDICATED][0], CANFD_TXQ_FIFO_SIZE);
+
+    hw_finish(CANFD_TXQ_FIFO_SIZE, true);
+    (void)service();
+    expect_all_sent(CANFD_TXQ_FIFO_SIZE + 1UL);
+    CHECK_EQ(canfd_txq_get_stats()->callbacks,
+             12u + 2u + CANFD_TXQ_FIFO_SIZE + 1u);
+}
+
+int main(void)
+{
+    test_queue_behind_fifo();
+    test_cancelled();
+    test_complete_during_refill();
+    return test_result("canfd_txq");
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,221 @@
+/******************************************************************************
+* File Name:   test_stream_reasm.c
+*
+* Description: Host tests of stream_reasm.c: in-order delivery, reordering
+*              inside the window, duplicates, and gaps longer than the reorder
+*              window.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <string.h>
+#include "test.h"
+#include "stream_reasm.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+#define TEST_CAN_ID         (0x100UL)
+#define TEST_PAYLOAD        (4u)    /* Bytes after the sequence number */
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+static uint8_t test_buffer[1024];
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/* Registers a stream with the sequence number in bytes 0..1 and the payload
+ * in bytes 2..5 */
+static void setup(stream_reasm_t *stream, uint8_t window)
+{
+    stream_reasm_config_t config =
+    {
+        .can_id = TEST_CAN_ID,
+        .seq_offset = 0u,
+        .data_offset = 2u,
+        .reorder_window = window,
+        .buffer = test_buffer,
+        .buffer_size = sizeof(test_buffer),
+    };
+
+    CHECK(stream_reasm_register(stream, &config));
+}
+
+/* Frame with sequence number seq and the payload seq, seq+1, ... */
+static void push(stream_reasm_t *stream, uint16_t seq)
+{
+    canfd_frame_t frame;
+    uint8_t *bytes = canfd_frame_bytes(&frame);
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = TEST_CAN_ID;
+    frame.len = (uint8_t)(2u + TEST_PAYLOAD);
+    bytes[0] = (uint8_t)seq;
+    bytes[1] = (uint8_t)(seq >> 8);
+    for (uint32_t idx = 0UL; idx < TEST_PAYLOAD; idx++)
+    {
+        bytes[2UL + idx] = (uint8_t)(seq + idx);
+    }
+    stream_reasm_push(stream, &frame);
+}
+
+/* Checks that the buffer holds the payloads of the sequence numbers in
+ * order, and consumes them */
+static void expect_payloads(stream_reasm_t *stream, const uint16_t *seqs,
+                            uint32_t count)
+{
+    stream_reasm_span_t span;
+
+    CHECK_EQ(stream_reasm_available(stream), count * TEST_PAYLOAD);
+    for (uint32_t frame = 0UL; frame < count; frame++)
+    {
+        span = stream_reasm_peek(stream);
+        CHECK(span.len >= TEST_PAYLOAD);
+        if (span.len < TEST_PAYLOAD)
+        {
+            return;
+        }
+        CHECK_EQ(span.data[0], (uint8_t)seqs[frame]);
+        CHECK_EQ(span.data[TEST_PAYLOAD - 1u],
+                 (uint8_t)(seqs[frame] + TEST_PAYLOAD - 1u));
+        stream_reasm_consume(stream, TEST_PAYLOAD);
+    }
+}
+
+static void test_reorder_in_window(void)
+{
+    static stream_reasm_t stream;
+    static const uint16_t order[] = { 0u, 1u, 2u, 3u, 4u };
+
+    setup(&stream, 4u);
+    push(&stream, 0u);
+    push(&stream, 2u);
+    push(&stream, 3u);
+    push(&stream, 1u);
+    push(&stream, 4u);
+    push(&stream, 3u);
+
+    CHECK_EQ(stream.stats.frames, 5u);
+    CHECK_EQ(stream.stats.reordered, 2u);
+    CHECK_EQ(stream.stats.lost, 0u);
+    CHECK_EQ(stream.stats.duplicates, 1u);
+    expect_payloads(&stream, order, 5UL);
+}
+
+/* Regression: a frame beyond the window used to take the slot of a frame
+ * held right after the gap, so one missing frame lost the whole stream */
+static void test_gap_longer_than_window(void)
+{
+    static stream_reasm_t stream;
+    uint16_t order[37];
+
+    setup(&stream, 4u);
+    push(&stream, 0u);
+    order[0] = 0u;
+    for (uint16_t seq = 2u; seq <= 37u; seq++)
+    {
+        push(&stream, seq);
+        order[seq - 1u] = seq;
+    }
+
+    CHECK_EQ(stream.stats.frames, 37u);
+    CHECK_EQ(stream.stats.lost, 1u);
+    CHECK_EQ(stream.stats.duplicates, 0u);
+    CHECK_EQ(stream.expected, 38u);
+    CHECK_EQ(stream.pending_mask, 0u);
+    expect_payloads(&stream, order, 37UL);
+}
+
+/* A jump far ahead counts the skipped numbers as lost and keeps the new
+ * frame until the numbers before it arrive */
+static void test_jump_ahead(void)
+{
+    static stream_reasm_t stream;
+    static const uint16_t order[] = { 0u, 6u, 7u, 8u, 9u, 10u };
+
+    setup(&stream, 4u);
+    push(&stream, 0u);
+    push(&stream, 10u);
+    CHECK_EQ(stream.stats.frames, 1u);
+    CHECK_EQ(stream.stats.lost, 5u);
+    CHECK_EQ(stream.expected, 6u);
+
+    push(&stream, 5u);
+    CHECK_EQ(stream.stats.duplicates, 1u);
+    push(&stream, 6u);
+    push(&stream, 7u);
+    push(&stream, 8u);
+    push(&stream, 9u);
+    CHECK_EQ(stream.stats.frames, 6u);
+    CHECK_EQ(stream.stats.lost, 5u);
+    CHECK_EQ(stream.expected, 11u);
+    expect_payloads(&stream, order, 6UL);
+}
+
+/* Without a reorder window every gap is lost at once */
+static void test_no_window(void)
+{
+    static stream_reasm_t stream;
+    static const uint16_t order[] = { 0xFFFEu, 0xFFFFu, 2u, 3u };
+
+    setup(&stream, 0u);
+    push(&stream, 0xFFFEu);
+    push(&stream, 0xFFFFu);
+    push(&stream, 2u);
+    push(&stream, 1u);
+    push(&stream, 3u);
+
+    CHECK_EQ(stream.stats.frames, 4u);
+    CHECK_EQ(stream.stats.lost, 2u);
+    CHECK_EQ(stream.stats.duplicates, 1u);
+    expect_payloads(&stream, order, 4UL);
+}
+
+int main(void)
+{
+    test_reorder_in_window();
+    test_gap_longer_than_window();
+    test_jump_ahead();
+    test_no_window();
+    return test_result("stream_reasm");
+}
+
+/* [] END OF FILE */
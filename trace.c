@@ -0,0 +1,304 @@
+/******************************************************************************
+* File Name:   trace.c
+*
+* Description: Event tracer: fixed-size events with DWT cycle timestamps
+*              recorded into a RAM ring from any context and sent over the
+*              binary log channel.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <string.h>
+#include "trace.h"
+#include "stats_registry.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Record payload: first event index (u32), core clock in Hz (u32), events
+ * lost so far (u32), event count (u16), reserved (u16), then the events as
+ * stored in the ring (timestamp u32, type u8, arg8 u8, arg16 u16; little
+ * endian like the core) */
+#define TRACE_RECORD_HEADER     (16u)
+#define TRACE_EVENT_SIZE        (8u)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+trace_ring_t trace_ring;
+
+static trace_stats_t trace_stats;
+
+/* Index of the next event to send */
+static uint32_t trace_tail;
+static bool trace_streaming;
+static binlog_channel_t trace_channel;
+
+STATS_COUNTER(sent, "trace.sent", &trace_stats.sent);
+STATS_COUNTER(lost, "trace.lost", &trace_stats.lost);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint32_t trace_send(binlog_channel_t channel);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: trace_init
+********************************************************************************
+* Summary:
+* Empties the ring and starts recording if TRACE_ENABLE is set.
+*
+*******************************************************************************/
+void trace_init(void)
+{
+    cycle_count_init();
+
+    trace_ring.recording = false;
+    trace_ring.head = 0UL;
+    trace_tail = 0UL;
+    memset(trace_ring.events, 0, sizeof(trace_ring.events));
+    trace_ring.recording = (0u != TRACE_ENABLE);
+}
+
+/*******************************************************************************
+* Function Name: trace_set_recording
+********************************************************************************
+* Summary:
+* Stops or resumes recording, e.g. to freeze the ring around an event of
+* interest. The ring keeps its contents.
+*
+*******************************************************************************/
+void trace_set_recording(bool recording)
+{
+    trace_ring.recording = recording && (0u != TRACE_ENABLE);
+}
+
+/*******************************************************************************
+* Function Name: trace_set_streaming / trace_is_streaming
+********************************************************************************
+* Summary:
+* Starts or stops streaming from trace_process. Streaming starts with the
+* events recorded from now on. A UART at 115200 baud carries about 1400
+* events/s; the main loop waits for the UART while a record is written, so
+* use trace_dump for undisturbed timelines of short bursts.
+*
+*******************************************************************************/
+void trace_set_streaming(binlog_channel_t channel, bool streaming)
+{
+    trace_channel = channel;
+    trace_tail = trace_ring.head;
+    trace_streaming = streaming;
+}
+
+bool trace_is_streaming(void)
+{
+    return trace_streaming;
+}
+
+/*******************************************************************************
+* Function Name: trace_process
+********************************************************************************
+* Summary:
+* Main loop part of the streaming: sends up to TRACE_STREAM_BATCH events.
+*
+*******************************************************************************/
+void trace_process(void)
+{
+    if (trace_streaming)
+    {
+        (void)trace_send(trace_channel);
+    }
+}
+
+/*******************************************************************************
+* Function Name: trace_dump
+********************************************************************************
+* Summary:
+* Sends the ring contents that were not streamed yet. Recording is paused
+* during the dump so that it does not trace itself.
+*
+*******************************************************************************/
+void trace_dump(binlog_channel_t channel)
+{
+    bool recording = trace_ring.recording;
+    uint32_t head;
+
+    trace_ring.recording = false;
+
+    head = trace_ring.head;
+    if ((head - trace_tail) > TRACE_RING_EVENTS)
+    {
+        trace_tail = head - TRACE_RING_EVENTS;
+    }
+    while (0UL != trace_send(channel))
+    {
+    }
+
+    trace_ring.recording = recording;
+}
+
+/*******************************************************************************
+* Function Name: trace_copy_last
+********************************************************************************
+* Summary:
+* Copies the most recent events, oldest first, without stopping the writers.
+* For fault and diagnostic records.
+*
+* Return:
+*  uint32_t  events copied
+*
+*******************************************************************************/
+uint32_t trace_copy_last(trace_event_t *dst, uint32_t max_events)
+{
+    uint32_t head = trace_ring.head;
+    uint32_t count = (head < TRACE_RING_EVENTS) ? head : TRACE_RING_EVENTS;
+
+    if (count > max_events)
+    {
+        count = max_events;
+    }
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        dst[idx] = trace_ring.events[(head - count + idx) &
+                                     (TRACE_RING_EVENTS - 1UL)];
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: trace_get_stats
+*******************************************************************************/
+const trace_stats_t *trace_get_stats(void)
+{
+    return &trace_stats;
+}
+
+/*******************************************************************************
+* Function Name: trace_send
+********************************************************************************
+* Summary:
+* Sends the next events, up to TRACE_STREAM_BATCH, as one record. The events
+* are copied first; those overwritten by writers during the copy are dropped
+* and counted as lost, as are events the ring lost before.
+*
+* Return:
+*  uint32_t  events sent
+*
+*******************************************************************************/
+static uint32_t trace_send(binlog_channel_t channel)
+{
+    trace_event_t batch[TRACE_STREAM_BATCH];
+    uint8_t header[TRACE_RECORD_HEADER];
+    uint32_t head = trace_ring.head;
+    uint32_t first;
+    uint32_t count;
+    uint32_t skip;
+
+    if ((head - trace_tail) > TRACE_RING_EVENTS)
+    {
+        trace_stats.lost += head - trace_tail - TRACE_RING_EVENTS;
+        trace_tail = head - TRACE_RING_EVENTS;
+    }
+
+    count = head - trace_tail;
+    if (count > TRACE_STREAM_BATCH)
+    {
+        count = TRACE_STREAM_BATCH;
+    }
+    if (0UL == count)
+    {
+        return 0UL;
+    }
+
+    for (uint32_t idx = 0UL; idx < count; idx++)
+    {
+        batch[idx] = trace_ring.events[(trace_tail + idx) &
+                                       (TRACE_RING_EVENTS - 1UL)];
+    }
+
+    /* Slots reused while they were copied */
+    first = trace_tail;
+    head = trace_ring.head;
+    skip = ((head - first) > TRACE_RING_EVENTS) ?
+           (head - first - TRACE_RING_EVENTS) : 0UL;
+    if (skip > count)
+    {
+        skip = count;
+    }
+    trace_stats.lost += skip;
+    trace_tail = first + count;
+    if (skip == count)
+    {
+        return count;
+    }
+
+    first += skip;
+    header[0] = (uint8_t)first;
+    header[1] = (uint8_t)(first >> 8);
+    header[2] = (uint8_t)(first >> 16);
+    header[3] = (uint8_t)(first >> 24);
+    header[4] = (uint8_t)SystemCoreClock;
+    header[5] = (uint8_t)(SystemCoreClock >> 8);
+    header[6] = (uint8_t)(SystemCoreClock >> 16);
+    header[7] = (uint8_t)(SystemCoreClock >> 24);
+    header[8] = (uint8_t)trace_stats.lost;
+    header[9] = (uint8_t)(trace_stats.lost >> 8);
+    header[10] = (uint8_t)(trace_stats.lost >> 16);
+    header[11] = (uint8_t)(trace_stats.lost >> 24);
+    header[12] = (uint8_t)(count - skip);
+    header[13] = (uint8_t)((count - skip) >> 8);
+    header[14] = 0u;
+    header[15] = 0u;
+
+    if (binlog_begin(channel, BINLOG_TYPE_TRACE, TRACE_RECORD_HEADER +
+                     ((count - skip) * TRACE_EVENT_SIZE)))
+    {
+        binlog_write(header, TRACE_RECORD_HEADER);
+        binlog_write(&batch[skip], (count - skip) * TRACE_EVENT_SIZE);
+        binlog_end();
+        trace_stats.sent += count - skip;
+        trace_stats.records++;
+    }
+    return count;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,216 @@
+/******************************************************************************
+* File Name:   trace.h
+*
+* Description: Event tracer: fixed-size events with DWT cycle timestamps
+*              recorded into a RAM ring from any context and sent over the
+*              binary log channel.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2023-2024, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*******************************************************************************
+* Header Files
+*******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_pdl.h"
+#include "binlog.h"
+#include "cycle_count.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Set to 1 (DEFINES+=TRACE_ENABLE=1 in the Makefile) to compile the trace
+ * points in; they cost nothing otherwise */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE            (0u)
+#endif
+
+/* Events held in RAM (power of two), 8 bytes each */
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS     (1024u)
+#endif
+
+/* Events per binary log record while streaming */
+#ifndef TRACE_STREAM_BATCH
+#define TRACE_STREAM_BATCH      (32u)
+#endif
+
+#if (TRACE_ENABLE)
+#define TRACE_RING_EVENTS       (TRACE_BUFFER_EVENTS)
+#else
+#define TRACE_RING_EVENTS       (1u)
+#endif
+
+/* Event types; arg8 and arg16 as noted */
+#define TRACE_ISR_ENTER         (1u)    /* CAN FD interrupt entry */
+#define TRACE_ISR_EXIT          (2u)    /* CAN FD interrupt return */
+#define TRACE_RX_FRAME          (3u)    /* Frame handled: len, id */
+#define TRACE_TXQ_PUSH          (4u)    /* Frame queued: depth, id */
+#define TRACE_TXQ_SUBMIT        (5u)    /* Frames to hardware: count, depth */
+#define TRACE_TX_DONE           (6u)    /* Transmission complete */
+#define TRACE_RXQ_DRAIN         (7u)    /* Rx FIFO 0 drained: count, depth */
+#define TRACE_RXQ_PROCESS       (8u)    /* Queued frames handled: -, count */
+#define TRACE_LOOP              (9u)    /* Main loop iteration: -, merged */
+
+#if (TRACE_ENABLE)
+#define TRACE(type, arg8, arg16)    trace_event((type), (uint8_t)(arg8), \
+                                                (uint16_t)(arg16))
+#define TRACE_LOOP_ITERATION()      trace_loop()
+#else
+#define TRACE(type, arg8, arg16)    do { } while (0)
+#define TRACE_LOOP_ITERATION()      do { } while (0)
+#endif
+
+/*******************************************************************************
+* Data Structures
+*******************************************************************************/
+typedef struct
+{
+    uint32_t timestamp;     /* DWT cycle count */
+    uint8_t type;           /* TRACE_xxx */
+    uint8_t arg8;
+    uint16_t arg16;
+} trace_event_t;
+
+typedef struct
+{
+    volatile uint32_t head;     /* Events written since trace_init */
+    volatile bool recording;
+    trace_event_t events[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+typedef struct
+{
+    uint32_t sent;          /* Events sent over the binary log */
+    uint32_t lost;          /* Events overwritten before they were sent */
+    uint32_t records;       /* Binary log records sent */
+} trace_stats_t;
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+extern trace_ring_t trace_ring;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void trace_init(void);
+void trace_set_recording(bool recording);
+void trace_set_streaming(binlog_channel_t channel, bool streaming);
+bool trace_is_streaming(void);
+void trace_process(void);
+void trace_dump(binlog_channel_t channel);
+uint32_t trace_copy_last(trace_event_t *dst, uint32_t max_events);
+const trace_stats_t *trace_get_stats(void);
+
+/*******************************************************************************
+* Function Definitions
+*******************************************************************************/
+
+/*******************************************************************************
+* Function Name: trace_event
+********************************************************************************
+* Summary:
+* Records an event from any context: one exclusive-access increment of the
+* head reserves the slot, then the event is stored as two words. Use through
+* the TRACE macro so that disabled builds contain no code.
+*
+*******************************************************************************/
+__STATIC_INLINE void trace_event(uint8_t type, uint8_t arg8, uint16_t arg16)
+{
+    uint32_t idx;
+    trace_event_t *event;
+
+    if (!trace_ring.recording)
+    {
+        return;
+    }
+
+#if (__CORTEX_M >= 3U)
+    do
+    {
+        idx = __LDREXW(&trace_ring.head);
+    } while (0UL != __STREXW(idx + 1UL, &trace_ring.head));
+#else
+    {
+        uint32_t saved_intr = Cy_SysLib_EnterCriticalSection();
+
+        idx = trace_ring.head;
+        trace_ring.head = idx + 1UL;
+        Cy_SysLib_ExitCriticalSection(saved_intr);
+    }
+#endif
+
+    event = &trace_ring.events[idx & (TRACE_RING_EVENTS - 1UL)];
+    event->timestamp = cycle_count_now();
+    event->type = type;
+    event->arg8 = arg8;
+    event->arg16 = arg16;
+}
+
+/*******************************************************************************
+* Function Name: trace_loop
+********************************************************************************
+* Summary:
+* Marks a main loop iteration. Iterations that record nothing else are merged
+* into the previous marker, which counts them in arg16, so an idle loop does
+* not flush the ring.
+*
+*******************************************************************************/
+__STATIC_INLINE void trace_loop(void)
+{
+    uint32_t head = trace_ring.head;
+    trace_event_t *last = &trace_ring.events[(head - 1UL) &
+                                             (TRACE_RING_EVENTS - 1UL)];
+
+    if ((0UL != head) && (TRACE_LOOP == last->type))
+    {
+        if (0xFFFFu != last->arg16)
+        {
+            last->arg16++;
+        }
+        return;
+    }
+    trace_event(TRACE_LOOP, 0u, 1u);
+}
+
+#endif /* TRACE_H_ */
+
+/* [] END OF FILE */